@@ -34,6 +34,8 @@
 #ifndef __UKPLAT_IRQ_H__
 #define __UKPLAT_IRQ_H__
 
+#include <uk/arch/types.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -58,6 +60,23 @@ typedef int (*irq_handler_func_t)(void *);
  */
 int ukplat_irq_register(unsigned long irq, irq_handler_func_t func, void *arg);
 
+/**
+ * Allocates an interrupt for a message signaled interrupt (MSI/MSI-X)
+ * @param irq Filled out with the allocated interrupt number
+ * @param addr Filled out with the address the device writes the message to
+ * @param data Filled out with the message the device writes
+ * @return 0 on success, -ENOTSUP if the platform does not support message
+ *         signaled interrupts, -ENOSPC if no interrupt is left
+ */
+int ukplat_irq_msi_alloc(unsigned long *irq, __u64 *addr, __u32 *data);
+
+/**
+ * Releases an interrupt allocated with ukplat_irq_msi_alloc(). It must not
+ * have been registered with ukplat_irq_register().
+ * @param irq Interrupt number
+ */
+void ukplat_irq_msi_free(unsigned long irq);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,154 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Platform page table management
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * THIS HEADER MAY NOT BE EXTRACTED OR MODIFIED IN ANY WAY.
+ */
+
+#ifndef __UKPLAT_PAGING_H__
+#define __UKPLAT_PAGING_H__
+
+#include <uk/arch/types.h>
+#include <uk/config.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Page protection flags */
+#define UKPLAT_PAGE_PROT_NONE	(0x0)
+#define UKPLAT_PAGE_PROT_READ	(0x1)
+#define UKPLAT_PAGE_PROT_WRITE	(0x2)
+#define UKPLAT_PAGE_PROT_EXEC	(0x4)
+
+/* Page fault flags */
+#define UKPLAT_PAGEFAULT_WRITE	 (0x1)	/* Faulting access was a write */
+#define UKPLAT_PAGEFAULT_EXEC	 (0x2)	/* Faulting access was a fetch */
+#define UKPLAT_PAGEFAULT_PRESENT (0x4)	/* Page was mapped, access was denied */
+
+/*
+ * The following interface is implemented by platforms that select
+ * CONFIG_HAVE_PAGING. ukplat_pagefault_handler_register() fails with
+ * -ENOTSUP on all other platforms.
+ */
+
+/**
+ * Page fault handler
+ * @param vaddr Faulting virtual address
+ * @param flags Kind of the access (UKPLAT_PAGEFAULT_*)
+ * @return 0 if the fault was resolved and the access shall be retried,
+ *         < 0 if the fault is fatal
+ */
+typedef int (*ukplat_pagefault_handler_t)(__uptr vaddr, unsigned long flags);
+
+/**
+ * Called for every mapped page by ukplat_page_unmap()
+ * @param vaddr Virtual address of the page
+ * @param paddr Physical address of the page frame that was mapped
+ * @param cookie Argument that was passed to ukplat_page_unmap()
+ */
+typedef void (*ukplat_page_unmap_cb_t)(__uptr vaddr, __uptr paddr,
+				       void *cookie);
+
+/**
+ * Returns the virtual address range that is reserved for dynamic page
+ * mappings. It is not backed by memory unless pages are mapped with
+ * ukplat_page_map().
+ * @param base Filled out with the base address of the range
+ * @param len Filled out with the length of the range
+ */
+void ukplat_paging_window(__uptr *base, __sz *len);
+
+/**
+ * Maps a page frame into the dynamic mapping window. Page tables are
+ * allocated from the platform memory allocator as needed.
+ * @param vaddr Page-aligned virtual address
+ * @param paddr Page-aligned physical address of the page frame
+ * @param prot Protection of the page (UKPLAT_PAGE_PROT_*). The frame stays
+ *        assigned to `vaddr` with UKPLAT_PAGE_PROT_NONE but is inaccessible
+ * @return 0 on success, -EINVAL if `vaddr` is outside the window,
+ *         -EEXIST if a frame is already mapped, -ENOMEM if no page table
+ *         could be allocated
+ */
+int ukplat_page_map(__uptr vaddr, __uptr paddr, unsigned long prot);
+
+/**
+ * Unmaps all pages of a range of the dynamic mapping window
+ * @param vaddr Page-aligned virtual address
+ * @param len Length of the range, multiple of the page size
+ * @param cb Called for every page frame that was mapped (may be NULL)
+ * @param cookie Argument for `cb`
+ * @return Number of unmapped pages, -EINVAL if the range is outside the
+ *         window
+ */
+long ukplat_page_unmap(__uptr vaddr, __sz len,
+		       ukplat_page_unmap_cb_t cb, void *cookie);
+
+/**
+ * Changes the protection of all mapped pages of a range of the dynamic
+ * mapping window
+ * @param vaddr Page-aligned virtual address
+ * @param len Length of the range, multiple of the page size
+ * @param prot New protection (UKPLAT_PAGE_PROT_*)
+ * @return 0 on success, -EINVAL if the range is outside the window
+ */
+int ukplat_page_set_prot(__uptr vaddr, __sz len, unsigned long prot);
+
+/**
+ * Looks up the page frame that is mapped at a virtual address of the
+ * dynamic mapping window
+ * @param vaddr Page-aligned virtual address
+ * @param paddr Filled out with the physical address of the frame
+ * @return 0 on success, -ENOENT if no frame is mapped
+ */
+int ukplat_page_lookup(__uptr vaddr, __uptr *paddr);
+
+/**
+ * Maps a range of device memory (MMIO) uncached. The mapping is outside of
+ * the dynamic mapping window and cannot be removed.
+ * @param paddr Physical address of the range
+ * @param len Length of the range
+ * @return Virtual address of `paddr`, NULL if the range could not be mapped
+ */
+void *ukplat_io_map(__uptr paddr, __sz len);
+
+/**
+ * Installs the handler for page faults. Faults that are not resolved
+ * by the handler crash the system.
+ * @param handler Page fault handler, NULL to remove the handler
+ * @return 0 on success, < 0 otherwise
+ */
+int ukplat_pagefault_handler_register(ukplat_pagefault_handler_t handler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UKPLAT_PAGING_H__ */
@@ -572,12 +572,24 @@ out:
 #define uk_9pfs_fsync		((vnop_fsync_t)vfscore_vop_nullop)
 #define uk_9pfs_setattr		((vnop_setattr_t)vfscore_vop_nullop)
 #define uk_9pfs_truncate	((vnop_truncate_t)vfscore_vop_nullop)
+static int uk_9pfs_mmap(struct vnode *vp, struct vfscore_file *fp __unused,
+			off_t off __unused, size_t len __unused, void **addr)
+{
+	if (vp->v_type != VREG)
+		return ENODEV;
+
+	/* File data is not cached, mappings are populated by reading. */
+	*addr = NULL;
+	return 0;
+}
+
 #define uk_9pfs_link		((vnop_link_t)vfscore_vop_eperm)
 #define uk_9pfs_cache		((vnop_cache_t)NULL)
 #define uk_9pfs_readlink	((vnop_readlink_t)vfscore_vop_einval)
 #define uk_9pfs_symlink		((vnop_symlink_t)vfscore_vop_eperm)
 #define uk_9pfs_fallocate	((vnop_fallocate_t)vfscore_vop_nullop)
 #define uk_9pfs_rename		((vnop_rename_t)vfscore_vop_einval)
+#define uk_9pfs_munmap		((vnop_munmap_t)vfscore_vop_nullop)
 
 struct vnops uk_9pfs_vnops = {
 	.vop_open	= uk_9pfs_open,
@@ -602,5 +614,7 @@ struct vnops uk_9pfs_vnops = {
 	.vop_cache	= uk_9pfs_cache,
 	.vop_fallocate	= uk_9pfs_fallocate,
 	.vop_readlink	= uk_9pfs_readlink,
-	.vop_symlink	= uk_9pfs_symlink
+	.vop_symlink	= uk_9pfs_symlink,
+	.vop_mmap	= uk_9pfs_mmap,
+	.vop_munmap	= uk_9pfs_munmap
 };
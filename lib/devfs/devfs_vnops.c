@@ -289,6 +289,8 @@ struct vnops devfs_vnops = {
 	devfs_fallocate,	/* fallocate */
 	devfs_readlink,		/* read link */
 	devfs_symlink,		/* symbolic link */
+	(vnop_mmap_t) NULL, /* mmap */
+	(vnop_munmap_t) NULL, /* munmap */
 };
 
 /*
@@ -0,0 +1,151 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * devfs nodes with statistics reports
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <uk/config.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <uk/ctors.h>
+#include <uk/print.h>
+#include <vfscore/uio.h>
+#include <devfs/device.h>
+#if CONFIG_LIBDEVFS_DEV_ALLOCSTATS
+#include <uk/alloc.h>
+#endif
+#if CONFIG_LIBDEVFS_DEV_NETSTATS
+#include <uk/netdev.h>
+#endif
+
+#define DEV_ALLOCSTATS_NAME "allocstats"
+#define DEV_NETSTATS_NAME "netstats"
+
+/* Reserve for counters that grow while the report is written */
+#define DEV_STATS_SLACK 256
+
+/* Private data of a statistics node */
+struct dev_stats {
+	/* Writes the report like snprintf(), returns its full length */
+	size_t (*print)(char *buf, size_t len);
+};
+
+static int dev_stats_read(struct device *dev, struct uio *uio,
+			  int flags __unused)
+{
+	struct dev_stats *ds = dev->private_data;
+	size_t len, off;
+	char *buf;
+	int ret;
+
+	if (uio->uio_offset < 0)
+		return EINVAL;
+
+	/* Every read renders a fresh report */
+	len = ds->print(NULL, 0) + DEV_STATS_SLACK;
+	buf = malloc(len);
+	if (!buf)
+		return ENOMEM;
+	len = MIN(ds->print(buf, len), len - 1);
+
+	off = (size_t) uio->uio_offset;
+	ret = 0;
+	if (off < len)
+		ret = vfscore_uiomove(buf + off, (int) (len - off), uio);
+
+	free(buf);
+	return ret;
+}
+
+static int dev_stats_write(struct device *dev __unused,
+			   struct uio *uio __unused, int flags __unused)
+{
+	return EACCES;
+}
+
+static int dev_stats_open(struct device *device __unused, int mode __unused)
+{
+	return 0;
+}
+
+static int dev_stats_close(struct device *device __unused)
+{
+	return 0;
+}
+
+static struct devops stats_devops = {
+	.read = dev_stats_read,
+	.write = dev_stats_write,
+	.open = dev_stats_open,
+	.close = dev_stats_close,
+};
+
+static struct driver drv_stats = {
+	.devops = &stats_devops,
+	.devsz = sizeof(struct dev_stats),
+	.name = "stats"
+};
+
+static int dev_stats_create(const char *name,
+			    size_t (*print)(char *buf, size_t len))
+{
+	struct device *dev;
+
+	uk_pr_debug("Register '%s' to devfs\n", name);
+
+	dev = device_create(&drv_stats, name, D_CHR);
+	if (dev == NULL) {
+		uk_pr_err("Failed to register '%s' to devfs\n", name);
+		return -1;
+	}
+	((struct dev_stats *) dev->private_data)->print = print;
+
+	return 0;
+}
+
+static int devfs_register_stats(void)
+{
+	int rc = 0;
+
+#if CONFIG_LIBDEVFS_DEV_ALLOCSTATS
+	/* register /dev/allocstats */
+	if (dev_stats_create(DEV_ALLOCSTATS_NAME, uk_alloc_stats_print) < 0)
+		rc = -1;
+#endif
+#if CONFIG_LIBDEVFS_DEV_NETSTATS
+	/* register /dev/netstats */
+	if (dev_stats_create(DEV_NETSTATS_NAME, uk_netdev_stats_print) < 0)
+		rc = -1;
+#endif
+	return rc;
+}
+
+devfs_initcall(devfs_register_stats);
@@ -53,6 +53,7 @@ struct ramfs_node {
 	struct timespec rn_mtime;
 	int rn_mode;
 	bool rn_owns_buf;
+	unsigned int rn_mapcount;    /* direct mappings of rn_buf */
 };
 
 struct ramfs_node *ramfs_allocate_node(const char *name, int type);
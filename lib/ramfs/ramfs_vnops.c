@@ -45,6 +45,7 @@
 #include <stdlib.h>
 
 #include <uk/page.h>
+#include <uk/assert.h>
 #include <vfscore/vnode.h>
 #include <vfscore/mount.h>
 #include <vfscore/uio.h>
@@ -106,6 +107,19 @@ ramfs_allocate_node(const char *name, int type)
 	return np;
 }
 
+/*
+ * File buffers are page-aligned so that they can be mapped directly
+ */
+static void *
+ramfs_alloc_buf(size_t size)
+{
+	void *buf;
+
+	if (posix_memalign(&buf, __PAGE_SIZE, size) != 0)
+		return NULL;
+	return buf;
+}
+
 void
 ramfs_free_node(struct ramfs_node *np)
 {
@@ -150,6 +164,8 @@ ramfs_remove_node(struct ramfs_node *dnp, struct ramfs_node *np)
 
 	if (dnp->rn_child == NULL)
 		return EBUSY;
+	if (np->rn_mapcount)
+		return EBUSY;
 
 	uk_mutex_lock(&ramfs_lock);
 
@@ -346,16 +362,18 @@ ramfs_truncate(struct vnode *vp, off_t length)
 	np = vp->v_data;
 
 	if (length == 0) {
-		if (np->rn_buf != NULL) {
+		/* A mapped buffer is kept for reuse */
+		if (np->rn_buf != NULL && !np->rn_mapcount) {
 			if (np->rn_owns_buf)
 				free(np->rn_buf);
 			np->rn_buf = NULL;
 			np->rn_bufsize = 0;
 		}
 	} else if ((size_t) length > np->rn_bufsize) {
-		/* TODO: this could use a page level allocator */
+		if (np->rn_mapcount)
+			return EBUSY;
 		new_size = round_pgup(length);
-		new_buf = malloc(new_size);
+		new_buf = ramfs_alloc_buf(new_size);
 		if (!new_buf)
 			return EIO;
 		if (np->rn_size != 0) {
@@ -468,12 +486,15 @@ ramfs_write(struct vnode *vp, struct uio *uio, int ioflag)
 		off_t end_pos = uio->uio_offset + uio->uio_resid;
 
 		if (end_pos > (off_t) np->rn_bufsize) {
-			// XXX: this could use a page level allocator
 			size_t new_size = round_pgup(end_pos);
-			void *new_buf = calloc(1, new_size);
+			void *new_buf;
 
+			if (np->rn_mapcount)
+				return EBUSY;
+			new_buf = ramfs_alloc_buf(new_size);
 			if (!new_buf)
 				return EIO;
+			memset(new_buf, 0, new_size);
 			if (np->rn_size != 0) {
 				memcpy(new_buf, np->rn_buf, vp->v_size);
 				if (np->rn_owns_buf)
@@ -514,6 +535,8 @@ ramfs_rename(struct vnode *dvp1, struct vnode *vp1, char *name1 __unused,
 	} else {
 		/* Create new file or directory */
 		old_np = vp1->v_data;
+		if (old_np->rn_mapcount)
+			return EBUSY;
 		np = ramfs_add_node(dvp2->v_data, name2, old_np->rn_type);
 		if (np == NULL)
 			return ENOMEM;
@@ -635,6 +658,40 @@ ramfs_setattr(struct vnode *vnode, struct vattr *attr)
 	return 0;
 }
 
+static int
+ramfs_mmap(struct vnode *vp, struct vfscore_file *fp __unused,
+	   off_t off, size_t len, void **addr)
+{
+	struct ramfs_node *np = vp->v_data;
+
+	if (vp->v_type != VREG)
+		return ENODEV;
+
+	/* Data that is not page-aligned is copied by the caller */
+	*addr = NULL;
+	if (off < 0 || !np->rn_buf
+	    || (size_t) off > np->rn_bufsize
+	    || np->rn_bufsize - off < len
+	    || round_pgdown((__uptr) (np->rn_buf + off))
+	       != (__uptr) (np->rn_buf + off))
+		return 0;
+
+	np->rn_mapcount++;
+	*addr = np->rn_buf + off;
+	return 0;
+}
+
+static int
+ramfs_munmap(struct vnode *vp, struct vfscore_file *fp __unused,
+	     off_t off __unused, size_t len __unused)
+{
+	struct ramfs_node *np = vp->v_data;
+
+	UK_ASSERT(np->rn_mapcount > 0);
+	np->rn_mapcount--;
+	return 0;
+}
+
 #define ramfs_open      ((vnop_open_t)vfscore_vop_nullop)
 #define ramfs_close     ((vnop_close_t)vfscore_vop_nullop)
 #define ramfs_seek      ((vnop_seek_t)vfscore_vop_nullop)
@@ -671,5 +728,7 @@ struct vnops ramfs_vnops = {
 		ramfs_fallocate,        /* fallocate */
 		ramfs_readlink,         /* read link */
 		ramfs_symlink,          /* symbolic link */
+		ramfs_mmap,             /* mmap */
+		ramfs_munmap,           /* munmap */
 };
 
@@ -203,7 +203,7 @@ typedef long uk_syscall_arg_t;
 		long ret = rname(					\
 			UK_ARG_MAPx(x, UK_S_ARG_CAST_LONG, __VA_ARGS__)); \
 		if (ret < 0 && PTRISERR(ret)) {				\
-			errno = (int) PTR2ERR(ret);			\
+			errno = -PTR2ERR(ret);				\
 			return -1;					\
 		}							\
 		return ret;						\
@@ -64,6 +64,10 @@ int uk_alloc_register(struct uk_alloc *a)
 {
 	struct uk_alloc *this = _uk_alloc_head;
 
+#if CONFIG_LIBUKALLOC_STATS
+	memset(&a->_stats, 0, sizeof(a->_stats));
+#endif
+
 	if (!_uk_alloc_head) {
 		_uk_alloc_head = a;
 		a->next = NULL;
@@ -77,6 +81,46 @@ int uk_alloc_register(struct uk_alloc *a)
 	return 0;
 }
 
+int uk_alloc_unregister(struct uk_alloc *a)
+{
+	struct uk_alloc **this = &_uk_alloc_head;
+
+	UK_ASSERT(a);
+
+	while (*this && *this != a)
+		this = &(*this)->next;
+	if (!*this)
+		return -ENOENT;
+
+	*this = a->next;
+	a->next = NULL;
+	return 0;
+}
+
+int uk_alloc_set_default(struct uk_alloc *a)
+{
+	struct uk_alloc *this = _uk_alloc_head;
+	struct uk_alloc *prev = NULL;
+
+	UK_ASSERT(a);
+
+	/* the allocator has to be registered already */
+	while (this && this != a) {
+		prev = this;
+		this = this->next;
+	}
+	if (!this)
+		return -ENOENT;
+
+	if (prev) {
+		/* move `a` to the head of the list */
+		prev->next = a->next;
+		a->next = _uk_alloc_head;
+		_uk_alloc_head = a;
+	}
+	return 0;
+}
+
 struct metadata_ifpages {
 	unsigned long	num_pages;
 	void		*base;
@@ -125,44 +169,78 @@ static size_t uk_getmallocsize(const void *ptr)
 	       __PAGE_SIZE - (size_t)ptr;
 }
 
-void *uk_malloc_ifpages(struct uk_alloc *a, size_t size)
+unsigned long uk_ifpages_num_pages(size_t size)
 {
-	uintptr_t intptr;
-	unsigned long num_pages;
-	struct metadata_ifpages *metadata;
-	size_t realsize = sizeof(*metadata) + size;
+	size_t realsize = sizeof(struct metadata_ifpages) + size;
 
-	UK_ASSERT(a);
 	/* check for invalid size and overflow */
 	if (!size || realsize < size)
-		return NULL;
+		return 0;
 
-	num_pages = size_to_num_pages(realsize);
-	intptr = (uintptr_t)uk_palloc(a, num_pages);
+	return size_to_num_pages(realsize);
+}
 
-	if (!intptr)
-		return NULL;
+void *uk_ifpages_obj_init(void *base, unsigned long num_pages)
+{
+	struct metadata_ifpages *metadata;
 
-	metadata = (struct metadata_ifpages *) intptr;
+	UK_ASSERT(base);
+
+	metadata = (struct metadata_ifpages *) base;
 	metadata->num_pages = num_pages;
-	metadata->base = (void *) intptr;
+	metadata->base = base;
+
+	return (void *)((uintptr_t) base + sizeof(*metadata));
+}
+
+void *uk_ifpages_obj_base(const void *ptr, unsigned long *num_pages)
+{
+	struct metadata_ifpages *metadata = uk_get_metadata(ptr);
+
+	UK_ASSERT(metadata->base != NULL);
+	UK_ASSERT(metadata->num_pages != 0);
 
-	return (void *)(intptr + sizeof(*metadata));
+	*num_pages = metadata->num_pages;
+	return metadata->base;
+}
+
+void *uk_malloc_ifpages(struct uk_alloc *a, size_t size)
+{
+	unsigned long num_pages;
+	void *base;
+
+	UK_ASSERT(a);
+
+	num_pages = uk_ifpages_num_pages(size);
+	if (!num_pages)
+		return NULL;
+
+	base = uk_do_palloc(a, num_pages);
+	if (!base)
+		return NULL;
+
+	return uk_ifpages_obj_init(base, num_pages);
 }
 
 void uk_free_ifpages(struct uk_alloc *a, void *ptr)
 {
-	struct metadata_ifpages *metadata;
+	unsigned long num_pages;
+	void *base;
 
 	UK_ASSERT(a);
 	if (!ptr)
 		return;
 
-	metadata = uk_get_metadata(ptr);
+	base = uk_ifpages_obj_base(ptr, &num_pages);
+	uk_do_pfree(a, base, num_pages);
+}
 
-	UK_ASSERT(metadata->base != NULL);
-	UK_ASSERT(metadata->num_pages != 0);
-	uk_pfree(a, metadata->base, metadata->num_pages);
+size_t uk_getsize_ifpages(struct uk_alloc *a __maybe_unused, const void *ptr)
+{
+	UK_ASSERT(a);
+	UK_ASSERT(ptr);
+
+	return uk_getmallocsize(ptr);
 }
 
 void *uk_realloc_ifpages(struct uk_alloc *a, void *ptr, size_t size)
@@ -253,7 +331,7 @@ int uk_posix_memalign_ifpages(struct uk_alloc *a,
 		return EINVAL;
 
 	num_pages = size_to_num_pages(realsize);
-	intptr = (uintptr_t) uk_palloc(a, num_pages);
+	intptr = (uintptr_t) uk_do_palloc(a, num_pages);
 
 	if (!intptr)
 		return ENOMEM;
@@ -309,6 +387,15 @@ void uk_free_ifmalloc(struct uk_alloc *a, void *ptr)
 	a->free_backend(a, metadata->base);
 }
 
+size_t uk_getsize_ifmalloc(struct uk_alloc *a __maybe_unused,
+			   const void *ptr)
+{
+	UK_ASSERT(a);
+	UK_ASSERT(ptr);
+
+	return uk_getmallocsize_ifmalloc(ptr);
+}
+
 void *uk_malloc_ifmalloc(struct uk_alloc *a, size_t size)
 {
 	struct metadata_ifmalloc *metadata;
@@ -421,7 +508,7 @@ void uk_pfree_compat(struct uk_alloc *a, void *ptr,
 	/* if the object is not page aligned it was clearly not from us */
 	UK_ASSERT(page_off(ptr) == 0);
 
-	uk_free(a, ptr);
+	uk_do_free(a, ptr);
 }
 
 void *uk_palloc_compat(struct uk_alloc *a, unsigned long num_pages)
@@ -434,7 +521,26 @@ void *uk_palloc_compat(struct uk_alloc *a, unsigned long num_pages)
 	if (num_pages > (~(size_t)0)/__PAGE_SIZE)
 		return NULL;
 
-	if (uk_posix_memalign(a, &ptr, __PAGE_SIZE, num_pages * __PAGE_SIZE))
+	if (uk_do_posix_memalign(a, &ptr, __PAGE_SIZE,
+				 num_pages * __PAGE_SIZE))
+		return NULL;
+
+	return ptr;
+}
+
+void *uk_palloc_aligned_compat(struct uk_alloc *a, unsigned long align,
+			       unsigned long num_pages)
+{
+	void *ptr;
+
+	UK_ASSERT(a);
+
+	/* check for overflow */
+	if (num_pages > (~(size_t)0)/__PAGE_SIZE)
+		return NULL;
+
+	if (uk_do_posix_memalign(a, &ptr, MAX(align, __PAGE_SIZE),
+				 num_pages * __PAGE_SIZE))
 		return NULL;
 
 	return ptr;
@@ -446,20 +552,20 @@ void *uk_realloc_compat(struct uk_alloc *a, void *ptr, size_t size)
 
 	UK_ASSERT(a);
 	if (!ptr)
-		return uk_malloc(a, size);
+		return uk_do_malloc(a, size);
 
 	if (ptr && !size) {
-		uk_free(a, ptr);
+		uk_do_free(a, ptr);
 		return NULL;
 	}
 
-	retptr = uk_malloc(a, size);
+	retptr = uk_do_malloc(a, size);
 	if (!retptr)
 		return NULL;
 
 	memcpy(retptr, ptr, size);
 
-	uk_free(a, ptr);
+	uk_do_free(a, ptr);
 	return retptr;
 }
 
@@ -473,7 +579,7 @@ void *uk_calloc_compat(struct uk_alloc *a, size_t nmemb, size_t size)
 		return NULL;
 
 	UK_ASSERT(a);
-	ptr = uk_malloc(a, tlen);
+	ptr = uk_do_malloc(a, tlen);
 	if (!ptr)
 		return NULL;
 
@@ -481,12 +587,35 @@ void *uk_calloc_compat(struct uk_alloc *a, size_t nmemb, size_t size)
 	return ptr;
 }
 
+unsigned int uk_malloc_bulk_compat(struct uk_alloc *a, size_t size,
+				   void *ptrs[], unsigned int count)
+{
+	unsigned int i;
+
+	UK_ASSERT(a);
+	for (i = 0; i < count; ++i) {
+		ptrs[i] = uk_do_malloc(a, size);
+		if (unlikely(!ptrs[i]))
+			break;
+	}
+	return i;
+}
+
+void uk_free_bulk_compat(struct uk_alloc *a, void *ptrs[], unsigned int count)
+{
+	unsigned int i;
+
+	UK_ASSERT(a);
+	for (i = 0; i < count; ++i)
+		uk_do_free(a, ptrs[i]);
+}
+
 void *uk_memalign_compat(struct uk_alloc *a, size_t align, size_t size)
 {
 	void *ptr;
 
 	UK_ASSERT(a);
-	if (uk_posix_memalign(a, &ptr, align, size) != 0)
+	if (uk_do_posix_memalign(a, &ptr, align, size) != 0)
 		return NULL;
 
 	return ptr;
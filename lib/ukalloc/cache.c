@@ -0,0 +1,453 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Per-thread object caches for ukalloc
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * The cache allocator wraps a backend allocator and keeps a magazine (a
+ * small stack of object pointers) per thread and size class. malloc() pops
+ * an object from the magazine of the calling thread and free() pushes it
+ * back, so that the backend is only called when a magazine runs empty or
+ * overflows. Because each thread only touches its own magazines, the fast
+ * path does not need to synchronize with other threads. Until the scheduler
+ * is started, a global set of magazines is used. It is released when the
+ * scheduler starts. If the backend runs out of memory, the magazines of the
+ * calling thread are released before the allocation is retried.
+ *
+ * Every object carries a `struct cache_hdr` in front of it that records its
+ * size class, so that free() can find the matching magazine. Objects that do
+ * not fit into a size class (or have a larger alignment requirement than the
+ * header provides) are marked with CACHE_CLS_NONE and are passed through to
+ * the backend.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <uk/alloc_impl.h>
+#include <uk/alloc_cache.h>
+#include <uk/config.h>
+#include <uk/essentials.h>
+#include <uk/assert.h>
+#include <uk/print.h>
+#include <uk/arch/atomic.h>
+#if CONFIG_LIBUKSCHED
+#include <uk/sched.h>
+#include <uk/thread.h>
+#endif
+
+#define CACHE_NR_CLASSES	24
+#define CACHE_MAX_OBJ_LEN	2048
+#define CACHE_CLS_NONE		((uintptr_t) -1)
+#define CACHE_MAGSIZE		CONFIG_LIBUKALLOC_CACHE_MAGSIZE
+
+/* Size classes: 16 B steps up to 128 B, then four classes per power of two */
+static const uint16_t cache_obj_len[CACHE_NR_CLASSES] = {
+	16,   32,   48,   64,   80,   96,  112,  128,
+	160,  192,  224,  256,
+	320,  384,  448,  512,
+	640,  768,  896, 1024,
+	1280, 1536, 1792, 2048,
+};
+
+struct cache_hdr {
+	/* start of the backend allocation */
+	void *base;
+	/* size class or CACHE_CLS_NONE */
+	uintptr_t cls;
+};
+
+/* Cached objects are allocated CACHE_HDR_LEN-aligned from the backend so
+ * that the returned pointers have the same alignment
+ */
+#define CACHE_HDR_LEN		16
+UK_CTASSERT(sizeof(struct cache_hdr) <= CACHE_HDR_LEN);
+
+struct magazine {
+	unsigned int count;
+	void *obj[CACHE_MAGSIZE];
+};
+
+struct uk_alloc_magazines {
+	struct uk_alloc *owner;
+	struct uk_alloc_magazines *next;
+	struct magazine mag[CACHE_NR_CLASSES];
+};
+
+struct uk_alloc_cache {
+	struct uk_alloc *backend;
+};
+
+#define ukalloc2cache(a) \
+	((struct uk_alloc_cache *)&(a)->priv)
+
+#define obj2hdr(obj) \
+	((struct cache_hdr *)((uintptr_t)(obj) - CACHE_HDR_LEN))
+
+/* magazines used before the scheduler runs threads */
+static struct uk_alloc_magazines *_boot_mags;
+
+static inline unsigned int size_to_class(size_t size)
+{
+	unsigned long shift;
+
+	UK_ASSERT(size > 0 && size <= CACHE_MAX_OBJ_LEN);
+
+	if (size <= 128)
+		return (unsigned int)((size - 1) >> 4);
+
+	/* Above 128 B, every power of two is divided into four classes */
+	size--;
+	shift = ukarch_flsl(size);
+	return (unsigned int)(8 + ((shift - 7) << 2)
+			      + ((size >> (shift - 2)) & 3));
+}
+
+static inline struct uk_alloc_magazines **_mags_slot(void)
+{
+#if CONFIG_LIBUKSCHED
+	struct uk_sched *s = uk_sched_get_default();
+
+	if (s && uk_sched_started(s))
+		return &uk_thread_current()->alloc_cache;
+#endif
+	return &_boot_mags;
+}
+
+static struct uk_alloc_magazines *_mags_get(struct uk_alloc *a)
+{
+	struct uk_alloc_magazines **slot = _mags_slot();
+	struct uk_alloc_magazines *mags;
+
+	/* fast path: most threads use a single cache allocator */
+	mags = *slot;
+	if (likely(mags && mags->owner == a))
+		return mags;
+
+	for (; mags; mags = mags->next)
+		if (mags->owner == a)
+			return mags;
+
+	mags = uk_calloc(ukalloc2cache(a)->backend, 1, sizeof(*mags));
+	if (unlikely(!mags))
+		return NULL;
+
+	mags->owner = a;
+	mags->next = *slot;
+	*slot = mags;
+	return mags;
+}
+
+/* Objects cached by the calling thread are returned to the backends once
+ * before an allocation fails
+ */
+static int cache_backend_memalign(struct uk_alloc_cache *c, void **memptr,
+				  size_t align, size_t size)
+{
+	if (likely(uk_posix_memalign(c->backend, memptr, align, size) == 0))
+		return 0;
+
+	uk_alloc_cache_release(_mags_slot());
+	return uk_posix_memalign(c->backend, memptr, align, size);
+}
+
+static void *cache_backend_alloc(struct uk_alloc_cache *c, unsigned int cls)
+{
+	struct cache_hdr *hdr;
+	void *base;
+
+	if (cache_backend_memalign(c, &base, CACHE_HDR_LEN,
+				   CACHE_HDR_LEN + cache_obj_len[cls]) != 0)
+		return NULL;
+
+	hdr = base;
+	hdr->base = base;
+	hdr->cls  = cls;
+	return (void *)((uintptr_t) hdr + CACHE_HDR_LEN);
+}
+
+/* Pass-through allocation for objects without size class. The usable
+ * length is stored at the beginning of the backend allocation.
+ */
+static void *cache_backend_alloc_large(struct uk_alloc_cache *c,
+				       size_t align, size_t size)
+{
+	struct cache_hdr *hdr;
+	size_t off, realsize;
+	void *base;
+
+	off = MAX(align, (size_t) (2 * CACHE_HDR_LEN));
+	realsize = size + off;
+	if (unlikely(realsize < size))
+		return NULL;
+
+	if (cache_backend_memalign(c, &base,
+				   MAX(align, sizeof(void *)), realsize) != 0)
+		return NULL;
+
+	*((size_t *) base) = size;
+	hdr = obj2hdr((uintptr_t) base + off);
+	hdr->base = base;
+	hdr->cls  = CACHE_CLS_NONE;
+	return (void *)((uintptr_t) base + off);
+}
+
+static void cache_backend_free(struct uk_alloc_cache *c, void *obj)
+{
+	uk_free(c->backend, obj2hdr(obj)->base);
+}
+
+static void magazine_drain(struct uk_alloc_cache *c, struct magazine *m,
+			   unsigned int keep)
+{
+	while (m->count > keep)
+		cache_backend_free(c, m->obj[--m->count]);
+}
+
+static void *cache_malloc(struct uk_alloc *a, size_t size)
+{
+	struct uk_alloc_cache *c;
+	struct uk_alloc_magazines *mags;
+	struct magazine *m;
+	unsigned int cls;
+
+	UK_ASSERT(a);
+	c = ukalloc2cache(a);
+
+	if (unlikely(!size))
+		return NULL;
+	/* Large objects get the same alignment as cached ones */
+	if (unlikely(size > CACHE_MAX_OBJ_LEN))
+		return cache_backend_alloc_large(c, CACHE_HDR_LEN, size);
+
+	cls = size_to_class(size);
+	mags = _mags_get(a);
+	if (likely(mags)) {
+		m = &mags->mag[cls];
+		if (likely(m->count))
+			return m->obj[--m->count];
+	}
+	return cache_backend_alloc(c, cls);
+}
+
+static void cache_free(struct uk_alloc *a, void *ptr)
+{
+	struct uk_alloc_cache *c;
+	struct uk_alloc_magazines *mags;
+	struct cache_hdr *hdr;
+	struct magazine *m;
+
+	UK_ASSERT(a);
+	c = ukalloc2cache(a);
+
+	if (unlikely(!ptr))
+		return;
+
+	hdr = obj2hdr(ptr);
+	if (unlikely(hdr->cls == CACHE_CLS_NONE)) {
+		uk_free(c->backend, hdr->base);
+		return;
+	}
+	UK_ASSERT(hdr->cls < CACHE_NR_CLASSES);
+
+	mags = _mags_get(a);
+	if (unlikely(!mags)) {
+		uk_free(c->backend, hdr->base);
+		return;
+	}
+
+	m = &mags->mag[hdr->cls];
+	if (unlikely(m->count == CACHE_MAGSIZE)) {
+		/* Give half of the magazine back so that alternating
+		 * malloc/free sequences do not hit the backend each time
+		 */
+		magazine_drain(c, m, CACHE_MAGSIZE / 2);
+	}
+	m->obj[m->count++] = ptr;
+}
+
+static int cache_posix_memalign(struct uk_alloc *a, void **memptr,
+				size_t align, size_t size)
+{
+	struct uk_alloc_cache *c;
+	void *obj;
+
+	UK_ASSERT(a);
+	c = ukalloc2cache(a);
+
+	if (((align - 1) & align) != 0
+	    || (align % sizeof(void *)) != 0)
+		return EINVAL;
+
+	/* Leave memptr untouched. See comment in uk_posix_memalign_ifpages. */
+	if (!size)
+		return EINVAL;
+
+	/* cached objects are aligned to CACHE_HDR_LEN */
+	if (align <= CACHE_HDR_LEN && size <= CACHE_MAX_OBJ_LEN)
+		obj = cache_malloc(a, size);
+	else
+		obj = cache_backend_alloc_large(c, align, size);
+
+	if (unlikely(!obj))
+		return ENOMEM;
+
+	*memptr = obj;
+	return 0;
+}
+
+static size_t cache_getsize(struct uk_alloc *a, const void *ptr)
+{
+	struct cache_hdr *hdr;
+
+	UK_ASSERT(a);
+
+	hdr = obj2hdr(ptr);
+	if (hdr->cls == CACHE_CLS_NONE)
+		return *((size_t *) hdr->base);
+	return cache_obj_len[hdr->cls];
+}
+
+static void *cache_realloc(struct uk_alloc *a, void *ptr, size_t size)
+{
+	size_t cursize;
+	void *retptr;
+
+	UK_ASSERT(a);
+
+	if (!ptr)
+		return cache_malloc(a, size);
+
+	if (ptr && !size) {
+		cache_free(a, ptr);
+		return NULL;
+	}
+
+	cursize = cache_getsize(a, ptr);
+	if (size <= cursize)
+		return ptr;
+
+	retptr = cache_malloc(a, size);
+	if (!retptr)
+		return NULL;
+
+	memcpy(retptr, ptr, cursize);
+	cache_free(a, ptr);
+	return retptr;
+}
+
+static void *cache_palloc(struct uk_alloc *a, unsigned long num_pages)
+{
+	UK_ASSERT(a);
+	return uk_palloc(ukalloc2cache(a)->backend, num_pages);
+}
+
+static void cache_pfree(struct uk_alloc *a, void *ptr,
+			unsigned long num_pages)
+{
+	UK_ASSERT(a);
+	uk_pfree(ukalloc2cache(a)->backend, ptr, num_pages);
+}
+
+static void *cache_palloc_aligned(struct uk_alloc *a, unsigned long align,
+				  unsigned long num_pages)
+{
+	UK_ASSERT(a);
+	return uk_palloc_aligned(ukalloc2cache(a)->backend, align, num_pages);
+}
+
+static int cache_addmem(struct uk_alloc *a, void *base, size_t len)
+{
+	UK_ASSERT(a);
+	return uk_alloc_addmem(ukalloc2cache(a)->backend, base, len);
+}
+
+#if CONFIG_LIBUKALLOC_IFSTATS
+static ssize_t cache_availmem(struct uk_alloc *a)
+{
+	UK_ASSERT(a);
+	return uk_alloc_availmem(ukalloc2cache(a)->backend);
+}
+#endif
+
+void uk_alloc_cache_release(struct uk_alloc_magazines **mags)
+{
+	struct uk_alloc_magazines *m, *next;
+	struct uk_alloc_cache *c;
+	unsigned int i;
+
+	UK_ASSERT(mags);
+
+	for (m = *mags; m; m = next) {
+		next = m->next;
+		c = ukalloc2cache(m->owner);
+		for (i = 0; i < CACHE_NR_CLASSES; ++i)
+			magazine_drain(c, &m->mag[i], 0);
+		uk_free(c->backend, m);
+	}
+	*mags = NULL;
+}
+
+void uk_alloc_cache_flush(void)
+{
+	uk_alloc_cache_release(_mags_slot());
+}
+
+struct uk_alloc *uk_alloc_cache_init(struct uk_alloc *backend)
+{
+	struct uk_alloc *a;
+	struct uk_alloc_cache *c;
+
+	UK_ASSERT(backend);
+
+	a = uk_malloc(backend, sizeof(*a) + sizeof(*c));
+	if (!a) {
+		uk_pr_err("Not enough space for cache allocator descriptor\n");
+		return NULL;
+	}
+
+	uk_pr_info("Initialize per-thread cache allocator %"__PRIuptr" on %"__PRIuptr"\n",
+		   (uintptr_t) a, (uintptr_t) backend);
+	memset(a, 0, sizeof(*a) + sizeof(*c));
+	c = ukalloc2cache(a);
+	c->backend = backend;
+
+	uk_alloc_init_malloc(a, cache_malloc, uk_calloc_compat,
+			     cache_realloc, cache_free, cache_posix_memalign,
+			     uk_memalign_compat, cache_addmem);
+	a->palloc  = cache_palloc;
+	a->pfree   = cache_pfree;
+	a->palloc_aligned = cache_palloc_aligned;
+	a->getsize = cache_getsize;
+#if CONFIG_LIBUKALLOC_IFSTATS
+	a->availmem = cache_availmem;
+#endif
+
+	return a;
+}
@@ -43,6 +43,7 @@
 #include <uk/config.h>
 #include <uk/assert.h>
 #include <uk/essentials.h>
+#include <uk/arch/limits.h>
 
 struct uk_alloc;
 
@@ -65,17 +66,46 @@ typedef void* (*uk_alloc_realloc_func_t)
 		(struct uk_alloc *a, void *ptr, size_t size);
 typedef void  (*uk_alloc_free_func_t)
 		(struct uk_alloc *a, void *ptr);
+typedef unsigned int (*uk_alloc_malloc_bulk_func_t)
+		(struct uk_alloc *a, size_t size, void *ptrs[],
+		 unsigned int count);
+typedef void  (*uk_alloc_free_bulk_func_t)
+		(struct uk_alloc *a, void *ptrs[], unsigned int count);
 typedef void* (*uk_alloc_palloc_func_t)
 		(struct uk_alloc *a, unsigned long num_pages);
 typedef void  (*uk_alloc_pfree_func_t)
 		(struct uk_alloc *a, void *ptr, unsigned long num_pages);
+typedef void* (*uk_alloc_palloc_aligned_func_t)
+		(struct uk_alloc *a, unsigned long align,
+		 unsigned long num_pages);
 typedef int   (*uk_alloc_addmem_func_t)
 		(struct uk_alloc *a, void *base, size_t size);
+typedef size_t (*uk_alloc_getsize_func_t)
+		(struct uk_alloc *a, const void *ptr);
+typedef int   (*uk_alloc_freeblocks_func_t)
+		(struct uk_alloc *a, unsigned long *counts, unsigned int len);
 #if CONFIG_LIBUKALLOC_IFSTATS
 typedef ssize_t (*uk_alloc_availmem_func_t)
 		(struct uk_alloc *a);
 #endif
 
+#if CONFIG_LIBUKALLOC_STATS
+/* Number of size classes of the allocation histogram: Class 0 counts
+ * requests of up to 16 bytes, class n requests of up to 16 << n bytes.
+ * The last class counts all larger requests.
+ */
+#define UK_ALLOC_STATS_HIST_LEN 16
+
+struct uk_alloc_stats {
+	unsigned long nb_allocs;	/* satisfied allocation requests */
+	unsigned long nb_frees;		/* release requests */
+	unsigned long nb_enomem;	/* failed allocation requests */
+	ssize_t cur_mem_use;		/* bytes currently handed out */
+	ssize_t max_mem_use;		/* peak of cur_mem_use */
+	unsigned long hist[UK_ALLOC_STATS_HIST_LEN]; /* requests by size */
+};
+#endif
+
 struct uk_alloc {
 	/* memory allocation */
 	uk_alloc_malloc_func_t malloc;
@@ -84,6 +114,8 @@ struct uk_alloc {
 	uk_alloc_posix_memalign_func_t posix_memalign;
 	uk_alloc_memalign_func_t memalign;
 	uk_alloc_free_func_t free;
+	uk_alloc_malloc_bulk_func_t malloc_bulk;
+	uk_alloc_free_bulk_func_t free_bulk;
 
 #if CONFIG_LIBUKALLOC_IFMALLOC
 	uk_alloc_free_func_t free_backend;
@@ -93,15 +125,24 @@ struct uk_alloc {
 	/* page allocation interface */
 	uk_alloc_palloc_func_t palloc;
 	uk_alloc_pfree_func_t pfree;
+	/* optional interface */
+	uk_alloc_palloc_aligned_func_t palloc_aligned;
 #if CONFIG_LIBUKALLOC_IFSTATS
 	/* optional interface */
 	uk_alloc_availmem_func_t availmem;
 #endif
 	/* optional interface */
 	uk_alloc_addmem_func_t addmem;
+	/* optional interface */
+	uk_alloc_getsize_func_t getsize;
+	/* optional interface */
+	uk_alloc_freeblocks_func_t freeblocks;
 
 	/* internal */
 	struct uk_alloc *next;
+#if CONFIG_LIBUKALLOC_STATS
+	struct uk_alloc_stats _stats;
+#endif
 	int8_t priv[];
 };
 
@@ -112,7 +153,86 @@ static inline struct uk_alloc *uk_alloc_get_default(void)
 	return _uk_alloc_head;
 }
 
-/* wrapper functions */
+/**
+ * Makes a registered allocator the default allocator that is returned by
+ * uk_alloc_get_default().
+ *
+ * @param a
+ *  Allocator that was previously registered with uk_alloc_register().
+ * @return
+ *  - (0): Success.
+ *  - (-ENOENT): The allocator is not registered.
+ */
+int uk_alloc_set_default(struct uk_alloc *a);
+
+#if CONFIG_LIBUKALLOC_STATS
+struct uk_alloc_libstats;
+
+/* Reference of a compilation unit to the statistics of its library */
+struct uk_alloc_libref {
+	struct uk_alloc_libstats *ls;	/* looked up with the first request */
+	const char *libname;
+};
+
+#if CONFIG_LIBUKALLOC_STATS_PERLIB && defined(__LIBNAME__)
+static struct uk_alloc_libref _uk_alloc_libref __maybe_unused = {
+	.ls      = NULL,
+	.libname = STRINGIFY(__LIBNAME__),
+};
+#define _UK_ALLOC_LIBREF (&_uk_alloc_libref)
+#else
+#define _UK_ALLOC_LIBREF (NULL)
+#endif
+
+void _uk_alloc_stats_count_alloc(struct uk_alloc *a,
+				 struct uk_alloc_libref *lib,
+				 size_t size, size_t len);
+void _uk_alloc_stats_count_free(struct uk_alloc *a,
+				struct uk_alloc_libref *lib,
+				size_t len);
+void _uk_alloc_stats_count_enomem(struct uk_alloc *a,
+				  struct uk_alloc_libref *lib,
+				  size_t size);
+
+static inline size_t _uk_alloc_stats_objlen(struct uk_alloc *a,
+					    const void *ptr)
+{
+	return (a->getsize) ? a->getsize(a, ptr) : 0;
+}
+
+#define _uk_alloc_stats_obj(a, ptr, size)				\
+	do {								\
+		if (likely(ptr))					\
+			_uk_alloc_stats_count_alloc((a), _UK_ALLOC_LIBREF, \
+					(size),				\
+					_uk_alloc_stats_objlen((a), (ptr))); \
+		else							\
+			_uk_alloc_stats_count_enomem((a), _UK_ALLOC_LIBREF, \
+					(size));			\
+	} while (0)
+#define _uk_alloc_stats_pages(a, ptr, num_pages)			\
+	do {								\
+		if (likely(ptr))					\
+			_uk_alloc_stats_count_alloc((a), _UK_ALLOC_LIBREF, \
+					(num_pages) << __PAGE_SHIFT,	\
+					(num_pages) << __PAGE_SHIFT);	\
+		else							\
+			_uk_alloc_stats_count_enomem((a), _UK_ALLOC_LIBREF, \
+					(num_pages) << __PAGE_SHIFT);	\
+	} while (0)
+#define _uk_alloc_stats_free(a, len)					\
+	_uk_alloc_stats_count_free((a), _UK_ALLOC_LIBREF, (len))
+#else /* !CONFIG_LIBUKALLOC_STATS */
+#define _uk_alloc_stats_obj(a, ptr, size)		do {} while (0)
+#define _uk_alloc_stats_pages(a, ptr, num_pages)	do {} while (0)
+#define _uk_alloc_stats_free(a, len)			do {} while (0)
+#endif /* !CONFIG_LIBUKALLOC_STATS */
+
+/* wrapper functions
+ * NOTE: The uk_do_*() variants do not update allocation statistics. They
+ *       are meant for allocator implementations that forward a request
+ *       to their own interface.
+ */
 static inline void *uk_do_malloc(struct uk_alloc *a, size_t size)
 {
 	UK_ASSERT(a);
@@ -121,11 +241,15 @@ static inline void *uk_do_malloc(struct uk_alloc *a, size_t size)
 
 static inline void *uk_malloc(struct uk_alloc *a, size_t size)
 {
+	void *ptr;
+
 	if (unlikely(!a)) {
 		errno = ENOMEM;
 		return NULL;
 	}
-	return uk_do_malloc(a, size);
+	ptr = uk_do_malloc(a, size);
+	_uk_alloc_stats_obj(a, ptr, size);
+	return ptr;
 }
 
 static inline void *uk_do_calloc(struct uk_alloc *a,
@@ -138,11 +262,15 @@ static inline void *uk_do_calloc(struct uk_alloc *a,
 static inline void *uk_calloc(struct uk_alloc *a,
 			      size_t nmemb, size_t size)
 {
+	void *ptr;
+
 	if (unlikely(!a)) {
 		errno = ENOMEM;
 		return NULL;
 	}
-	return uk_do_calloc(a, nmemb, size);
+	ptr = uk_do_calloc(a, nmemb, size);
+	_uk_alloc_stats_obj(a, ptr, nmemb * size);
+	return ptr;
 }
 
 static inline void *uk_do_realloc(struct uk_alloc *a,
@@ -154,11 +282,26 @@ static inline void *uk_do_realloc(struct uk_alloc *a,
 
 static inline void *uk_realloc(struct uk_alloc *a, void *ptr, size_t size)
 {
+	void *retptr;
+#if CONFIG_LIBUKALLOC_STATS
+	size_t len;
+#endif
+
 	if (unlikely(!a)) {
 		errno = ENOMEM;
 		return NULL;
 	}
-	return uk_do_realloc(a, ptr, size);
+#if CONFIG_LIBUKALLOC_STATS
+	len = (ptr) ? _uk_alloc_stats_objlen(a, ptr) : 0;
+#endif
+	retptr = uk_do_realloc(a, ptr, size);
+#if CONFIG_LIBUKALLOC_STATS
+	if (ptr && (!size || retptr))
+		_uk_alloc_stats_free(a, len);
+	if (size)
+		_uk_alloc_stats_obj(a, retptr, size);
+#endif
+	return retptr;
 }
 
 static inline int uk_do_posix_memalign(struct uk_alloc *a, void **memptr,
@@ -171,11 +314,16 @@ static inline int uk_do_posix_memalign(struct uk_alloc *a, void **memptr,
 static inline int uk_posix_memalign(struct uk_alloc *a, void **memptr,
 				    size_t align, size_t size)
 {
+	int ret;
+
 	if (unlikely(!a)) {
 		*memptr = NULL;
 		return ENOMEM;
 	}
-	return uk_do_posix_memalign(a, memptr, align, size);
+	ret = uk_do_posix_memalign(a, memptr, align, size);
+	if (ret != EINVAL)
+		_uk_alloc_stats_obj(a, (ret == 0) ? *memptr : NULL, size);
+	return ret;
 }
 
 static inline void *uk_do_memalign(struct uk_alloc *a,
@@ -188,9 +336,13 @@ static inline void *uk_do_memalign(struct uk_alloc *a,
 static inline void *uk_memalign(struct uk_alloc *a,
 				size_t align, size_t size)
 {
+	void *ptr;
+
 	if (unlikely(!a))
 		return NULL;
-	return uk_do_memalign(a, align, size);
+	ptr = uk_do_memalign(a, align, size);
+	_uk_alloc_stats_obj(a, ptr, size);
+	return ptr;
 }
 
 static inline void uk_do_free(struct uk_alloc *a, void *ptr)
@@ -201,9 +353,89 @@ static inline void uk_do_free(struct uk_alloc *a, void *ptr)
 
 static inline void uk_free(struct uk_alloc *a, void *ptr)
 {
+#if CONFIG_LIBUKALLOC_STATS
+	if (ptr)
+		_uk_alloc_stats_free(a, _uk_alloc_stats_objlen(a, ptr));
+#endif
 	uk_do_free(a, ptr);
 }
 
+static inline unsigned int uk_do_malloc_bulk(struct uk_alloc *a, size_t size,
+					     void *ptrs[], unsigned int count)
+{
+	UK_ASSERT(a);
+	UK_ASSERT(ptrs || !count);
+	return a->malloc_bulk(a, size, ptrs, count);
+}
+
+/**
+ * Allocates up to `count` objects of the same size with a single call.
+ * This is faster than repeated calls to uk_malloc() with allocators that
+ * implement batch operations natively, e.g., pools.
+ *
+ * @param a
+ *  Allocator to allocate from.
+ * @param size
+ *  Size of each object in bytes.
+ * @param ptrs
+ *  Array that receives the pointers to the objects.
+ * @param count
+ *  Number of objects to allocate.
+ * @return
+ *  Number of allocated objects, stored in ptrs[0] to ptrs[ret - 1]. This
+ *  is less than `count` if the allocator ran out of memory.
+ */
+static inline unsigned int uk_malloc_bulk(struct uk_alloc *a, size_t size,
+					  void *ptrs[], unsigned int count)
+{
+	unsigned int ret;
+#if CONFIG_LIBUKALLOC_STATS
+	unsigned int i;
+#endif
+
+	if (unlikely(!a))
+		return 0;
+	ret = uk_do_malloc_bulk(a, size, ptrs, count);
+#if CONFIG_LIBUKALLOC_STATS
+	for (i = 0; i < ret; ++i)
+		_uk_alloc_stats_obj(a, ptrs[i], size);
+	if (ret < count)
+		_uk_alloc_stats_obj(a, NULL, size);
+#endif
+	return ret;
+}
+
+static inline void uk_do_free_bulk(struct uk_alloc *a, void *ptrs[],
+				   unsigned int count)
+{
+	UK_ASSERT(a);
+	UK_ASSERT(ptrs || !count);
+	a->free_bulk(a, ptrs, count);
+}
+
+/**
+ * Releases multiple objects of an allocator with a single call.
+ *
+ * @param a
+ *  Allocator that handed out the objects.
+ * @param ptrs
+ *  Array of pointers to the objects. Unlike uk_free(), NULL is not
+ *  accepted as object.
+ * @param count
+ *  Number of objects in ptrs.
+ */
+static inline void uk_free_bulk(struct uk_alloc *a, void *ptrs[],
+				unsigned int count)
+{
+#if CONFIG_LIBUKALLOC_STATS
+	unsigned int i;
+
+	for (i = 0; i < count; ++i)
+		_uk_alloc_stats_free(a, _uk_alloc_stats_objlen(a, ptrs[i]));
+#endif
+	uk_do_free_bulk(a, ptrs, count);
+}
+
 static inline void *uk_do_palloc(struct uk_alloc *a, unsigned long num_pages)
 {
 	UK_ASSERT(a);
@@ -212,9 +444,58 @@ static inline void *uk_do_palloc(struct uk_alloc *a, unsigned long num_pages)
 
 static inline void *uk_palloc(struct uk_alloc *a, unsigned long num_pages)
 {
+	void *ptr;
+
 	if (unlikely(!a || !a->palloc))
 		return NULL;
-	return uk_do_palloc(a, num_pages);
+	ptr = uk_do_palloc(a, num_pages);
+	_uk_alloc_stats_pages(a, ptr, num_pages);
+	return ptr;
+}
+
+static inline void *uk_do_palloc_aligned(struct uk_alloc *a,
+					 unsigned long align,
+					 unsigned long num_pages)
+{
+	UK_ASSERT(a);
+	UK_ASSERT(POWER_OF_2(align));
+
+	if (a->palloc_aligned)
+		return a->palloc_aligned(a, align, num_pages);
+	if (align <= __PAGE_SIZE)
+		return a->palloc(a, num_pages);
+	errno = ENOTSUP;
+	return NULL;
+}
+
+/**
+ * Allocates a physically contiguous range of pages whose base address is a
+ * multiple of `align`. For instance, an alignment of 2 MiB enables mapping
+ * the range with large pages. The range is released with uk_pfree() and
+ * the same number of pages.
+ *
+ * @param a
+ *  Allocator to allocate from.
+ * @param align
+ *  Alignment of the base address in bytes, must be a power of two.
+ *  Alignments of up to one page are always supported.
+ * @param num_pages
+ *  Number of pages to allocate.
+ * @return
+ *  - (NULL): The request failed (errno set to ENOMEM), or the allocator
+ *    cannot handle alignments beyond a page (errno set to ENOTSUP).
+ *  - pointer to the first page of the range.
+ */
+static inline void *uk_palloc_aligned(struct uk_alloc *a, unsigned long align,
+				      unsigned long num_pages)
+{
+	void *ptr;
+
+	if (unlikely(!a || !a->palloc))
+		return NULL;
+	ptr = uk_do_palloc_aligned(a, align, num_pages);
+	_uk_alloc_stats_pages(a, ptr, num_pages);
+	return ptr;
 }
 
 static inline void uk_do_pfree(struct uk_alloc *a, void *ptr,
@@ -227,6 +508,10 @@ static inline void uk_do_pfree(struct uk_alloc *a, void *ptr,
 static inline void uk_pfree(struct uk_alloc *a, void *ptr,
 			    unsigned long num_pages)
 {
+#if CONFIG_LIBUKALLOC_STATS
+	if (ptr)
+		_uk_alloc_stats_free(a, num_pages << __PAGE_SHIFT);
+#endif
 	uk_do_pfree(a, ptr, num_pages);
 }
 
@@ -239,6 +524,49 @@ static inline int uk_alloc_addmem(struct uk_alloc *a, void *base,
 	else
 		return -ENOTSUP;
 }
+/**
+ * Returns the usable size of an object that was handed out by an
+ * allocator. This can be larger than the size that was requested.
+ *
+ * @param a
+ *  Allocator that handed out the object.
+ * @param ptr
+ *  Pointer to the object.
+ * @return
+ *  - (0): The allocator does not support size queries.
+ *  - usable size of the object in bytes.
+ */
+static inline size_t uk_alloc_getsize(struct uk_alloc *a, const void *ptr)
+{
+	UK_ASSERT(a);
+	if (!a->getsize || !ptr)
+		return 0;
+	return a->getsize(a, ptr);
+}
+
+/**
+ * Counts the free blocks of a page allocator by order: counts[i] is set
+ * to the number of free blocks of (1 << i) pages.
+ *
+ * @param a
+ *  Allocator to query.
+ * @param counts
+ *  Array that receives the counts.
+ * @param len
+ *  Number of elements of counts.
+ * @return
+ *  - (-ENOTSUP): The allocator does not support this query.
+ *  - number of orders that were written to counts.
+ */
+static inline int uk_alloc_freeblocks(struct uk_alloc *a,
+				      unsigned long *counts, unsigned int len)
+{
+	UK_ASSERT(a);
+	if (!a->freeblocks)
+		return -ENOTSUP;
+	return a->freeblocks(a, counts, len);
+}
+
 #if CONFIG_LIBUKALLOC_IFSTATS
 static inline ssize_t uk_alloc_availmem(struct uk_alloc *a)
 {
@@ -249,6 +577,69 @@ static inline ssize_t uk_alloc_availmem(struct uk_alloc *a)
 }
 #endif /* CONFIG_LIBUKALLOC_IFSTATS */
 
+#if CONFIG_LIBUKALLOC_STATS
+/**
+ * Copies the allocation statistics of an allocator. The statistics count
+ * the requests that were made through the public ukalloc interface.
+ * Bytes in use are only tracked for allocators that support getsize().
+ *
+ * @param a
+ *  Allocator to query.
+ * @param dst
+ *  Destination for the statistics.
+ */
+void uk_alloc_stats_get(struct uk_alloc *a, struct uk_alloc_stats *dst);
+
+/**
+ * Clears the allocation statistics of an allocator. The peak of used
+ * memory restarts from the current usage.
+ */
+void uk_alloc_stats_reset(struct uk_alloc *a);
+
+#if CONFIG_LIBUKALLOC_STATS_PERLIB
+/**
+ * Returns the number of libraries with allocation statistics. The
+ * statistics of a library count the requests that were issued by code of
+ * that library, independent of the used allocator.
+ */
+unsigned int uk_alloc_libstats_count(void);
+
+/**
+ * Copies the allocation statistics of a library.
+ *
+ * @param idx
+ *  Index of the library, less than uk_alloc_libstats_count().
+ * @param dst
+ *  Destination for the statistics.
+ * @return
+ *  - (NULL): Invalid index.
+ *  - name of the library.
+ */
+const char *uk_alloc_libstats_get(unsigned int idx,
+				  struct uk_alloc_stats *dst);
+#endif /* CONFIG_LIBUKALLOC_STATS_PERLIB */
+
+/**
+ * Writes a text report of the statistics of all registered allocators
+ * (and libraries) to a buffer. The output is truncated to the buffer
+ * size but always terminated.
+ *
+ * @param buf
+ *  Destination buffer.
+ * @param len
+ *  Size of the destination buffer.
+ * @return
+ *  Length of the full report, without terminating character.
+ */
+size_t uk_alloc_stats_print(char *buf, size_t len);
+
+/**
+ * Prints the statistics of all registered allocators (and libraries)
+ * to the kernel console with uk_pr_info().
+ */
+void uk_alloc_stats_dump(void);
+#endif /* CONFIG_LIBUKALLOC_STATS */
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,88 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Per-thread object caches for ukalloc
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * THIS HEADER MAY NOT BE EXTRACTED OR MODIFIED IN ANY WAY.
+ */
+
+#ifndef __UK_ALLOC_CACHE_H__
+#define __UK_ALLOC_CACHE_H__
+
+#include <uk/alloc.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Per-thread magazines of one cache allocator (opaque) */
+struct uk_alloc_magazines;
+
+/**
+ * Creates an allocator that caches released objects per thread and size
+ * class in front of a backend allocator. Objects that are released by a
+ * thread are handed out again to the same thread without calling the
+ * backend. Allocations that are larger than the largest size class and
+ * page allocations are forwarded to the backend.
+ * The cache allocator is registered with ukalloc but does not become the
+ * default allocator, see uk_alloc_set_default().
+ * NOTE: Like the backend allocators, the cache must not be used from
+ *       interrupt context.
+ *
+ * @param backend
+ *  Allocator that provides the memory for the cached objects.
+ * @return
+ *  - (NULL): If allocation of the allocator descriptor failed.
+ *  - pointer to the uk_alloc interface of the cache allocator.
+ */
+struct uk_alloc *uk_alloc_cache_init(struct uk_alloc *backend);
+
+/**
+ * Returns all objects that are cached by the calling thread to the
+ * backend allocators. This can be used by threads that are done with
+ * allocation-heavy work.
+ */
+void uk_alloc_cache_flush(void);
+
+/**
+ * Returns all cached objects of a list of magazines to the backend
+ * allocators and releases the magazines. This function is called by
+ * the scheduler when a thread is destroyed.
+ *
+ * @param mags
+ *  Pointer to the list of magazines of a thread. The list is empty
+ *  afterwards.
+ */
+void uk_alloc_cache_release(struct uk_alloc_magazines **mags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UK_ALLOC_CACHE_H__ */
@@ -49,6 +49,12 @@ extern "C" {
 
 int uk_alloc_register(struct uk_alloc *a);
 
+/* Removes an allocator from the list of registered allocators. If it is the
+ * default allocator, the next registered allocator becomes the default.
+ * Returns -ENOENT if the allocator is not registered.
+ */
+int uk_alloc_unregister(struct uk_alloc *a);
+
 /**
  * Compatibility functions that can be used by allocator implementations to
  * fill out callback functions in `struct uk_alloc` when just a subset of the
@@ -61,6 +67,16 @@ void *uk_realloc_ifpages(struct uk_alloc *a, void *ptr, size_t size);
 int uk_posix_memalign_ifpages(struct uk_alloc *a, void **memptr,
 				size_t align, size_t size);
 void uk_free_ifpages(struct uk_alloc *a, void *ptr);
+size_t uk_getsize_ifpages(struct uk_alloc *a, const void *ptr);
+
+/* Object layout of uk_malloc_ifpages() for native implementations of
+ * further functions: the number of pages that an object of `size` bytes
+ * occupies (0 if the size is invalid), the setup of an object on a range of
+ * pages, and the range of pages of an object.
+ */
+unsigned long uk_ifpages_num_pages(size_t size);
+void *uk_ifpages_obj_init(void *base, unsigned long num_pages);
+void *uk_ifpages_obj_base(const void *ptr, unsigned long *num_pages);
 
 #if CONFIG_LIBUKALLOC_IFMALLOC
 void *uk_malloc_ifmalloc(struct uk_alloc *a, size_t size);
@@ -68,6 +84,7 @@ void *uk_realloc_ifmalloc(struct uk_alloc *a, void *ptr, size_t size);
 int uk_posix_memalign_ifmalloc(struct uk_alloc *a, void **memptr,
 				     size_t align, size_t size);
 void uk_free_ifmalloc(struct uk_alloc *a, void *ptr);
+size_t uk_getsize_ifmalloc(struct uk_alloc *a, const void *ptr);
 #endif
 
 /* Functionality that is provided based on malloc() and posix_memalign() */
@@ -76,6 +93,12 @@ void *uk_realloc_compat(struct uk_alloc *a, void *ptr, size_t size);
 void *uk_memalign_compat(struct uk_alloc *a, size_t align, size_t len);
 void *uk_palloc_compat(struct uk_alloc *a, unsigned long num_pages);
 void uk_pfree_compat(struct uk_alloc *a, void *ptr, unsigned long num_pages);
+void *uk_palloc_aligned_compat(struct uk_alloc *a, unsigned long align,
+			       unsigned long num_pages);
+unsigned int uk_malloc_bulk_compat(struct uk_alloc *a, size_t size,
+				   void *ptrs[], unsigned int count);
+void uk_free_bulk_compat(struct uk_alloc *a, void *ptrs[],
+			 unsigned int count);
 
 /* Shortcut for doing a registration of an allocator that does not implement
  * palloc() or pfree()
@@ -89,9 +112,14 @@ void uk_pfree_compat(struct uk_alloc *a, void *ptr, unsigned long num_pages);
 		(a)->posix_memalign = (posix_memalign_f);		\
 		(a)->memalign       = (memalign_f);			\
 		(a)->free           = (free_f);				\
+		(a)->malloc_bulk    = uk_malloc_bulk_compat;		\
+		(a)->free_bulk      = uk_free_bulk_compat;		\
 		(a)->palloc         = uk_palloc_compat;			\
 		(a)->pfree          = uk_pfree_compat;			\
+		(a)->palloc_aligned = uk_palloc_aligned_compat;		\
 		(a)->addmem         = (addmem_f);			\
+		(a)->getsize        = NULL;				\
+		(a)->freeblocks     = NULL;				\
 									\
 		uk_alloc_register((a));					\
 	} while (0)
@@ -107,9 +135,14 @@ void uk_pfree_compat(struct uk_alloc *a, void *ptr, unsigned long num_pages);
 		(a)->malloc_backend = (malloc_f);			\
 		(a)->free_backend   = (free_f);				\
 		(a)->free           = uk_free_ifmalloc;			\
+		(a)->malloc_bulk    = uk_malloc_bulk_compat;		\
+		(a)->free_bulk      = uk_free_bulk_compat;		\
 		(a)->palloc         = uk_palloc_compat;			\
 		(a)->pfree          = uk_pfree_compat;			\
+		(a)->palloc_aligned = uk_palloc_aligned_compat;		\
 		(a)->addmem         = (addmem_f);			\
+		(a)->getsize        = uk_getsize_ifmalloc;		\
+		(a)->freeblocks     = NULL;				\
 									\
 		uk_alloc_register((a));					\
 	} while (0)
@@ -126,9 +159,14 @@ void uk_pfree_compat(struct uk_alloc *a, void *ptr, unsigned long num_pages);
 		(a)->posix_memalign = uk_posix_memalign_ifpages;	\
 		(a)->memalign       = uk_memalign_compat;		\
 		(a)->free           = uk_free_ifpages;			\
+		(a)->malloc_bulk    = uk_malloc_bulk_compat;		\
+		(a)->free_bulk      = uk_free_bulk_compat;		\
 		(a)->palloc         = (palloc_func);			\
 		(a)->pfree          = (pfree_func);			\
+		(a)->palloc_aligned = NULL;				\
 		(a)->addmem         = (addmem_func);			\
+		(a)->getsize        = uk_getsize_ifpages;		\
+		(a)->freeblocks     = NULL;				\
 									\
 		uk_alloc_register((a));					\
 	} while (0)
@@ -0,0 +1,313 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Allocation statistics for ukalloc
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Statistics are counted by the inline wrappers of <uk/alloc.h> (uk_malloc(),
+ * uk_free(), ...) so that allocator implementations do not need to care
+ * about them. Each allocator carries its own set of counters. With
+ * CONFIG_LIBUKALLOC_STATS_PERLIB, every request is additionally accounted to
+ * the library that issued it. The library is identified by the __LIBNAME__
+ * of the calling compilation unit; each unit caches a reference to its entry
+ * so that the lookup happens only once.
+ *
+ * Like the allocators themselves, the counters are not protected against
+ * concurrent updates from interrupt context.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <uk/alloc_impl.h>
+#include <uk/config.h>
+#include <uk/essentials.h>
+#include <uk/assert.h>
+#include <uk/print.h>
+#include <uk/report.h>
+#include <uk/arch/atomic.h>
+
+#define STATS_LINE_LEN		UK_REPORT_LINE_LEN
+#define STATS_MAX_ORDERS	((sizeof(void *) << 3) - __PAGE_SHIFT)
+
+#if CONFIG_LIBUKALLOC_STATS_PERLIB
+struct uk_alloc_libstats {
+	const char *libname;
+	struct uk_alloc_stats stats;
+};
+
+static struct uk_alloc_libstats libstats[CONFIG_LIBUKALLOC_STATS_PERLIB_MAX];
+static unsigned int libstats_count;
+
+static struct uk_alloc_stats *libstats_lookup(struct uk_alloc_libref *lib)
+{
+	unsigned int i;
+
+	if (!lib)
+		return NULL;
+	if (likely(lib->ls))
+		return &lib->ls->stats;
+
+	UK_ASSERT(lib->libname);
+	for (i = 0; i < libstats_count; ++i) {
+		if (strcmp(libstats[i].libname, lib->libname) == 0)
+			goto out;
+	}
+
+	if (unlikely(libstats_count == ARRAY_SIZE(libstats))) {
+		uk_pr_warn("No space left for allocation statistics of %s\n",
+			   lib->libname);
+		return NULL;
+	}
+	i = libstats_count++;
+	libstats[i].libname = lib->libname;
+out:
+	lib->ls = &libstats[i];
+	return &libstats[i].stats;
+}
+
+unsigned int uk_alloc_libstats_count(void)
+{
+	return libstats_count;
+}
+
+const char *uk_alloc_libstats_get(unsigned int idx,
+				  struct uk_alloc_stats *dst)
+{
+	UK_ASSERT(dst);
+
+	if (idx >= libstats_count)
+		return NULL;
+
+	*dst = libstats[idx].stats;
+	return libstats[idx].libname;
+}
+#else /* !CONFIG_LIBUKALLOC_STATS_PERLIB */
+#define libstats_lookup(lib) \
+	({ (void)(lib); (struct uk_alloc_stats *) NULL; })
+#endif /* !CONFIG_LIBUKALLOC_STATS_PERLIB */
+
+static inline unsigned int hist_idx(size_t size)
+{
+	unsigned int idx;
+
+	if (size <= 16)
+		return 0;
+
+	idx = (unsigned int) ukarch_flsl(size - 1) - 3;
+	return MIN(idx, (unsigned int) UK_ALLOC_STATS_HIST_LEN - 1);
+}
+
+static inline void stats_alloc(struct uk_alloc_stats *s, size_t size,
+			       size_t len)
+{
+	s->nb_allocs++;
+	s->hist[hist_idx(size)]++;
+	s->cur_mem_use += len;
+	if (s->cur_mem_use > s->max_mem_use)
+		s->max_mem_use = s->cur_mem_use;
+}
+
+static inline void stats_free(struct uk_alloc_stats *s, size_t len)
+{
+	s->nb_frees++;
+	s->cur_mem_use -= len;
+}
+
+void _uk_alloc_stats_count_alloc(struct uk_alloc *a,
+				 struct uk_alloc_libref *lib,
+				 size_t size, size_t len)
+{
+	struct uk_alloc_stats *s;
+
+	UK_ASSERT(a);
+
+	stats_alloc(&a->_stats, size, len);
+	s = libstats_lookup(lib);
+	if (s)
+		stats_alloc(s, size, len);
+}
+
+void _uk_alloc_stats_count_free(struct uk_alloc *a,
+				struct uk_alloc_libref *lib,
+				size_t len)
+{
+	struct uk_alloc_stats *s;
+
+	UK_ASSERT(a);
+
+	stats_free(&a->_stats, len);
+	s = libstats_lookup(lib);
+	if (s)
+		stats_free(s, len);
+}
+
+void _uk_alloc_stats_count_enomem(struct uk_alloc *a,
+				  struct uk_alloc_libref *lib,
+				  size_t size __unused)
+{
+	struct uk_alloc_stats *s;
+
+	UK_ASSERT(a);
+
+	a->_stats.nb_enomem++;
+	s = libstats_lookup(lib);
+	if (s)
+		s->nb_enomem++;
+}
+
+void uk_alloc_stats_get(struct uk_alloc *a, struct uk_alloc_stats *dst)
+{
+	UK_ASSERT(a);
+	UK_ASSERT(dst);
+
+	*dst = a->_stats;
+}
+
+void uk_alloc_stats_reset(struct uk_alloc *a)
+{
+	ssize_t cur_mem_use;
+
+	UK_ASSERT(a);
+
+	cur_mem_use = a->_stats.cur_mem_use;
+	memset(&a->_stats, 0, sizeof(a->_stats));
+	a->_stats.cur_mem_use = cur_mem_use;
+	a->_stats.max_mem_use = cur_mem_use;
+}
+
+/*
+ * Report
+ */
+/* Appends a formatted item to a line buffer, the line is flushed when it is
+ * about to overflow
+ */
+#define STATS_ITEM_LEN 32
+
+static void stats_print_item(struct uk_report *o, const char *prefix,
+			     char *line, size_t *pos, const char *item)
+{
+	if (*pos + strlen(item) >= STATS_LINE_LEN - STATS_ITEM_LEN) {
+		uk_report_printf(o, "  %s%s\n", prefix, line);
+		*pos = 0;
+	}
+	strcpy(line + *pos, item);
+	*pos += strlen(item);
+}
+
+static void stats_print_counters(struct uk_report *o,
+				 const struct uk_alloc_stats *s)
+{
+	char line[STATS_LINE_LEN];
+	char item[STATS_ITEM_LEN];
+	size_t pos = 0;
+	unsigned int i;
+
+	uk_report_printf(o, "  allocs %lu frees %lu enomem %lu"
+			 " in-use %zd B peak %zd B\n",
+			 s->nb_allocs, s->nb_frees, s->nb_enomem,
+			 s->cur_mem_use, s->max_mem_use);
+
+	/* only show the size classes that have been requested */
+	for (i = 0; i < UK_ALLOC_STATS_HIST_LEN; ++i) {
+		if (!s->hist[i])
+			continue;
+
+		if (i == UK_ALLOC_STATS_HIST_LEN - 1)
+			snprintf(item, sizeof(item), " >%lu:%lu",
+				 16UL << (i - 1), s->hist[i]);
+		else
+			snprintf(item, sizeof(item), " <=%lu:%lu",
+				 16UL << i, s->hist[i]);
+		stats_print_item(o, "sizes", line, &pos, item);
+	}
+	if (pos)
+		uk_report_printf(o, "  sizes%s\n", line);
+}
+
+static void stats_print_freeblocks(struct uk_report *o, struct uk_alloc *a)
+{
+	unsigned long counts[STATS_MAX_ORDERS];
+	char line[STATS_LINE_LEN];
+	char item[STATS_ITEM_LEN];
+	size_t pos = 0;
+	int i, nr;
+
+	nr = uk_alloc_freeblocks(a, counts, ARRAY_SIZE(counts));
+	if (nr <= 0)
+		return;
+
+	for (i = 0; i < nr; ++i) {
+		if (!counts[i])
+			continue;
+
+		snprintf(item, sizeof(item), " %d:%lu", i, counts[i]);
+		stats_print_item(o, "free blocks by order", line, &pos, item);
+	}
+	if (pos)
+		uk_report_printf(o, "  free blocks by order%s\n", line);
+}
+
+static void stats_report(struct uk_report *o)
+{
+	struct uk_alloc *a;
+	const char *tag;
+#if CONFIG_LIBUKALLOC_STATS_PERLIB
+	unsigned int i;
+#endif
+
+	for (a = _uk_alloc_head; a; a = a->next) {
+		tag = (a == uk_alloc_get_default()) ? " (default)" : "";
+#if CONFIG_LIBUKALLOC_IFSTATS
+		uk_report_printf(o, "allocator %p%s: avail %zd B\n",
+				 a, tag, uk_alloc_availmem(a));
+#else
+		uk_report_printf(o, "allocator %p%s:\n", a, tag);
+#endif
+		stats_print_counters(o, &a->_stats);
+		stats_print_freeblocks(o, a);
+	}
+
+#if CONFIG_LIBUKALLOC_STATS_PERLIB
+	for (i = 0; i < libstats_count; ++i) {
+		uk_report_printf(o, "library %s:\n", libstats[i].libname);
+		stats_print_counters(o, &libstats[i].stats);
+	}
+#endif
+}
+
+size_t uk_alloc_stats_print(char *buf, size_t len)
+{
+	return uk_report_print(stats_report, buf, len);
+}
+
+void uk_alloc_stats_dump(void)
+{
+	uk_report_dump(stats_report);
+}
@@ -66,6 +66,9 @@ struct chunk_tail_st {
 #define FREELIST_SIZE ((sizeof(void *) << 3) - __PAGE_SHIFT)
 #define FREELIST_EMPTY(_l) ((_l)->next == NULL)
 
+/* Order of a 2 MiB chunk */
+#define HUGEPAGE_ORDER (21 - __PAGE_SHIFT)
+
 /* keep a bitmap for each memory region separately */
 struct uk_bbpalloc_memr {
 	struct uk_bbpalloc_memr *next;
@@ -225,6 +228,26 @@ static ssize_t bbuddy_availmem(struct uk_alloc *a)
 }
 #endif
 
+static int bbuddy_freeblocks(struct uk_alloc *a, unsigned long *counts,
+			     unsigned int len)
+{
+	struct uk_bbpalloc *b;
+	chunk_head_t *ch;
+	unsigned int i;
+
+	UK_ASSERT(a != NULL);
+	UK_ASSERT(counts || !len);
+	b = (struct uk_bbpalloc *)&a->priv;
+
+	len = MIN(len, (unsigned int) FREELIST_SIZE);
+	for (i = 0; i < len; i++) {
+		counts[i] = 0;
+		for (ch = b->free_head[i]; !FREELIST_EMPTY(ch); ch = ch->next)
+			counts[i]++;
+	}
+	return (int) len;
+}
+
 /* return log of the next power of two of passed number */
 static inline unsigned long num_pages_to_order(unsigned long num_pages)
 {
@@ -245,7 +268,37 @@ static inline unsigned long num_pages_to_order(unsigned long num_pages)
 /*********************
  * BINARY BUDDY PAGE ALLOCATOR
  */
-static void *bbuddy_palloc(struct uk_alloc *a, unsigned long num_pages)
+#if CONFIG_LIBUKALLOCBBUDDY_HUGEPAGE
+/*
+ * Selects the chunk that is split for an allocation of `order` from the
+ * free list of order `i`. Chunks of at least 2 MiB are only split when no
+ * smaller chunk is available. In this case, requests below 2 MiB take
+ * the chunk with the lowest address, larger requests the one with the
+ * highest address. Small allocations are thereby grouped at the bottom of
+ * the memory, while the 2 MiB-aligned chunks at the top stay intact for
+ * large allocations. The lists of these orders are short, scanning them is
+ * cheap compared to the split that follows.
+ */
+static chunk_head_t *freelist_pick(struct uk_bbpalloc *b, size_t i,
+				   size_t order)
+{
+	chunk_head_t *ch, *best;
+
+	best = b->free_head[i];
+	if (i < HUGEPAGE_ORDER)
+		return best;
+
+	for (ch = best->next; !FREELIST_EMPTY(ch); ch = ch->next) {
+		if ((order < HUGEPAGE_ORDER) ? (ch < best) : (ch > best))
+			best = ch;
+	}
+	return best;
+}
+#else
+#define freelist_pick(b, i, order) ((b)->free_head[(i)])
+#endif /* CONFIG_LIBUKALLOCBBUDDY_HUGEPAGE */
+
+static void *bbuddy_palloc_order(struct uk_alloc *a, size_t order)
 {
 	struct uk_bbpalloc *b;
 	size_t i;
@@ -255,8 +308,6 @@ static void *bbuddy_palloc(struct uk_alloc *a, unsigned long num_pages)
 	UK_ASSERT(a != NULL);
 	b = (struct uk_bbpalloc *)&a->priv;
 
-	size_t order = (size_t)num_pages_to_order(num_pages);
-
 	/* Find smallest order which can satisfy the request. */
 	for (i = order; i < FREELIST_SIZE; i++) {
 		if (!FREELIST_EMPTY(b->free_head[i]))
@@ -266,8 +317,8 @@ static void *bbuddy_palloc(struct uk_alloc *a, unsigned long num_pages)
 		goto no_memory;
 
 	/* Unlink a chunk. */
-	alloc_ch = b->free_head[i];
-	b->free_head[i] = alloc_ch->next;
+	alloc_ch = freelist_pick(b, i, order);
+	*(alloc_ch->pprev) = alloc_ch->next;
 	alloc_ch->next->pprev = alloc_ch->pprev;
 
 	/* We may have to break the chunk a number of times. */
@@ -300,6 +351,11 @@ no_memory:
 	return NULL;
 }
 
+static void *bbuddy_palloc(struct uk_alloc *a, unsigned long num_pages)
+{
+	return bbuddy_palloc_order(a, (size_t)num_pages_to_order(num_pages));
+}
+
 static void bbuddy_pfree(struct uk_alloc *a, void *obj, unsigned long num_pages)
 {
 	struct uk_bbpalloc *b;
@@ -362,6 +418,87 @@ static void bbuddy_pfree(struct uk_alloc *a, void *obj, unsigned long num_pages)
 	b->free_head[order] = freed_ch;
 }
 
+/*
+ * Chunks of order n are aligned to 2^n pages, so an aligned request is
+ * served from a chunk of the alignment's order. The pages behind the
+ * requested range are given back right away, so the range can be released
+ * with a regular pfree() call.
+ */
+static void *bbuddy_palloc_aligned(struct uk_alloc *a, unsigned long align,
+				   unsigned long num_pages)
+{
+	size_t order, align_order, i;
+	char *ptr;
+
+	order = (size_t)num_pages_to_order(num_pages);
+	if (align <= __PAGE_SIZE)
+		return bbuddy_palloc_order(a, order);
+
+	align_order = (size_t)ukarch_flsl(align) - __PAGE_SHIFT;
+	if (align_order <= order)
+		return bbuddy_palloc_order(a, order);
+
+	ptr = bbuddy_palloc_order(a, align_order);
+	if (!ptr)
+		return NULL;
+
+	for (i = order; i < align_order; i++)
+		bbuddy_pfree(a, ptr + (1UL << (i + __PAGE_SHIFT)), 1UL << i);
+	return ptr;
+}
+
+/*
+ * Objects of a bulk request are carved out of as few chunks as possible:
+ * a chunk of order (n + k) is split into 2^k objects of order n. Each
+ * object can still be released on its own with uk_free(), the buddies are
+ * merged again when all of them are free.
+ */
+static unsigned int bbuddy_malloc_bulk(struct uk_alloc *a, size_t size,
+				       void *ptrs[], unsigned int count)
+{
+	unsigned long num_pages;
+	size_t order, k, j;
+	unsigned int n = 0;
+	char *ptr;
+
+	num_pages = uk_ifpages_num_pages(size);
+	if (unlikely(!num_pages || !count))
+		return 0;
+	order = (size_t)num_pages_to_order(num_pages);
+	if (unlikely(order >= FREELIST_SIZE))
+		return 0;
+
+	k = MIN((size_t)ukarch_flsl(count), FREELIST_SIZE - 1 - order);
+	while (n < count) {
+		k = MIN(k, (size_t)ukarch_flsl(count - n));
+		ptr = bbuddy_palloc_order(a, order + k);
+		if (!ptr) {
+			if (k == 0)
+				break;
+			k--;
+			continue;
+		}
+
+		for (j = 0; j < (1UL << k); j++)
+			ptrs[n++] = uk_ifpages_obj_init(
+				ptr + (j << (order + __PAGE_SHIFT)), num_pages);
+	}
+	return n;
+}
+
+static void bbuddy_free_bulk(struct uk_alloc *a, void *ptrs[],
+			     unsigned int count)
+{
+	unsigned long num_pages;
+	unsigned int i;
+	void *base;
+
+	for (i = 0; i < count; i++) {
+		base = uk_ifpages_obj_base(ptrs[i], &num_pages);
+		bbuddy_pfree(a, base, num_pages);
+	}
+}
+
 static int bbuddy_addmem(struct uk_alloc *a, void *base, size_t len)
 {
 	struct uk_bbpalloc *b;
@@ -504,6 +641,10 @@ struct uk_alloc *uk_allocbbuddy_init(void *base, size_t len)
 	/* initialize and register allocator interface */
 	uk_alloc_init_palloc(a, bbuddy_palloc, bbuddy_pfree,
 			     bbuddy_addmem);
+	a->palloc_aligned = bbuddy_palloc_aligned;
+	a->malloc_bulk = bbuddy_malloc_bulk;
+	a->free_bulk = bbuddy_free_bulk;
+	a->freeblocks = bbuddy_freeblocks;
 #if CONFIG_LIBUKALLOC_IFSTATS
 	a->availmem = bbuddy_availmem;
 #endif
@@ -0,0 +1,738 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Allocator micro-benchmarks
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <uk/config.h>
+#include <uk/essentials.h>
+#include <uk/assert.h>
+#include <uk/alloc.h>
+#include <uk/alloc_impl.h>
+#include <uk/allocbench.h>
+#include <uk/init.h>
+#include <uk/print.h>
+#include <uk/plat/time.h>
+#if CONFIG_LIBUKALLOCBBUDDY
+#include <uk/allocbbuddy.h>
+#endif
+#if CONFIG_LIBUKALLOCREGION
+#include <uk/allocregion.h>
+#endif
+#if CONFIG_LIBUKALLOCTLSF
+#include <uk/alloctlsf.h>
+#endif
+#if CONFIG_LIBUKALLOCSLAB
+#include <uk/allocslab.h>
+#endif
+#if CONFIG_LIBUKALLOC_CACHE
+#include <uk/alloc_cache.h>
+#endif
+#if CONFIG_LIBUKALLOCPOOL
+#include <uk/allocpool.h>
+#endif
+#if CONFIG_LIBUKALLOCBENCH_THREADS
+#include <uk/sched.h>
+#include <uk/thread.h>
+#endif
+
+#define BENCH_OPS		((unsigned long) CONFIG_LIBUKALLOCBENCH_OPS)
+#define BENCH_ARENA_LEN		((size_t) CONFIG_LIBUKALLOCBENCH_ARENA_MB << 20)
+#define BENCH_BURST		64U	/* fixed pattern: objects per burst */
+#define BENCH_SMALL_LEN		64U	/* fixed pattern: object size */
+#define BENCH_SLOTS		1024U	/* mixed pattern: live objects */
+#define BENCH_RING		256U	/* producer/consumer: ring size */
+#define BENCH_FRAG_SLOTS	4096U	/* fragmentation: live objects */
+#define BENCH_FRAG_EPOCHS	8U
+#define BENCH_MAX_SHIFT		10U	/* power-law sizes: 16 B - 32 KiB */
+#define BENCH_SMALL_SHIFT	3U	/* power-law sizes: 16 B - 256 B */
+#define BENCH_SAMPLES		4096U	/* latency samples per operation */
+#define BENCH_POOL_OBJ_LEN	256U
+#define BENCH_POOL_OBJS		256U	/* take/return: pool size */
+
+UK_CTASSERT(POWER_OF_2(BENCH_SAMPLES));
+UK_CTASSERT(POWER_OF_2(BENCH_SLOTS));
+UK_CTASSERT(POWER_OF_2(BENCH_RING));
+
+enum bench_op {
+	BENCH_MALLOC = 0,
+	BENCH_FREE,
+	BENCH_MEMALIGN,
+	BENCH_PALLOC,
+	BENCH_PFREE,
+	BENCH_OP_COUNT
+};
+
+static const char *const bench_op_name[BENCH_OP_COUNT] = {
+	[BENCH_MALLOC]   = "malloc",
+	[BENCH_FREE]     = "free",
+	[BENCH_MEMALIGN] = "memalign",
+	[BENCH_PALLOC]   = "palloc",
+	[BENCH_PFREE]    = "pfree",
+};
+
+/* Latency samples of one operation; the most recent BENCH_SAMPLES are kept */
+struct bench_lat {
+	unsigned long count;
+	__nsec sample[BENCH_SAMPLES];
+};
+
+struct bench {
+	const char *name;
+	struct uk_alloc *a;
+	__u64 rand;
+	unsigned long ops;
+	unsigned long failed;
+	/* NULL if single operations are not timed */
+	struct bench_lat *lat;
+};
+
+/* Object of the mixed and fragmentation patterns */
+struct bench_obj {
+	void *ptr;
+	/* bytes, or pages with BENCH_PALLOC */
+	size_t len;
+	enum bench_op op;
+};
+
+static struct bench_lat bench_lat[BENCH_OP_COUNT];
+static struct bench_obj bench_obj[BENCH_FRAG_SLOTS];
+static __nsec bench_clock_cost;
+
+static __u32 bench_rand(struct bench *b)
+{
+	/* xorshift64* */
+	b->rand ^= b->rand >> 12;
+	b->rand ^= b->rand << 25;
+	b->rand ^= b->rand >> 27;
+	return (__u32) ((b->rand * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/* Returns k with probability 2^-(k+1), the last value takes the rest */
+static unsigned int bench_rand_geom(struct bench *b, unsigned int max)
+{
+	__u32 r = bench_rand(b);
+	unsigned int k = 0;
+
+	while (k < max && (r & (1U << k)))
+		++k;
+	return k;
+}
+
+/* Sizes follow a power law: each doubling is half as likely */
+static size_t bench_rand_size(struct bench *b, unsigned int max_shift)
+{
+	size_t base = 16UL << bench_rand_geom(b, max_shift);
+
+	return base + (bench_rand(b) & (base - 1));
+}
+
+static inline __nsec bench_start(struct bench *b)
+{
+	return b->lat ? ukplat_monotonic_clock() : 0;
+}
+
+static inline void bench_stop(struct bench *b, enum bench_op op,
+			      __nsec start)
+{
+	struct bench_lat *l;
+	__nsec t;
+
+	b->ops++;
+	if (!b->lat)
+		return;
+
+	t = ukplat_monotonic_clock() - start;
+	l = &b->lat[op];
+	l->sample[l->count++ & (BENCH_SAMPLES - 1)] =
+		(t > bench_clock_cost) ? t - bench_clock_cost : 0;
+}
+
+static void *bench_malloc(struct bench *b, size_t size)
+{
+	__nsec start = bench_start(b);
+	void *obj;
+
+	obj = uk_malloc(b->a, size);
+	bench_stop(b, BENCH_MALLOC, start);
+	if (unlikely(!obj))
+		b->failed++;
+	return obj;
+}
+
+static void *bench_memalign(struct bench *b, size_t align, size_t size)
+{
+	__nsec start = bench_start(b);
+	void *obj;
+
+	obj = uk_memalign(b->a, align, size);
+	bench_stop(b, BENCH_MEMALIGN, start);
+	if (unlikely(!obj))
+		b->failed++;
+	return obj;
+}
+
+static void *bench_palloc(struct bench *b, unsigned long num_pages)
+{
+	__nsec start = bench_start(b);
+	void *obj;
+
+	obj = uk_palloc(b->a, num_pages);
+	bench_stop(b, BENCH_PALLOC, start);
+	if (unlikely(!obj))
+		b->failed++;
+	return obj;
+}
+
+static void bench_free(struct bench *b, void *obj)
+{
+	__nsec start;
+
+	if (unlikely(!obj))
+		return;
+
+	start = bench_start(b);
+	uk_free(b->a, obj);
+	bench_stop(b, BENCH_FREE, start);
+}
+
+static void bench_pfree(struct bench *b, void *obj, unsigned long num_pages)
+{
+	__nsec start;
+
+	if (unlikely(!obj))
+		return;
+
+	start = bench_start(b);
+	uk_pfree(b->a, obj, num_pages);
+	bench_stop(b, BENCH_PFREE, start);
+}
+
+/* 3/4 malloc, 1/8 memalign with 64 B - 4 KiB alignment, 1/8 palloc */
+static void bench_obj_alloc(struct bench *b, struct bench_obj *o,
+			    unsigned int max_shift)
+{
+	__u32 r = bench_rand(b) & 7;
+
+	if (r < 6) {
+		o->op = BENCH_MALLOC;
+		o->len = bench_rand_size(b, max_shift);
+		o->ptr = bench_malloc(b, o->len);
+	} else if (r < 7) {
+		o->op = BENCH_MEMALIGN;
+		o->len = bench_rand_size(b, max_shift);
+		o->ptr = bench_memalign(b, 64UL << (bench_rand(b) % 7),
+					o->len);
+	} else {
+		o->op = BENCH_PALLOC;
+		o->len = 1UL << bench_rand_geom(b, 3);
+		o->ptr = bench_palloc(b, o->len);
+	}
+}
+
+static void bench_obj_free(struct bench *b, struct bench_obj *o)
+{
+	if (o->op == BENCH_PALLOC)
+		bench_pfree(b, o->ptr, o->len);
+	else
+		bench_free(b, o->ptr);
+	o->ptr = NULL;
+}
+
+static void bench_obj_free_all(struct bench *b, unsigned int count)
+{
+	unsigned int i;
+
+	for (i = 0; i < count; ++i)
+		bench_obj_free(b, &bench_obj[i]);
+}
+
+/* Bursts of small objects of one size, released in allocation order */
+static void pattern_fixed(struct bench *b)
+{
+	static void *obj[BENCH_BURST];
+	unsigned int i;
+
+	while (b->ops < BENCH_OPS) {
+		for (i = 0; i < BENCH_BURST; ++i)
+			obj[i] = bench_malloc(b, BENCH_SMALL_LEN);
+		for (i = 0; i < BENCH_BURST; ++i)
+			bench_free(b, obj[i]);
+	}
+}
+
+/* Random allocation and release of objects with power-law sizes */
+static void pattern_mixed(struct bench *b)
+{
+	struct bench_obj *o;
+
+	memset(bench_obj, 0, sizeof(bench_obj));
+	while (b->ops < BENCH_OPS) {
+		o = &bench_obj[bench_rand(b) & (BENCH_SLOTS - 1)];
+		if (o->ptr)
+			bench_obj_free(b, o);
+		else
+			bench_obj_alloc(b, o, BENCH_MAX_SHIFT);
+	}
+	bench_obj_free_all(b, BENCH_SLOTS);
+}
+
+#if CONFIG_LIBUKALLOCBENCH_THREADS
+static struct {
+	void *obj[BENCH_RING];
+	unsigned int head;
+	unsigned int tail;
+	int done;
+} bench_ring;
+
+static void bench_producer(void *arg)
+{
+	struct bench *b = arg;
+	void *obj;
+
+	while (b->ops < BENCH_OPS) {
+		if (bench_ring.head - bench_ring.tail == BENCH_RING) {
+			uk_sched_yield();
+			continue;
+		}
+		obj = bench_malloc(b, bench_rand_size(b, BENCH_SMALL_SHIFT));
+		if (obj)
+			bench_ring.obj[bench_ring.head++ & (BENCH_RING - 1)] =
+				obj;
+	}
+	bench_ring.done = 1;
+}
+
+static void bench_consumer(void *arg)
+{
+	struct bench *b = arg;
+
+	while (!bench_ring.done || bench_ring.tail != bench_ring.head) {
+		if (bench_ring.tail == bench_ring.head) {
+			uk_sched_yield();
+			continue;
+		}
+		bench_free(b, bench_ring.obj[bench_ring.tail & (BENCH_RING - 1)]);
+		bench_ring.tail++;
+	}
+}
+
+/* Objects are allocated by one thread and released by another one */
+static void pattern_prodcons(struct bench *b)
+{
+	struct uk_thread *prod, *cons;
+
+	memset(&bench_ring, 0, sizeof(bench_ring));
+	prod = uk_thread_create("allocbench-prod", bench_producer, b);
+	cons = uk_thread_create("allocbench-cons", bench_consumer, b);
+	UK_ASSERT(prod && cons);
+	uk_thread_wait(prod);
+	uk_thread_wait(cons);
+}
+#endif /* CONFIG_LIBUKALLOCBENCH_THREADS */
+
+/* A large set of live objects is replaced randomly over several epochs.
+ * The size range alternates between epochs, so that small free blocks
+ * get scattered between long-living large objects. The memory overhead
+ * is reported at the end of each epoch.
+ */
+static void pattern_frag(struct bench *b)
+{
+	ssize_t avail0, avail;
+	unsigned long live, used;
+	unsigned int e, i;
+	struct bench_obj *o;
+
+	memset(bench_obj, 0, sizeof(bench_obj));
+	avail0 = uk_alloc_availmem(b->a);
+	for (e = 0; e < BENCH_FRAG_EPOCHS; ++e) {
+		while (b->ops < (e + 1) * BENCH_OPS / BENCH_FRAG_EPOCHS) {
+			o = &bench_obj[bench_rand(b) % BENCH_FRAG_SLOTS];
+			bench_obj_free(b, o);
+			bench_obj_alloc(b, o, (e & 1) ? BENCH_MAX_SHIFT
+						     : BENCH_SMALL_SHIFT);
+		}
+
+		live = 0;
+		for (i = 0; i < BENCH_FRAG_SLOTS; ++i) {
+			o = &bench_obj[i];
+			if (o->ptr)
+				live += (o->op == BENCH_PALLOC)
+					? o->len << __PAGE_SHIFT : o->len;
+		}
+
+		avail = uk_alloc_availmem(b->a);
+		if (avail0 < 0 || avail < 0 || !live) {
+			printf("%-8s frag     epoch %u: %8lu KiB live, %lu failed\n",
+			       b->name, e, live >> 10, b->failed);
+			continue;
+		}
+		used = (unsigned long) (avail0 - avail);
+		printf("%-8s frag     epoch %u: %8lu KiB live, %8lu KiB used (%3lu%% overhead), %lu failed\n",
+		       b->name, e, live >> 10, used >> 10,
+		       (used > live) ? (used - live) * 100 / live : 0,
+		       b->failed);
+	}
+	bench_obj_free_all(b, BENCH_FRAG_SLOTS);
+}
+
+static const struct {
+	const char *name;
+	void (*run)(struct bench *b);
+	/* measure latency in a second run */
+	int lat;
+} bench_pattern[] = {
+	{ "fixed", pattern_fixed, 1 },
+	{ "mixed", pattern_mixed, 1 },
+#if CONFIG_LIBUKALLOCBENCH_THREADS
+	{ "prodcons", pattern_prodcons, 1 },
+#endif
+	{ "frag", pattern_frag, 0 },
+};
+
+static int nsec_cmp(const void *p1, const void *p2)
+{
+	__nsec t1 = *(const __nsec *) p1;
+	__nsec t2 = *(const __nsec *) p2;
+
+	return (t1 > t2) - (t1 < t2);
+}
+
+static void bench_lat_report(const char *name, const char *pattern)
+{
+	struct bench_lat *l;
+	unsigned long n;
+	unsigned int op;
+
+	for (op = 0; op < BENCH_OP_COUNT; ++op) {
+		l = &bench_lat[op];
+		if (!l->count)
+			continue;
+
+		n = MIN(l->count, (unsigned long) BENCH_SAMPLES);
+		qsort(l->sample, n, sizeof(l->sample[0]), nsec_cmp);
+		printf("%-8s %-8s %-8s p50 %6"__PRInsec" p90 %6"__PRInsec" p99 %6"__PRInsec" max %8"__PRInsec" ns\n",
+		       name, pattern, bench_op_name[op],
+		       l->sample[n / 2], l->sample[n * 9 / 10],
+		       l->sample[n * 99 / 100], l->sample[n - 1]);
+	}
+}
+
+static void bench_init(struct bench *b, const char *name,
+		       struct uk_alloc *a, struct bench_lat *lat)
+{
+	b->name = name;
+	b->a = a;
+	b->rand = 0x9E3779B97F4A7C15ULL;
+	b->ops = 0;
+	b->failed = 0;
+	b->lat = lat;
+	if (lat)
+		memset(lat, 0, sizeof(*lat) * BENCH_OP_COUNT);
+}
+
+/* The minimum cost of reading the clock is subtracted from the samples */
+static void bench_clock_calibrate(void)
+{
+	__nsec t, min = (__nsec) -1;
+	unsigned int i;
+
+	for (i = 0; i < 1024; ++i) {
+		t = ukplat_monotonic_clock();
+		t = ukplat_monotonic_clock() - t;
+		min = MIN(min, t);
+	}
+	bench_clock_cost = min;
+}
+
+int uk_allocbench_run(const char *name, struct uk_alloc *a)
+{
+	struct bench b;
+	unsigned int i;
+	__nsec t;
+
+	UK_ASSERT(name);
+	if (!a)
+		return -EINVAL;
+
+	bench_clock_calibrate();
+	for (i = 0; i < ARRAY_SIZE(bench_pattern); ++i) {
+#if CONFIG_LIBUKALLOCBENCH_THREADS
+		if (bench_pattern[i].run == pattern_prodcons
+		    && !uk_sched_get_default())
+			continue;
+#endif
+		bench_init(&b, name, a, NULL);
+		t = ukplat_monotonic_clock();
+		bench_pattern[i].run(&b);
+		t = ukplat_monotonic_clock() - t;
+		printf("%-8s %-8s %lu ops, %"__PRInsec" ns/op, %"__PRInsec" kops/s, %lu failed\n",
+		       name, bench_pattern[i].name, b.ops,
+		       t / b.ops, (__nsec) b.ops * 1000000 / (t ? t : 1),
+		       b.failed);
+
+		if (!bench_pattern[i].lat)
+			continue;
+		bench_init(&b, name, a, bench_lat);
+		bench_pattern[i].run(&b);
+		bench_lat_report(name, bench_pattern[i].name);
+	}
+	return 0;
+}
+
+#if CONFIG_LIBUKALLOCPOOL
+typedef unsigned int (*bench_pool_func_t)(struct uk_allocpool *p,
+					  void *obj[], unsigned int count);
+
+static unsigned int pool_take_single(struct uk_allocpool *p, void *obj[],
+				     unsigned int count)
+{
+	unsigned int i;
+
+	for (i = 0; i < count; ++i) {
+		obj[i] = uk_allocpool_take(p);
+		if (unlikely(!obj[i]))
+			break;
+	}
+	return i;
+}
+
+static unsigned int pool_return_single(struct uk_allocpool *p, void *obj[],
+				       unsigned int count)
+{
+	unsigned int i;
+
+	for (i = 0; i < count; ++i)
+		uk_allocpool_return(p, obj[i]);
+	return count;
+}
+
+static unsigned int pool_return_batch(struct uk_allocpool *p, void *obj[],
+				      unsigned int count)
+{
+	uk_allocpool_return_batch(p, obj, count);
+	return count;
+}
+
+/* Drains the pool and refills it in bursts, similar to a driver that
+ * refills its receive ring and later releases the buffers again.
+ * Returns the average time of a take and a return in nanoseconds.
+ */
+static __nsec bench_pool_run(struct uk_allocpool *p,
+			     bench_pool_func_t take, bench_pool_func_t put)
+{
+	static void *obj[BENCH_POOL_OBJS];
+	unsigned long rounds, r;
+	unsigned int count, total;
+	__nsec start;
+
+	rounds = MAX(BENCH_OPS / (2 * BENCH_POOL_OBJS), 1UL);
+	start = ukplat_monotonic_clock();
+	for (r = 0; r < rounds; ++r) {
+		total = 0;
+		do {
+			count = take(p, &obj[total],
+				     MIN(BENCH_BURST,
+					 BENCH_POOL_OBJS - total));
+			total += count;
+		} while (count > 0 && total < BENCH_POOL_OBJS);
+		UK_ASSERT(total == BENCH_POOL_OBJS);
+
+		for (count = 0; count < total; count += BENCH_BURST)
+			put(p, &obj[count], MIN(BENCH_BURST, total - count));
+	}
+	return (ukplat_monotonic_clock() - start)
+		/ ((__nsec) rounds * BENCH_POOL_OBJS * 2);
+}
+
+/* Compares single and batched take/return operations on a pool, which
+ * is free'd afterwards
+ */
+static void bench_pool(const char *name, struct uk_allocpool *p)
+{
+	__nsec single, batch;
+
+	if (!p) {
+		printf("%-8s Failed to allocate pool\n", name);
+		return;
+	}
+
+	/* warm up */
+	bench_pool_run(p, uk_allocpool_take_batch, pool_return_batch);
+
+	single = bench_pool_run(p, pool_take_single, pool_return_single);
+	batch  = bench_pool_run(p, uk_allocpool_take_batch,
+				pool_return_batch);
+	printf("%-8s take/return %"__PRInsec" ns/op single, %"__PRInsec" ns/op batch of %u\n",
+	       name, single, batch, BENCH_BURST);
+	uk_allocpool_free(p);
+}
+#endif /* CONFIG_LIBUKALLOCPOOL */
+
+static void *bench_arena(struct uk_alloc *parent, const char *name)
+{
+	void *base;
+
+	base = uk_palloc(parent, BENCH_ARENA_LEN >> __PAGE_SHIFT);
+	if (!base)
+		printf("%-8s Failed to allocate arena of %zu MiB\n",
+		       name, BENCH_ARENA_LEN >> 20);
+	return base;
+}
+
+/* The allocators that were created on an arena keep their descriptors
+ * within the arena. They are unregistered before the arena is returned.
+ */
+static void bench_arena_free(struct uk_alloc *parent, void *base)
+{
+	struct uk_alloc *a, *next;
+
+#if CONFIG_LIBUKALLOC_CACHE
+	/* Magazines of the calling thread may hold objects of the arena */
+	uk_alloc_cache_flush();
+#endif
+	for (a = uk_alloc_get_default(); a; a = next) {
+		next = a->next;
+		if ((uintptr_t) a >= (uintptr_t) base
+		    && (uintptr_t) a < (uintptr_t) base + BENCH_ARENA_LEN)
+			uk_alloc_unregister(a);
+	}
+	uk_pfree(parent, base, BENCH_ARENA_LEN >> __PAGE_SHIFT);
+}
+
+int uk_allocbench_run_all(struct uk_alloc *parent)
+{
+	struct uk_alloc *a __maybe_unused;
+	void *base __maybe_unused;
+
+	if (!parent)
+		return -EINVAL;
+
+	printf("Allocator benchmark: %lu ops per pattern, %zu MiB arenas\n",
+	       BENCH_OPS, BENCH_ARENA_LEN >> 20);
+
+#if CONFIG_LIBUKALLOCBBUDDY
+	base = bench_arena(parent, "bbuddy");
+	if (base) {
+		a = uk_allocbbuddy_init(base, BENCH_ARENA_LEN);
+		if (a)
+			uk_allocbench_run("bbuddy", a);
+		bench_arena_free(parent, base);
+	}
+#endif
+#if CONFIG_LIBUKALLOCREGION
+	base = bench_arena(parent, "region");
+	if (base) {
+		a = uk_allocregion_init(base, BENCH_ARENA_LEN);
+		if (a)
+			uk_allocbench_run("region", a);
+		bench_arena_free(parent, base);
+	}
+#endif
+#if CONFIG_LIBUKALLOCTLSF
+	base = bench_arena(parent, "tlsf");
+	if (base) {
+		a = uk_alloctlsf_init(base, BENCH_ARENA_LEN);
+		if (a)
+			uk_allocbench_run("tlsf", a);
+		bench_arena_free(parent, base);
+	}
+#endif
+#if CONFIG_LIBUKALLOCSLAB && CONFIG_LIBUKALLOCBBUDDY
+	base = bench_arena(parent, "slab");
+	if (base) {
+		a = uk_allocbbuddy_init(base, BENCH_ARENA_LEN);
+		if (a)
+			a = uk_allocslab_init(a);
+		if (a)
+			uk_allocbench_run("slab", a);
+		bench_arena_free(parent, base);
+	}
+#endif
+#if CONFIG_LIBUKALLOC_CACHE && CONFIG_LIBUKALLOCBBUDDY
+	base = bench_arena(parent, "cache");
+	if (base) {
+		a = uk_allocbbuddy_init(base, BENCH_ARENA_LEN);
+		if (a)
+			a = uk_alloc_cache_init(a);
+		if (a)
+			uk_allocbench_run("cache", a);
+		bench_arena_free(parent, base);
+	}
+#endif
+#if CONFIG_LIBUKALLOCPOOL
+	base = bench_arena(parent, "pool");
+	if (base) {
+		struct uk_allocpool *p;
+
+#if CONFIG_LIBUKALLOCPOOL_LOCKFREE
+		p = uk_allocpool_init_lockfree(base, BENCH_ARENA_LEN,
+					       BENCH_POOL_OBJ_LEN,
+					       sizeof(void *));
+#else
+		p = uk_allocpool_init(base, BENCH_ARENA_LEN,
+				      BENCH_POOL_OBJ_LEN, sizeof(void *));
+#endif
+		if (p)
+			uk_allocbench_run("pool", uk_allocpool2ukalloc(p));
+		bench_arena_free(parent, base);
+	}
+
+	bench_pool("list", uk_allocpool_alloc(parent, BENCH_POOL_OBJS,
+					      BENCH_POOL_OBJ_LEN,
+					      sizeof(void *)));
+#if CONFIG_LIBUKALLOCPOOL_LOCKFREE
+	bench_pool("lockfree",
+		   uk_allocpool_alloc_lockfree(parent, BENCH_POOL_OBJS,
+					       BENCH_POOL_OBJ_LEN,
+					       sizeof(void *)));
+#endif
+#endif
+	return 0;
+}
+
+#if CONFIG_LIBUKALLOCBENCH_BOOT
+static int allocbench_boot(void)
+{
+	struct uk_alloc *a = uk_alloc_get_default();
+
+	if (!a) {
+		uk_pr_warn("No default allocator, skipping allocator benchmark\n");
+		return 0;
+	}
+	uk_allocbench_run_all(a);
+	return 0;
+}
+
+uk_late_initcall(allocbench_boot);
+#endif /* CONFIG_LIBUKALLOCBENCH_BOOT */
@@ -0,0 +1,81 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Allocator micro-benchmarks
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * THIS HEADER MAY NOT BE EXTRACTED OR MODIFIED IN ANY WAY.
+ */
+
+#ifndef __UKALLOCBENCH_H__
+#define __UKALLOCBENCH_H__
+
+#include <uk/alloc.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Runs all allocation patterns against an allocator and prints the
+ * throughput and the latency percentiles of each operation. The
+ * patterns release all memory they allocated, except with allocators
+ * that do not support free (e.g., ukallocregion).
+ * This can be used to benchmark allocators that are not covered by
+ * uk_allocbench_run_all().
+ *
+ * @param name
+ *  Name of the allocator that is used in the report.
+ * @param a
+ *  Allocator to benchmark.
+ * @return
+ *  - (0): Benchmark completed.
+ *  - (<0): Negative error code.
+ */
+int uk_allocbench_run(const char *name, struct uk_alloc *a);
+
+/**
+ * Creates each enabled allocator on its own arena of
+ * CONFIG_LIBUKALLOCBENCH_ARENA_MB MiB and benchmarks it with
+ * uk_allocbench_run(). Each arena is released after its run. With
+ * ukallocpool, single and batched take/return operations are
+ * additionally compared on list-based and lock-free pools.
+ *
+ * @param parent
+ *  Allocator that provides the arenas.
+ * @return
+ *  - (0): Benchmark completed.
+ *  - (<0): Negative error code.
+ */
+int uk_allocbench_run_all(struct uk_alloc *parent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UKALLOCBENCH_H__ */
@@ -37,6 +37,7 @@
 #ifndef __LIBUKALLOCPOOL_H__
 #define __LIBUKALLOCPOOL_H__
 
+#include <uk/config.h>
 #include <uk/alloc.h>
 
 #ifdef __cplusplus
@@ -112,6 +113,71 @@ void uk_allocpool_free(struct uk_allocpool *p);
 struct uk_allocpool *uk_allocpool_init(void *base, size_t len,
 				       size_t obj_len, size_t obj_align);
 
+#if CONFIG_LIBUKALLOCPOOL_LOCKFREE
+/**
+ * Computes the required memory for a lock-free pool allocation.
+ *
+ * @param obj_count
+ *  Number of objects that are allocated with the pool.
+ * @param obj_len
+ *  Size of one object (bytes).
+ * @param obj_align
+ *  Alignment requirement for each pool object.
+ * @return
+ *  Number of bytes needed for pool allocation.
+ */
+size_t uk_allocpool_reqmem_lockfree(unsigned int obj_count, size_t obj_len,
+				    size_t obj_align);
+
+/**
+ * Allocates a lock-free memory pool on a parent allocator.
+ * Free objects of a lock-free pool are kept on an array-based stack
+ * instead of a linked list: Objects are not touched when they are taken
+ * or returned and a whole batch is moved with a single atomic operation.
+ * uk_allocpool_take(), uk_allocpool_return() and their batch variants are
+ * safe to be called concurrently, including from interrupt context, without
+ * any locking. This does not hold for uk_malloc() and uk_free() on the pool
+ * when CONFIG_LIBUKALLOC_STATS is enabled: They update the allocator
+ * statistics, which are not protected against concurrent updates.
+ *
+ * @param parent
+ *  Allocator on which the pool will be allocated.
+ * @param obj_count
+ *  Number of objects that are allocated with the pool.
+ * @param obj_len
+ *  Size of one object (bytes).
+ * @param obj_align
+ *  Alignment requirement for each pool object.
+ * @return
+ *  - (NULL): If allocation failed (e.g., ENOMEM).
+ *  - pointer to allocated pool.
+ */
+struct uk_allocpool *uk_allocpool_alloc_lockfree(struct uk_alloc *parent,
+						 unsigned int obj_count,
+						 size_t obj_len,
+						 size_t obj_align);
+
+/**
+ * Initializes a lock-free memory pool on a given memory range.
+ * See uk_allocpool_alloc_lockfree() for the properties of such a pool.
+ *
+ * @param base
+ *  Base address of memory range.
+ * @param len
+ *  Length of memory range (bytes).
+ * @param obj_len
+ *  Size of one object (bytes).
+ * @param obj_align
+ *  Alignment requirement for each pool object.
+ * @return
+ *  - (NULL): Not enough memory for pool.
+ *  - pointer to initializes pool.
+ */
+struct uk_allocpool *uk_allocpool_init_lockfree(void *base, size_t len,
+						size_t obj_len,
+						size_t obj_align);
+#endif /* CONFIG_LIBUKALLOCPOOL_LOCKFREE */
+
 /**
  * Return uk_alloc compatible interface for allocpool.
  * With this interface, uk_malloc(), uk_free(), etc. can
@@ -38,6 +38,9 @@
 #include <uk/alloc_impl.h>
 #include <uk/allocpool.h>
 #include <uk/list.h>
+#if CONFIG_LIBUKALLOCPOOL_LOCKFREE
+#include <uk/arch/atomic.h>
+#endif
 #include <string.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -61,6 +64,28 @@
  *          +=======================+
  *          |         ...           |
  *          v                       v
+ *
+ * In lock-free mode, an array of `uint32_t` follows the pool header. It
+ * is used as a stack of free object indices:
+ *
+ *          ++---------------------++
+ *          || struct uk_allocpool ||
+ *          ++---------------------++
+ *          |  lf_next[obj_count]   |
+ *          +-----------------------+
+ *          |    // padding //      |
+ *          +=======================+
+ *          |       OBJECT 1        |
+ *          v          ...          v
+ *
+ * `lf_top` holds the index of the topmost free object in its lower 32 bits
+ * and a tag that is incremented with every update in its upper 32 bits
+ * (avoids ABA). `lf_next[i]` is the index of the free object below object
+ * `i`. Pushing and popping a burst of objects is a single compare-and-swap
+ * on `lf_top`; the objects themselves are never touched. Because no
+ * operation waits for another one to complete, the pool can be used
+ * concurrently from thread and interrupt context without disabling
+ * interrupts.
  */
 
 #define MIN_OBJ_ALIGN sizeof(void *)
@@ -78,6 +103,12 @@ struct uk_allocpool {
 
 	struct uk_alloc *parent;
 	void *base;
+
+#if CONFIG_LIBUKALLOCPOOL_LOCKFREE
+	uint64_t lf_top;
+	uint32_t *lf_next; /* NULL if pool is in list mode */
+	void *obj_base;
+#endif
 };
 
 struct free_obj {
@@ -126,46 +157,158 @@ static inline void *_take_free_obj(struct uk_allocpool *p)
 	return (void *) obj;
 }
 
+#if CONFIG_LIBUKALLOCPOOL_LOCKFREE
+#define LF_NIL			UINT32_MAX
+#define LF_TOP(idx, tag)	(((uint64_t) (tag) << 32) | (uint32_t) (idx))
+#define LF_TOP_IDX(top)		((uint32_t) (top))
+#define LF_TOP_TAG(top)		((uint32_t) ((top) >> 32))
+
+#define _is_lockfree(p)		((p)->lf_next != NULL)
+
+static inline uint32_t _lf_obj2idx(struct uk_allocpool *p, void *obj)
+{
+	uintptr_t off;
+
+	UK_ASSERT((uintptr_t) obj >= (uintptr_t) p->obj_base);
+	off = (uintptr_t) obj - (uintptr_t) p->obj_base;
+	UK_ASSERT((off % p->obj_len) == 0);
+	UK_ASSERT((off / p->obj_len) < p->obj_count);
+	return (uint32_t) (off / p->obj_len);
+}
+
+static inline void *_lf_idx2obj(struct uk_allocpool *p, uint32_t idx)
+{
+	return (void *) ((uintptr_t) p->obj_base + (uintptr_t) idx * p->obj_len);
+}
+
+static unsigned int _lf_take(struct uk_allocpool *p,
+			     void *obj[], unsigned int count)
+{
+	uint64_t top, ntop;
+	uint32_t idx;
+	unsigned int i;
+
+	do {
+		top = ukarch_load_n(&p->lf_top);
+		idx = LF_TOP_IDX(top);
+		/* The walk may read links that are concurrently modified.
+		 * This is harmless: links are always valid indices and the
+		 * tag comparison below rejects any stale result.
+		 */
+		for (i = 0; i < count && idx != LF_NIL; ++i) {
+			obj[i] = _lf_idx2obj(p, idx);
+			idx = UK_READ_ONCE(p->lf_next[idx]);
+		}
+		if (unlikely(i == 0))
+			return 0;
+		ntop = LF_TOP(idx, LF_TOP_TAG(top) + 1);
+	} while (ukarch_compare_exchange_sync(&p->lf_top, top, ntop) != ntop);
+
+	ukarch_fetch_add(&p->free_obj_count, -i);
+	return i;
+}
+
+static void _lf_return(struct uk_allocpool *p,
+		       void *obj[], unsigned int count)
+{
+	uint64_t top, ntop;
+	uint32_t first, last, idx;
+	unsigned int i;
+
+	if (unlikely(count == 0))
+		return;
+
+	/* Chain the objects privately, publish them with a single update */
+	first = last = _lf_obj2idx(p, obj[0]);
+	for (i = 1; i < count; ++i) {
+		idx = _lf_obj2idx(p, obj[i]);
+		p->lf_next[last] = idx;
+		last = idx;
+	}
+
+	do {
+		top = ukarch_load_n(&p->lf_top);
+		UK_WRITE_ONCE(p->lf_next[last], LF_TOP_IDX(top));
+		ntop = LF_TOP(first, LF_TOP_TAG(top) + 1);
+	} while (ukarch_compare_exchange_sync(&p->lf_top, top, ntop) != ntop);
+
+	ukarch_fetch_add(&p->free_obj_count, count);
+	UK_ASSERT(p->free_obj_count <= p->obj_count);
+}
+#else
+#define _is_lockfree(p)		(0)
+#define _lf_take(p, obj, count)	({ UK_CRASH("Unreachable"); 0U; })
+#define _lf_return(p, obj, count) UK_CRASH("Unreachable")
+#endif /* CONFIG_LIBUKALLOCPOOL_LOCKFREE */
+
 static void pool_free(struct uk_alloc *a, void *ptr)
 {
 	struct uk_allocpool *p = ukalloc2pool(a);
 
 	if (likely(ptr))
-		_prepend_free_obj(p, ptr);
+		uk_allocpool_return(p, ptr);
 }
 
 static void *pool_malloc(struct uk_alloc *a, size_t size)
 {
 	struct uk_allocpool *p = ukalloc2pool(a);
+	void *obj;
 
-	if (unlikely((size > p->obj_len)
-		     || uk_list_empty(&p->free_obj))) {
+	if (unlikely(size > p->obj_len)) {
 		errno = ENOMEM;
 		return NULL;
 	}
 
-	return _take_free_obj(p);
+	obj = uk_allocpool_take(p);
+	if (unlikely(!obj))
+		errno = ENOMEM;
+	return obj;
+}
+
+static unsigned int pool_malloc_bulk(struct uk_alloc *a, size_t size,
+				     void *ptrs[], unsigned int count)
+{
+	struct uk_allocpool *p = ukalloc2pool(a);
+
+	if (unlikely(size > p->obj_len))
+		return 0;
+
+	return uk_allocpool_take_batch(p, ptrs, count);
+}
+
+static void pool_free_bulk(struct uk_alloc *a, void *ptrs[],
+			   unsigned int count)
+{
+	uk_allocpool_return_batch(ukalloc2pool(a), ptrs, count);
 }
 
 static int pool_posix_memalign(struct uk_alloc *a, void **memptr, size_t align,
 				size_t size)
 {
 	struct uk_allocpool *p = ukalloc2pool(a);
+	void *obj;
 
 	if (unlikely((size > p->obj_len)
-		     || (align > p->obj_align)
-		     || uk_list_empty(&p->free_obj))) {
+		     || (align > p->obj_align)))
 		return ENOMEM;
-	}
 
-	*memptr = _take_free_obj(p);
+	obj = uk_allocpool_take(p);
+	if (unlikely(!obj))
+		return ENOMEM;
+
+	*memptr = obj;
 	return 0;
 }
 
 void *uk_allocpool_take(struct uk_allocpool *p)
 {
+	void *obj;
+
 	UK_ASSERT(p);
 
+	if (_is_lockfree(p))
+		return (_lf_take(p, &obj, 1) == 1) ? obj : NULL;
+
 	if (unlikely(uk_list_empty(&p->free_obj)))
 		return NULL;
 
@@ -180,6 +323,9 @@ unsigned int uk_allocpool_take_batch(struct uk_allocpool *p,
 	UK_ASSERT(p);
 	UK_ASSERT(obj);
 
+	if (_is_lockfree(p))
+		return _lf_take(p, obj, count);
+
 	for (i = 0; i < count; ++i) {
 		if (unlikely(uk_list_empty(&p->free_obj)))
 			break;
@@ -193,6 +339,11 @@ void uk_allocpool_return(struct uk_allocpool *p, void *obj)
 {
 	UK_ASSERT(p);
 
+	if (_is_lockfree(p)) {
+		_lf_return(p, &obj, 1);
+		return;
+	}
+
 	_prepend_free_obj(p, obj);
 }
 
@@ -204,10 +355,20 @@ void uk_allocpool_return_batch(struct uk_allocpool *p,
 	UK_ASSERT(p);
 	UK_ASSERT(obj);
 
+	if (_is_lockfree(p)) {
+		_lf_return(p, obj, count);
+		return;
+	}
+
 	for (i = 0; i < count; ++i)
 		_prepend_free_obj(p, obj[i]);
 }
 
+static size_t pool_getsize(struct uk_alloc *a, const void *ptr __unused)
+{
+	return ukalloc2pool(a)->obj_len;
+}
+
 #if CONFIG_LIBUKALLOC_IFSTATS
 static ssize_t pool_availmem(struct uk_alloc *a)
 {
@@ -217,8 +378,8 @@ static ssize_t pool_availmem(struct uk_alloc *a)
 }
 #endif
 
-size_t uk_allocpool_reqmem(unsigned int obj_count, size_t obj_len,
-			   size_t obj_align)
+static size_t _reqmem(unsigned int obj_count, size_t obj_len,
+		      size_t obj_align, int lockfree)
 {
 	size_t obj_alen;
 
@@ -228,10 +389,17 @@ size_t uk_allocpool_reqmem(unsigned int obj_count, size_t obj_len,
 	obj_align = MAX(obj_align, MIN_OBJ_ALIGN);
 	obj_alen  = ALIGN_UP(obj_len, obj_align);
 	return (sizeof(struct uk_allocpool)
+		+ (lockfree ? ((size_t) obj_count * sizeof(uint32_t)) : 0)
 		+ obj_align
 		+ ((size_t) obj_count * obj_alen));
 }
 
+size_t uk_allocpool_reqmem(unsigned int obj_count, size_t obj_len,
+			   size_t obj_align)
+{
+	return _reqmem(obj_count, obj_len, obj_align, 0);
+}
+
 unsigned int uk_allocpool_availcount(struct uk_allocpool *p)
 {
 	return p->free_obj_count;
@@ -242,8 +410,35 @@ size_t uk_allocpool_objlen(struct uk_allocpool *p)
 	return p->obj_len;
 }
 
-struct uk_allocpool *uk_allocpool_init(void *base, size_t len,
-				       size_t obj_len, size_t obj_align)
+#if CONFIG_LIBUKALLOCPOOL_LOCKFREE
+/* Places the link array behind the pool header and returns the number of
+ * objects that fit into the remaining space
+ */
+static unsigned int _lf_layout(struct uk_allocpool *p, size_t len,
+			       size_t obj_alen, size_t obj_align)
+{
+	uintptr_t end = (uintptr_t) p + len;
+	uintptr_t obj_ptr;
+	size_t count;
+
+	p->lf_next = (uint32_t *) ((uintptr_t) p + sizeof(*p));
+	count = (len - sizeof(*p)) / (obj_alen + sizeof(uint32_t));
+	count = MIN(count, (size_t) LF_NIL);
+	while (count > 0) {
+		obj_ptr = ALIGN_UP((uintptr_t) &p->lf_next[count], obj_align);
+		if (obj_ptr <= end && (end - obj_ptr) / obj_alen >= count)
+			break;
+		--count;
+	}
+	p->obj_base = (void *) ALIGN_UP((uintptr_t) &p->lf_next[count],
+					obj_align);
+	return (unsigned int) count;
+}
+#endif /* CONFIG_LIBUKALLOCPOOL_LOCKFREE */
+
+static struct uk_allocpool *_init(void *base, size_t len,
+				  size_t obj_len, size_t obj_align,
+				  int lockfree)
 {
 	struct uk_allocpool *p;
 	struct uk_alloc *a;
@@ -267,6 +462,30 @@ struct uk_allocpool *uk_allocpool_init(void *base, size_t len,
 	a = allocpool2ukalloc(p);
 
 	obj_alen = ALIGN_UP(obj_len, obj_align);
+	p->obj_count = 0;
+	p->free_obj_count = 0;
+	UK_INIT_LIST_HEAD(&p->free_obj);
+
+#if CONFIG_LIBUKALLOCPOOL_LOCKFREE
+	if (lockfree) {
+		unsigned int i;
+
+		p->obj_count = _lf_layout(p, len, obj_alen, obj_align);
+		for (i = 0; i < p->obj_count; ++i)
+			p->lf_next[i] = i + 1;
+		if (p->obj_count > 0)
+			p->lf_next[p->obj_count - 1] = LF_NIL;
+		p->lf_top = LF_TOP(p->obj_count > 0 ? 0 : LF_NIL, 0);
+		p->free_obj_count = p->obj_count;
+		if (p->obj_count == 0)
+			uk_pr_debug("%p: Empty pool: Not enough space for allocating objects\n",
+				    p);
+		goto out;
+	}
+#else
+	UK_ASSERT(!lockfree);
+#endif
+
 	obj_ptr = (void *) ALIGN_UP((uintptr_t) base + sizeof(*p),
 				    obj_align);
 	if ((uintptr_t) obj_ptr > (uintptr_t) base + len) {
@@ -277,9 +496,6 @@ struct uk_allocpool *uk_allocpool_init(void *base, size_t len,
 
 	left = len - ((uintptr_t) obj_ptr - (uintptr_t) base);
 
-	p->obj_count = 0;
-	p->free_obj_count = 0;
-	UK_INIT_LIST_HEAD(&p->free_obj);
 	while (left >= obj_alen) {
 		++p->obj_count;
 		_prepend_free_obj(p, obj_ptr);
@@ -301,30 +517,41 @@ out:
 			     pool_posix_memalign,
 			     uk_memalign_compat,
 			     NULL);
+	p->self.malloc_bulk = pool_malloc_bulk;
+	p->self.free_bulk   = pool_free_bulk;
+	p->self.getsize = pool_getsize;
 #if CONFIG_LIBUKALLOC_IFSTATS
 	p->self.availmem = pool_availmem;
 #endif
 
-	uk_pr_debug("%p: Pool created (%"__PRIsz" B): %u objs of %"__PRIsz" B, aligned to %"__PRIsz" B\n",
-		    p, len, p->obj_count, p->obj_len, p->obj_align);
+	uk_pr_debug("%p: %sPool created (%"__PRIsz" B): %u objs of %"__PRIsz" B, aligned to %"__PRIsz" B\n",
+		    p, lockfree ? "Lock-free " : "", len, p->obj_count,
+		    p->obj_len, p->obj_align);
 	return p;
 }
 
-struct uk_allocpool *uk_allocpool_alloc(struct uk_alloc *parent,
-					unsigned int obj_count,
-					size_t obj_len, size_t obj_align)
+struct uk_allocpool *uk_allocpool_init(void *base, size_t len,
+				       size_t obj_len, size_t obj_align)
+{
+	return _init(base, len, obj_len, obj_align, 0);
+}
+
+static struct uk_allocpool *_alloc(struct uk_alloc *parent,
+				   unsigned int obj_count,
+				   size_t obj_len, size_t obj_align,
+				   int lockfree)
 {
 	struct uk_allocpool *p;
 	void *base;
 	size_t len;
 
-	/* uk_allocpool_reqmem computes minimum requirement */
-	len = uk_allocpool_reqmem(obj_count, obj_len, obj_align);
+	/* _reqmem() computes minimum requirement */
+	len = _reqmem(obj_count, obj_len, obj_align, lockfree);
 	base = uk_malloc(parent, len);
 	if (!base)
 		return NULL;
 
-	p = uk_allocpool_init(base, len, obj_len, obj_align);
+	p = _init(base, len, obj_len, obj_align, lockfree);
 	if (!p) {
 		uk_free(parent, base);
 		errno = ENOSPC;
@@ -335,6 +562,36 @@ struct uk_allocpool *uk_allocpool_alloc(struct uk_alloc *parent,
 	return p;
 }
 
+struct uk_allocpool *uk_allocpool_alloc(struct uk_alloc *parent,
+					unsigned int obj_count,
+					size_t obj_len, size_t obj_align)
+{
+	return _alloc(parent, obj_count, obj_len, obj_align, 0);
+}
+
+#if CONFIG_LIBUKALLOCPOOL_LOCKFREE
+size_t uk_allocpool_reqmem_lockfree(unsigned int obj_count, size_t obj_len,
+				    size_t obj_align)
+{
+	return _reqmem(obj_count, obj_len, obj_align, 1);
+}
+
+struct uk_allocpool *uk_allocpool_init_lockfree(void *base, size_t len,
+						size_t obj_len,
+						size_t obj_align)
+{
+	return _init(base, len, obj_len, obj_align, 1);
+}
+
+struct uk_allocpool *uk_allocpool_alloc_lockfree(struct uk_alloc *parent,
+						 unsigned int obj_count,
+						 size_t obj_len,
+						 size_t obj_align)
+{
+	return _alloc(parent, obj_count, obj_len, obj_align, 1);
+}
+#endif /* CONFIG_LIBUKALLOCPOOL_LOCKFREE */
+
 void uk_allocpool_free(struct uk_allocpool *p)
 {
 	/* If we do not have a parent, this pool was created with
@@ -346,9 +603,6 @@ void uk_allocpool_free(struct uk_allocpool *p)
 	/* Make sure we got all objects back */
 	UK_ASSERT(p->free_obj_count == p->obj_count);
 
-	/* FIXME: Unregister `ukalloc` interface from `lib/ukalloc` */
-	/* TODO: Provide unregistration interface at `lib/ukalloc` */
-	UK_CRASH("Unregistering from `lib/ukalloc` not implemented.\n");
-
+	uk_alloc_unregister(allocpool2ukalloc(p));
 	uk_free(p->parent, p->base);
 }
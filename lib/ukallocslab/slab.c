@@ -0,0 +1,503 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Size-class slab allocator
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * ukallocslab serves small allocations from slabs: single pages of a parent
+ * page allocator that are cut into equally-sized objects of one size class.
+ * Each size class keeps a list of slabs that still have free objects, so
+ * that malloc() and free() do not have to search: both are O(1). Objects of
+ * a freshly allocated slab are handed out in order from the untouched tail
+ * of the page, so creating a slab does not touch any object memory.
+ *
+ * Every slab page starts with a header (`struct slab_page`) so that free()
+ * can find the owning slab and size class by rounding the object address
+ * down to the page boundary. Allocations that do not fit into the largest
+ * size class are served directly with pages from the parent allocator and
+ * carry a `struct large_hdr` at the start of the page that contains the
+ * returned pointer (or at the start of the preceding page if the returned
+ * pointer is page-aligned, like the page-based ukalloc malloc interface).
+ *
+ * SLAB PAGE: MEMORY LAYOUT
+ *
+ *          ++---------------------++
+ *          ||  struct slab_page   ||
+ *          ++---------------------++  <- SLAB_HDR_LEN
+ *          |       OBJECT 1        |
+ *          +=======================+
+ *          |       OBJECT 2        |
+ *          +=======================+
+ *          |         ...           |
+ *          +=======================+
+ *          |    // unused //       |
+ *          +-----------------------+  <- __PAGE_SIZE
+ */
+
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include <uk/allocslab.h>
+#include <uk/alloc_impl.h>
+#include <uk/arch/atomic.h>
+#include <uk/essentials.h>
+#include <uk/print.h>
+#include <uk/assert.h>
+#include <uk/page.h>
+#include <uk/list.h>
+
+#define SLAB_MAGIC		0x51AB51ABU
+#define LARGE_MAGIC		0x1A26E1A2U
+
+/* Objects start cache-line aligned so that alignments up to
+ * SLAB_HDR_LEN can be served from slabs
+ */
+#define SLAB_HDR_LEN		64
+#define SLAB_MIN_ALIGN		16
+#define LARGE_HDR_LEN		32
+
+#define NR_SIZE_CLASSES		20
+#define SLAB_MAX_OBJ_LEN	1024
+
+#define size_to_num_pages(size) \
+	(ALIGN_UP((unsigned long)(size), __PAGE_SIZE) / __PAGE_SIZE)
+#define page_off(x) ((unsigned long)(x) & (__PAGE_SIZE - 1))
+
+/* Size classes: 16 B steps up to 128 B, then four classes per power of two */
+static const uint16_t class_obj_len[NR_SIZE_CLASSES] = {
+	16,   32,   48,   64,   80,   96,  112,  128,
+	160,  192,  224,  256,
+	320,  384,  448,  512,
+	640,  768,  896, 1024,
+};
+
+struct slab_page {
+	uint32_t magic;
+	uint16_t cls;
+	/* number of objects that are currently handed out */
+	uint16_t inuse;
+	/* number of objects that were ever handed out from the page tail */
+	uint16_t carved;
+	void *free_obj;
+	struct uk_list_head list;
+};
+
+struct large_hdr {
+	uint32_t magic;
+	unsigned long num_pages;
+	void *base;
+};
+
+UK_CTASSERT(sizeof(struct slab_page) <= SLAB_HDR_LEN);
+UK_CTASSERT(sizeof(struct large_hdr) <= LARGE_HDR_LEN);
+
+struct slab_cache {
+	/* slabs with at least one free object */
+	struct uk_list_head partial;
+	/* number of slabs without any handed out object */
+	unsigned int nr_empty;
+	uint16_t obj_len;
+	uint16_t obj_count;
+};
+
+struct uk_allocslab {
+	struct uk_alloc *parent;
+	struct slab_cache cache[NR_SIZE_CLASSES];
+};
+
+#define ukalloc2slab(a) \
+	((struct uk_allocslab *)&(a)->priv)
+
+static inline unsigned int size_to_class(size_t size)
+{
+	unsigned long shift;
+
+	UK_ASSERT(size > 0 && size <= SLAB_MAX_OBJ_LEN);
+
+	if (size <= 128)
+		return (unsigned int)((size - 1) >> 4);
+
+	/* Above 128 B, every power of two is divided into four classes:
+	 * `shift` selects the power of two, the two bits below the most
+	 * significant bit select the quarter within it.
+	 */
+	size--;
+	shift = ukarch_flsl(size);
+	return (unsigned int)(8 + ((shift - 7) << 2)
+			      + ((size >> (shift - 2)) & 3));
+}
+
+static struct slab_page *slab_new(struct uk_allocslab *s, unsigned int cls)
+{
+	struct slab_cache *c = &s->cache[cls];
+	struct slab_page *slab;
+
+	slab = uk_palloc(s->parent, 1);
+	if (unlikely(!slab))
+		return NULL;
+
+	slab->magic    = SLAB_MAGIC;
+	slab->cls      = (uint16_t) cls;
+	slab->inuse    = 0;
+	slab->carved   = 0;
+	slab->free_obj = NULL;
+	uk_list_add(&slab->list, &c->partial);
+	c->nr_empty++;
+	return slab;
+}
+
+static void *slab_cache_alloc(struct uk_allocslab *s, unsigned int cls)
+{
+	struct slab_cache *c = &s->cache[cls];
+	struct slab_page *slab;
+	void *obj;
+
+	if (unlikely(uk_list_empty(&c->partial))) {
+		if (unlikely(!slab_new(s, cls))) {
+			errno = ENOMEM;
+			return NULL;
+		}
+	}
+	slab = uk_list_first_entry(&c->partial, struct slab_page, list);
+
+	if (slab->free_obj) {
+		obj = slab->free_obj;
+		slab->free_obj = *((void **) obj);
+	} else {
+		UK_ASSERT(slab->carved < c->obj_count);
+		obj = (void *)((uintptr_t) slab + SLAB_HDR_LEN
+			       + (uintptr_t) slab->carved * c->obj_len);
+		slab->carved++;
+	}
+
+	if (slab->inuse++ == 0)
+		c->nr_empty--;
+	if (slab->inuse == c->obj_count)
+		uk_list_del(&slab->list); /* slab is full */
+
+	return obj;
+}
+
+static void slab_cache_free(struct uk_allocslab *s, struct slab_page *slab,
+			    void *obj)
+{
+	struct slab_cache *c;
+
+	UK_ASSERT(slab->cls < NR_SIZE_CLASSES);
+	c = &s->cache[slab->cls];
+
+	UK_ASSERT(slab->inuse > 0);
+	UK_ASSERT(((uintptr_t) obj - (uintptr_t) slab - SLAB_HDR_LEN)
+		  % c->obj_len == 0);
+
+	if (slab->inuse == c->obj_count)
+		uk_list_add(&slab->list, &c->partial); /* was full */
+
+	*((void **) obj) = slab->free_obj;
+	slab->free_obj = obj;
+
+	if (--slab->inuse == 0) {
+		/* Keep one empty slab per class to avoid thrashing the
+		 * parent allocator when an object is allocated and
+		 * released repeatedly at a slab boundary.
+		 */
+		if (c->nr_empty == 0) {
+			c->nr_empty++;
+			return;
+		}
+		uk_list_del(&slab->list);
+		slab->magic = 0;
+		uk_pfree(s->parent, slab, 1);
+	}
+}
+
+static inline struct large_hdr *large_hdr_get(const void *ptr)
+{
+	uintptr_t hdr;
+
+	hdr = ALIGN_DOWN((uintptr_t) ptr, (uintptr_t) __PAGE_SIZE);
+	if (hdr == (uintptr_t) ptr) {
+		/* page-aligned objects have their header at the start of
+		 * the preceding page
+		 */
+		hdr -= __PAGE_SIZE;
+	}
+	return (struct large_hdr *) hdr;
+}
+
+static void *large_alloc(struct uk_allocslab *s, size_t align, size_t size)
+{
+	struct large_hdr *hdr;
+	unsigned long num_pages;
+	uintptr_t base, ptr;
+	size_t realsize;
+
+	/* The returned pointer is at most `align` bytes after the start
+	 * of the allocated pages; the first LARGE_HDR_LEN bytes of that
+	 * range hold the header.
+	 */
+	align = MAX(align, (size_t) LARGE_HDR_LEN);
+	realsize = size + align;
+	if (unlikely(realsize < size))
+		return NULL;
+
+	num_pages = size_to_num_pages(realsize);
+	base = (uintptr_t) uk_palloc(s->parent, num_pages);
+	if (unlikely(!base))
+		return NULL;
+
+	ptr = ALIGN_UP(base + LARGE_HDR_LEN, (uintptr_t) align);
+	hdr = large_hdr_get((void *) ptr);
+	UK_ASSERT((uintptr_t) hdr >= base);
+
+	hdr->magic     = LARGE_MAGIC;
+	hdr->num_pages = num_pages;
+	hdr->base      = (void *) base;
+	return (void *) ptr;
+}
+
+static size_t slab_usable_size(struct uk_allocslab *s, const void *ptr)
+{
+	struct slab_page *slab;
+	struct large_hdr *hdr;
+
+	if (page_off(ptr)) {
+		slab = (struct slab_page *) ALIGN_DOWN((uintptr_t) ptr,
+						       __PAGE_SIZE);
+		if (slab->magic == SLAB_MAGIC)
+			return s->cache[slab->cls].obj_len;
+	}
+
+	hdr = large_hdr_get(ptr);
+	UK_ASSERT(hdr->magic == LARGE_MAGIC);
+	return (size_t) hdr->base + hdr->num_pages * __PAGE_SIZE
+		- (size_t) ptr;
+}
+
+static void *slab_malloc(struct uk_alloc *a, size_t size)
+{
+	struct uk_allocslab *s;
+
+	UK_ASSERT(a);
+	s = ukalloc2slab(a);
+
+	if (unlikely(!size))
+		return NULL;
+	if (unlikely(size > SLAB_MAX_OBJ_LEN))
+		return large_alloc(s, SLAB_MIN_ALIGN, size);
+
+	return slab_cache_alloc(s, size_to_class(size));
+}
+
+static void slab_free(struct uk_alloc *a, void *ptr)
+{
+	struct uk_allocslab *s;
+	struct slab_page *slab;
+	struct large_hdr *hdr;
+
+	UK_ASSERT(a);
+	s = ukalloc2slab(a);
+
+	if (unlikely(!ptr))
+		return;
+
+	/* slab objects are never page-aligned because of the slab header */
+	if (page_off(ptr)) {
+		slab = (struct slab_page *) ALIGN_DOWN((uintptr_t) ptr,
+						       __PAGE_SIZE);
+		if (slab->magic == SLAB_MAGIC) {
+			slab_cache_free(s, slab, ptr);
+			return;
+		}
+	}
+
+	hdr = large_hdr_get(ptr);
+	UK_ASSERT(hdr->magic == LARGE_MAGIC);
+	UK_ASSERT(hdr->num_pages != 0);
+	hdr->magic = 0;
+	uk_pfree(s->parent, hdr->base, hdr->num_pages);
+}
+
+static int slab_posix_memalign(struct uk_alloc *a, void **memptr,
+			       size_t align, size_t size)
+{
+	struct uk_allocslab *s;
+	unsigned int cls;
+	void *obj;
+
+	UK_ASSERT(a);
+	s = ukalloc2slab(a);
+
+	if (((align - 1) & align) != 0
+	    || (align % sizeof(void *)) != 0)
+		return EINVAL;
+
+	/* Leave memptr untouched. See comment in uk_posix_memalign_ifpages. */
+	if (!size)
+		return EINVAL;
+
+	if (align <= SLAB_HDR_LEN
+	    && ALIGN_UP(size, align) <= SLAB_MAX_OBJ_LEN) {
+		/* Objects start at an offset of SLAB_HDR_LEN, so any class
+		 * with an object length that is a multiple of `align`
+		 * returns aligned objects. The largest class fulfills this
+		 * for every align <= SLAB_HDR_LEN.
+		 */
+		cls = size_to_class(ALIGN_UP(size, align));
+		while (class_obj_len[cls] & (align - 1))
+			cls++;
+		obj = slab_cache_alloc(s, cls);
+	} else {
+		obj = large_alloc(s, align, size);
+	}
+
+	if (unlikely(!obj))
+		return ENOMEM;
+
+	*memptr = obj;
+	return 0;
+}
+
+static void *slab_realloc(struct uk_alloc *a, void *ptr, size_t size)
+{
+	struct uk_allocslab *s;
+	size_t cursize;
+	void *retptr;
+
+	UK_ASSERT(a);
+	s = ukalloc2slab(a);
+
+	if (!ptr)
+		return slab_malloc(a, size);
+
+	if (ptr && !size) {
+		slab_free(a, ptr);
+		return NULL;
+	}
+
+	cursize = slab_usable_size(s, ptr);
+	if (size <= cursize)
+		return ptr;
+
+	retptr = slab_malloc(a, size);
+	if (!retptr)
+		return NULL;
+
+	memcpy(retptr, ptr, cursize);
+	slab_free(a, ptr);
+	return retptr;
+}
+
+static void *slab_palloc(struct uk_alloc *a, unsigned long num_pages)
+{
+	UK_ASSERT(a);
+	return uk_palloc(ukalloc2slab(a)->parent, num_pages);
+}
+
+static void slab_pfree(struct uk_alloc *a, void *ptr, unsigned long num_pages)
+{
+	UK_ASSERT(a);
+	uk_pfree(ukalloc2slab(a)->parent, ptr, num_pages);
+}
+
+static void *slab_palloc_aligned(struct uk_alloc *a, unsigned long align,
+				 unsigned long num_pages)
+{
+	UK_ASSERT(a);
+	return uk_palloc_aligned(ukalloc2slab(a)->parent, align, num_pages);
+}
+
+static size_t slab_getsize(struct uk_alloc *a, const void *ptr)
+{
+	UK_ASSERT(a);
+	return slab_usable_size(ukalloc2slab(a), ptr);
+}
+
+static int slab_addmem(struct uk_alloc *a, void *base, size_t len)
+{
+	UK_ASSERT(a);
+	return uk_alloc_addmem(ukalloc2slab(a)->parent, base, len);
+}
+
+#if CONFIG_LIBUKALLOC_IFSTATS
+static ssize_t slab_availmem(struct uk_alloc *a)
+{
+	UK_ASSERT(a);
+	return uk_alloc_availmem(ukalloc2slab(a)->parent);
+}
+#endif
+
+struct uk_alloc *uk_allocslab_init(struct uk_alloc *parent)
+{
+	struct uk_alloc *a;
+	struct uk_allocslab *s;
+	unsigned long meta_pages;
+	unsigned int i;
+
+	UK_ASSERT(parent);
+	UK_ASSERT(parent->palloc && parent->pfree);
+
+	/* Allocate space for allocator descriptor */
+	meta_pages = size_to_num_pages(sizeof(*a) + sizeof(*s));
+	a = uk_palloc(parent, meta_pages);
+	if (!a) {
+		uk_pr_err("Not enough space for slab allocator descriptor\n");
+		return NULL;
+	}
+
+	uk_pr_info("Initialize slab allocator %"__PRIuptr" on %"__PRIuptr"\n",
+		   (uintptr_t) a, (uintptr_t) parent);
+	memset(a, 0, sizeof(*a) + sizeof(*s));
+	s = ukalloc2slab(a);
+	s->parent = parent;
+
+	for (i = 0; i < NR_SIZE_CLASSES; ++i) {
+		UK_INIT_LIST_HEAD(&s->cache[i].partial);
+		s->cache[i].nr_empty  = 0;
+		s->cache[i].obj_len   = class_obj_len[i];
+		s->cache[i].obj_count = (uint16_t)
+			((__PAGE_SIZE - SLAB_HDR_LEN) / class_obj_len[i]);
+	}
+
+	uk_alloc_init_malloc(a, slab_malloc, uk_calloc_compat,
+			     slab_realloc, slab_free, slab_posix_memalign,
+			     uk_memalign_compat, slab_addmem);
+	a->palloc  = slab_palloc;
+	a->pfree   = slab_pfree;
+	a->palloc_aligned = slab_palloc_aligned;
+	a->getsize = slab_getsize;
+#if CONFIG_LIBUKALLOC_IFSTATS
+	a->availmem = slab_availmem;
+#endif
+
+	return a;
+}
@@ -0,0 +1,693 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Two-Level Segregated Fit (TLSF) allocator
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * ukalloctlsf implements the Two-Level Segregated Fit allocator as described
+ * by Masmano et al., `TLSF: a New Dynamic Memory Allocator for Real-Time
+ * Systems' (ECRTS'04).
+ *
+ * Free blocks are kept in segregated lists. The first level divides block
+ * sizes into powers of two, the second level divides each power of two
+ * linearly into SL_INDEX_COUNT ranges. A bitmap per level records which lists
+ * are non-empty, so that a suitable free block is found with two
+ * find-first-set operations. Allocation and release are O(1); blocks are
+ * split on allocation and coalesced with their physical neighbours on
+ * release.
+ *
+ * BLOCK: MEMORY LAYOUT
+ *
+ *          ++---------------------++
+ *          ||  prev_phys          ||
+ *          ||  size | flags       ||
+ *          ++---------------------++  <- returned pointer (BLOCK_HDR_LEN)
+ *          |  next_free (if free)  |
+ *          |  prev_free (if free)  |
+ *          |    // payload //      |
+ *          +-----------------------+  <- next physical block
+ *
+ * Each memory region that is added to the allocator ends with a sentinel
+ * block of size zero that is always marked as used, so that coalescing stops
+ * at the region boundary.
+ */
+
+#include <string.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include <uk/alloctlsf.h>
+#include <uk/alloc_impl.h>
+#include <uk/arch/atomic.h>
+#include <uk/essentials.h>
+#include <uk/print.h>
+#include <uk/assert.h>
+#include <uk/page.h>
+
+#if __SIZEOF_POINTER__ == 8
+#define TLSF_ALIGN_LOG2		4
+#define FL_INDEX_MAX		48	/* blocks up to 256 TiB */
+#else
+#define TLSF_ALIGN_LOG2		3
+#define FL_INDEX_MAX		30	/* blocks up to 1 GiB */
+#endif
+#define TLSF_ALIGN		(1UL << TLSF_ALIGN_LOG2)
+
+#define SL_INDEX_COUNT_LOG2	5
+#define SL_INDEX_COUNT		(1U << SL_INDEX_COUNT_LOG2)
+
+/* Blocks smaller than SMALL_BLOCK_SIZE are all kept on the first level,
+ * divided linearly into SL_INDEX_COUNT lists of TLSF_ALIGN granularity.
+ */
+#define FL_INDEX_SHIFT		(SL_INDEX_COUNT_LOG2 + TLSF_ALIGN_LOG2)
+#define FL_INDEX_COUNT		(FL_INDEX_MAX - FL_INDEX_SHIFT + 1)
+#define SMALL_BLOCK_SIZE	(1UL << FL_INDEX_SHIFT)
+
+#define BLOCK_FREE		0x1UL
+#define BLOCK_PREV_FREE		0x2UL
+#define BLOCK_FLAGS		(BLOCK_FREE | BLOCK_PREV_FREE)
+
+struct tlsf_block {
+	/* previous block in physical memory */
+	struct tlsf_block *prev_phys;
+	/* payload length, the lower bits hold BLOCK_FLAGS */
+	size_t size;
+
+	/* only valid for free blocks: segregated free list */
+	struct tlsf_block *next_free;
+	struct tlsf_block *prev_free;
+};
+
+#define BLOCK_HDR_LEN		offsetof(struct tlsf_block, next_free)
+#define BLOCK_SIZE_MIN		(sizeof(struct tlsf_block) - BLOCK_HDR_LEN)
+/* Largest allocation for which rounding up to the next list size does not
+ * exceed the first level
+ */
+#define BLOCK_SIZE_MAX		(1UL << (FL_INDEX_MAX - 1))
+/* Largest block that is accepted when adding memory */
+#define POOL_BLOCK_SIZE_MAX	(ALIGN_DOWN((1UL << FL_INDEX_MAX) - 1, \
+					    TLSF_ALIGN))
+
+UK_CTASSERT(BLOCK_HDR_LEN == TLSF_ALIGN);
+UK_CTASSERT(BLOCK_SIZE_MIN == TLSF_ALIGN);
+UK_CTASSERT(FL_INDEX_COUNT < (sizeof(unsigned long) * 8));
+
+struct uk_alloctlsf {
+	unsigned long fl_bitmap;
+	uint32_t sl_bitmap[FL_INDEX_COUNT];
+	struct tlsf_block *blocks[FL_INDEX_COUNT][SL_INDEX_COUNT];
+
+	/* sum of payload lengths of all free blocks */
+	size_t free_mem;
+};
+
+#define ukalloc2tlsf(a) \
+	((struct uk_alloctlsf *)&(a)->priv)
+
+/*
+ * Block helpers
+ */
+static inline size_t block_size(const struct tlsf_block *b)
+{
+	return b->size & ~BLOCK_FLAGS;
+}
+
+static inline void block_set_size(struct tlsf_block *b, size_t size)
+{
+	b->size = size | (b->size & BLOCK_FLAGS);
+}
+
+static inline int block_is_free(const struct tlsf_block *b)
+{
+	return (b->size & BLOCK_FREE) != 0;
+}
+
+static inline int block_is_prev_free(const struct tlsf_block *b)
+{
+	return (b->size & BLOCK_PREV_FREE) != 0;
+}
+
+static inline void *block_to_ptr(const struct tlsf_block *b)
+{
+	return (void *)((uintptr_t) b + BLOCK_HDR_LEN);
+}
+
+static inline struct tlsf_block *block_from_ptr(const void *ptr)
+{
+	return (struct tlsf_block *)((uintptr_t) ptr - BLOCK_HDR_LEN);
+}
+
+static inline struct tlsf_block *block_next(const struct tlsf_block *b)
+{
+	return (struct tlsf_block *)((uintptr_t) block_to_ptr(b)
+				     + block_size(b));
+}
+
+static inline void block_mark_free(struct tlsf_block *b)
+{
+	struct tlsf_block *next = block_next(b);
+
+	b->size |= BLOCK_FREE;
+	next->prev_phys = b;
+	next->size |= BLOCK_PREV_FREE;
+}
+
+static inline void block_mark_used(struct tlsf_block *b)
+{
+	b->size &= ~BLOCK_FREE;
+	block_next(b)->size &= ~BLOCK_PREV_FREE;
+}
+
+static inline size_t adjust_size(size_t size)
+{
+	if (size < BLOCK_SIZE_MIN)
+		return BLOCK_SIZE_MIN;
+	return ALIGN_UP(size, TLSF_ALIGN);
+}
+
+/*
+ * Two-level index computation
+ */
+static inline void mapping_insert(size_t size, unsigned int *fl,
+				  unsigned int *sl)
+{
+	unsigned long f;
+
+	if (size < SMALL_BLOCK_SIZE) {
+		*fl = 0;
+		*sl = (unsigned int)(size
+				     / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT));
+		return;
+	}
+
+	f = ukarch_flsl(size);
+	*sl = (unsigned int)(size >> (f - SL_INDEX_COUNT_LOG2))
+	      ^ SL_INDEX_COUNT;
+	*fl = (unsigned int)(f - (FL_INDEX_SHIFT - 1));
+}
+
+/* Rounds `size` up to the next list size so that every block of the list
+ * returned by mapping_insert() satisfies the request (good fit).
+ */
+static inline void mapping_search(size_t size, unsigned int *fl,
+				  unsigned int *sl)
+{
+	if (size >= SMALL_BLOCK_SIZE)
+		size += (1UL << (ukarch_flsl(size) - SL_INDEX_COUNT_LOG2)) - 1;
+	mapping_insert(size, fl, sl);
+}
+
+/*
+ * Free lists
+ */
+static void insert_free_block(struct uk_alloctlsf *t, struct tlsf_block *b)
+{
+	unsigned int fl, sl;
+	struct tlsf_block *head;
+
+	mapping_insert(block_size(b), &fl, &sl);
+	UK_ASSERT(fl < FL_INDEX_COUNT);
+
+	head = t->blocks[fl][sl];
+	b->next_free = head;
+	b->prev_free = NULL;
+	if (head)
+		head->prev_free = b;
+	t->blocks[fl][sl] = b;
+
+	t->fl_bitmap |= (1UL << fl);
+	t->sl_bitmap[fl] |= (1U << sl);
+	t->free_mem += block_size(b);
+}
+
+static void remove_free_block(struct uk_alloctlsf *t, struct tlsf_block *b)
+{
+	unsigned int fl, sl;
+
+	mapping_insert(block_size(b), &fl, &sl);
+	UK_ASSERT(fl < FL_INDEX_COUNT);
+
+	if (b->next_free)
+		b->next_free->prev_free = b->prev_free;
+	if (b->prev_free)
+		b->prev_free->next_free = b->next_free;
+
+	if (t->blocks[fl][sl] == b) {
+		t->blocks[fl][sl] = b->next_free;
+		if (!b->next_free) {
+			t->sl_bitmap[fl] &= ~(1U << sl);
+			if (!t->sl_bitmap[fl])
+				t->fl_bitmap &= ~(1UL << fl);
+		}
+	}
+	t->free_mem -= block_size(b);
+}
+
+static struct tlsf_block *search_suitable_block(struct uk_alloctlsf *t,
+						unsigned int fl,
+						unsigned int sl)
+{
+	unsigned long fl_map;
+	uint32_t sl_map;
+
+	/* first look for a non-empty list in the same first-level range */
+	sl_map = t->sl_bitmap[fl] & (~0U << sl);
+	if (!sl_map) {
+		/* continue with the next larger first-level range */
+		fl_map = t->fl_bitmap & (~0UL << (fl + 1));
+		if (!fl_map)
+			return NULL;
+
+		fl = (unsigned int) ukarch_ffsl(fl_map);
+		sl_map = t->sl_bitmap[fl];
+		UK_ASSERT(sl_map);
+	}
+	sl = (unsigned int) ukarch_ffsl(sl_map);
+
+	return t->blocks[fl][sl];
+}
+
+/* Finds and unlinks a free block of at least `size` bytes */
+static struct tlsf_block *locate_free_block(struct uk_alloctlsf *t,
+					    size_t size)
+{
+	struct tlsf_block *b;
+	unsigned int fl, sl;
+
+	mapping_search(size, &fl, &sl);
+	if (unlikely(fl >= FL_INDEX_COUNT))
+		return NULL;
+
+	b = search_suitable_block(t, fl, sl);
+	if (unlikely(!b))
+		return NULL;
+
+	UK_ASSERT(block_size(b) >= size);
+	remove_free_block(t, b);
+	return b;
+}
+
+/*
+ * Splitting and coalescing
+ */
+static inline int block_can_split(const struct tlsf_block *b, size_t size)
+{
+	return block_size(b) >= size + BLOCK_HDR_LEN + BLOCK_SIZE_MIN;
+}
+
+/* Splits off the tail of `b` behind `size` bytes of payload as a new free
+ * block. The new block is not linked into a free list.
+ */
+static struct tlsf_block *block_split(struct tlsf_block *b, size_t size)
+{
+	struct tlsf_block *rem;
+	size_t rem_size;
+
+	UK_ASSERT(block_can_split(b, size));
+
+	rem = (struct tlsf_block *)((uintptr_t) block_to_ptr(b) + size);
+	rem_size = block_size(b) - size - BLOCK_HDR_LEN;
+
+	block_set_size(b, size);
+	rem->prev_phys = b;
+	rem->size = rem_size | BLOCK_PREV_FREE;
+	block_mark_free(rem);
+	return rem;
+}
+
+static struct tlsf_block *block_merge_prev(struct uk_alloctlsf *t,
+					   struct tlsf_block *b)
+{
+	struct tlsf_block *prev;
+
+	if (!block_is_prev_free(b))
+		return b;
+
+	prev = b->prev_phys;
+	UK_ASSERT(prev && block_is_free(prev));
+	remove_free_block(t, prev);
+
+	block_set_size(prev, block_size(prev) + BLOCK_HDR_LEN
+		       + block_size(b));
+	block_next(prev)->prev_phys = prev;
+	return prev;
+}
+
+static struct tlsf_block *block_merge_next(struct uk_alloctlsf *t,
+					   struct tlsf_block *b)
+{
+	struct tlsf_block *next = block_next(b);
+
+	if (!block_is_free(next))
+		return b;
+
+	remove_free_block(t, next);
+
+	block_set_size(b, block_size(b) + BLOCK_HDR_LEN + block_size(next));
+	block_next(b)->prev_phys = b;
+	return b;
+}
+
+/* Returns the tail of an unlinked free block to the free lists */
+static void block_trim_free(struct uk_alloctlsf *t, struct tlsf_block *b,
+			    size_t size)
+{
+	UK_ASSERT(block_is_free(b));
+
+	if (block_can_split(b, size))
+		insert_free_block(t, block_split(b, size));
+}
+
+/* Returns the tail of a used block to the free lists */
+static void block_trim_used(struct uk_alloctlsf *t, struct tlsf_block *b,
+			    size_t size)
+{
+	struct tlsf_block *rem;
+
+	UK_ASSERT(!block_is_free(b));
+
+	if (block_can_split(b, size)) {
+		rem = block_split(b, size);
+		rem->size &= ~BLOCK_PREV_FREE;
+		rem = block_merge_next(t, rem);
+		insert_free_block(t, rem);
+	}
+}
+
+static void *block_prepare_used(struct uk_alloctlsf *t, struct tlsf_block *b,
+				size_t size)
+{
+	block_trim_free(t, b, size);
+	block_mark_used(b);
+	return block_to_ptr(b);
+}
+
+/*
+ * ukalloc interface
+ */
+static void *tlsf_malloc(struct uk_alloc *a, size_t size)
+{
+	struct uk_alloctlsf *t;
+	struct tlsf_block *b;
+
+	UK_ASSERT(a);
+	t = ukalloc2tlsf(a);
+
+	if (unlikely(!size))
+		return NULL;
+
+	if (unlikely(size > BLOCK_SIZE_MAX)) {
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	size = adjust_size(size);
+	b = locate_free_block(t, size);
+	if (unlikely(!b)) {
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	return block_prepare_used(t, b, size);
+}
+
+static void *tlsf_memalign_block(struct uk_alloctlsf *t, size_t align,
+				 size_t size)
+{
+	const size_t gap_min = BLOCK_HDR_LEN + BLOCK_SIZE_MIN;
+	struct tlsf_block *b, *lead;
+	uintptr_t ptr, aligned;
+	size_t gap, req;
+
+	size = adjust_size(size);
+
+	/* Reserve enough space to split off a leading free block in case
+	 * the block payload is not aligned.
+	 */
+	req = size + align + gap_min;
+	if (unlikely(req < size || req > BLOCK_SIZE_MAX))
+		return NULL;
+
+	b = locate_free_block(t, req);
+	if (unlikely(!b))
+		return NULL;
+
+	ptr = (uintptr_t) block_to_ptr(b);
+	aligned = ALIGN_UP(ptr, (uintptr_t) align);
+	gap = aligned - ptr;
+	if (gap && gap < gap_min) {
+		/* gap too small to hold a free block */
+		aligned = ALIGN_UP(ptr + gap_min, (uintptr_t) align);
+		gap = aligned - ptr;
+	}
+
+	if (gap) {
+		lead = b;
+		b = block_split(lead, gap - BLOCK_HDR_LEN);
+		insert_free_block(t, lead);
+	}
+	UK_ASSERT((uintptr_t) block_to_ptr(b) == aligned);
+
+	return block_prepare_used(t, b, size);
+}
+
+static int tlsf_posix_memalign(struct uk_alloc *a, void **memptr,
+			       size_t align, size_t size)
+{
+	struct uk_alloctlsf *t;
+	struct tlsf_block *b;
+	void *ptr;
+
+	UK_ASSERT(a);
+	t = ukalloc2tlsf(a);
+
+	if (((align - 1) & align) != 0
+	    || (align % sizeof(void *)) != 0)
+		return EINVAL;
+
+	/* Leave memptr untouched. See comment in uk_posix_memalign_ifpages. */
+	if (!size)
+		return EINVAL;
+
+	if (align <= TLSF_ALIGN) {
+		if (unlikely(size > BLOCK_SIZE_MAX))
+			return ENOMEM;
+
+		size = adjust_size(size);
+		b = locate_free_block(t, size);
+		ptr = (b) ? block_prepare_used(t, b, size) : NULL;
+	} else {
+		ptr = tlsf_memalign_block(t, align, size);
+	}
+
+	if (unlikely(!ptr))
+		return ENOMEM;
+
+	*memptr = ptr;
+	return 0;
+}
+
+static void tlsf_free(struct uk_alloc *a, void *ptr)
+{
+	struct uk_alloctlsf *t;
+	struct tlsf_block *b;
+
+	UK_ASSERT(a);
+	t = ukalloc2tlsf(a);
+
+	if (unlikely(!ptr))
+		return;
+
+	b = block_from_ptr(ptr);
+	UK_ASSERT(!block_is_free(b));
+
+	block_mark_free(b);
+	b = block_merge_prev(t, b);
+	b = block_merge_next(t, b);
+	insert_free_block(t, b);
+}
+
+static void *tlsf_realloc(struct uk_alloc *a, void *ptr, size_t size)
+{
+	struct uk_alloctlsf *t;
+	struct tlsf_block *b, *next;
+	size_t cursize, combined;
+	void *retptr;
+
+	UK_ASSERT(a);
+	t = ukalloc2tlsf(a);
+
+	if (!ptr)
+		return tlsf_malloc(a, size);
+
+	if (ptr && !size) {
+		tlsf_free(a, ptr);
+		return NULL;
+	}
+
+	if (unlikely(size > BLOCK_SIZE_MAX)) {
+		errno = ENOMEM;
+		return NULL;
+	}
+
+	b = block_from_ptr(ptr);
+	UK_ASSERT(!block_is_free(b));
+
+	size = adjust_size(size);
+	cursize = block_size(b);
+	next = block_next(b);
+	combined = cursize;
+	if (block_is_free(next))
+		combined += BLOCK_HDR_LEN + block_size(next);
+
+	if (size > combined) {
+		/* cannot grow in place, tlsf_malloc() sets errno */
+		retptr = tlsf_malloc(a, size);
+		if (!retptr)
+			return NULL;
+
+		memcpy(retptr, ptr, cursize);
+		tlsf_free(a, ptr);
+		return retptr;
+	}
+
+	if (size > cursize) {
+		/* grow into the following free block */
+		block_merge_next(t, b);
+		block_mark_used(b);
+	}
+	block_trim_used(t, b, size);
+	return ptr;
+}
+
+static int tlsf_addmem(struct uk_alloc *a, void *base, size_t len)
+{
+	struct uk_alloctlsf *t;
+	struct tlsf_block *b, *sentinel;
+	uintptr_t start, end;
+	size_t size;
+
+	UK_ASSERT(a);
+	UK_ASSERT(base);
+	t = ukalloc2tlsf(a);
+
+	start = ALIGN_UP((uintptr_t) base, TLSF_ALIGN);
+	end   = ALIGN_DOWN((uintptr_t) base + len, TLSF_ALIGN);
+
+	/* one block with minimum payload and the sentinel */
+	if (end < start
+	    || end - start < 2 * BLOCK_HDR_LEN + BLOCK_SIZE_MIN) {
+		uk_pr_err("%"__PRIuptr": Failed to add memory region %"__PRIuptr"-%"__PRIuptr": Not enough space after applying alignments\n",
+			  (uintptr_t) a, (uintptr_t) base,
+			  (uintptr_t) base + (uintptr_t) len);
+		return -EINVAL;
+	}
+
+	size = end - start - 2 * BLOCK_HDR_LEN;
+	if (size > POOL_BLOCK_SIZE_MAX) {
+		uk_pr_warn("%"__PRIuptr": Truncate memory region %"__PRIuptr"-%"__PRIuptr" to %"__PRIsz" B\n",
+			   (uintptr_t) a, (uintptr_t) base,
+			   (uintptr_t) base + (uintptr_t) len,
+			   (size_t) POOL_BLOCK_SIZE_MAX);
+		size = POOL_BLOCK_SIZE_MAX;
+	}
+
+	uk_pr_debug("%"__PRIuptr": Add memory region %"__PRIuptr" - %"__PRIuptr"\n",
+		    (uintptr_t) a, start, start + size + 2 * BLOCK_HDR_LEN);
+
+	b = (struct tlsf_block *) start;
+	b->prev_phys = NULL;
+	b->size = size;
+
+	sentinel = block_next(b);
+	sentinel->prev_phys = b;
+	sentinel->size = 0;
+
+	block_mark_free(b);
+	insert_free_block(t, b);
+	return 0;
+}
+
+static size_t tlsf_getsize(struct uk_alloc *a __maybe_unused,
+			   const void *ptr)
+{
+	struct tlsf_block *b = block_from_ptr(ptr);
+
+	UK_ASSERT(!block_is_free(b));
+	return block_size(b);
+}
+
+#if CONFIG_LIBUKALLOC_IFSTATS
+static ssize_t tlsf_availmem(struct uk_alloc *a)
+{
+	UK_ASSERT(a);
+	return (ssize_t) ukalloc2tlsf(a)->free_mem;
+}
+#endif
+
+struct uk_alloc *uk_alloctlsf_init(void *base, size_t len)
+{
+	struct uk_alloc *a;
+	struct uk_alloctlsf *t;
+	uintptr_t min, max;
+	size_t metalen;
+
+	min = ALIGN_UP((uintptr_t) base, TLSF_ALIGN);
+	max = (uintptr_t) base + len;
+	metalen = ALIGN_UP(sizeof(*a) + sizeof(*t), TLSF_ALIGN);
+
+	/* enough space for allocator available? */
+	if (max < min || min + metalen > max) {
+		uk_pr_err("Not enough space for allocator: %"__PRIsz" B required but only %"__PRIuptr" B usable\n",
+			  metalen, (max > min) ? (max - min) : 0);
+		return NULL;
+	}
+
+	a = (struct uk_alloc *) min;
+	uk_pr_info("Initialize TLSF allocator %"__PRIuptr"\n", (uintptr_t) a);
+	memset(a, 0, metalen);
+	t = ukalloc2tlsf(a);
+	min += metalen;
+
+	uk_alloc_init_malloc(a, tlsf_malloc, uk_calloc_compat, tlsf_realloc,
+			     tlsf_free, tlsf_posix_memalign,
+			     uk_memalign_compat, tlsf_addmem);
+	a->getsize = tlsf_getsize;
+#if CONFIG_LIBUKALLOC_IFSTATS
+	a->availmem = tlsf_availmem;
+#endif
+
+	/* add left memory - ignore return value */
+	if (max > min)
+		tlsf_addmem(a, (void *) min, (size_t)(max - min));
+
+	return a;
+}
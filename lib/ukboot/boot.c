@@ -43,10 +43,16 @@
 
 #if CONFIG_LIBUKBOOT_INITBBUDDY
 #include <uk/allocbbuddy.h>
+#elif CONFIG_LIBUKBOOT_INITSLAB
+#include <uk/allocbbuddy.h>
+#include <uk/allocslab.h>
 #elif CONFIG_LIBUKBOOT_INITREGION
 #include <uk/allocregion.h>
 #elif CONFIG_LIBUKBOOT_INITTLSF
-#include <uk/tlsf.h>
+#include <uk/alloctlsf.h>
+#endif
+#if CONFIG_LIBUKBOOT_ALLOCCACHE
+#include <uk/alloc_cache.h>
 #endif
 #if CONFIG_LIBUKSCHED
 #include <uk/sched.h>
@@ -237,17 +243,43 @@ void ukplat_entry(int argc, char *argv[])
 		 * subsequent region to it
 		 */
 		if (!a) {
-#if CONFIG_LIBUKBOOT_INITBBUDDY
+#if CONFIG_LIBUKBOOT_INITBBUDDY || CONFIG_LIBUKBOOT_INITSLAB
 			a = uk_allocbbuddy_init(md.base, md.len);
 #elif CONFIG_LIBUKBOOT_INITREGION
 			a = uk_allocregion_init(md.base, md.len);
 #elif CONFIG_LIBUKBOOT_INITTLSF
-			a = uk_tlsf_init(md.base, md.len);
+			a = uk_alloctlsf_init(md.base, md.len);
 #endif
 		} else {
 			uk_alloc_addmem(a, md.base, md.len);
 		}
 	}
+#if CONFIG_LIBUKBOOT_INITSLAB
+	/* stack the slab allocator on top of the page allocator */
+	if (likely(a)) {
+		struct uk_alloc *sa = uk_allocslab_init(a);
+
+		if (likely(sa)) {
+			uk_alloc_set_default(sa);
+			a = sa;
+		} else {
+			uk_pr_warn("Could not initialize slab allocator. Continue with page allocator\n");
+		}
+	}
+#endif
+#if CONFIG_LIBUKBOOT_ALLOCCACHE
+	/* put per-thread object caches in front of the allocator */
+	if (likely(a)) {
+		struct uk_alloc *ca = uk_alloc_cache_init(a);
+
+		if (likely(ca)) {
+			uk_alloc_set_default(ca);
+			a = ca;
+		} else {
+			uk_pr_warn("Could not initialize allocator caches. Continue without\n");
+		}
+	}
+#endif
 	if (unlikely(!a))
 		uk_pr_warn("No suitable memory region for memory allocator. Continue without heap\n");
 	else {
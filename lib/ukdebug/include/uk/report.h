@@ -0,0 +1,109 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Text reports to a buffer or the console
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * THIS HEADER MAY NOT BE EXTRACTED OR MODIFIED IN ANY WAY.
+ */
+
+#ifndef __UKDEBUG_REPORT_H__
+#define __UKDEBUG_REPORT_H__
+
+#include <stddef.h>
+#include <uk/essentials.h>
+#include <uk/print.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum length of a line that is printed to the console */
+#define UK_REPORT_LINE_LEN 160
+
+/**
+ * Destination of a text report that is written line by line. The report is
+ * either appended to a buffer, like snprintf() it is truncated there, or its
+ * lines are printed to the console with the info log level.
+ */
+struct uk_report {
+	/* print lines to the console instead of writing to buf */
+	int console;
+	/* library that is named in console messages */
+	const char *libname;
+	char *buf;
+	size_t len;
+	/* length of the full report */
+	size_t off;
+};
+
+/**
+ * Function that writes a report with uk_report_printf()
+ */
+typedef void (*uk_report_func_t)(struct uk_report *r);
+
+/**
+ * Appends a formatted line, or a part of it, to a report
+ *
+ * @param r
+ *   Report destination
+ * @param fmt
+ *   printf() format string
+ */
+void uk_report_printf(struct uk_report *r, const char *fmt, ...) __printf(2, 3);
+
+/**
+ * Writes a report to a buffer
+ *
+ * @param fn
+ *   Function that writes the report
+ * @param buf
+ *   Destination buffer, can be NULL if `len` is 0
+ * @param len
+ *   Size of `buf`; the report is truncated and always terminated
+ * @return
+ *   Length of the full report without the terminating null character
+ */
+size_t uk_report_print(uk_report_func_t fn, char *buf, size_t len);
+
+void _uk_report_dump(uk_report_func_t fn, const char *libname);
+
+/**
+ * Prints a report line by line to the console
+ *
+ * @param fn
+ *   Function that writes the report
+ */
+#define uk_report_dump(fn) \
+	_uk_report_dump((fn), __STR_LIBNAME__)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UKDEBUG_REPORT_H__ */
@@ -0,0 +1,87 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Text reports to a buffer or the console
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <uk/assert.h>
+#include <uk/print.h>
+#include <uk/report.h>
+
+void uk_report_printf(struct uk_report *r, const char *fmt, ...)
+{
+	char line[UK_REPORT_LINE_LEN];
+	size_t left;
+	va_list ap;
+	int ret;
+
+	UK_ASSERT(r);
+
+	va_start(ap, fmt);
+	if (r->console) {
+		vsnprintf(line, sizeof(line), fmt, ap);
+#if CONFIG_LIBUKDEBUG_PRINTK
+		if (KLVL_INFO <= KLVL_MAX)
+			_uk_printk(KLVL_INFO, r->libname, __STR_BASENAME__,
+				   __LINE__, "%s", line);
+#endif
+	} else {
+		left = (r->off < r->len) ? r->len - r->off : 0;
+		ret = vsnprintf(left ? r->buf + r->off : NULL, left, fmt, ap);
+		if (ret > 0)
+			r->off += ret;
+	}
+	va_end(ap);
+}
+
+size_t uk_report_print(uk_report_func_t fn, char *buf, size_t len)
+{
+	struct uk_report r = { .console = 0, .libname = NULL,
+			       .buf = buf, .len = len, .off = 0 };
+
+	UK_ASSERT(fn);
+	UK_ASSERT(buf || !len);
+
+	if (len)
+		buf[0] = '\0';
+	fn(&r);
+	return r.off;
+}
+
+void _uk_report_dump(uk_report_func_t fn, const char *libname)
+{
+	struct uk_report r = { .console = 1, .libname = libname,
+			       .buf = NULL, .len = 0, .off = 0 };
+
+	UK_ASSERT(fn);
+
+	fn(&r);
+}
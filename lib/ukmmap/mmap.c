@@ -34,146 +34,1155 @@
  * THIS HEADER MAY NOT BE EXTRACTED OR MODIFIED IN ANY WAY.
  */
 
+#define _GNU_SOURCE
 #include <sys/mman.h>
-#include <uk/alloc.h>
 #include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <uk/alloc.h>
+#include <uk/page.h>
+#include <uk/print.h>
+#include <uk/assert.h>
+#include <uk/essentials.h>
+#include <uk/errptr.h>
 #include <uk/syscall.h>
+#include <uk/plat/paging.h>
+#if CONFIG_LIBVFSCORE
+#include <vfscore/file.h>
+#include <vfscore/fs.h>
+#include <vfscore/uio.h>
+#include <vfscore/vnode.h>
+#endif
+
+/*
+ * Mappings are described by virtual memory areas (VMAs) that are kept in an
+ * array sorted by address. VMAs never overlap, lookups are binary searches.
+ *
+ * On platforms with dynamic page mappings (CONFIG_HAVE_PAGING), a mapping
+ * only reserves address space within the mapping window of the platform.
+ * Page frames are allocated and mapped by the page fault handler on first
+ * access (or immediately with MAP_POPULATE) and released by munmap().
+ *
+ * All other platforms back a mapping with contiguous memory at mmap() time.
+ * Such a backing block is released as soon as no VMA refers to it anymore.
+ * Protections are recorded but not enforced.
+ *
+ * File mappings (with vfscore) use the file data in place if the file system
+ * keeps it in memory at a page-aligned address (VOP_MMAP). Otherwise, the
+ * file contents are read into the mapping at mmap() time. Shared mappings
+ * of files that are open for writing are written back by munmap().
+ */
 
-struct mmap_addr {
-	void *begin;
-	void *end;
-	struct mmap_addr *next;
+struct mmap_backing {
+	void *base;			/* NULL with paging */
+	unsigned long num_pages;
+	unsigned int refs;		/* VMAs that refer to this block */
+#if CONFIG_LIBVFSCORE
+	struct vfscore_file *fp;	/* NULL for anonymous memory */
+	off_t off;			/* file offset at `start` */
+	__uptr start;
+	__sz len;
+	int direct;			/* file data is mapped in place */
+	int writable;			/* mapped with PROT_WRITE at any time */
+#endif
 };
 
-static struct mmap_addr *mmap_addr;
+struct vma {
+	__uptr start;
+	__uptr end;
+	int prot;
+	int flags;
+	struct mmap_backing *backing;	/* NULL for anonymous with paging */
+};
 
-/**
- * This is not a correct implementation of mmap. It is just a trick that works
- * for Go but it needs to be revisited. Instead of mapping, it allocates len
- * bytes of memory and stores the beginninig and the end of that memory chunk
- * in struct mmap_addr. At first it checks if addr belongs to one of the memory
- * chunks that have been allocated in a previous call of mmap. If that is the
- * case addr is the return value. Otherwise a new memory block is allocated and
- * the return value is a pointer to the beginninig of that block.
- *
- * Go uses mmap always with:
- * @prot   =	either PROT_NONE or PROT_READ|PROT_WRITE,
- * @flags  =	as MAP_ANON|MAP_PRIVATE, or MAP_FIXED|MAP_ANON|MAP_PRIVATE
- *		or MAP_NORESERVE|MAP_ANON|MAP_PRIVATE
- * @fildes =	-1
- * @off    =	0
- *
+#if CONFIG_LIBVFSCORE
+#define vma_file(v)	((v)->backing ? (v)->backing->fp : NULL)
+#define vma_direct(v)	((v)->backing && (v)->backing->direct)
+#else
+#define vma_file(v)	NULL
+#define vma_direct(v)	0
+#endif
+
+static struct vma *vmas;
+static unsigned int vma_count;
+static unsigned int vma_cap;
+
+/* > 0: paging, < 0: backing blocks, 0: not initialized yet */
+static int mmap_mode;
+static __uptr win_base;
+static __sz win_len;
+
+#define mmap_paging()		(mmap_mode > 0)
+#define mmap_alloc()		uk_alloc_get_default()
+
+/*
+ * Fallbacks for platforms that do not provide dynamic page mappings
+ */
+__weak int ukplat_pagefault_handler_register(
+	ukplat_pagefault_handler_t handler __unused)
+{
+	return -ENOTSUP;
+}
+
+__weak void ukplat_paging_window(__uptr *base, __sz *len)
+{
+	*base = 0;
+	*len  = 0;
+}
+
+__weak int ukplat_page_map(__uptr vaddr __unused, __uptr paddr __unused,
+			   unsigned long prot __unused)
+{
+	return -ENOTSUP;
+}
+
+__weak long ukplat_page_unmap(__uptr vaddr __unused, __sz len __unused,
+			      ukplat_page_unmap_cb_t cb __unused,
+			      void *cookie __unused)
+{
+	return -ENOTSUP;
+}
+
+__weak int ukplat_page_set_prot(__uptr vaddr __unused, __sz len __unused,
+				unsigned long prot __unused)
+{
+	return -ENOTSUP;
+}
+
+__weak int ukplat_page_lookup(__uptr vaddr __unused, __uptr *paddr __unused)
+{
+	return -ENOENT;
+}
+
+/*
+ * VMA array
  */
 
-UK_SYSCALL_DEFINE(void*, mmap, void*, addr, size_t, len, int, prot,
-		int, flags, int, fildes, off_t, off)
+/* Returns the index of the first VMA that ends above `addr` */
+static unsigned int vma_lookup(__uptr addr)
 {
-	struct mmap_addr *tmp = mmap_addr, *last = NULL, *new = NULL;
+	unsigned int lo = 0, hi = vma_count, mid;
 
-	if (!len) {
-		errno = EINVAL;
-		return (void *) -1;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (vmas[mid].end <= addr)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
+	return lo;
+}
 
-	/* Check if parameters match the ones that go use
-	 * Otherwise return 0 (unimplemented mmap)
-	 */
-	if (fildes != -1 || off)
-		return 0;
-	if (!(prot & (PROT_READ|PROT_WRITE)) && (prot != 0))
-		return 0;
-	if (!(flags & (MAP_ANON|MAP_PRIVATE)) &&
-			!(flags & (MAP_FIXED|MAP_ANON|MAP_PRIVATE)) &&
-			!(flags & (MAP_NORESERVE|MAP_ANON|MAP_PRIVATE)))
+/* Returns the VMA that contains `addr`, NULL if there is none */
+static struct vma *vma_find(__uptr addr)
+{
+	unsigned int i = vma_lookup(addr);
+
+	if (i == vma_count || vmas[i].start > addr)
+		return NULL;
+	return &vmas[i];
+}
+
+/* Checks that no VMA overlaps with [start, end) */
+static int vma_range_free(__uptr start, __uptr end)
+{
+	unsigned int i = vma_lookup(start);
+
+	return i == vma_count || vmas[i].start >= end;
+}
+
+/* Checks that [start, end) is completely covered by VMAs */
+static int vma_range_mapped(__uptr start, __uptr end)
+{
+	unsigned int i = vma_lookup(start);
+
+	for (; start < end; ++i) {
+		if (i == vma_count || vmas[i].start > start)
+			return 0;
+		start = vmas[i].end;
+	}
+	return 1;
+}
+
+/* Makes room for `count` additional VMAs */
+static int vma_reserve(unsigned int count)
+{
+	struct vma *n;
+	unsigned int cap;
+
+	if (vma_count + count <= vma_cap)
 		return 0;
 
-	while (tmp) {
-		if (addr) {
-			if (addr >= tmp->begin && addr < tmp->end)
-				return addr;
+	cap = MAX(MAX(vma_cap * 2, vma_count + count), 16U);
+	n = uk_realloc(mmap_alloc(), vmas, cap * sizeof(*n));
+	if (unlikely(!n))
+		return -ENOMEM;
+
+	vmas = n;
+	vma_cap = cap;
+	return 0;
+}
+
+static void vma_insert_at(unsigned int idx, const struct vma *v)
+{
+	UK_ASSERT(vma_count < vma_cap);
+	UK_ASSERT(idx <= vma_count);
+
+	memmove(&vmas[idx + 1], &vmas[idx],
+		(vma_count - idx) * sizeof(*vmas));
+	vmas[idx] = *v;
+	vma_count++;
+}
+
+static void vma_remove(unsigned int first, unsigned int last)
+{
+	UK_ASSERT(first <= last && last <= vma_count);
+
+	memmove(&vmas[first], &vmas[last],
+		(vma_count - last) * sizeof(*vmas));
+	vma_count -= last - first;
+}
+
+/* Splits a VMA at `addr`, requires room for one more VMA */
+static void vma_split(unsigned int idx, __uptr addr)
+{
+	struct vma v = vmas[idx];
+
+	UK_ASSERT(addr > v.start && addr < v.end);
+
+	vmas[idx].end = addr;
+	v.start = addr;
+	if (v.backing)
+		v.backing->refs++;
+	vma_insert_at(idx + 1, &v);
+}
+
+/*
+ * Splits VMAs at `start` and `end` so that [start, end) is covered by whole
+ * VMAs. These are the VMAs with indices [*first, *last).
+ */
+static int vma_isolate(__uptr start, __uptr end,
+		       unsigned int *first, unsigned int *last)
+{
+	unsigned int i;
+
+	if (unlikely(vma_reserve(2) < 0))
+		return -ENOMEM;
+
+	i = vma_lookup(start);
+	if (i < vma_count && vmas[i].start < start) {
+		vma_split(i, start);
+		i++;
+	}
+	*first = i;
+
+	i = vma_lookup(end);
+	if (i < vma_count && vmas[i].start < end) {
+		vma_split(i, end);
+		i++;
+	}
+	*last = i;
+	return 0;
+}
+
+/* Merges adjacent VMAs with identical attributes around [first, last) */
+static void vma_merge(unsigned int first, unsigned int last)
+{
+	unsigned int i;
+
+	i = (first > 0) ? first - 1 : 0;
+	while (i + 1 < vma_count && i <= last) {
+		if (vmas[i].end != vmas[i + 1].start
+		    || vmas[i].prot != vmas[i + 1].prot
+		    || vmas[i].flags != vmas[i + 1].flags
+		    || vmas[i].backing != vmas[i + 1].backing) {
+			i++;
+			continue;
 		}
-		last = tmp;
-		tmp = tmp->next;
+
+		vmas[i].end = vmas[i + 1].end;
+		if (vmas[i].backing)
+			vmas[i].backing->refs--;
+		vma_remove(i + 1, i + 2);
+		if (last > 0)
+			last--;
+	}
+}
+
+/* Finds free address space of `len` bytes in the mapping window */
+static __uptr vma_find_gap(__uptr hint, __sz len)
+{
+	__uptr cur = win_base;
+	unsigned int i;
+
+	if (hint >= win_base && hint - win_base <= win_len - len
+	    && vma_range_free(hint, hint + len))
+		return hint;
+
+	/* Direct file mappings are outside of the window */
+	for (i = vma_lookup(win_base); i < vma_count; ++i) {
+		if (vmas[i].start >= win_base + win_len)
+			break;
+		if (vmas[i].start - cur >= len)
+			return cur;
+		cur = vmas[i].end;
 	}
-	void *mem = uk_malloc(uk_alloc_get_default(), len);
+	if (win_base + win_len - cur >= len)
+		return cur;
+	return 0;
+}
+
+/*
+ * File access
+ */
+#if CONFIG_LIBVFSCORE
+static int file_io(struct vfscore_file *fp, off_t off, void *buf, __sz len,
+		   enum uio_rw rw)
+{
+	struct vnode *vp = fp->f_dentry->d_vnode;
+	struct iovec iov;
+	struct uio uio;
+	ssize_t resid;
+	int rc = 0;
 
-	if (!mem) {
-		errno = ENOMEM;
-		return (void *) -1;
+	iov.iov_base = buf;
+	iov.iov_len  = len;
+	uio.uio_iov    = &iov;
+	uio.uio_iovcnt = 1;
+	uio.uio_offset = off;
+	uio.uio_resid  = len;
+	uio.uio_rw     = rw;
+
+	/* File systems may transfer less than requested per call */
+	vn_lock(vp);
+	while (uio.uio_resid > 0) {
+		resid = uio.uio_resid;
+		if (rw == UIO_READ)
+			rc = VOP_READ(vp, fp, &uio, 0);
+		else
+			rc = VOP_WRITE(vp, &uio, 0);
+		if (rc || uio.uio_resid == resid)
+			break;
 	}
-	new = uk_malloc(uk_alloc_get_default(), sizeof(struct mmap_addr));
+	vn_unlock(vp);
+	return -rc;
+}
+
+/* Reads the file data of the page at `vaddr` into `buf` */
+static int file_read_page(struct mmap_backing *b, __uptr vaddr, void *buf)
+{
+	off_t off = b->off + (off_t) (vaddr - b->start);
+	off_t size = (off_t) b->fp->f_dentry->d_vnode->v_size;
+
+	if (off >= size)
+		return 0;
+	return file_io(b->fp, off, buf, MIN((off_t) __PAGE_SIZE, size - off),
+		       UIO_READ);
+}
+
+/* Writes [start, end) of a shared file mapping back to the file */
+static void file_writeback(struct vma *v, __uptr start, __uptr end)
+{
+	struct mmap_backing *b = v->backing;
+	off_t size = (off_t) b->fp->f_dentry->d_vnode->v_size;
+	__uptr paddr;
+	off_t off;
+	int rc;
+
+	if ((v->flags & MAP_TYPE) == MAP_PRIVATE || b->direct || !b->writable)
+		return;
 
-	if (!new) {
-		uk_free(uk_alloc_get_default(), mem);
-		errno = ENOMEM;
-		return (void *) -1;
+	/* The file is not extended; data beyond its end is dropped */
+	for (; start < end; start += __PAGE_SIZE) {
+		off = b->off + (off_t) (start - b->start);
+		if (off >= size)
+			break;
+
+		if (!mmap_paging())
+			paddr = start;
+		else if (ukplat_page_lookup(start, &paddr) < 0)
+			continue;
+
+		rc = file_io(b->fp, off, (void *) paddr,
+			     MIN((off_t) __PAGE_SIZE, size - off), UIO_WRITE);
+		if (unlikely(rc < 0))
+			uk_pr_err("Failed to write back mapped file data: %d\n",
+				  rc);
 	}
-	new->begin = mem;
-	new->end = mem + len;
-	new->next = NULL;
-	if (!mmap_addr)
-		mmap_addr = new;
-	else
-		last->next = new;
-	return mem;
+}
+#endif /* CONFIG_LIBVFSCORE */
+
+/*
+ * Memory management
+ */
+static unsigned long prot2plat(int prot)
+{
+	unsigned long pprot = UKPLAT_PAGE_PROT_NONE;
+
+	if (prot & PROT_READ)
+		pprot |= UKPLAT_PAGE_PROT_READ;
+	if (prot & PROT_WRITE)
+		pprot |= UKPLAT_PAGE_PROT_WRITE;
+	if (prot & PROT_EXEC)
+		pprot |= UKPLAT_PAGE_PROT_EXEC;
+	return pprot;
 }
 
 /*
- * munmap frees len bytes os memory starting from addr.
- * addr needs to be a pointer to a memory block that has been allocated from
- * mmap. If len has the same value with the size of the memory block that has
- * been allocated from mmap the struct mmap_addr counterpart is destroyed.
- * Otherwise the initial memory block is replaced by a smaller one.
+ * Maps a zeroed page at `vaddr`. File contents are only read in if `b`
+ * refers to a file, which must not happen from the page fault handler.
  */
+static int page_populate(__uptr vaddr, int prot,
+			 struct mmap_backing *b __maybe_unused)
+{
+	void *frame;
+	int rc;
+
+	frame = uk_palloc(mmap_alloc(), 1);
+	if (unlikely(!frame))
+		return -ENOMEM;
+	memset(frame, 0, __PAGE_SIZE);
+
+#if CONFIG_LIBVFSCORE
+	if (b && b->fp) {
+		rc = file_read_page(b, vaddr, frame);
+		if (unlikely(rc < 0))
+			goto err_free;
+	}
+#endif
+
+	rc = ukplat_page_map(vaddr, (__uptr) frame, prot2plat(prot));
+	if (unlikely(rc < 0))
+		goto err_free;
+	return 0;
+
+err_free:
+	uk_pfree(mmap_alloc(), frame, 1);
+	return rc;
+}
+
+static void page_release(__uptr vaddr __unused, __uptr paddr,
+			 void *cookie __unused)
+{
+	uk_pfree(mmap_alloc(), (void *) paddr, 1);
+}
+
+static int range_populate(__uptr start, __uptr end, int prot,
+			  struct mmap_backing *b)
+{
+	__uptr paddr;
+	int rc;
+
+	for (; start < end; start += __PAGE_SIZE) {
+		if (ukplat_page_lookup(start, &paddr) == 0)
+			continue;
+		rc = page_populate(start, prot, b);
+		if (unlikely(rc < 0))
+			return rc;
+	}
+	return 0;
+}
+
+static int mmap_fault(__uptr vaddr, unsigned long flags)
+{
+	struct vma *v = vma_find(vaddr);
+
+	if (!v || (flags & UKPLAT_PAGEFAULT_PRESENT))
+		return -EFAULT;
+	if (!(v->prot & (PROT_READ | PROT_WRITE | PROT_EXEC)))
+		return -EFAULT;
+	if ((flags & UKPLAT_PAGEFAULT_WRITE) && !(v->prot & PROT_WRITE))
+		return -EFAULT;
+	if ((flags & UKPLAT_PAGEFAULT_EXEC) && !(v->prot & PROT_EXEC))
+		return -EFAULT;
+
+	/*
+	 * File mappings are populated at mmap() time, so this is beyond the
+	 * end of the file or after MADV_DONTNEED: map a zero page.
+	 */
+	if (unlikely(page_populate(round_pgdown(vaddr), v->prot, NULL) < 0)) {
+		uk_pr_err("Failed to populate page at 0x%"__PRIuptr"\n",
+			  vaddr);
+		return -ENOMEM;
+	}
+	return 0;
+}
+
+static void mmap_init(void)
+{
+	if (likely(mmap_mode != 0))
+		return;
+
+	if (ukplat_pagefault_handler_register(mmap_fault) == 0) {
+		ukplat_paging_window(&win_base, &win_len);
+		mmap_mode = 1;
+		uk_pr_info("Mappings with demand paging in 0x%"__PRIuptr" - 0x%"__PRIuptr"\n",
+			   win_base, win_base + win_len);
+	} else {
+		mmap_mode = -1;
+		uk_pr_info("Mappings with preallocated memory\n");
+	}
+}
+
+static struct mmap_backing *backing_alloc(void)
+{
+	struct mmap_backing *b;
+
+	b = uk_calloc(mmap_alloc(), 1, sizeof(*b));
+	if (likely(b))
+		b->refs = 1;
+	return b;
+}
+
+/* Drops a VMA reference to a backing, releases it with the last one */
+static void backing_put(struct mmap_backing *b)
+{
+#if CONFIG_LIBVFSCORE
+	struct vnode *vp;
+#endif
+
+	UK_ASSERT(b && b->refs > 0);
+	if (--b->refs > 0)
+		return;
+
+	if (b->base)
+		uk_pfree(mmap_alloc(), b->base, b->num_pages);
+#if CONFIG_LIBVFSCORE
+	if (b->fp) {
+		vp = b->fp->f_dentry->d_vnode;
+		if (b->direct) {
+			vn_lock(vp);
+			VOP_MUNMAP(vp, b->fp, b->off, b->len);
+			vn_unlock(vp);
+		}
+		vfscore_put_file(b->fp);
+	}
+#endif
+	uk_free(mmap_alloc(), b);
+}
 
-UK_SYSCALL_DEFINE(int, munmap, void*, addr, size_t, len)
+/* Releases the memory of the VMAs [first, last) and removes them */
+static void vma_release(unsigned int first, unsigned int last)
 {
-	struct mmap_addr *tmp = mmap_addr, *prev = NULL;
-	size_t remain_mem;
+	unsigned int i;
 
-	if (!len) {
-		errno = EINVAL;
-		return -1;
+	for (i = first; i < last; ++i) {
+#if CONFIG_LIBVFSCORE
+		if (vma_file(&vmas[i]))
+			file_writeback(&vmas[i], vmas[i].start, vmas[i].end);
+#endif
+		if (mmap_paging() && !vma_direct(&vmas[i]))
+			ukplat_page_unmap(vmas[i].start,
+					  vmas[i].end - vmas[i].start,
+					  page_release, NULL);
+		if (vmas[i].backing)
+			backing_put(vmas[i].backing);
 	}
-	if (!addr)
+	vma_remove(first, last);
+}
+
+static int do_munmap(__uptr start, __sz len)
+{
+	unsigned int first, last;
+	int rc;
+
+	if (vma_range_free(start, start + len))
 		return 0;
-	while (tmp) {
-		if (addr != tmp->begin) {
-			if (tmp->end > addr + len) {
-				errno = EINVAL;
-				return -1;
-			}
-			remain_mem = tmp->end - addr - len;
-			if (remain_mem) {
-
-				void *mem = uk_malloc(uk_alloc_get_default(),
-						remain_mem);
-				if (!mem) {
-					errno = ENOMEM;
-					return -1;
-				}
-				memcpy(mem, addr+len, remain_mem);
-				tmp->begin = mem;
-			} else {
-
-				if (!prev)
-					mmap_addr = tmp->next;
-				else
-					prev->next = tmp->next;
-				uk_free(uk_alloc_get_default(), tmp);
-			}
-			uk_free(uk_alloc_get_default(), addr);
+
+	rc = vma_isolate(start, start + len, &first, &last);
+	if (unlikely(rc < 0))
+		return rc;
+
+	vma_release(first, last);
+	return 0;
+}
+
+/*
+ * Creates a VMA with backing memory for platforms without paging. The
+ * backing `b` is completed with the memory block.
+ */
+static int vma_create_backed(__sz len, int prot, int flags,
+			     struct mmap_backing *b, __uptr *addr)
+{
+	struct vma v;
+	unsigned int i;
+
+	if (unlikely(vma_reserve(1) < 0))
+		return -ENOMEM;
+
+	b->num_pages = len >> __PAGE_SHIFT;
+	b->base = uk_palloc(mmap_alloc(), b->num_pages);
+	if (unlikely(!b->base))
+		return -ENOMEM;
+	memset(b->base, 0, len);
+
+	v.start   = (__uptr) b->base;
+	v.end     = v.start + len;
+	v.prot    = prot;
+	v.flags   = flags;
+	v.backing = b;
+
+	i = vma_lookup(v.start);
+	UK_ASSERT(i == vma_count || vmas[i].start >= v.end);
+	vma_insert_at(i, &v);
+	*addr = v.start;
+	return 0;
+}
+
+/*
+ * Creates a VMA that reserves address space of the mapping window. Pages
+ * of file mappings (`b` refers to a file) are populated immediately.
+ */
+static int vma_create_reserved(__uptr hint, __sz len, int prot, int flags,
+			       struct mmap_backing *b, __uptr *addr)
+{
+	struct vma v;
+	unsigned int i;
+	int rc;
+
+	if (unlikely(vma_reserve(1) < 0))
+		return -ENOMEM;
+
+	if (flags & MAP_FIXED) {
+		v.start = hint;
+	} else {
+		v.start = vma_find_gap(hint, len);
+		if (unlikely(!v.start))
+			return -ENOMEM;
+	}
+	v.end     = v.start + len;
+	v.prot    = prot;
+	v.flags   = flags & ~(MAP_FIXED | MAP_FIXED_NOREPLACE | MAP_POPULATE);
+	v.backing = b;
+
+	i = vma_lookup(v.start);
+	UK_ASSERT(i == vma_count || vmas[i].start >= v.end);
+	vma_insert_at(i, &v);
+
+	if ((flags & (MAP_POPULATE | MAP_LOCKED)) || vma_file(&v)) {
+		rc = range_populate(v.start, v.end, prot, b);
+		if (unlikely(rc < 0)) {
+			/* The caller still owns the backing */
+			if (b)
+				b->refs++;
+			do_munmap(v.start, len);
+			return rc;
+		}
+	}
+
+	vma_merge(i, i + 1);
+	*addr = v.start;
+	return 0;
+}
+
+/* Replaces the mappings of a range that is covered by backed VMAs */
+static int vma_replace_backed(__uptr start, __sz len, int prot, int flags)
+{
+	unsigned int first, last, i;
+	int rc;
+
+	if (!vma_range_mapped(start, start + len))
+		return -ENOMEM;
+	for (i = vma_lookup(start); i < vma_count; ++i) {
+		if (vmas[i].start >= start + len)
+			break;
+		if (vma_file(&vmas[i]))
+			return -EINVAL;
+	}
+
+	rc = vma_isolate(start, start + len, &first, &last);
+	if (unlikely(rc < 0))
+		return rc;
+
+	for (i = first; i < last; ++i) {
+		vmas[i].prot  = prot;
+		vmas[i].flags = flags & ~(MAP_FIXED | MAP_FIXED_NOREPLACE);
+	}
+	memset((void *) start, 0, len);
+	vma_merge(first, last);
+	return 0;
+}
+
+#if CONFIG_LIBVFSCORE
+/* Maps the file data in place if the file system supports it */
+static int vma_create_direct(__sz len, int prot, int flags,
+			     struct mmap_backing *b, __uptr *addr)
+{
+	struct vnode *vp = b->fp->f_dentry->d_vnode;
+	void *data = NULL;
+	struct vma v;
+	unsigned int i;
+	int rc;
+
+	if (unlikely(vma_reserve(1) < 0))
+		return -ENOMEM;
+
+	vn_lock(vp);
+	rc = -VOP_MMAP(vp, b->fp, b->off, len, &data);
+	vn_unlock(vp);
+	if (rc < 0 || !data)
+		return rc;
+
+	/* The same file data may not be mapped twice in place */
+	v.start = (__uptr) data;
+	v.end   = v.start + len;
+	if (!vma_range_free(v.start, v.end)) {
+		vn_lock(vp);
+		VOP_MUNMAP(vp, b->fp, b->off, len);
+		vn_unlock(vp);
+		return 0;
+	}
+
+	v.prot    = prot;
+	v.flags   = flags;
+	v.backing = b;
+	b->direct = 1;
+	b->start  = v.start;
+
+	i = vma_lookup(v.start);
+	vma_insert_at(i, &v);
+	*addr = v.start;
+	return 0;
+}
+
+static int vma_create_file(__uptr hint, __sz len, int prot, int flags,
+			   int fd, off_t off, __uptr *addr)
+{
+	struct vfscore_file *fp;
+	struct mmap_backing *b;
+	struct vnode *vp;
+	int rc;
+
+	if (unlikely(off < 0 || (off & (__PAGE_SIZE - 1))))
+		return -EINVAL;
+	if (unlikely(fd < 0 || fd >= FDTABLE_MAX_FILES))
+		return -EBADF;
+
+	fp = vfscore_get_file(fd);
+	if (unlikely(!fp))
+		return -EBADF;
+
+	if (unlikely(!fp->f_dentry)) {
+		rc = -ENODEV;
+		goto err_put;
+	}
+	vp = fp->f_dentry->d_vnode;
+	if (unlikely(!vp->v_op->vop_mmap || !vp->v_op->vop_munmap)) {
+		rc = -ENODEV;
+		goto err_put;
+	}
+	if (unlikely(!(fp->f_flags & UK_FREAD)
+		     || ((flags & MAP_TYPE) != MAP_PRIVATE
+			 && (prot & PROT_WRITE)
+			 && !(fp->f_flags & UK_FWRITE)))) {
+		rc = -EACCES;
+		goto err_put;
+	}
+
+	b = backing_alloc();
+	if (unlikely(!b)) {
+		rc = -ENOMEM;
+		goto err_put;
+	}
+	b->fp  = fp;
+	b->off = off;
+	b->len = len;
+	b->writable = !!(prot & PROT_WRITE);
+
+	/*
+	 * Private writable mappings get a copy so that changes do not
+	 * reach the file
+	 */
+	*addr = 0;
+	if (!(flags & MAP_FIXED)
+	    && ((flags & MAP_TYPE) != MAP_PRIVATE || !(prot & PROT_WRITE))) {
+		rc = vma_create_direct(len, prot, flags, b, addr);
+		if (unlikely(rc < 0))
+			goto err_free;
+		if (*addr)
 			return 0;
+	}
+
+	if (mmap_paging()) {
+		rc = vma_create_reserved(hint, len, prot, flags, b, addr);
+		if (unlikely(rc < 0))
+			goto err_free;
+		b->start = *addr;
+		return 0;
+	}
+
+	if (flags & MAP_FIXED) {
+		rc = -EINVAL;
+		goto err_free;
+	}
+	rc = vma_create_backed(len, prot, flags, b, addr);
+	if (unlikely(rc < 0))
+		goto err_free;
+	b->start = *addr;
+	rc = file_io(fp, off, b->base,
+		     MIN((off_t) len, MAX((off_t) vp->v_size - off, 0)),
+		     UIO_READ);
+	if (unlikely(rc < 0)) {
+		/* Do not write the incomplete copy back to the file */
+		b->writable = 0;
+		do_munmap(*addr, len);
+		return rc;
+	}
+	return 0;
+
+err_free:
+	uk_free(mmap_alloc(), b);
+err_put:
+	vfscore_put_file(fp);
+	return rc;
+}
+#endif /* CONFIG_LIBVFSCORE */
+
+static void *do_mmap(void *addr, size_t len, int prot, int flags,
+		     int fd __maybe_unused, off_t off __maybe_unused)
+{
+	struct mmap_backing *b;
+	__uptr start = (__uptr) addr;
+	__uptr res;
+	int type = flags & MAP_TYPE;
+	int rc;
+
+	if (unlikely(!len))
+		return ERR2PTR(-EINVAL);
+	if (unlikely(type != MAP_PRIVATE && type != MAP_SHARED
+		     && type != MAP_SHARED_VALIDATE))
+		return ERR2PTR(-EINVAL);
+	if (unlikely((flags & (MAP_FIXED | MAP_FIXED_NOREPLACE))
+		     && round_pgdown(start) != start))
+		return ERR2PTR(-EINVAL);
+	if (unlikely(len > SIZE_MAX - __PAGE_SIZE))
+		return ERR2PTR(-ENOMEM);
+	len = round_pgup(len);
+
+#if !CONFIG_LIBVFSCORE
+	if (!(flags & MAP_ANON))
+		return ERR2PTR(-ENODEV);
+#endif
+
+	mmap_init();
+	if (mmap_paging() && unlikely(len > win_len))
+		return ERR2PTR(-ENOMEM);
+
+	if (flags & MAP_FIXED_NOREPLACE) {
+		if (!vma_range_free(start, start + len))
+			return ERR2PTR(-EEXIST);
+		flags |= MAP_FIXED;
+	}
+
+	if ((flags & MAP_FIXED) && !mmap_paging()) {
+		if (!(flags & MAP_ANON))
+			return ERR2PTR(-EINVAL);
+		rc = vma_replace_backed(start, len, prot, flags);
+		return (rc < 0) ? ERR2PTR(rc) : addr;
+	}
+
+	if (flags & MAP_FIXED) {
+		if (start < win_base || start - win_base > win_len - len)
+			return ERR2PTR(-ENOMEM);
+		rc = do_munmap(start, len);
+		if (unlikely(rc < 0))
+			return ERR2PTR(rc);
+	}
+
+#if CONFIG_LIBVFSCORE
+	if (!(flags & MAP_ANON)) {
+		rc = vma_create_file(start, len, prot, flags, fd, off, &res);
+		return (rc < 0) ? ERR2PTR(rc) : (void *) res;
+	}
+#endif
+
+	if (mmap_paging()) {
+		rc = vma_create_reserved(start, len, prot, flags, NULL, &res);
+		return (rc < 0) ? ERR2PTR(rc) : (void *) res;
+	}
+
+	b = backing_alloc();
+	if (unlikely(!b))
+		return ERR2PTR(-ENOMEM);
+	rc = vma_create_backed(len, prot, flags, b, &res);
+	if (unlikely(rc < 0)) {
+		uk_free(mmap_alloc(), b);
+		return ERR2PTR(rc);
+	}
+	return (void *) res;
+}
+
+UK_SYSCALL_R_DEFINE(void *, mmap, void *, addr, size_t, len, int, prot,
+		    int, flags, int, fd, off_t, off)
+{
+	return do_mmap(addr, len, prot, flags, fd, off);
+}
+
+UK_SYSCALL_R_DEFINE(int, munmap, void *, addr, size_t, len)
+{
+	__uptr start = (__uptr) addr;
+
+	if (unlikely(!len || round_pgdown(start) != start))
+		return -EINVAL;
+	if (unlikely(len > SIZE_MAX - __PAGE_SIZE))
+		return -EINVAL;
+
+	return do_munmap(start, round_pgup(len));
+}
+
+UK_SYSCALL_R_DEFINE(int, mprotect, void *, addr, size_t, len, int, prot)
+{
+	__uptr start = (__uptr) addr;
+	unsigned int first, last, i;
+	int rc;
+
+	if (unlikely(round_pgdown(start) != start))
+		return -EINVAL;
+	if (unlikely(len > SIZE_MAX - __PAGE_SIZE))
+		return -ENOMEM;
+	len = round_pgup(len);
+	if (!len)
+		return 0;
+
+	if (!vma_range_mapped(start, start + len))
+		return -ENOMEM;
+#if CONFIG_LIBVFSCORE
+	/*
+	 * Shared file mappings require write access to the file. Private
+	 * read-only mappings that use the file buffer in place have no copy
+	 * that could be written.
+	 */
+	i = (prot & PROT_WRITE) ? vma_lookup(start) : vma_count;
+	for (; i < vma_count && vmas[i].start < start + len; ++i) {
+		if (!vma_file(&vmas[i]))
+			continue;
+		if ((vmas[i].flags & MAP_TYPE) == MAP_PRIVATE) {
+			if (vma_direct(&vmas[i]))
+				return -EACCES;
+		} else if (!(vma_file(&vmas[i])->f_flags & UK_FWRITE)) {
+			return -EACCES;
 		}
-		prev = tmp;
-		tmp = tmp->next;
 	}
-	/* unimplemented munmap */
+#endif
+
+	rc = vma_isolate(start, start + len, &first, &last);
+	if (unlikely(rc < 0))
+		return rc;
+
+	for (i = first; i < last; ++i) {
+		vmas[i].prot = prot;
+#if CONFIG_LIBVFSCORE
+		if (vma_file(&vmas[i]) && (prot & PROT_WRITE))
+			vmas[i].backing->writable = 1;
+#endif
+	}
+	if (mmap_paging())
+		ukplat_page_set_prot(start, len, prot2plat(prot));
+
+	vma_merge(first, last);
+	return 0;
+}
+
+UK_SYSCALL_R_DEFINE(int, madvise, void *, addr, size_t, len, int, advice)
+{
+	__uptr start = (__uptr) addr;
+	__uptr end, s, e;
+	unsigned int i;
+
+	if (unlikely(round_pgdown(start) != start))
+		return -EINVAL;
+	if (unlikely(len > SIZE_MAX - __PAGE_SIZE))
+		return -EINVAL;
+	end = start + round_pgup(len);
+	if (!vma_range_mapped(start, end))
+		return -ENOMEM;
+	if (advice != MADV_DONTNEED && advice != MADV_FREE)
+		return 0; /* Hints without effect */
+
+	/* Only anonymous memory is discarded, it reads as zero afterwards */
+	for (i = vma_lookup(start); i < vma_count; ++i) {
+		if (vmas[i].start >= end)
+			break;
+		if (vma_file(&vmas[i]))
+			continue;
+
+		s = MAX(vmas[i].start, start);
+		e = MIN(vmas[i].end, end);
+		if (mmap_paging())
+			ukplat_page_unmap(s, e - s, page_release, NULL);
+		else if (advice == MADV_DONTNEED)
+			memset((void *) s, 0, e - s);
+	}
 	return 0;
 }
 
-void *mremap(void *old_address __unused, size_t old_size __unused,
-	     size_t new_size __unused, int flags __unused, ...)
+static void page_move(__uptr vaddr, __uptr paddr, void *cookie)
+{
+	__uptr delta = *((__uptr *) cookie);
+
+	if (unlikely(ukplat_page_map(vaddr + delta, paddr,
+				     UKPLAT_PAGE_PROT_NONE) < 0)) {
+		/* Content is lost, the page faults in again as zero page */
+		uk_pr_err("Failed to move page 0x%"__PRIuptr"\n", vaddr);
+		page_release(vaddr, paddr, NULL);
+	}
+}
+
+static void *do_mremap(__uptr old, size_t old_len, size_t new_len, int flags,
+		       __uptr new_addr)
 {
-	return NULL;
+	struct vma *v, nv;
+	__uptr res, delta;
+	unsigned int first, last, i;
+	int rc;
+
+	if (unlikely(round_pgdown(old) != old))
+		return ERR2PTR(-EINVAL);
+	if (unlikely(flags & ~(MREMAP_MAYMOVE | MREMAP_FIXED)))
+		return ERR2PTR(-EINVAL);
+	if (unlikely((flags & MREMAP_FIXED) && !(flags & MREMAP_MAYMOVE)))
+		return ERR2PTR(-EINVAL);
+	if (unlikely(!new_len || new_len > SIZE_MAX - __PAGE_SIZE
+		     || old_len > SIZE_MAX - __PAGE_SIZE))
+		return ERR2PTR(-EINVAL);
+	/* Duplicating shared mappings (old_len == 0) is not supported */
+	if (unlikely(!old_len))
+		return ERR2PTR(-EINVAL);
+	old_len = round_pgup(old_len);
+	new_len = round_pgup(new_len);
+	if (mmap_paging() && unlikely(new_len > win_len))
+		return ERR2PTR(-ENOMEM);
+
+	v = vma_find(old);
+	if (unlikely(!v || old + old_len > v->end))
+		return ERR2PTR(-EFAULT);
+
+	if (!(flags & MREMAP_FIXED) && new_len <= old_len) {
+		rc = do_munmap(old + new_len, old_len - new_len);
+		return (rc < 0) ? ERR2PTR(rc) : (void *) old;
+	}
+
+	/* Growing and moving file mappings is not supported */
+	if (vma_file(v))
+		return ERR2PTR(-EINVAL);
+
+	/* Grow in place */
+	if (!(flags & MREMAP_FIXED) && mmap_paging()
+	    && old + old_len == v->end
+	    && old + new_len - win_base <= win_len
+	    && vma_range_free(old + old_len, old + new_len)) {
+		v->end = old + new_len;
+		if (v->flags & MAP_LOCKED) {
+			rc = range_populate(old + old_len, old + new_len,
+					    v->prot, NULL);
+			if (unlikely(rc < 0)) {
+				do_munmap(old + old_len, new_len - old_len);
+				return ERR2PTR(rc);
+			}
+		}
+		return (void *) old;
+	}
+
+	if (!(flags & MREMAP_MAYMOVE))
+		return ERR2PTR(-ENOMEM);
+
+	nv = *v;
+	if (!mmap_paging()) {
+		if (flags & MREMAP_FIXED)
+			return ERR2PTR(-EINVAL);
+		res = (__uptr) do_mmap(NULL, new_len, nv.prot,
+				       nv.flags | MAP_ANON, -1, 0);
+		if (PTRISERR(res))
+			return (void *) res;
+		memcpy((void *) res, (void *) old, MIN(old_len, new_len));
+		do_munmap(old, old_len);
+		return (void *) res;
+	}
+
+	if (flags & MREMAP_FIXED) {
+		if (unlikely(round_pgdown(new_addr) != new_addr
+			     || (new_addr < old + old_len
+				 && old < new_addr + new_len)))
+			return ERR2PTR(-EINVAL);
+		if (unlikely(new_addr < win_base
+			     || new_addr - win_base > win_len - new_len))
+			return ERR2PTR(-ENOMEM);
+		rc = do_munmap(new_addr, new_len);
+		if (unlikely(rc < 0))
+			return ERR2PTR(rc);
+		res = new_addr;
+	} else {
+		res = vma_find_gap(0, new_len);
+		if (unlikely(!res))
+			return ERR2PTR(-ENOMEM);
+	}
+
+	/* Only the head of a shrinking mapping is moved, drop the tail */
+	if (new_len < old_len) {
+		rc = do_munmap(old + new_len, old_len - new_len);
+		if (unlikely(rc < 0))
+			return ERR2PTR(rc);
+		old_len = new_len;
+	}
+
+	/*
+	 * Reserve the new range, then move the frames over. A locked range is
+	 * only populated beyond the moved frames.
+	 */
+	rc = vma_create_reserved(res, new_len, nv.prot,
+				 (nv.flags & ~(MAP_POPULATE | MAP_LOCKED))
+				 | MAP_FIXED, NULL, &res);
+	if (unlikely(rc < 0))
+		return ERR2PTR(rc);
+	if (nv.flags & MAP_LOCKED) {
+		rc = vma_isolate(res, res + new_len, &first, &last);
+		if (likely(rc == 0)) {
+			for (i = first; i < last; ++i)
+				vmas[i].flags |= MAP_LOCKED;
+			vma_merge(first, last);
+			rc = range_populate(res + old_len, res + new_len,
+					    nv.prot, NULL);
+		}
+		if (unlikely(rc < 0)) {
+			do_munmap(res, new_len);
+			return ERR2PTR(rc);
+		}
+	}
+
+	delta = res - old;
+	ukplat_page_unmap(old, old_len, page_move, &delta);
+	ukplat_page_set_prot(res, old_len, prot2plat(nv.prot));
+
+	rc = vma_isolate(old, old + old_len, &first, &last);
+	if (likely(rc == 0))
+		vma_release(first, last);
+	return (void *) res;
+}
+
+UK_LLSYSCALL_R_DEFINE(void *, mremap, void *, old_address, size_t, old_size,
+		      size_t, new_size, int, flags, void *, new_address)
+{
+	return do_mremap((__uptr) old_address, old_size, new_size, flags,
+			 (__uptr) new_address);
+}
+
+#if UK_LIBC_SYSCALLS
+void *mremap(void *old_address, size_t old_size, size_t new_size, int flags,
+	     ...)
+{
+	void *new_address = NULL;
+	long ret;
+	va_list ap;
+
+	if (flags & MREMAP_FIXED) {
+		va_start(ap, flags);
+		new_address = va_arg(ap, void *);
+		va_end(ap);
+	}
+
+	ret = uk_syscall_e_mremap((long) old_address, (long) old_size,
+				  (long) new_size, (long) flags,
+				  (long) new_address);
+	return (ret == -1) ? MAP_FAILED : (void *) ret;
 }
+#endif /* UK_LIBC_SYSCALLS */
@@ -0,0 +1,595 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Packet capture on uknetdev queues
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Captured packets are copied into records of a fixed size. Records cycle
+ * between two lock-free rings: Producers (the receive and transmit
+ * functions) take a record from the free ring, fill it and put it to the
+ * ready ring. The consumer (flush thread or uk_netdev_capture_flush())
+ * writes the ready records as pcapng Enhanced Packet Blocks to the sink and
+ * returns them to the free ring. Since a ring holds one entry less than its
+ * size, nb_records - 1 records are allocated and both rings never overflow.
+ */
+
+#define _GNU_SOURCE /* for asprintf() */
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <uk/netdev.h>
+#include <uk/netdev_capture.h>
+#include <uk/ring.h>
+#include <uk/print.h>
+#include <uk/plat/time.h>
+#include <uk/plat/console.h>
+#include <uk/arch/lcpu.h>
+#include <uk/arch/atomic.h>
+#if CONFIG_LIBVFSCORE
+#include <unistd.h>
+#endif
+
+#define CAPTURE_ALIGN(len)	ALIGN_UP((len), 4)
+#define CAPTURE_FLUSH_INTERVAL	ukarch_time_msec_to_nsec(10)
+
+/* pcapng block types and options */
+#define PCAPNG_SHB		0x0A0D0D0A
+#define PCAPNG_IDB		0x00000001
+#define PCAPNG_EPB		0x00000006
+#define PCAPNG_BYTE_ORDER	0x1A2B3C4D
+#define PCAPNG_LINKTYPE_ETH	1
+#define PCAPNG_OPT_END		0
+#define PCAPNG_OPT_IF_NAME	2
+#define PCAPNG_OPT_IF_TSRESOL	9
+#define PCAPNG_OPT_EPB_FLAGS	2
+#define PCAPNG_OPT_EPB_QUEUE	6
+#define PCAPNG_EPB_INBOUND	0x1
+#define PCAPNG_EPB_OUTBOUND	0x2
+
+/* EPB header, options (flags, queue, end) and trailer */
+#define CAPTURE_EPB_HDR_LEN	28
+#define CAPTURE_EPB_TAIL_LEN	24
+#define CAPTURE_IFNAME_LEN	16
+
+struct capture_rec {
+	__nsec ts;
+	uint32_t origlen;
+	uint16_t caplen;
+	uint16_t queue_id;
+	uint32_t flags;
+	uint8_t data[];
+};
+
+struct uk_netdev_capture {
+	struct uk_alloc *a;
+	uint16_t snaplen;
+	size_t rec_size;
+	void *recs;
+	struct uk_ring *free;
+	struct uk_ring *ready;
+
+	/* Rate limit */
+	uint32_t rate;
+	__nsec window;
+	uint32_t window_count;
+
+	uk_netdev_capture_write_t write;
+	void *write_cookie;
+	int write_error;
+	uint8_t *block;       /* EPB that is written to the sink */
+	struct uk_netdev_capture_stats stats;
+
+#ifdef CONFIG_LIBUKSCHED
+	struct uk_thread *flusher;
+	char *flusher_name;
+	int stop;
+#endif
+};
+
+static int capture_write(struct uk_netdev_capture *cap, const void *buf,
+			 size_t len)
+{
+	const uint8_t *p = buf;
+	ssize_t ret;
+
+	if (unlikely(cap->write_error))
+		return cap->write_error;
+
+	while (len) {
+		ret = cap->write(cap->write_cookie, p, len);
+		if (unlikely(ret <= 0)) {
+			cap->write_error = (ret < 0) ? (int) ret : -EIO;
+			uk_pr_err("Packet capture stopped writing: %d\n",
+				  cap->write_error);
+			return cap->write_error;
+		}
+		p += ret;
+		len -= ret;
+		cap->stats.bytes += ret;
+	}
+	return 0;
+}
+
+static inline uint8_t *capture_put32(uint8_t *p, uint32_t val)
+{
+	memcpy(p, &val, sizeof(val));
+	return p + sizeof(val);
+}
+
+static inline uint8_t *capture_put16(uint8_t *p, uint16_t val)
+{
+	memcpy(p, &val, sizeof(val));
+	return p + sizeof(val);
+}
+
+static int capture_write_headers(struct uk_netdev_capture *cap,
+				 struct uk_netdev *dev)
+{
+	uint8_t buf[64];
+	char ifname[CAPTURE_IFNAME_LEN];
+	uint8_t *p;
+	size_t namelen;
+	uint32_t blen;
+	int rc;
+
+	/* Section Header Block */
+	p = buf;
+	p = capture_put32(p, PCAPNG_SHB);
+	p = capture_put32(p, 28);
+	p = capture_put32(p, PCAPNG_BYTE_ORDER);
+	p = capture_put16(p, 1);
+	p = capture_put16(p, 0);
+	/* Section length is not specified */
+	p = capture_put32(p, UINT32_MAX);
+	p = capture_put32(p, UINT32_MAX);
+	p = capture_put32(p, 28);
+	rc = capture_write(cap, buf, p - buf);
+	if (unlikely(rc < 0))
+		return rc;
+
+	/* Interface Description Block, timestamps in nanoseconds */
+	namelen = snprintf(ifname, sizeof(ifname), "netdev%"PRIu16,
+			   dev->_data->id);
+	blen = 20 + 4 + CAPTURE_ALIGN(namelen) + 8 + 4;
+	memset(buf, 0, sizeof(buf));
+	p = buf;
+	p = capture_put32(p, PCAPNG_IDB);
+	p = capture_put32(p, blen);
+	p = capture_put16(p, PCAPNG_LINKTYPE_ETH);
+	p = capture_put16(p, 0);
+	p = capture_put32(p, cap->snaplen);
+	p = capture_put16(p, PCAPNG_OPT_IF_NAME);
+	p = capture_put16(p, namelen);
+	memcpy(p, ifname, namelen);
+	p += CAPTURE_ALIGN(namelen);
+	p = capture_put16(p, PCAPNG_OPT_IF_TSRESOL);
+	p = capture_put16(p, 1);
+	*p = 9;
+	p += 4;
+	p = capture_put32(p, PCAPNG_OPT_END);
+	p = capture_put32(p, blen);
+	UK_ASSERT((size_t) (p - buf) == blen);
+	return capture_write(cap, buf, blen);
+}
+
+static int capture_write_rec(struct uk_netdev_capture *cap,
+			     struct capture_rec *rec)
+{
+	uint8_t *p = cap->block;
+	uint32_t blen;
+
+	blen = CAPTURE_EPB_HDR_LEN + CAPTURE_ALIGN(rec->caplen)
+	       + CAPTURE_EPB_TAIL_LEN;
+	p = capture_put32(p, PCAPNG_EPB);
+	p = capture_put32(p, blen);
+	p = capture_put32(p, 0);
+	p = capture_put32(p, (uint32_t) (rec->ts >> 32));
+	p = capture_put32(p, (uint32_t) rec->ts);
+	p = capture_put32(p, rec->caplen);
+	p = capture_put32(p, rec->origlen);
+	memcpy(p, rec->data, rec->caplen);
+	memset(p + rec->caplen, 0, CAPTURE_ALIGN(rec->caplen) - rec->caplen);
+	p += CAPTURE_ALIGN(rec->caplen);
+	p = capture_put16(p, PCAPNG_OPT_EPB_FLAGS);
+	p = capture_put16(p, 4);
+	p = capture_put32(p, rec->flags);
+	p = capture_put16(p, PCAPNG_OPT_EPB_QUEUE);
+	p = capture_put16(p, 4);
+	p = capture_put32(p, rec->queue_id);
+	p = capture_put32(p, PCAPNG_OPT_END);
+	p = capture_put32(p, blen);
+	UK_ASSERT((uint32_t) (p - cap->block) == blen);
+	return capture_write(cap, cap->block, blen);
+}
+
+static int capture_flush(struct uk_netdev_capture *cap)
+{
+	struct capture_rec *rec;
+	int count = 0;
+	int rc;
+
+	while ((rec = uk_ring_dequeue_sc(cap->ready)) != NULL) {
+		rc = capture_write_rec(cap, rec);
+		uk_ring_enqueue(cap->free, rec);
+		if (unlikely(rc < 0))
+			return rc;
+		cap->stats.captured++;
+		count++;
+	}
+	return count;
+}
+
+/**
+ * Takes a free record and copies the packet into it, or returns NULL when
+ * the packet is not captured.
+ */
+static struct capture_rec *capture_rec_fill(struct uk_netdev_capture *cap,
+					    uint16_t queue_id, uint32_t flags,
+					    struct uk_netbuf *pkt)
+{
+	struct capture_rec *rec;
+	struct uk_netbuf *m;
+	__nsec now;
+	size_t len;
+
+	now = ukplat_wall_clock();
+	if (cap->rate) {
+		/* Approximate with concurrent producers, that is fine */
+		if (now - cap->window >= UKARCH_NSEC_PER_SEC) {
+			cap->window = now;
+			cap->window_count = 0;
+		}
+		if (cap->window_count >= cap->rate) {
+			cap->stats.rate_limited++;
+			return NULL;
+		}
+		cap->window_count++;
+	}
+
+	rec = uk_ring_dequeue_mc(cap->free);
+	if (unlikely(!rec)) {
+		cap->stats.ring_full++;
+		return NULL;
+	}
+
+	rec->ts = now;
+	rec->origlen = 0;
+	rec->caplen = 0;
+	rec->queue_id = queue_id;
+	rec->flags = flags;
+	UK_NETBUF_CHAIN_FOREACH(m, pkt) {
+		len = MIN((size_t) m->len,
+			  (size_t) (cap->snaplen - rec->caplen));
+		memcpy(&rec->data[rec->caplen], m->data, len);
+		rec->caplen += len;
+		rec->origlen += m->len;
+	}
+	return rec;
+}
+
+/* The hooks announce themselves in `capture_users` before they load the
+ * capture, so that uk_netdev_capture_stop() can wait until no hook uses the
+ * capture anymore before it is freed. The capture may be gone already when a
+ * hook was entered.
+ */
+static inline struct uk_netdev_capture *capture_get(struct uk_netdev *dev)
+{
+	struct uk_netdev_capture *cap;
+
+	ukarch_inc(&dev->_data->capture_users);
+	cap = ukarch_load_n(&dev->_data->capture);
+	if (unlikely(!cap))
+		ukarch_dec(&dev->_data->capture_users);
+	return cap;
+}
+
+static inline void capture_put(struct uk_netdev *dev)
+{
+	ukarch_dec(&dev->_data->capture_users);
+}
+
+void _uk_netdev_capture_rx(struct uk_netdev *dev, uint16_t queue_id,
+			   struct uk_netbuf *pkt[], uint16_t cnt)
+{
+	struct uk_netdev_capture *cap;
+	struct capture_rec *rec;
+	uint16_t i;
+
+	cap = capture_get(dev);
+	if (unlikely(!cap))
+		return;
+
+	for (i = 0; i < cnt; i++) {
+		rec = capture_rec_fill(cap, queue_id, PCAPNG_EPB_INBOUND,
+				       pkt[i]);
+		if (rec)
+			uk_ring_enqueue(cap->ready, rec);
+	}
+	capture_put(dev);
+}
+
+int _uk_netdev_capture_tx_one(struct uk_netdev *dev, uint16_t queue_id,
+			      struct uk_netbuf *pkt)
+{
+	struct uk_netdev_capture *cap;
+	struct capture_rec *rec;
+	int rc;
+
+	cap = capture_get(dev);
+	if (unlikely(!cap))
+		return dev->tx_one(dev, dev->_tx_queue[queue_id], pkt);
+
+	/* The packet may be gone after it was handed over to the driver */
+	rec = capture_rec_fill(cap, queue_id, PCAPNG_EPB_OUTBOUND, pkt);
+	rc = dev->tx_one(dev, dev->_tx_queue[queue_id], pkt);
+	if (rec)
+		uk_ring_enqueue(uk_netdev_status_successful(rc)
+				? cap->ready : cap->free, rec);
+	capture_put(dev);
+	return rc;
+}
+
+int _uk_netdev_capture_tx_burst(struct uk_netdev *dev, uint16_t queue_id,
+				struct uk_netbuf *pkt[], uint16_t *cnt)
+{
+	struct uk_netdev_capture *cap;
+	struct capture_rec *rec[CONFIG_LIBUKNETDEV_CAPTURE_BURST];
+	uint16_t total = 0;
+	uint16_t i, n, sent;
+	int rc = 0;
+
+	cap = capture_get(dev);
+	if (unlikely(!cap))
+		return dev->tx_burst(dev, dev->_tx_queue[queue_id], pkt, cnt);
+
+	/* Transmit in chunks for which records are filled in advance */
+	while (total < *cnt) {
+		n = MIN(*cnt - total, CONFIG_LIBUKNETDEV_CAPTURE_BURST);
+		for (i = 0; i < n; i++)
+			rec[i] = capture_rec_fill(cap, queue_id,
+						  PCAPNG_EPB_OUTBOUND,
+						  pkt[total + i]);
+
+		sent = n;
+		rc = dev->tx_burst(dev, dev->_tx_queue[queue_id],
+				   &pkt[total], &sent);
+		if (unlikely(rc < 0))
+			sent = 0;
+		for (i = 0; i < n; i++) {
+			if (rec[i])
+				uk_ring_enqueue(i < sent ? cap->ready
+						: cap->free, rec[i]);
+		}
+		total += sent;
+		if (sent < n)
+			break;
+	}
+	capture_put(dev);
+
+	*cnt = total;
+	/* Report an error only if nothing was sent */
+	if (rc < 0 && total > 0)
+		rc = UK_NETDEV_STATUS_SUCCESS;
+	return rc;
+}
+
+#ifdef CONFIG_LIBUKSCHED
+static void capture_flusher(void *arg)
+{
+	struct uk_netdev_capture *cap = arg;
+
+	while (!ukarch_load_n(&cap->stop)) {
+		if (capture_flush(cap) <= 0)
+			uk_sched_thread_sleep(CAPTURE_FLUSH_INTERVAL);
+	}
+}
+#endif
+
+static void capture_free(struct uk_netdev_capture *cap)
+{
+	if (cap->ready)
+		uk_ring_free(cap->ready, cap->a);
+	if (cap->free)
+		uk_ring_free(cap->free, cap->a);
+	if (cap->recs)
+		uk_free(cap->a, cap->recs);
+	if (cap->block)
+		uk_free(cap->a, cap->block);
+#ifdef CONFIG_LIBUKSCHED
+	if (cap->flusher_name)
+		free(cap->flusher_name);
+#endif
+	uk_free(cap->a, cap);
+}
+
+int uk_netdev_capture_start(struct uk_netdev *dev,
+			    const struct uk_netdev_capture_conf *conf)
+{
+	struct uk_netdev_capture *cap;
+	uint16_t nb_records;
+	uint16_t i;
+	int rc;
+
+	UK_ASSERT(dev);
+	UK_ASSERT(dev->_data);
+	UK_ASSERT(conf);
+	UK_ASSERT(conf->a);
+	UK_ASSERT(conf->write);
+
+	if (dev->_data->capture)
+		return -EBUSY;
+
+	nb_records = conf->nb_records ? conf->nb_records
+		     : CONFIG_LIBUKNETDEV_CAPTURE_RECORDS;
+	if (unlikely(nb_records < 2 || (nb_records & (nb_records - 1))))
+		return -EINVAL;
+
+	cap = uk_calloc(conf->a, 1, sizeof(*cap));
+	if (!cap)
+		return -ENOMEM;
+	cap->a = conf->a;
+	cap->snaplen = conf->snaplen ? conf->snaplen
+		       : CONFIG_LIBUKNETDEV_CAPTURE_SNAPLEN;
+	cap->rate = conf->rate;
+	cap->write = conf->write;
+	cap->write_cookie = conf->write_cookie;
+
+	rc = -ENOMEM;
+	cap->rec_size = ALIGN_UP(sizeof(struct capture_rec) + cap->snaplen,
+				 sizeof(__nsec));
+	cap->recs = uk_malloc(cap->a, cap->rec_size * (nb_records - 1));
+	cap->block = uk_malloc(cap->a, CAPTURE_EPB_HDR_LEN
+			       + CAPTURE_ALIGN(cap->snaplen)
+			       + CAPTURE_EPB_TAIL_LEN);
+	cap->free = uk_ring_alloc(nb_records, cap->a);
+	cap->ready = uk_ring_alloc(nb_records, cap->a);
+	if (!cap->recs || !cap->block || !cap->free || !cap->ready)
+		goto err_free;
+	for (i = 0; i < nb_records - 1; i++)
+		uk_ring_enqueue(cap->free,
+				(uint8_t *) cap->recs + i * cap->rec_size);
+
+	rc = capture_write_headers(cap, dev);
+	if (rc < 0)
+		goto err_free;
+
+#ifdef CONFIG_LIBUKSCHED
+	if (conf->s) {
+		/* In case of errors, we just continue without a name */
+		if (asprintf(&cap->flusher_name, "netdev%"PRIu16"-capture",
+			     dev->_data->id) < 0)
+			cap->flusher_name = NULL;
+		cap->flusher = uk_sched_thread_create(conf->s,
+						      cap->flusher_name, NULL,
+						      capture_flusher, cap);
+		if (!cap->flusher) {
+			rc = -ENOMEM;
+			goto err_free;
+		}
+	}
+#endif
+
+	barrier();
+	ukarch_store_n(&dev->_data->capture, cap);
+	uk_pr_info("netdev%"PRIu16": Started packet capture\n",
+		   dev->_data->id);
+	return 0;
+
+err_free:
+	capture_free(cap);
+	return rc;
+}
+
+int uk_netdev_capture_stop(struct uk_netdev *dev)
+{
+	struct uk_netdev_capture *cap;
+
+	UK_ASSERT(dev);
+	UK_ASSERT(dev->_data);
+
+	cap = ukarch_exchange_n(&dev->_data->capture, NULL);
+	if (!cap)
+		return -EINVAL;
+
+	/* Wait until no receive or transmit function uses the capture */
+	while (ukarch_load_n(&dev->_data->capture_users))
+#ifdef CONFIG_LIBUKSCHED
+		uk_sched_yield();
+#else
+		ukarch_spinwait();
+#endif
+
+#ifdef CONFIG_LIBUKSCHED
+	if (cap->flusher) {
+		ukarch_store_n(&cap->stop, 1);
+		uk_thread_wait(cap->flusher);
+	}
+#endif
+	capture_flush(cap);
+
+	uk_pr_info("netdev%"PRIu16": Stopped packet capture\n",
+		   dev->_data->id);
+	capture_free(cap);
+	return 0;
+}
+
+int uk_netdev_capture_flush(struct uk_netdev *dev)
+{
+	UK_ASSERT(dev);
+	UK_ASSERT(dev->_data);
+
+	if (!dev->_data->capture)
+		return -EINVAL;
+	return capture_flush(dev->_data->capture);
+}
+
+int uk_netdev_capture_stats_get(struct uk_netdev *dev,
+				struct uk_netdev_capture_stats *stats)
+{
+	UK_ASSERT(dev);
+	UK_ASSERT(dev->_data);
+	UK_ASSERT(stats);
+
+	if (!dev->_data->capture)
+		return -EINVAL;
+	*stats = dev->_data->capture->stats;
+	return 0;
+}
+
+ssize_t uk_netdev_capture_write_console(void *cookie __unused,
+					const void *buf, size_t len)
+{
+	static const char hex[] = "0123456789abcdef";
+	const uint8_t *p = buf;
+	char line[8 + 2 * 32 + 1];
+	size_t i, n, off;
+
+	memcpy(line, "pcapng: ", 8);
+	for (off = 0; off < len; off += n) {
+		n = MIN(len - off, (size_t) 32);
+		for (i = 0; i < n; i++) {
+			line[8 + 2 * i] = hex[p[off + i] >> 4];
+			line[8 + 2 * i + 1] = hex[p[off + i] & 0xf];
+		}
+		line[8 + 2 * n] = '\n';
+		ukplat_coutk(line, 8 + 2 * n + 1);
+	}
+	return len;
+}
+
+#if CONFIG_LIBVFSCORE
+ssize_t uk_netdev_capture_write_fd(void *cookie, const void *buf, size_t len)
+{
+	ssize_t ret;
+
+	ret = write((int) (intptr_t) cookie, buf, len);
+	return (ret < 0) ? -errno : ret;
+}
+#endif
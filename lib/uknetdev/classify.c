@@ -0,0 +1,348 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Receive classifiers for uknetdev queues
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <uk/netdev.h>
+#include <uk/netdev_driver.h>
+#include <uk/netdev_classify.h>
+#include <uk/ring.h>
+#include <uk/arch/lcpu.h>
+
+/* Replies that are collected before they are sent as burst */
+#define CLASSIFY_TX_BURST	32
+
+#define CLASSIFY_ETH_HDR_LEN	14
+#define CLASSIFY_ETH_P_IPV4	0x0800
+#define CLASSIFY_ETH_P_ARP	0x0806
+#define CLASSIFY_ARP_LEN	28
+#define CLASSIFY_ARP_REQUEST	1
+#define CLASSIFY_ARP_REPLY	2
+#define CLASSIFY_IPV4_HDR_MINLEN	20
+#define CLASSIFY_IPV4_FRAG_MASK	0x3fff /* MF flag and fragment offset */
+#define CLASSIFY_IPPROTO_ICMP	1
+#define CLASSIFY_ICMP_ECHO_REPLY	0
+#define CLASSIFY_ICMP_ECHO	8
+
+int uk_netdev_rxq_classifier_set(struct uk_netdev *dev, uint16_t queue_id,
+				 uk_netdev_rx_classifier_t classifier,
+				 void *cookie)
+{
+	struct uk_netdev_rxq_classifier *c;
+
+	UK_ASSERT(dev);
+	UK_ASSERT(dev->_data);
+	UK_ASSERT(queue_id < CONFIG_LIBUKNETDEV_MAXNBQUEUES);
+
+	c = &dev->_data->rxq_classifier[queue_id];
+	if (unlikely(!c->backlog))
+		return -EINVAL;
+
+	/* The cookie has to be valid before a receive call sees fn */
+	c->cookie = cookie;
+	barrier();
+	c->fn = classifier;
+	return 0;
+}
+
+/**
+ * Hands a packet over to the backlog of another queue. A queue in interrupt
+ * mode gets its driver interrupts disabled until it drained the backlog so
+ * that the event is not lost in between. Without dispatcher threads, the
+ * event would run the callback of the queue nested in this receive call, so
+ * packets can only be redirected to queues that are polled.
+ */
+static int classify_redirect(struct uk_netdev *dev, uint16_t queue_id,
+			     struct uk_netbuf *pkt)
+{
+	struct uk_netdev_rxq_classifier *c;
+
+	if (unlikely(queue_id >= CONFIG_LIBUKNETDEV_MAXNBQUEUES))
+		return -EINVAL;
+	c = &dev->_data->rxq_classifier[queue_id];
+	if (unlikely(!c->backlog))
+		return -EINVAL;
+#ifndef CONFIG_LIBUKNETDEV_DISPATCHERTHREADS
+	if (unlikely(c->intr_user))
+		return -ENOTSUP;
+#endif
+	if (unlikely(uk_ring_enqueue(c->backlog, pkt) != 0))
+		return -ENOBUFS;
+
+	if (c->intr_user && !c->intr_paused) {
+		c->intr_paused = 1;
+		if (dev->ops->rxq_intr_disable)
+			dev->ops->rxq_intr_disable(dev,
+						   dev->_rx_queue[queue_id]);
+		uk_netdev_drv_rx_event(dev, queue_id);
+	}
+	return 0;
+}
+
+static void classify_reply(struct uk_netdev *dev, uint16_t queue_id,
+			   struct uk_netbuf *pkt[], uint16_t cnt)
+{
+	uint16_t sent = cnt;
+	int rc = -EINVAL;
+
+	if (likely(!PTRISERR(dev->_tx_queue[queue_id])))
+		rc = uk_netdev_tx_burst(dev, queue_id, pkt, &sent);
+	if (unlikely(rc < 0))
+		sent = 0;
+	if (unlikely(sent < cnt)) {
+		uk_netdev_drv_rxq_stats_add(dev, queue_id, drops, cnt - sent);
+		for (; sent < cnt; sent++)
+			uk_netbuf_free(pkt[sent]);
+	}
+}
+
+int _uk_netdev_rxq_classify(struct uk_netdev *dev, uint16_t queue_id,
+			    struct uk_netbuf *pkt[], uint16_t *cnt,
+			    uint16_t len, int status)
+{
+	struct uk_netdev_rxq_classifier *c;
+	struct uk_netbuf *reply[CLASSIFY_TX_BURST];
+	uk_netdev_rx_classifier_t fn;
+	uint16_t nb_reply = 0;
+	uint16_t i, n = 0;
+	uint16_t target;
+	int rc;
+
+	UK_ASSERT(dev);
+	UK_ASSERT(dev->_data);
+	UK_ASSERT(pkt && cnt);
+	UK_ASSERT(*cnt <= len);
+
+	c = &dev->_data->rxq_classifier[queue_id];
+	fn = c->fn;
+	if (!fn) {
+		n = *cnt;
+		goto backlog;
+	}
+
+	for (i = 0; i < *cnt; i++) {
+		target = queue_id;
+		switch (fn(dev, queue_id, pkt[i], &target, c->cookie)) {
+		case UK_NETDEV_RX_PASS:
+			pkt[n++] = pkt[i];
+			break;
+		case UK_NETDEV_RX_REDIRECT:
+			if (target == queue_id) {
+				pkt[n++] = pkt[i];
+				break;
+			}
+			if (likely(classify_redirect(dev, target, pkt[i]) == 0))
+				break;
+			/* fall through */
+		case UK_NETDEV_RX_DROP:
+			uk_netdev_drv_rxq_stats_add(dev, queue_id, drops, 1);
+			uk_netbuf_free(pkt[i]);
+			break;
+		case UK_NETDEV_RX_TX:
+			reply[nb_reply++] = pkt[i];
+			if (nb_reply == CLASSIFY_TX_BURST) {
+				classify_reply(dev, queue_id, reply, nb_reply);
+				nb_reply = 0;
+			}
+			break;
+		case UK_NETDEV_RX_STOLEN:
+			break;
+		default:
+			UK_CRASH("Invalid classifier verdict\n");
+		}
+	}
+	if (nb_reply)
+		classify_reply(dev, queue_id, reply, nb_reply);
+
+backlog:
+	/* Packets that were redirected to this queue */
+	while (n < len && !uk_ring_empty(c->backlog))
+		pkt[n++] = uk_ring_dequeue_sc(c->backlog);
+
+	/**
+	 * Interrupts that were disabled for a redirect are enabled again
+	 * before the backlog is checked a last time so that no packet is
+	 * left behind.
+	 */
+	if (c->intr_paused && !(status & UK_NETDEV_STATUS_MORE)) {
+		c->intr_paused = 0;
+		barrier();
+		rc = dev->ops->rxq_intr_enable(dev, dev->_rx_queue[queue_id]);
+		if (rc > 0)
+			status |= UK_NETDEV_STATUS_MORE;
+	}
+	if (!uk_ring_empty(c->backlog))
+		status |= UK_NETDEV_STATUS_MORE;
+
+	*cnt = n;
+	if (n)
+		status |= UK_NETDEV_STATUS_SUCCESS;
+	else
+		status &= ~UK_NETDEV_STATUS_SUCCESS;
+	return status;
+}
+
+int _uk_netdev_rxq_classify_one(struct uk_netdev *dev, uint16_t queue_id,
+				struct uk_netbuf **pkt, int status)
+{
+	uint16_t cnt;
+
+	for (;;) {
+		cnt = (status & UK_NETDEV_STATUS_SUCCESS) ? 1 : 0;
+		status = _uk_netdev_rxq_classify(dev, queue_id, pkt, &cnt, 1,
+						 status);
+		if (cnt || !(status & UK_NETDEV_STATUS_MORE))
+			return status;
+
+		/* The packet was consumed, receive the next one */
+		status = dev->rx_one(dev, dev->_rx_queue[queue_id], pkt);
+		if (unlikely(status < 0))
+			return status;
+	}
+}
+
+int _uk_netdev_rxq_intr_enabled(struct uk_netdev *dev, uint16_t queue_id,
+				int rc)
+{
+	struct uk_netdev_rxq_classifier *c;
+
+	if (rc < 0)
+		return rc;
+
+	c = &dev->_data->rxq_classifier[queue_id];
+	c->intr_user = 1;
+	c->intr_paused = 0;
+	barrier();
+	/* Redirected packets are pending like received ones */
+	if (rc == 0 && c->backlog && !uk_ring_empty(c->backlog))
+		rc = 1;
+	return rc;
+}
+
+static inline uint16_t classify_read16(const uint8_t *p)
+{
+	return (uint16_t) ((p[0] << 8) | p[1]);
+}
+
+static inline void classify_write16(uint8_t *p, uint16_t val)
+{
+	p[0] = (uint8_t) (val >> 8);
+	p[1] = (uint8_t) val;
+}
+
+static void classify_swap(uint8_t *a, uint8_t *b, size_t len)
+{
+	uint8_t tmp[UK_NETDEV_HWADDR_LEN];
+
+	UK_ASSERT(len <= sizeof(tmp));
+
+	memcpy(tmp, a, len);
+	memcpy(a, b, len);
+	memcpy(b, tmp, len);
+}
+
+enum uk_netdev_rx_verdict uk_netdev_rx_classify_echo(
+		struct uk_netdev *dev, uint16_t queue_id __unused,
+		struct uk_netbuf *pkt, uint16_t *redirect __unused,
+		void *cookie)
+{
+	const struct uk_netdev_echo_conf *conf = cookie;
+	const struct uk_hwaddr *hwaddr;
+	uint8_t *p;
+	size_t len, hlen;
+	uint32_t sum;
+
+	UK_ASSERT(pkt);
+	UK_ASSERT(conf);
+
+	p = pkt->data;
+	len = pkt->len;
+	if (unlikely(len < CLASSIFY_ETH_HDR_LEN))
+		return UK_NETDEV_RX_PASS;
+
+	switch (classify_read16(&p[12])) {
+	case CLASSIFY_ETH_P_ARP:
+		p += CLASSIFY_ETH_HDR_LEN;
+		len -= CLASSIFY_ETH_HDR_LEN;
+		/* Ethernet/IPv4 request for our address */
+		if (len < CLASSIFY_ARP_LEN
+		    || classify_read16(&p[0]) != 1
+		    || classify_read16(&p[2]) != CLASSIFY_ETH_P_IPV4
+		    || p[4] != UK_NETDEV_HWADDR_LEN || p[5] != 4
+		    || classify_read16(&p[6]) != CLASSIFY_ARP_REQUEST
+		    || memcmp(&p[24], &conf->ipv4_addr, 4) != 0)
+			return UK_NETDEV_RX_PASS;
+
+		hwaddr = uk_netdev_hwaddr_get(dev);
+		if (unlikely(!hwaddr))
+			return UK_NETDEV_RX_PASS;
+		classify_write16(&p[6], CLASSIFY_ARP_REPLY);
+		memcpy(&p[18], &p[8], UK_NETDEV_HWADDR_LEN + 4);
+		memcpy(&p[8], hwaddr->addr_bytes, UK_NETDEV_HWADDR_LEN);
+		memcpy(&p[14], &conf->ipv4_addr, 4);
+		break;
+	case CLASSIFY_ETH_P_IPV4:
+		p += CLASSIFY_ETH_HDR_LEN;
+		len -= CLASSIFY_ETH_HDR_LEN;
+		if (len < CLASSIFY_IPV4_HDR_MINLEN)
+			return UK_NETDEV_RX_PASS;
+		hlen = (p[0] & 0x0f) * 4;
+		if (hlen < CLASSIFY_IPV4_HDR_MINLEN || len < hlen + 8
+		    || p[9] != CLASSIFY_IPPROTO_ICMP
+		    || (classify_read16(&p[6]) & CLASSIFY_IPV4_FRAG_MASK)
+		    || memcmp(&p[16], &conf->ipv4_addr, 4) != 0
+		    || p[hlen] != CLASSIFY_ICMP_ECHO || p[hlen + 1] != 0)
+			return UK_NETDEV_RX_PASS;
+
+		hwaddr = uk_netdev_hwaddr_get(dev);
+		if (unlikely(!hwaddr))
+			return UK_NETDEV_RX_PASS;
+		/* The IPv4 checksum does not change by swapping addresses */
+		classify_swap(&p[12], &p[16], 4);
+		p[hlen] = CLASSIFY_ICMP_ECHO_REPLY;
+		/* Incremental checksum update (RFC 1624) for the type */
+		sum = (uint16_t) ~classify_read16(&p[hlen + 2]);
+		sum += (uint16_t) ~(CLASSIFY_ICMP_ECHO << 8);
+		sum += CLASSIFY_ICMP_ECHO_REPLY << 8;
+		sum = (sum & 0xffff) + (sum >> 16);
+		sum = (sum & 0xffff) + (sum >> 16);
+		classify_write16(&p[hlen + 2], (uint16_t) ~sum);
+		break;
+	default:
+		return UK_NETDEV_RX_PASS;
+	}
+
+	/* Reply to the sender */
+	p = pkt->data;
+	memcpy(&p[0], &p[6], UK_NETDEV_HWADDR_LEN);
+	memcpy(&p[6], hwaddr->addr_bytes, UK_NETDEV_HWADDR_LEN);
+	return UK_NETDEV_RX_TX;
+}
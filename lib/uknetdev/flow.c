@@ -0,0 +1,174 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Software flow hashing for queue selection
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <uk/assert.h>
+#include <uk/essentials.h>
+#include <uk/netdev_flow.h>
+
+#define FLOW_ETH_HDR_LEN	14
+#define FLOW_VLAN_HDR_LEN	4
+#define FLOW_ETH_P_IPV4		0x0800
+#define FLOW_ETH_P_IPV6		0x86dd
+#define FLOW_ETH_P_8021Q	0x8100
+#define FLOW_IPV4_HDR_MINLEN	20
+#define FLOW_IPV4_FRAG_MASK	0x3fff /* MF flag and fragment offset */
+#define FLOW_IPV6_HDR_LEN	40
+#define FLOW_IPPROTO_TCP	6
+#define FLOW_IPPROTO_UDP	17
+
+/* Addresses and ports of an IPv6 flow */
+#define FLOW_TUPLE_MAXLEN	36
+
+/**
+ * A key with a repeating 16-bit pattern makes the Toeplitz hash symmetric:
+ * Swapping the source and destination fields does not change the result.
+ */
+static const uint8_t flow_key[FLOW_TUPLE_MAXLEN + 4] = {
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+	0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a, 0x6d, 0x5a,
+};
+
+static uint32_t flow_toeplitz(const uint8_t *tuple, size_t len)
+{
+	uint32_t hash = 0;
+	uint32_t window;
+	size_t i;
+	int b;
+
+	UK_ASSERT(len <= FLOW_TUPLE_MAXLEN);
+
+	window = ((uint32_t) flow_key[0] << 24) | ((uint32_t) flow_key[1] << 16)
+		 | ((uint32_t) flow_key[2] << 8) | flow_key[3];
+	for (i = 0; i < len; i++) {
+		for (b = 7; b >= 0; b--) {
+			if (tuple[i] & (1 << b))
+				hash ^= window;
+			window <<= 1;
+			if (flow_key[i + 4] & (1 << b))
+				window |= 1;
+		}
+	}
+	return hash;
+}
+
+uint32_t uk_netdev_flow_hash_ipv4(uint32_t saddr, uint32_t daddr,
+				  uint16_t sport, uint16_t dport)
+{
+	uint8_t tuple[12];
+
+	memcpy(&tuple[0], &saddr, 4);
+	memcpy(&tuple[4], &daddr, 4);
+	memcpy(&tuple[8], &sport, 2);
+	memcpy(&tuple[10], &dport, 2);
+	return flow_toeplitz(tuple, sizeof(tuple));
+}
+
+uint32_t uk_netdev_flow_hash_ipv6(const uint8_t *saddr, const uint8_t *daddr,
+				  uint16_t sport, uint16_t dport)
+{
+	uint8_t tuple[FLOW_TUPLE_MAXLEN];
+
+	UK_ASSERT(saddr && daddr);
+
+	memcpy(&tuple[0], saddr, 16);
+	memcpy(&tuple[16], daddr, 16);
+	memcpy(&tuple[32], &sport, 2);
+	memcpy(&tuple[34], &dport, 2);
+	return flow_toeplitz(tuple, sizeof(tuple));
+}
+
+static inline uint16_t flow_read16(const uint8_t *p)
+{
+	return (uint16_t) ((p[0] << 8) | p[1]);
+}
+
+uint32_t uk_netdev_flow_hash(const struct uk_netbuf *pkt)
+{
+	uint8_t tuple[FLOW_TUPLE_MAXLEN];
+	const uint8_t *p;
+	size_t len, hlen, alen;
+	uint16_t type;
+	uint8_t proto;
+
+	UK_ASSERT(pkt);
+
+	p = pkt->data;
+	len = pkt->len;
+	if (unlikely(len < FLOW_ETH_HDR_LEN))
+		return 0;
+	type = flow_read16(&p[12]);
+	p += FLOW_ETH_HDR_LEN;
+	len -= FLOW_ETH_HDR_LEN;
+	if (type == FLOW_ETH_P_8021Q) {
+		if (unlikely(len < FLOW_VLAN_HDR_LEN))
+			return 0;
+		type = flow_read16(&p[2]);
+		p += FLOW_VLAN_HDR_LEN;
+		len -= FLOW_VLAN_HDR_LEN;
+	}
+
+	switch (type) {
+	case FLOW_ETH_P_IPV4:
+		if (unlikely(len < FLOW_IPV4_HDR_MINLEN))
+			return 0;
+		hlen = (p[0] & 0x0f) * 4;
+		proto = p[9];
+		alen = 4;
+		memcpy(&tuple[0], &p[12], 2 * alen);
+		/* Only the first fragment carries ports, hash none of them */
+		if (hlen < FLOW_IPV4_HDR_MINLEN
+		    || (flow_read16(&p[6]) & FLOW_IPV4_FRAG_MASK))
+			proto = 0;
+		break;
+	case FLOW_ETH_P_IPV6:
+		if (unlikely(len < FLOW_IPV6_HDR_LEN))
+			return 0;
+		hlen = FLOW_IPV6_HDR_LEN;
+		proto = p[6];
+		alen = 16;
+		memcpy(&tuple[0], &p[8], 2 * alen);
+		break;
+	default:
+		return 0;
+	}
+
+	if ((proto == FLOW_IPPROTO_TCP || proto == FLOW_IPPROTO_UDP)
+	    && len >= hlen + 4) {
+		memcpy(&tuple[2 * alen], &p[hlen], 4);
+		return flow_toeplitz(tuple, 2 * alen + 4);
+	}
+	return flow_toeplitz(tuple, 2 * alen);
+}
@@ -52,6 +52,33 @@ struct uk_netbuf;
 
 typedef void (*uk_netbuf_dtor_t)(struct uk_netbuf *);
 
+/*
+ * Offload flags of a packet. They are only evaluated on the first netbuf
+ * of a chain.
+ */
+/** RX: The checksums of the packet were validated by the device. */
+#define UK_NETBUF_F_DATA_VALID_BIT	0
+#define UK_NETBUF_F_DATA_VALID		(1U << UK_NETBUF_F_DATA_VALID_BIT)
+/**
+ * TX: The device has to complete the checksum that is located `csum_offset`
+ * bytes after `csum_start`. The checksum field has to contain the checksum
+ * of the pseudo-header.
+ * RX: The checksum was not completed by the sender, the packet is also
+ * marked with UK_NETBUF_F_DATA_VALID.
+ */
+#define UK_NETBUF_F_PARTIAL_CSUM_BIT	1
+#define UK_NETBUF_F_PARTIAL_CSUM	(1U << UK_NETBUF_F_PARTIAL_CSUM_BIT)
+
+/*
+ * Segmentation offload types
+ * TX: The device splits the TCP payload into segments of `gso_size` bytes.
+ *     Requires UK_NETBUF_F_PARTIAL_CSUM.
+ * RX: The packet was coalesced from segments of `gso_size` bytes.
+ */
+#define UK_NETBUF_GSO_NONE		0
+#define UK_NETBUF_GSO_TCPV4		1
+#define UK_NETBUF_GSO_TCPV6		2
+
 /**
  * The netbuf structure is used to describe a single contiguous packet buffer.
  * The structure can be chained to describe a packet with multiple scattered
@@ -111,6 +138,13 @@ struct uk_netbuf {
 	uint16_t len;          /**< Payload length (should be <= buflen). */
 	__atomic refcount;     /**< Reference counter */
 
+	uint16_t flags;        /**< Offload flags (UK_NETBUF_F_*) */
+	uint16_t csum_start;   /**< Checksum start, offset from data */
+	uint16_t csum_offset;  /**< Checksum field, offset from csum_start */
+	uint16_t gso_type;     /**< Segmentation type (UK_NETBUF_GSO_*) */
+	uint16_t gso_size;     /**< Payload bytes per segment */
+	uint16_t header_len;   /**< Length of all headers of a GSO packet */
+
 	void *priv;            /**< Reference to user-provided private data */
 
 	void *buf;             /**< Start address of contiguous buffer. */
@@ -0,0 +1,145 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Netbuf pools
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * THIS HEADER MAY NOT BE EXTRACTED OR MODIFIED IN ANY WAY.
+ */
+
+#ifndef __UK_NETBUF_POOL__
+#define __UK_NETBUF_POOL__
+
+#include <stdint.h>
+#include <uk/alloc.h>
+#include <uk/netbuf.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A netbuf pool hands out netbufs of a fixed buffer size from a memory pool
+ * (libukallocpool). All netbufs are initialized when the pool is created.
+ * Their destructor re-initializes them and returns them to the pool on the
+ * last uk_netbuf_free(), so that no heap allocation is involved in taking
+ * and releasing them. A pool per receive queue is intended to be used with
+ * `uk_netbuf_pool_alloc_rxpkts()` as `alloc_rxpkts` callback.
+ */
+struct uk_netbuf_pool;
+
+/**
+ * Allocates a netbuf pool.
+ * @param a
+ *   Allocator on which the pool is allocated.
+ * @param count
+ *   Number of netbufs in the pool.
+ * @param buflen
+ *   Size of the buffer area of each netbuf.
+ * @param bufalign
+ *   Alignment for the buffer areas (power of 2).
+ * @param headroom
+ *   Number of bytes reserved as headroom from the buffer area.
+ *   `headroom` has to be smaller or equal to `buflen`. Drivers may require
+ *   headroom for receiving (see `nb_encap_rx` of `struct uk_netdev_info`).
+ * @param privlen
+ *   Length of the private data area of each netbuf.
+ * @param dtor
+ *   Destructor that is called before a netbuf returns to the pool (optional).
+ *   Please note that `m->dtor` of a pool netbuf must not be changed.
+ * @returns
+ *   - (NULL): Allocation failed
+ *   - Reference to the netbuf pool
+ */
+struct uk_netbuf_pool *uk_netbuf_pool_alloc(struct uk_alloc *a,
+					    unsigned int count,
+					    size_t buflen, size_t bufalign,
+					    uint16_t headroom, size_t privlen,
+					    uk_netbuf_dtor_t dtor);
+
+/**
+ * Frees a netbuf pool and returns its memory to the allocator that was
+ * given to uk_netbuf_pool_alloc(). All netbufs have to be returned to the
+ * pool before, e.g., by releasing the receive queue that used the pool.
+ * @param p
+ *   Reference to the netbuf pool.
+ */
+void uk_netbuf_pool_free(struct uk_netbuf_pool *p);
+
+/**
+ * Takes an initialized netbuf from a pool.
+ * @param p
+ *   Reference to the netbuf pool.
+ * @returns
+ *   - (NULL): No more netbufs available
+ *   - Reference to the netbuf
+ */
+struct uk_netbuf *uk_netbuf_pool_take(struct uk_netbuf_pool *p);
+
+/**
+ * Takes multiple initialized netbufs from a pool.
+ * @param p
+ *   Reference to the netbuf pool.
+ * @param m
+ *   Array that is filled with references to the netbufs.
+ * @param count
+ *   Maximum number of netbufs to take.
+ * @returns
+ *   Number of netbufs placed to m[0]...m[n - 1].
+ */
+unsigned int uk_netbuf_pool_take_batch(struct uk_netbuf_pool *p,
+				       struct uk_netbuf *m[],
+				       unsigned int count);
+
+/**
+ * Returns the number of available netbufs of a pool.
+ * @param p
+ *   Reference to the netbuf pool.
+ */
+unsigned int uk_netbuf_pool_availcount(struct uk_netbuf_pool *p);
+
+/**
+ * Receive buffer allocator (`uk_netdev_alloc_rxpkts`) that takes the
+ * netbufs from a pool.
+ * @param argp
+ *   Reference to the netbuf pool (`alloc_rxpkts_argp`).
+ * @param pkts
+ *   Array that is filled with references to the netbufs.
+ * @param count
+ *   Maximum number of netbufs to take.
+ * @returns
+ *   Number of netbufs placed to pkts[0]...pkts[n - 1].
+ */
+uint16_t uk_netbuf_pool_alloc_rxpkts(void *argp, struct uk_netbuf *pkts[],
+				     uint16_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UK_NETBUF_POOL__ */
@@ -171,9 +171,12 @@ const void *uk_netdev_einfo_get(struct uk_netdev *dev,
  *   The Unikraft Network Device in unconfigured state.
  * @param conf
  *   The pointer to the configuration data to be used for the Unikraft
- *   network device.
+ *   network device. Offloads are only enabled when they were requested
+ *   with uk_netdev_conf_offloads_set(), and only if they are reported by
+ *   uk_netdev_info_get().
  * @return
  *   - (0): Success, device is in configured state.
+ *   - (-ENOTSUP): Requested offloads are not supported.
  *   - (<0): Error code returned by the driver.
  */
 int uk_netdev_configure(struct uk_netdev *dev,
@@ -218,7 +221,16 @@ int uk_netdev_rxq_info_get(struct uk_netdev *dev, uint16_t queue_id,
  *   Its memory can be released after invoking this function. Please note that
  *   the receive buffer allocator (`rx_conf->alloc_rxpkts`) has to be
  *   interrupt-context-safe when `uk_netdev_rx_one` is going to be called from
- *   interrupt context.
+ *   interrupt context. With CONFIG_LIBUKALLOCPOOL_LOCKFREE, a netbuf pool
+ *   (see uk/netbuf_pool.h) provides such an allocator without heap
+ *   allocations. With dispatcher threads, each receive queue that has an
+ *   event callback gets its own thread on scheduler `rx_conf->s`, created
+ *   with the optional attributes `rx_conf->attr` (e.g., priority).
+ *   In adaptive mode (`rx_conf->mode`), the dispatcher thread disables the
+ *   queue interrupts and calls the callback repeatedly while the queue
+ *   receives at least `rx_conf->poll_rate` packets per second. After each
+ *   `rx_conf->poll_budget` received packets, it yields the CPU. Interrupts
+ *   are enabled again when no packet arrived for `rx_conf->poll_timeout`.
  * @return
  *   - (0): Success, receive queue correctly set up.
  *   - (-ENOMEM): Unable to allocate the receive ring descriptors.
@@ -362,6 +374,58 @@ uint16_t uk_netdev_mtu_get(struct uk_netdev *dev);
  */
 int uk_netdev_mtu_set(struct uk_netdev *dev, uint16_t mtu);
 
+#ifdef CONFIG_LIBUKNETDEV_CLASSIFIER
+/**
+ * Installs the classifier of a receive queue. The classifier is applied
+ * by uk_netdev_rx_one() and uk_netdev_rx_burst() to each packet before it
+ * is returned. Packets that are redirected to a queue are returned by its
+ * next receive call; if the queue is operated in interrupt mode, an event is
+ * raised for it. Without CONFIG_LIBUKNETDEV_DISPATCHERTHREADS, packets that
+ * are redirected to a queue in interrupt mode are dropped because its event
+ * callback would run within the receive call of the redirecting queue.
+ * Replies (UK_NETDEV_RX_TX) are free'd when the transmit queue is full.
+ * Dropped packets are counted as drops in the queue statistics. The
+ * classifier can be replaced at runtime but not concurrently to a receive
+ * call on the queue.
+ *
+ * @param dev
+ *   The Unikraft Network Device.
+ * @param queue_id
+ *   The index of a configured receive queue.
+ * @param classifier
+ *   Classifier function, (NULL) removes the classifier.
+ * @param cookie
+ *   Argument pointer for the classifier.
+ * @return
+ *   - (0): Success.
+ *   - (-EINVAL): Queue is not configured.
+ */
+int uk_netdev_rxq_classifier_set(struct uk_netdev *dev, uint16_t queue_id,
+				 uk_netdev_rx_classifier_t classifier,
+				 void *cookie);
+
+/* Internal helpers of the receive functions */
+int _uk_netdev_rxq_classify(struct uk_netdev *dev, uint16_t queue_id,
+			    struct uk_netbuf *pkt[], uint16_t *cnt,
+			    uint16_t len, int status);
+int _uk_netdev_rxq_classify_one(struct uk_netdev *dev, uint16_t queue_id,
+				struct uk_netbuf **pkt, int status);
+int _uk_netdev_rxq_intr_enabled(struct uk_netdev *dev, uint16_t queue_id,
+				int rc);
+#endif /* CONFIG_LIBUKNETDEV_CLASSIFIER */
+
+#ifdef CONFIG_LIBUKNETDEV_CAPTURE
+/* Internal helpers of the receive and transmit functions, the capture API
+ * is declared in uk/netdev_capture.h
+ */
+void _uk_netdev_capture_rx(struct uk_netdev *dev, uint16_t queue_id,
+			   struct uk_netbuf *pkt[], uint16_t cnt);
+int _uk_netdev_capture_tx_one(struct uk_netdev *dev, uint16_t queue_id,
+			      struct uk_netbuf *pkt);
+int _uk_netdev_capture_tx_burst(struct uk_netdev *dev, uint16_t queue_id,
+				struct uk_netbuf *pkt[], uint16_t *cnt);
+#endif /* CONFIG_LIBUKNETDEV_CAPTURE */
+
 /**
  * Enable interrupts for an RX queue.
  *
@@ -381,6 +445,8 @@ int uk_netdev_mtu_set(struct uk_netdev *dev, uint16_t mtu);
 static inline int uk_netdev_rxq_intr_enable(struct uk_netdev *dev,
 					    uint16_t queue_id)
 {
+	int rc;
+
 	UK_ASSERT(dev);
 	UK_ASSERT(dev->ops);
 	UK_ASSERT(dev->_data);
@@ -390,7 +456,11 @@ static inline int uk_netdev_rxq_intr_enable(struct uk_netdev *dev,
 
 	if (unlikely(!dev->ops->rxq_intr_enable))
 		return -ENOTSUP;
-	return dev->ops->rxq_intr_enable(dev, dev->_rx_queue[queue_id]);
+	rc = dev->ops->rxq_intr_enable(dev, dev->_rx_queue[queue_id]);
+#ifdef CONFIG_LIBUKNETDEV_CLASSIFIER
+	rc = _uk_netdev_rxq_intr_enabled(dev, queue_id, rc);
+#endif
+	return rc;
 }
 
 /**
@@ -418,6 +488,10 @@ static inline int uk_netdev_rxq_intr_disable(struct uk_netdev *dev,
 
 	if (unlikely(!dev->ops->rxq_intr_disable))
 		return -ENOTSUP;
+#ifdef CONFIG_LIBUKNETDEV_CLASSIFIER
+	dev->_data->rxq_classifier[queue_id].intr_user = 0;
+	dev->_data->rxq_classifier[queue_id].intr_paused = 0;
+#endif
 	return dev->ops->rxq_intr_disable(dev, dev->_rx_queue[queue_id]);
 }
 
@@ -460,6 +534,8 @@ static inline int uk_netdev_rxq_intr_disable(struct uk_netdev *dev,
 static inline int uk_netdev_rx_one(struct uk_netdev *dev, uint16_t queue_id,
 				   struct uk_netbuf **pkt)
 {
+	int rc;
+
 	UK_ASSERT(dev);
 	UK_ASSERT(dev->rx_one);
 	UK_ASSERT(queue_id < CONFIG_LIBUKNETDEV_MAXNBQUEUES);
@@ -467,7 +543,21 @@ static inline int uk_netdev_rx_one(struct uk_netdev *dev, uint16_t queue_id,
 	UK_ASSERT(!PTRISERR(dev->_rx_queue[queue_id]));
 	UK_ASSERT(pkt);
 
-	return dev->rx_one(dev, dev->_rx_queue[queue_id], pkt);
+	rc = dev->rx_one(dev, dev->_rx_queue[queue_id], pkt);
+#ifdef CONFIG_LIBUKNETDEV_ADAPTIVEPOLL
+	if (rc > 0 && (rc & UK_NETDEV_STATUS_SUCCESS))
+		dev->_data->rxq_handler[queue_id].rx_pkts++;
+#endif
+#ifdef CONFIG_LIBUKNETDEV_CLASSIFIER
+	if (rc >= 0)
+		rc = _uk_netdev_rxq_classify_one(dev, queue_id, pkt, rc);
+#endif
+#ifdef CONFIG_LIBUKNETDEV_CAPTURE
+	if (unlikely(dev->_data->capture)
+	    && rc > 0 && (rc & UK_NETDEV_STATUS_SUCCESS))
+		_uk_netdev_capture_rx(dev, queue_id, pkt, 1);
+#endif
+	return rc;
 }
 
 /**
@@ -506,9 +596,117 @@ static inline int uk_netdev_tx_one(struct uk_netdev *dev, uint16_t queue_id,
 	UK_ASSERT(!PTRISERR(dev->_tx_queue[queue_id]));
 	UK_ASSERT(pkt);
 
+#ifdef CONFIG_LIBUKNETDEV_CAPTURE
+	if (unlikely(dev->_data->capture))
+		return _uk_netdev_capture_tx_one(dev, queue_id, pkt);
+#endif
 	return dev->tx_one(dev, dev->_tx_queue[queue_id], pkt);
 }
 
+/**
+ * Receive multiple packets and re-program used receive descriptors once for
+ * the whole burst. The same rules as for uk_netdev_rx_one() apply regarding
+ * queue interrupts and the receive buffer allocator.
+ * Drivers without native support receive the packets one by one.
+ *
+ * @param dev
+ *   The Unikraft Network Device.
+ * @param queue_id
+ *   The index of the receive queue to receive from.
+ *   The value must be in the range [0, nb_rx_queue - 1] previously supplied
+ *   to uk_netdev_configure().
+ * @param pkt
+ *   Array of netbuf pointers which will point to the received packets
+ *   after the function call.
+ * @param cnt
+ *   On entry, the length of `pkt`. On return, the number of packets that
+ *   were received and placed to pkt[0]...pkt[*cnt - 1].
+ * @return
+ *   - (>=0): Positive value with status flags
+ *     - UK_NETDEV_STATUS_SUCCESS: At least one packet was received.
+ *     - UK_NETDEV_STATUS_MORE: `pkt` was filled completely and more received
+ *        packets are available on the receive queue. When interrupts are
+ *        used, they are disabled until this flag is unset by a subsequent
+ *        call.
+ *     - UK_NETDEV_STATUS_UNDERRUN: Some available slots of the receive queue
+ *        could not be programmed with a receive buffer.
+ *   - (<0): Negative value with error code from driver, no packet is returned.
+ */
+static inline int uk_netdev_rx_burst(struct uk_netdev *dev, uint16_t queue_id,
+				     struct uk_netbuf *pkt[], uint16_t *cnt)
+{
+#ifdef CONFIG_LIBUKNETDEV_CLASSIFIER
+	uint16_t len = *cnt;
+#endif
+	int rc;
+
+	UK_ASSERT(dev);
+	UK_ASSERT(dev->rx_burst);
+	UK_ASSERT(queue_id < CONFIG_LIBUKNETDEV_MAXNBQUEUES);
+	UK_ASSERT(dev->_data->state == UK_NETDEV_RUNNING);
+	UK_ASSERT(!PTRISERR(dev->_rx_queue[queue_id]));
+	UK_ASSERT(pkt && cnt);
+
+	rc = dev->rx_burst(dev, dev->_rx_queue[queue_id], pkt, cnt);
+#ifdef CONFIG_LIBUKNETDEV_ADAPTIVEPOLL
+	if (rc > 0)
+		dev->_data->rxq_handler[queue_id].rx_pkts += *cnt;
+#endif
+#ifdef CONFIG_LIBUKNETDEV_CLASSIFIER
+	if (rc >= 0)
+		rc = _uk_netdev_rxq_classify(dev, queue_id, pkt, cnt, len, rc);
+#endif
+#ifdef CONFIG_LIBUKNETDEV_CAPTURE
+	if (unlikely(dev->_data->capture) && rc > 0 && *cnt)
+		_uk_netdev_capture_rx(dev, queue_id, pkt, *cnt);
+#endif
+	return rc;
+}
+
+/**
+ * Transmit multiple packets. Drivers with native support notify the device
+ * only once for the whole burst. Otherwise, the packets are transmitted one
+ * by one. Packets are submitted in array order; when the transmit queue
+ * becomes full, the remaining packets are left to the caller.
+ *
+ * @param dev
+ *   The Unikraft Network Device.
+ * @param queue_id
+ *   The index of the transmit queue.
+ *   The value must be in the range [0, nb_tx_queue - 1] previously supplied
+ *   to uk_netdev_configure().
+ * @param pkt
+ *   Array of netbufs to send. Submitted packets are free'd by the driver
+ *   after sending was successfully finished by the device. See
+ *   uk_netdev_tx_one() for headroom requirements.
+ * @param cnt
+ *   On entry, the number of packets in `pkt`. On return, the number of
+ *   packets pkt[0]...pkt[*cnt - 1] that were put to the transmit queue.
+ * @return
+ *   - (>=0): Positive value with status flags
+ *     - UK_NETDEV_STATUS_SUCCESS: At least one packet was put to the transmit
+ *        queue.
+ *     - UK_NETDEV_STATUS_MORE: Indicates there is still at least one
+ *        descriptor available after the last submitted packet.
+ *   - (<0): Negative value with error code from driver, no packet was sent.
+ */
+static inline int uk_netdev_tx_burst(struct uk_netdev *dev, uint16_t queue_id,
+				     struct uk_netbuf *pkt[], uint16_t *cnt)
+{
+	UK_ASSERT(dev);
+	UK_ASSERT(dev->tx_burst);
+	UK_ASSERT(queue_id < CONFIG_LIBUKNETDEV_MAXNBQUEUES);
+	UK_ASSERT(dev->_data->state == UK_NETDEV_RUNNING);
+	UK_ASSERT(!PTRISERR(dev->_tx_queue[queue_id]));
+	UK_ASSERT(pkt && cnt);
+
+#ifdef CONFIG_LIBUKNETDEV_CAPTURE
+	if (unlikely(dev->_data->capture))
+		return _uk_netdev_capture_tx_burst(dev, queue_id, pkt, cnt);
+#endif
+	return dev->tx_burst(dev, dev->_tx_queue[queue_id], pkt, cnt);
+}
+
 /**
  * Tests for status flags returned by `uk_netdev_rx_one` or `uk_netdev_tx_one`.
  * When the functions returned an error code or one of the selected flags is
@@ -582,6 +780,50 @@ static inline int uk_netdev_tx_one(struct uk_netdev *dev, uint16_t queue_id,
 	uk_netdev_status_test_set((status), (UK_NETDEV_STATUS_SUCCESS	\
 					     | UK_NETDEV_STATUS_MORE))
 
+#ifdef CONFIG_LIBUKNETDEV_STATS
+/**
+ * Copies the statistics of the configured queues of a network device.
+ * The counters are maintained by the driver in its receive and transmit
+ * paths without synchronization, so a snapshot of a running device can be
+ * slightly inconsistent.
+ *
+ * @param dev
+ *   The Unikraft Network Device.
+ * @param stats
+ *   Destination for the statistics.
+ */
+void uk_netdev_stats_get(struct uk_netdev *dev,
+			 struct uk_netdev_stats *stats);
+
+/**
+ * Clears the statistics of all queues of a network device.
+ *
+ * @param dev
+ *   The Unikraft Network Device.
+ */
+void uk_netdev_stats_reset(struct uk_netdev *dev);
+
+/**
+ * Writes a text report of the queue statistics of all registered network
+ * devices to a buffer. The output is truncated to the buffer size but
+ * always terminated.
+ *
+ * @param buf
+ *   Destination buffer.
+ * @param len
+ *   Size of the destination buffer.
+ * @return
+ *   Length of the full report, without terminating character.
+ */
+size_t uk_netdev_stats_print(char *buf, size_t len);
+
+/**
+ * Prints the queue statistics of all registered network devices to the
+ * kernel console with uk_pr_info().
+ */
+void uk_netdev_stats_dump(void);
+#endif /* CONFIG_LIBUKNETDEV_STATS */
+
 #ifdef __cplusplus
 }
 #endif
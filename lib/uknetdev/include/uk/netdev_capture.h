@@ -0,0 +1,189 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Packet capture on uknetdev queues
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * THIS HEADER MAY NOT BE EXTRACTED OR MODIFIED IN ANY WAY.
+ */
+
+#ifndef __UK_NETDEV_CAPTURE__
+#define __UK_NETDEV_CAPTURE__
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <uk/netdev.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Packet capture for debugging. When a capture is started on a device, the
+ * receive and transmit functions of uknetdev copy the first bytes of each
+ * packet into a lock-free ring of records. Received packets are captured as
+ * they are returned to the user (i.e., after the receive classifier),
+ * transmitted packets when the driver accepted them. The records are written
+ * as pcapng stream (one interface per device, with direction and queue of
+ * each packet) to a sink function, either by a flush thread or by calling
+ * uk_netdev_capture_flush(). If the ring is full or the rate limit is
+ * exceeded, packets are not captured and counted instead. While no capture
+ * is active, the overhead is a single test in the receive and transmit
+ * functions.
+ */
+
+/**
+ * Function type for capture sinks.
+ *
+ * @param cookie
+ *   Argument pointer that was given with the sink.
+ * @param buf
+ *   pcapng data to write.
+ * @param len
+ *   Length of the data.
+ * @return
+ *   - (>=0): Number of bytes written.
+ *   - (<0): Error code, the capture stops writing.
+ */
+typedef ssize_t (*uk_netdev_capture_write_t)(void *cookie, const void *buf,
+					     size_t len);
+
+/**
+ * Configuration of a capture.
+ */
+struct uk_netdev_capture_conf {
+	struct uk_alloc *a;         /**< Allocator for the ring */
+	uint16_t snaplen;           /**< Bytes per packet (0: default) */
+	uint16_t nb_records;        /**< Ring size, power of two (0: default) */
+	uint32_t rate;              /**< Packets per second (0: unlimited) */
+	uk_netdev_capture_write_t write;  /**< Sink of the pcapng stream */
+	void *write_cookie;         /**< Argument pointer for the sink */
+#ifdef CONFIG_LIBUKSCHED
+	/* Scheduler of a flush thread, or (NULL) when the records are written
+	 * by calling uk_netdev_capture_flush()
+	 */
+	struct uk_sched *s;
+#endif
+};
+
+/**
+ * Counters of a capture.
+ */
+struct uk_netdev_capture_stats {
+	uint64_t captured;     /**< Packets that were written to the sink */
+	uint64_t ring_full;    /**< Packets skipped because of a full ring */
+	uint64_t rate_limited; /**< Packets skipped by the rate limit */
+	uint64_t bytes;        /**< Bytes written to the sink */
+};
+
+/**
+ * Starts capturing the packets of all queues of a device. The pcapng
+ * section and interface headers are written to the sink immediately.
+ *
+ * @param dev
+ *   The Unikraft Network Device.
+ * @param conf
+ *   Capture configuration.
+ * @return
+ *   - (0): Success.
+ *   - (-EBUSY): A capture is already active on the device.
+ *   - (-ENOMEM): Allocation of the ring or the flush thread failed.
+ *   - (<0): Error code returned by the sink.
+ */
+int uk_netdev_capture_start(struct uk_netdev *dev,
+			    const struct uk_netdev_capture_conf *conf);
+
+/**
+ * Stops the capture of a device and writes the remaining records. Waits
+ * until receive and transmit functions that run concurrently on other CPUs
+ * or threads do not access the capture anymore, so it must not be called
+ * from these functions or from an interrupt handler.
+ *
+ * @param dev
+ *   The Unikraft Network Device.
+ * @return
+ *   - (0): Success.
+ *   - (-EINVAL): No capture is active on the device.
+ */
+int uk_netdev_capture_stop(struct uk_netdev *dev);
+
+/**
+ * Writes the captured records of a device to its sink. Calls have to be
+ * serialized with the flush thread.
+ *
+ * @param dev
+ *   The Unikraft Network Device.
+ * @return
+ *   - (>=0): Number of written records.
+ *   - (-EINVAL): No capture is active on the device.
+ *   - (<0): Error code returned by the sink.
+ */
+int uk_netdev_capture_flush(struct uk_netdev *dev);
+
+/**
+ * Retrieves the counters of the capture of a device.
+ *
+ * @param dev
+ *   The Unikraft Network Device.
+ * @param stats
+ *   Reference to the structure that is filled.
+ * @return
+ *   - (0): Success.
+ *   - (-EINVAL): No capture is active on the device.
+ */
+int uk_netdev_capture_stats_get(struct uk_netdev *dev,
+				struct uk_netdev_capture_stats *stats);
+
+/**
+ * Sink that prints the pcapng stream as hex lines prefixed by "pcapng: " to
+ * the kernel console. The stream can be recovered from a console log with:
+ *   sed -n 's/^pcapng: //p' log | xxd -r -p > capture.pcapng
+ *
+ * @param cookie
+ *   Unused.
+ */
+ssize_t uk_netdev_capture_write_console(void *cookie, const void *buf,
+					size_t len);
+
+#if CONFIG_LIBVFSCORE
+/**
+ * Sink that writes the pcapng stream to a file descriptor, e.g., of a file
+ * on a host share.
+ *
+ * @param cookie
+ *   File descriptor, casted with `(void *)(intptr_t) fd`.
+ */
+ssize_t uk_netdev_capture_write_fd(void *cookie, const void *buf,
+				   size_t len);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UK_NETDEV_CAPTURE__ */
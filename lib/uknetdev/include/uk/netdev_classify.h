@@ -0,0 +1,89 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Receive classifiers for uknetdev queues
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * THIS HEADER MAY NOT BE EXTRACTED OR MODIFIED IN ANY WAY.
+ */
+
+#ifndef __UK_NETDEV_CLASSIFY__
+#define __UK_NETDEV_CLASSIFY__
+
+#include <stdint.h>
+#include <uk/netdev.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Ready-made classifiers that can be installed on receive queues with
+ * `uk_netdev_rxq_classifier_set()` or with the queue configuration.
+ */
+
+/**
+ * Cookie of `uk_netdev_rx_classify_echo()`.
+ */
+struct uk_netdev_echo_conf {
+	uint32_t ipv4_addr; /**< Own IPv4 address in network byte order */
+};
+
+/**
+ * Answers ARP requests for the configured IPv4 address and ICMP echo
+ * requests that are sent to it without passing them to the network stack.
+ * The request is turned into the reply in place and transmitted on the
+ * transmit queue with the same index as the receive queue. All other
+ * packets are passed. Only untagged frames are answered; the headers have
+ * to be contained in the first netbuf of a chain.
+ *
+ * @param dev
+ *   The Unikraft Network Device.
+ * @param queue_id
+ *   The queue on which the packet was received.
+ * @param pkt
+ *   The received packet.
+ * @param redirect
+ *   Unused.
+ * @param cookie
+ *   Reference to a `struct uk_netdev_echo_conf`.
+ * @return
+ *   - UK_NETDEV_RX_TX: The packet was turned into a reply.
+ *   - UK_NETDEV_RX_PASS: Any other packet.
+ */
+enum uk_netdev_rx_verdict uk_netdev_rx_classify_echo(struct uk_netdev *dev,
+						     uint16_t queue_id,
+						     struct uk_netbuf *pkt,
+						     uint16_t *redirect,
+						     void *cookie);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UK_NETDEV_CLASSIFY__ */
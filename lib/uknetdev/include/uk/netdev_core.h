@@ -49,6 +49,9 @@
 #include <uk/sched.h>
 #include <uk/semaphore.h>
 #endif
+#ifdef CONFIG_LIBUKNETDEV_ADAPTIVEPOLL
+#include <uk/arch/time.h>
+#endif
 
 /**
  * Unikraft network API common declarations.
@@ -137,6 +140,30 @@ struct uk_hwaddr {
 #define uk_netdev_rxintr_supported(feature)	\
 	(feature & (UK_FEATURE_RXQ_INTR_AVAILABLE))
 
+/**
+ * Offloads of a network device, see UK_NETBUF_F_* and UK_NETBUF_GSO_* for
+ * the corresponding netbuf fields. Drivers may enable further offloads that
+ * a requested one depends on (e.g., checksum offload for TSO).
+ */
+/** The device completes partial checksums of transmitted packets. */
+#define UK_NETDEV_OFFLOAD_TX_CSUM_BIT	0
+#define UK_NETDEV_OFFLOAD_TX_CSUM	(1U << UK_NETDEV_OFFLOAD_TX_CSUM_BIT)
+/** The device marks received packets with validated checksums. */
+#define UK_NETDEV_OFFLOAD_RX_CSUM_BIT	1
+#define UK_NETDEV_OFFLOAD_RX_CSUM	(1U << UK_NETDEV_OFFLOAD_RX_CSUM_BIT)
+/** The device segments transmitted TCP/IPv4 packets of up to 64 KiB. */
+#define UK_NETDEV_OFFLOAD_TSO4_BIT	2
+#define UK_NETDEV_OFFLOAD_TSO4		(1U << UK_NETDEV_OFFLOAD_TSO4_BIT)
+/** The device segments transmitted TCP/IPv6 packets of up to 64 KiB. */
+#define UK_NETDEV_OFFLOAD_TSO6_BIT	3
+#define UK_NETDEV_OFFLOAD_TSO6		(1U << UK_NETDEV_OFFLOAD_TSO6_BIT)
+/** The device may deliver coalesced TCP/IPv4 packets of up to 64 KiB. */
+#define UK_NETDEV_OFFLOAD_LRO4_BIT	4
+#define UK_NETDEV_OFFLOAD_LRO4		(1U << UK_NETDEV_OFFLOAD_LRO4_BIT)
+/** The device may deliver coalesced TCP/IPv6 packets of up to 64 KiB. */
+#define UK_NETDEV_OFFLOAD_LRO6_BIT	5
+#define UK_NETDEV_OFFLOAD_LRO6		(1U << UK_NETDEV_OFFLOAD_LRO6_BIT)
+
 /**
  * A structure used to describe network device capabilities.
  */
@@ -149,6 +176,8 @@ struct uk_netdev_info {
 	uint16_t nb_encap_rx;  /**< Number of bytes required as headroom for rx. */
 	uint16_t ioalign;  /**< Alignment in bytes for packet data buffers */
 	uint32_t features; /**< bitmap of the features supported */
+	uint32_t offloads; /**< bitmap of the offloads supported */
+	uint32_t lro_rxbuf_len; /**< Min. rx buffer size for LRO, 0 if any */
 };
 
 /**
@@ -161,14 +190,38 @@ struct uk_netdev_queue_info {
 	int nb_is_power_of_two; /**< Number of descriptors should be a power of two. */
 };
 
+/**
+ * Value of `uk_netdev_conf.offloads_en` to request offloads. Offloads are
+ * opt-in so that callers that only set the number of queues keep them
+ * disabled, even if they do not clear the remaining fields.
+ */
+#define UK_NETDEV_CONF_OFFLOADS_EN	0x4f46464cU /* "OFFL" */
+
 /**
  * A structure used to configure a network device.
  */
 struct uk_netdev_conf {
 	uint16_t nb_rx_queues;
 	uint16_t nb_tx_queues;
+	uint32_t offloads_en; /**< UK_NETDEV_CONF_OFFLOADS_EN to use offloads */
+	uint32_t offloads; /**< Offloads to enable (UK_NETDEV_OFFLOAD_*) */
 };
 
+/**
+ * Requests offloads with a network device configuration.
+ *
+ * @param conf
+ *   The configuration to update.
+ * @param offloads
+ *   Offloads to enable (UK_NETDEV_OFFLOAD_*).
+ */
+static inline void uk_netdev_conf_offloads_set(struct uk_netdev_conf *conf,
+					       uint32_t offloads)
+{
+	conf->offloads_en = UK_NETDEV_CONF_OFFLOADS_EN;
+	conf->offloads = offloads;
+}
+
 /**
  * @internal Queue structs that are defined internally by each driver
  * The datatype is introduced here for having type checking on the
@@ -256,6 +309,59 @@ typedef uint16_t (*uk_netdev_alloc_rxpkts)(void *argp,
 					   struct uk_netbuf *pkts[],
 					   uint16_t count);
 
+#ifdef CONFIG_LIBUKNETDEV_CLASSIFIER
+/**
+ * Verdicts of a receive classifier.
+ */
+enum uk_netdev_rx_verdict {
+	/** The packet is returned to the user of the queue */
+	UK_NETDEV_RX_PASS = 0,
+	/** The packet is free'd */
+	UK_NETDEV_RX_DROP,
+	/** The packet is returned by the receive queue `*redirect` */
+	UK_NETDEV_RX_REDIRECT,
+	/** The (modified) packet is sent on the transmit queue with the
+	 *  same index, e.g., as reply
+	 */
+	UK_NETDEV_RX_TX,
+	/** The classifier took over the packet */
+	UK_NETDEV_RX_STOLEN,
+};
+
+/**
+ * Function type for receive classifiers. A classifier inspects each packet
+ * that is received on a queue before it is returned to the user.
+ *
+ * @param dev
+ *   The Unikraft Network Device.
+ * @param queue_id
+ *   The queue on which the packet was received.
+ * @param pkt
+ *   The received packet.
+ * @param redirect
+ *   Receive queue for UK_NETDEV_RX_REDIRECT, initialized with `queue_id`.
+ * @param cookie
+ *   Argument pointer that was given with the classifier.
+ * @return
+ *   Verdict for the packet.
+ */
+typedef enum uk_netdev_rx_verdict (*uk_netdev_rx_classifier_t)(
+		struct uk_netdev *dev, uint16_t queue_id,
+		struct uk_netbuf *pkt, uint16_t *redirect, void *cookie);
+#endif
+
+#ifdef CONFIG_LIBUKNETDEV_ADAPTIVEPOLL
+/**
+ * Event modes of a receive queue.
+ */
+enum uk_netdev_rxq_mode {
+	/** The callback is dispatched for each queue interrupt */
+	UK_NETDEV_RXQ_MODE_INTR = 0,
+	/** The dispatcher busy-polls the queue while its packet rate is high */
+	UK_NETDEV_RXQ_MODE_ADAPTIVE,
+};
+#endif
+
 /**
  * A structure used to configure an Unikraft network device RX queue.
  */
@@ -269,6 +375,17 @@ struct uk_netdev_rxqueue_conf {
 	void *alloc_rxpkts_argp;             /**< Argument for alloc_rxpkts */
 #ifdef CONFIG_LIBUKNETDEV_DISPATCHERTHREADS
 	struct uk_sched *s;               /**< Scheduler for dispatcher. */
+	const uk_thread_attr_t *attr;     /**< Dispatcher attributes (opt.) */
+#endif
+#ifdef CONFIG_LIBUKNETDEV_ADAPTIVEPOLL
+	enum uk_netdev_rxq_mode mode;     /**< Interrupt or adaptive mode */
+	uint32_t poll_rate;    /**< Packets/s to start polling (0: default) */
+	uint16_t poll_budget;  /**< Packets per poll round (0: default) */
+	__nsec poll_timeout;   /**< Idle time to stop polling (0: default) */
+#endif
+#ifdef CONFIG_LIBUKNETDEV_CLASSIFIER
+	uk_netdev_rx_classifier_t classifier; /**< Classifier (optional) */
+	void *classifier_cookie;      /**< Argument pointer for classifier */
 #endif
 };
 
@@ -370,6 +487,26 @@ typedef int (*uk_netdev_tx_one_t)(struct uk_netdev *dev,
 				  struct uk_netdev_tx_queue *queue,
 				  struct uk_netbuf *pkt);
 
+/**
+ * Driver callback type to retrieve multiple packets from a RX queue.
+ * `cnt` contains the length of `pkt` on entry and the number of received
+ * packets on return.
+ */
+typedef int (*uk_netdev_rx_burst_t)(struct uk_netdev *dev,
+				    struct uk_netdev_rx_queue *queue,
+				    struct uk_netbuf *pkt[],
+				    uint16_t *cnt);
+
+/**
+ * Driver callback type to submit multiple packets to a TX queue.
+ * `cnt` contains the length of `pkt` on entry and the number of submitted
+ * packets on return.
+ */
+typedef int (*uk_netdev_tx_burst_t)(struct uk_netdev *dev,
+				    struct uk_netdev_tx_queue *queue,
+				    struct uk_netbuf *pkt[],
+				    uint16_t *cnt);
+
 /**
  * A structure containing the functions exported by a driver.
  */
@@ -403,6 +540,32 @@ struct uk_netdev_ops {
 	uk_netdev_start_t               start;
 };
 
+#ifdef CONFIG_LIBUKNETDEV_STATS
+/**
+ * Statistics of a receive or transmit queue. Counters that do not apply to
+ * the queue type stay zero.
+ */
+struct uk_netdev_queue_stats {
+	uint64_t packets;     /**< Packets received/transmitted */
+	uint64_t bytes;       /**< Bytes received/transmitted (w/o headers) */
+	uint64_t drops;       /**< Received packets that were discarded */
+	uint64_t errors;      /**< Packets rejected with an error on transmit */
+	uint64_t ring_full;   /**< Transmissions that found the ring full */
+	uint64_t refill_fail; /**< Incomplete refills of the receive ring */
+	uint64_t irqs;        /**< Receive queue interrupts */
+};
+
+/**
+ * Statistics of the queues of a network device.
+ */
+struct uk_netdev_stats {
+	uint16_t nb_rx_queues; /**< Number of valid entries in rxq */
+	uint16_t nb_tx_queues; /**< Number of valid entries in txq */
+	struct uk_netdev_queue_stats rxq[CONFIG_LIBUKNETDEV_MAXNBQUEUES];
+	struct uk_netdev_queue_stats txq[CONFIG_LIBUKNETDEV_MAXNBQUEUES];
+};
+#endif
+
 /**
  * @internal
  * Event handler configuration (internal to libuknetdev)
@@ -419,7 +582,29 @@ struct uk_netdev_event_handler {
 	char                *dispatcher_name; /**< reference to thread name */
 	struct uk_sched     *dispatcher_s;    /**< Scheduler for dispatcher. */
 #endif
+#ifdef CONFIG_LIBUKNETDEV_ADAPTIVEPOLL
+	uint64_t            rx_pkts;     /**< packets received from queue */
+	int                 adaptive;    /**< adaptive mode is configured */
+	int                 polling;     /**< queue is busy-polled */
+	uint32_t            poll_thresh; /**< packets per window to poll */
+	uint16_t            poll_budget; /**< packets per poll round */
+	__nsec              poll_timeout; /**< idle time to stop polling */
+#endif
+};
+
+#ifdef CONFIG_LIBUKNETDEV_CLASSIFIER
+/**
+ * @internal
+ * Classifier state of a receive queue.
+ */
+struct uk_netdev_rxq_classifier {
+	uk_netdev_rx_classifier_t fn;
+	void                *cookie;
+	struct uk_ring      *backlog;    /**< packets redirected to the queue */
+	int                 intr_user;   /**< interrupts enabled by the user */
+	int                 intr_paused; /**< interrupts off for a redirect */
 };
+#endif
 
 /**
  * @internal
@@ -430,6 +615,20 @@ struct uk_netdev_data {
 
 	struct uk_netdev_event_handler
 			     rxq_handler[CONFIG_LIBUKNETDEV_MAXNBQUEUES];
+#ifdef CONFIG_LIBUKNETDEV_CLASSIFIER
+	struct uk_netdev_rxq_classifier
+			     rxq_classifier[CONFIG_LIBUKNETDEV_MAXNBQUEUES];
+#endif
+#ifdef CONFIG_LIBUKNETDEV_STATS
+	struct uk_netdev_queue_stats
+			     rxq_stats[CONFIG_LIBUKNETDEV_MAXNBQUEUES];
+	struct uk_netdev_queue_stats
+			     txq_stats[CONFIG_LIBUKNETDEV_MAXNBQUEUES];
+#endif
+#ifdef CONFIG_LIBUKNETDEV_CAPTURE
+	struct uk_netdev_capture *capture; /**< Active packet capture */
+	unsigned int capture_users; /**< Hooks that may access `capture` */
+#endif
 
 	const uint16_t       id;    /**< ID is assigned during registration */
 	const char           *drv_name;
@@ -445,17 +644,21 @@ struct uk_netdev_einfo {
  * NETDEV
  * A structure used to interact with a network device.
  *
- * Function callbacks (tx_one, rx_one, ops) are registered by the driver before
- * registering the netdev. They change during device life time. Packet RX/TX
- * functions are added directly to this structure for performance reasons.
- * It prevents another indirection to ops.
+ * Function callbacks (tx_one, rx_one, tx_burst, rx_burst, ops) are registered
+ * by the driver before registering the netdev. They change during device life
+ * time. Packet RX/TX functions are added directly to this structure for
+ * performance reasons. It prevents another indirection to ops.
+ * A driver has to provide at least one of the single and the burst variant
+ * for each direction, libuknetdev fills in the other one on registration.
  */
 struct uk_netdev {
 	/** Packet transmission. */
-	uk_netdev_tx_one_t          tx_one; /* by driver */
+	uk_netdev_tx_one_t          tx_one;   /* by driver */
+	uk_netdev_tx_burst_t        tx_burst; /* by driver */
 
 	/** Packet reception. */
-	uk_netdev_rx_one_t          rx_one; /* by driver */
+	uk_netdev_rx_one_t          rx_one;   /* by driver */
+	uk_netdev_rx_burst_t        rx_burst; /* by driver */
 
 	/** Pointer to API-internal state data. */
 	struct uk_netdev_data       *_data;
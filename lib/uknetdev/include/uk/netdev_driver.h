@@ -67,6 +67,33 @@ extern "C" {
 int uk_netdev_drv_register(struct uk_netdev *dev, struct uk_alloc *a,
 			   const char *drv_name);
 
+#ifdef CONFIG_LIBUKNETDEV_STATS
+/**
+ * Adds a value to a statistics counter of a receive or transmit queue
+ * (see: struct uk_netdev_queue_stats). The counters are not atomic, so a
+ * counter has to be updated from a single context only, e.g., the context
+ * that operates the queue.
+ *
+ * @param dev
+ *   Unikraft network device
+ * @param queue_id
+ *   Queue ID
+ * @param counter
+ *   Name of the counter field
+ * @param val
+ *   Value to add
+ */
+#define uk_netdev_drv_rxq_stats_add(dev, queue_id, counter, val)	\
+	((dev)->_data->rxq_stats[(queue_id)].counter += (val))
+#define uk_netdev_drv_txq_stats_add(dev, queue_id, counter, val)	\
+	((dev)->_data->txq_stats[(queue_id)].counter += (val))
+#else
+#define uk_netdev_drv_rxq_stats_add(dev, queue_id, counter, val)	\
+	((void) (val))
+#define uk_netdev_drv_txq_stats_add(dev, queue_id, counter, val)	\
+	((void) (val))
+#endif
+
 /**
  * Forwards an RX queue event to the API user
  * Can (and should) be called from device interrupt context
@@ -85,6 +112,7 @@ static inline void uk_netdev_drv_rx_event(struct uk_netdev *dev,
 	UK_ASSERT(dev->_data);
 	UK_ASSERT(queue_id < CONFIG_LIBUKNETDEV_MAXNBQUEUES);
 
+	uk_netdev_drv_rxq_stats_add(dev, queue_id, irqs, 1);
 	rxq_handler = &dev->_data->rxq_handler[queue_id];
 
 #ifdef CONFIG_LIBUKNETDEV_DISPATCHERTHREADS
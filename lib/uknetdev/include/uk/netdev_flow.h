@@ -0,0 +1,122 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Software flow hashing for queue selection
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * THIS HEADER MAY NOT BE EXTRACTED OR MODIFIED IN ANY WAY.
+ */
+
+#ifndef __UK_NETDEV_FLOW__
+#define __UK_NETDEV_FLOW__
+
+#include <stdint.h>
+#include <uk/netbuf.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Flow hashing helpers to shard connections across the queues of a network
+ * device. The hash is a Toeplitz hash, as used by receive-side scaling,
+ * with a symmetric key: Both directions of a connection result in the same
+ * hash value. Devices that steer received packets to the queue on which a
+ * flow was transmitted (e.g., virtio-net with multiple queues) deliver a
+ * connection on a single queue pair when the application transmits it on
+ * the queue returned by `uk_netdev_flow_queue()`.
+ */
+
+/**
+ * Computes the flow hash of an Ethernet frame. IPv4 and IPv6 packets are
+ * hashed over their addresses and, for non-fragmented TCP and UDP packets,
+ * their ports. The headers have to be contained in the first netbuf of a
+ * chain.
+ *
+ * @param pkt
+ *   Reference to the packet, starting with the Ethernet header.
+ * @return
+ *   - (0): Packet is not an IPv4 or IPv6 packet.
+ *   - Flow hash of the packet.
+ */
+uint32_t uk_netdev_flow_hash(const struct uk_netbuf *pkt);
+
+/**
+ * Computes the flow hash of an IPv4 connection.
+ *
+ * @param saddr
+ *   Source address in network byte order.
+ * @param daddr
+ *   Destination address in network byte order.
+ * @param sport
+ *   Source port in network byte order.
+ * @param dport
+ *   Destination port in network byte order.
+ * @return
+ *   Flow hash of the connection.
+ */
+uint32_t uk_netdev_flow_hash_ipv4(uint32_t saddr, uint32_t daddr,
+				  uint16_t sport, uint16_t dport);
+
+/**
+ * Computes the flow hash of an IPv6 connection.
+ *
+ * @param saddr
+ *   Source address (16 bytes).
+ * @param daddr
+ *   Destination address (16 bytes).
+ * @param sport
+ *   Source port in network byte order.
+ * @param dport
+ *   Destination port in network byte order.
+ * @return
+ *   Flow hash of the connection.
+ */
+uint32_t uk_netdev_flow_hash_ipv6(const uint8_t *saddr, const uint8_t *daddr,
+				  uint16_t sport, uint16_t dport);
+
+/**
+ * Maps a flow hash to a queue identifier.
+ *
+ * @param hash
+ *   Flow hash.
+ * @param nb_queues
+ *   Number of configured queues, must be greater than 0.
+ * @return
+ *   Queue identifier in range [0, nb_queues - 1].
+ */
+static inline uint16_t uk_netdev_flow_queue(uint32_t hash, uint16_t nb_queues)
+{
+	return (uint16_t) (((uint64_t) hash * nb_queues) >> 32);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UK_NETDEV_FLOW__ */
@@ -57,6 +57,13 @@ void uk_netbuf_init_indir(struct uk_netbuf *m,
 	m->prev   = NULL;
 	m->next   = NULL;
 
+	m->flags       = 0;
+	m->csum_start  = 0;
+	m->csum_offset = 0;
+	m->gso_type    = UK_NETBUF_GSO_NONE;
+	m->gso_size    = 0;
+	m->header_len  = 0;
+
 	uk_refcount_init(&m->refcount, 1);
 
 	m->priv   = priv;
@@ -0,0 +1,222 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Netbuf pools
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Each pool object contains the buffer area of a netbuf, followed by the
+ * netbuf itself and its private data area:
+ *
+ *   +------------------+--------------------------+-------------------+
+ *   |   buffer area    | struct netbuf_pool_meta  | private data area |
+ *   +------------------+--------------------------+-------------------+
+ *   ^ object base                ^ meta_off
+ *
+ * The memory pool links free objects (if it is not lock-free) within the
+ * first bytes of the object, so only buffer data is overwritten while a
+ * netbuf is in the pool. The netbuf stays initialized.
+ */
+
+#include <uk/netbuf_pool.h>
+#include <uk/allocpool.h>
+#include <uk/assert.h>
+#include <uk/essentials.h>
+#include <uk/print.h>
+
+/* Used to align netbuf's priv and data areas to `long long` data type */
+#define NETBUF_POOL_ALIGN_UP(x) ALIGN_UP((__uptr) (x), sizeof(long long))
+
+struct uk_netbuf_pool {
+	struct uk_alloc *a;
+	struct uk_allocpool *p;
+	unsigned int count;
+	size_t meta_off;
+	uint16_t headroom;
+	size_t privlen;
+	uk_netbuf_dtor_t dtor;
+};
+
+struct netbuf_pool_meta {
+	struct uk_netbuf m;
+	struct uk_netbuf_pool *pool;
+};
+
+static void netbuf_pool_dtor(struct uk_netbuf *m);
+
+static inline struct uk_netbuf *_obj2netbuf(struct uk_netbuf_pool *pool,
+					    void *obj)
+{
+	return &((struct netbuf_pool_meta *)
+		 ((__uptr) obj + pool->meta_off))->m;
+}
+
+static void _netbuf_init(struct uk_netbuf_pool *pool,
+			 struct netbuf_pool_meta *meta, void *obj)
+{
+	uk_netbuf_init_indir(&meta->m, obj, pool->meta_off, pool->headroom,
+			     pool->privlen > 0 ? (void *) (meta + 1) : NULL,
+			     netbuf_pool_dtor);
+	meta->pool = pool;
+}
+
+static void netbuf_pool_dtor(struct uk_netbuf *m)
+{
+	struct netbuf_pool_meta *meta;
+	struct uk_netbuf_pool *pool;
+	void *obj;
+
+	meta = __containerof(m, struct netbuf_pool_meta, m);
+	pool = meta->pool;
+	obj = m->buf;
+	UK_ASSERT(_obj2netbuf(pool, obj) == m);
+
+	if (pool->dtor)
+		pool->dtor(m);
+
+	/* Hand out the netbuf again as it was after the pool creation */
+	_netbuf_init(pool, meta, obj);
+	uk_allocpool_return(pool->p, obj);
+}
+
+struct uk_netbuf_pool *uk_netbuf_pool_alloc(struct uk_alloc *a,
+					    unsigned int count,
+					    size_t buflen, size_t bufalign,
+					    uint16_t headroom, size_t privlen,
+					    uk_netbuf_dtor_t dtor)
+{
+	struct uk_netbuf_pool *pool;
+	struct uk_netbuf *m, *head = NULL;
+	size_t obj_len;
+	void *obj;
+
+	UK_ASSERT(a);
+	UK_ASSERT(count > 0);
+	UK_ASSERT(buflen > 0);
+	UK_ASSERT(headroom <= buflen);
+
+	pool = uk_malloc(a, sizeof(*pool));
+	if (!pool)
+		return NULL;
+
+	pool->a = a;
+	pool->meta_off = NETBUF_POOL_ALIGN_UP(buflen);
+	pool->headroom = headroom;
+	pool->privlen = privlen;
+	pool->dtor = dtor;
+	obj_len = pool->meta_off
+		  + NETBUF_POOL_ALIGN_UP(sizeof(struct netbuf_pool_meta)
+					 + privlen);
+
+	/* Netbufs may be free'd from any context */
+#if CONFIG_LIBUKALLOCPOOL_LOCKFREE
+	pool->p = uk_allocpool_alloc_lockfree(a, count, obj_len, bufalign);
+#else
+	pool->p = uk_allocpool_alloc(a, count, obj_len, bufalign);
+#endif
+	if (!pool->p) {
+		uk_free(a, pool);
+		return NULL;
+	}
+	pool->count = uk_allocpool_availcount(pool->p);
+	UK_ASSERT(pool->count >= count);
+
+	/* Initialize every netbuf once: All objects are taken and linked
+	 * with the `next` field before they are returned
+	 */
+	while ((obj = uk_allocpool_take(pool->p)) != NULL) {
+		m = _obj2netbuf(pool, obj);
+		_netbuf_init(pool, __containerof(m, struct netbuf_pool_meta, m),
+			     obj);
+		m->next = head;
+		head = m;
+	}
+	while (head) {
+		m = head;
+		head = m->next;
+		m->next = NULL;
+		uk_allocpool_return(pool->p, m->buf);
+	}
+	uk_pr_debug("%p: Netbuf pool with %u netbufs of %"__PRIsz" B\n",
+		    pool, count, pool->meta_off);
+	return pool;
+}
+
+void uk_netbuf_pool_free(struct uk_netbuf_pool *p)
+{
+	UK_ASSERT(p);
+	/* Make sure we got all netbufs back */
+	UK_ASSERT(uk_allocpool_availcount(p->p) == p->count);
+
+	uk_allocpool_free(p->p);
+	uk_free(p->a, p);
+}
+
+struct uk_netbuf *uk_netbuf_pool_take(struct uk_netbuf_pool *p)
+{
+	void *obj;
+
+	UK_ASSERT(p);
+
+	obj = uk_allocpool_take(p->p);
+	if (unlikely(!obj))
+		return NULL;
+	return _obj2netbuf(p, obj);
+}
+
+unsigned int uk_netbuf_pool_take_batch(struct uk_netbuf_pool *p,
+				       struct uk_netbuf *m[],
+				       unsigned int count)
+{
+	void **obj = (void **) m;
+	unsigned int i, n;
+
+	UK_ASSERT(p);
+	UK_ASSERT(m);
+
+	/* The object references are replaced in place */
+	n = uk_allocpool_take_batch(p->p, obj, count);
+	for (i = 0; i < n; ++i)
+		m[i] = _obj2netbuf(p, obj[i]);
+	return n;
+}
+
+unsigned int uk_netbuf_pool_availcount(struct uk_netbuf_pool *p)
+{
+	UK_ASSERT(p);
+
+	return uk_allocpool_availcount(p->p);
+}
+
+uint16_t uk_netbuf_pool_alloc_rxpkts(void *argp, struct uk_netbuf *pkts[],
+				     uint16_t count)
+{
+	return (uint16_t) uk_netbuf_pool_take_batch(
+		(struct uk_netbuf_pool *) argp, pkts, count);
+}
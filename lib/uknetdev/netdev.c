@@ -39,6 +39,12 @@
 #include <uk/netdev.h>
 #include <uk/print.h>
 #include <uk/libparam.h>
+#ifdef CONFIG_LIBUKNETDEV_ADAPTIVEPOLL
+#include <uk/plat/time.h>
+#endif
+#ifdef CONFIG_LIBUKNETDEV_CLASSIFIER
+#include <uk/ring.h>
+#endif
 
 struct uk_netdev_list uk_netdev_list =
 	UK_TAILQ_HEAD_INITIALIZER(uk_netdev_list);
@@ -133,6 +139,91 @@ static struct uk_netdev_einfo *_alloc_einfo(struct uk_alloc *a)
 	return _einfo;
 }
 
+/*
+ * Compatibility wrappers for drivers that implement only one of the
+ * single-packet and the burst interface.
+ */
+static int _rx_burst_compat(struct uk_netdev *dev,
+			    struct uk_netdev_rx_queue *queue,
+			    struct uk_netbuf *pkt[], uint16_t *cnt)
+{
+	int status = 0x0;
+	uint16_t i = 0;
+	int rc;
+
+	while (i < *cnt) {
+		rc = dev->rx_one(dev, queue, &pkt[i]);
+		if (unlikely(rc < 0)) {
+			if (i == 0)
+				return rc;
+			break;
+		}
+		status |= rc & UK_NETDEV_STATUS_UNDERRUN;
+		if (!(rc & UK_NETDEV_STATUS_SUCCESS))
+			break;
+		i++;
+
+		/* Interrupts stay disabled as long as MORE is reported */
+		status &= ~UK_NETDEV_STATUS_MORE;
+		status |= rc & UK_NETDEV_STATUS_MORE;
+		if (!(rc & UK_NETDEV_STATUS_MORE))
+			break;
+	}
+
+	*cnt = i;
+	return status | ((i > 0) ? UK_NETDEV_STATUS_SUCCESS : 0x0);
+}
+
+static int _tx_burst_compat(struct uk_netdev *dev,
+			    struct uk_netdev_tx_queue *queue,
+			    struct uk_netbuf *pkt[], uint16_t *cnt)
+{
+	int status = 0x0;
+	uint16_t i = 0;
+	int rc;
+
+	while (i < *cnt) {
+		rc = dev->tx_one(dev, queue, pkt[i]);
+		if (unlikely(rc < 0)) {
+			if (i == 0)
+				return rc;
+			break;
+		}
+		if (!(rc & UK_NETDEV_STATUS_SUCCESS))
+			break;
+		i++;
+
+		status = rc & UK_NETDEV_STATUS_MORE;
+		if (!(rc & UK_NETDEV_STATUS_MORE))
+			break;
+	}
+
+	*cnt = i;
+	return status | ((i > 0) ? UK_NETDEV_STATUS_SUCCESS : 0x0);
+}
+
+static int _rx_one_compat(struct uk_netdev *dev,
+			  struct uk_netdev_rx_queue *queue,
+			  struct uk_netbuf **pkt)
+{
+	uint16_t cnt = 1;
+	int rc;
+
+	rc = dev->rx_burst(dev, queue, pkt, &cnt);
+	if (rc >= 0 && cnt == 0)
+		*pkt = NULL;
+	return rc;
+}
+
+static int _tx_one_compat(struct uk_netdev *dev,
+			  struct uk_netdev_tx_queue *queue,
+			  struct uk_netbuf *pkt)
+{
+	uint16_t cnt = 1;
+
+	return dev->tx_burst(dev, queue, &pkt, &cnt);
+}
+
 int uk_netdev_drv_register(struct uk_netdev *dev, struct uk_alloc *a,
 			   const char *drv_name)
 {
@@ -153,8 +244,17 @@ int uk_netdev_drv_register(struct uk_netdev *dev, struct uk_alloc *a,
 	UK_ASSERT((dev->ops->rxq_intr_enable && dev->ops->rxq_intr_disable)
 		  || (!dev->ops->rxq_intr_enable
 		      && !dev->ops->rxq_intr_disable));
-	UK_ASSERT(dev->rx_one);
-	UK_ASSERT(dev->tx_one);
+	UK_ASSERT(dev->rx_one || dev->rx_burst);
+	UK_ASSERT(dev->tx_one || dev->tx_burst);
+
+	if (!dev->rx_burst)
+		dev->rx_burst = _rx_burst_compat;
+	else if (!dev->rx_one)
+		dev->rx_one = _rx_one_compat;
+	if (!dev->tx_burst)
+		dev->tx_burst = _tx_burst_compat;
+	else if (!dev->tx_one)
+		dev->tx_one = _tx_one_compat;
 
 	dev->_data = _alloc_data(a, netdev_count,  drv_name);
 	if (!dev->_data)
@@ -303,6 +403,7 @@ int uk_netdev_configure(struct uk_netdev *dev,
 			const struct uk_netdev_conf *dev_conf)
 {
 	struct uk_netdev_info dev_info;
+	struct uk_netdev_conf conf;
 	int ret;
 
 	UK_ASSERT(dev);
@@ -320,7 +421,16 @@ int uk_netdev_configure(struct uk_netdev *dev,
 	if (dev_conf->nb_tx_queues > dev_info.max_tx_queues)
 		return -EINVAL;
 
-	ret = dev->ops->configure(dev, dev_conf);
+	/* Drivers only see offloads that were explicitly requested */
+	conf = *dev_conf;
+	if (conf.offloads_en != UK_NETDEV_CONF_OFFLOADS_EN) {
+		conf.offloads_en = 0;
+		conf.offloads = 0;
+	}
+	if (conf.offloads & ~dev_info.offloads)
+		return -ENOTSUP;
+
+	ret = dev->ops->configure(dev, &conf);
 	if (ret >= 0) {
 		uk_pr_info("netdev%"PRIu16": Configured interface\n",
 			   dev->_data->id);
@@ -332,6 +442,91 @@ int uk_netdev_configure(struct uk_netdev *dev,
 	return ret;
 }
 
+#ifdef CONFIG_LIBUKNETDEV_ADAPTIVEPOLL
+/* Time window in which the packet rate of a queue is observed */
+#define ADAPTIVE_WINDOW ukarch_time_msec_to_nsec(1)
+
+static void _configure_adaptive(struct uk_netdev_event_handler *h,
+				const struct uk_netdev_rxqueue_conf *rx_conf)
+{
+	uint32_t rate;
+
+	h->rx_pkts = 0;
+	h->polling = 0;
+	h->adaptive = (rx_conf->mode == UK_NETDEV_RXQ_MODE_ADAPTIVE);
+
+	rate = rx_conf->poll_rate ? rx_conf->poll_rate
+				  : CONFIG_LIBUKNETDEV_ADAPTIVEPOLL_RATE;
+	h->poll_thresh = MAX(1U, (uint32_t) (rate * ADAPTIVE_WINDOW
+					      / UKARCH_NSEC_PER_SEC));
+	h->poll_budget = rx_conf->poll_budget ? rx_conf->poll_budget
+		: CONFIG_LIBUKNETDEV_ADAPTIVEPOLL_BUDGET;
+	h->poll_timeout = rx_conf->poll_timeout ? rx_conf->poll_timeout
+		: ukarch_time_usec_to_nsec(
+				CONFIG_LIBUKNETDEV_ADAPTIVEPOLL_TIMEOUT);
+}
+
+static void _dispatcher_adaptive(struct uk_netdev_event_handler *h)
+{
+	__nsec now, win_start = 0, last_rx = 0;
+	uint32_t win_pkts = 0, round_pkts = 0;
+	uint64_t rcvd;
+	int rc;
+
+	for (;;) {
+		/* In interrupt mode, wait for the next queue event */
+		if (!h->polling)
+			uk_semaphore_down(&h->events);
+
+		rcvd = h->rx_pkts;
+		h->callback(h->dev, h->queue_id, h->cookie);
+		rcvd = h->rx_pkts - rcvd;
+		now = ukplat_monotonic_clock();
+
+		if (!h->polling) {
+			if (now - win_start >= ADAPTIVE_WINDOW) {
+				win_start = now;
+				win_pkts = 0;
+			}
+			win_pkts += rcvd;
+			if (win_pkts < h->poll_thresh)
+				continue;
+
+			/* High load: Poll the queue with interrupts disabled */
+			if (uk_netdev_rxq_intr_disable(h->dev, h->queue_id) < 0)
+				continue;
+			h->polling = 1;
+			last_rx = now;
+			round_pkts = 0;
+			win_pkts = 0;
+			continue;
+		}
+
+		if (rcvd) {
+			last_rx = now;
+			round_pkts += rcvd;
+		} else if (now - last_rx >= h->poll_timeout) {
+			/* Low load: Return to interrupt mode. Packets that
+			 * arrived in the meantime are left on the queue and
+			 * have to be received before the driver arms the
+			 * interrupt again.
+			 */
+			h->polling = 0;
+			rc = uk_netdev_rxq_intr_enable(h->dev, h->queue_id);
+			if (rc == 1)
+				uk_semaphore_up(&h->events);
+			continue;
+		}
+
+		/* Let other threads run after an idle round or a budget */
+		if (!rcvd || round_pkts >= h->poll_budget) {
+			round_pkts = 0;
+			uk_sched_yield();
+		}
+	}
+}
+#endif
+
 #ifdef CONFIG_LIBUKNETDEV_DISPATCHERTHREADS
 static void _dispatcher(void *arg)
 {
@@ -341,6 +536,13 @@ static void _dispatcher(void *arg)
 	UK_ASSERT(handler);
 	UK_ASSERT(handler->callback);
 
+#ifdef CONFIG_LIBUKNETDEV_ADAPTIVEPOLL
+	if (handler->adaptive) {
+		_dispatcher_adaptive(handler);
+		return;
+	}
+#endif
+
 	for (;;) {
 		uk_semaphore_down(&handler->events);
 		handler->callback(handler->dev,
@@ -356,6 +558,7 @@ static int _create_event_handler(uk_netdev_queue_event_t callback,
 				 struct uk_netdev *dev, uint16_t queue_id,
 				 const char *queue_type_str,
 				 struct uk_sched *s,
+				 const uk_thread_attr_t *attr,
 #endif
 				 struct uk_netdev_event_handler *h)
 {
@@ -388,7 +591,7 @@ static int _create_event_handler(uk_netdev_queue_event_t callback,
 	}
 
 	h->dispatcher = uk_sched_thread_create(h->dispatcher_s,
-					       h->dispatcher_name, NULL,
+					       h->dispatcher_name, attr,
 					       _dispatcher, h);
 	if (!h->dispatcher) {
 		if (h->dispatcher_name)
@@ -425,6 +628,9 @@ int uk_netdev_rxq_configure(struct uk_netdev *dev, uint16_t queue_id,
 			    uint16_t nb_desc,
 			    struct uk_netdev_rxqueue_conf *rx_conf)
 {
+#ifdef CONFIG_LIBUKNETDEV_CLASSIFIER
+	struct uk_netdev_rxq_classifier *c;
+#endif
 	int err;
 
 	UK_ASSERT(dev);
@@ -446,9 +652,27 @@ int uk_netdev_rxq_configure(struct uk_netdev *dev, uint16_t queue_id,
 	if (!PTRISERR(dev->_rx_queue[queue_id]))
 		return -EBUSY;
 
+#ifdef CONFIG_LIBUKNETDEV_ADAPTIVEPOLL
+	/* Set up before the dispatcher thread gets started */
+	_configure_adaptive(&dev->_data->rxq_handler[queue_id], rx_conf);
+#endif
+
+#ifdef CONFIG_LIBUKNETDEV_CLASSIFIER
+	/* Every queue can be the target of a redirect */
+	c = &dev->_data->rxq_classifier[queue_id];
+	memset(c, 0, sizeof(*c));
+	c->backlog = uk_ring_alloc(CONFIG_LIBUKNETDEV_CLASSIFIER_BACKLOG,
+				   rx_conf->a);
+	if (!c->backlog)
+		return -ENOMEM;
+	c->fn = rx_conf->classifier;
+	c->cookie = rx_conf->classifier_cookie;
+#endif
+
 	err = _create_event_handler(rx_conf->callback, rx_conf->callback_cookie,
 #ifdef CONFIG_LIBUKNETDEV_DISPATCHERTHREADS
 				    dev, queue_id, "rxq", rx_conf->s,
+				    rx_conf->attr,
 #endif
 				    &dev->_data->rxq_handler[queue_id]);
 	if (err)
@@ -468,6 +692,10 @@ int uk_netdev_rxq_configure(struct uk_netdev *dev, uint16_t queue_id,
 err_destroy_handler:
 	_destroy_event_handler(&dev->_data->rxq_handler[queue_id]);
 err_out:
+#ifdef CONFIG_LIBUKNETDEV_CLASSIFIER
+	uk_ring_free(c->backlog, rx_conf->a);
+	c->backlog = NULL;
+#endif
 	return err;
 }
 
@@ -0,0 +1,126 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Queue statistics for uknetdev
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * The counters live in the libuknetdev private data of each device and are
+ * updated by the drivers with uk_netdev_drv_rxq_stats_add() and
+ * uk_netdev_drv_txq_stats_add(). Like the queues themselves, they are not
+ * protected against concurrent updates.
+ */
+
+#include <string.h>
+#include <inttypes.h>
+#include <uk/netdev.h>
+#include <uk/assert.h>
+#include <uk/report.h>
+
+void uk_netdev_stats_get(struct uk_netdev *dev,
+			 struct uk_netdev_stats *stats)
+{
+	uint16_t i;
+
+	UK_ASSERT(dev);
+	UK_ASSERT(dev->_data);
+	UK_ASSERT(stats);
+
+	memset(stats, 0, sizeof(*stats));
+
+	/* Report the queues up to the last configured one */
+	for (i = 0; i < CONFIG_LIBUKNETDEV_MAXNBQUEUES; ++i) {
+		if (!PTRISERR(dev->_rx_queue[i]))
+			stats->nb_rx_queues = i + 1;
+		if (!PTRISERR(dev->_tx_queue[i]))
+			stats->nb_tx_queues = i + 1;
+	}
+	memcpy(stats->rxq, dev->_data->rxq_stats,
+	       stats->nb_rx_queues * sizeof(stats->rxq[0]));
+	memcpy(stats->txq, dev->_data->txq_stats,
+	       stats->nb_tx_queues * sizeof(stats->txq[0]));
+}
+
+void uk_netdev_stats_reset(struct uk_netdev *dev)
+{
+	UK_ASSERT(dev);
+	UK_ASSERT(dev->_data);
+
+	memset(dev->_data->rxq_stats, 0, sizeof(dev->_data->rxq_stats));
+	memset(dev->_data->txq_stats, 0, sizeof(dev->_data->txq_stats));
+}
+
+/*
+ * Report
+ */
+static void stats_report(struct uk_report *o)
+{
+	struct uk_netdev_stats stats;
+	struct uk_netdev_queue_stats *q;
+	struct uk_netdev *dev;
+	unsigned int i;
+	uint16_t j;
+
+	for (i = 0; i < uk_netdev_count(); ++i) {
+		dev = uk_netdev_get(i);
+		if (!dev)
+			continue;
+
+		uk_netdev_stats_get(dev, &stats);
+		uk_report_printf(o, "netdev%u (%s):\n", i,
+				 uk_netdev_drv_name_get(dev) ?: "unknown");
+		for (j = 0; j < stats.nb_rx_queues; ++j) {
+			q = &stats.rxq[j];
+			uk_report_printf(o, "  rxq%"PRIu16": packets %"PRIu64
+					 " bytes %"PRIu64" errors %"PRIu64
+					 " drops %"PRIu64" refill-fail %"PRIu64
+					 " irqs %"PRIu64"\n",
+					 j, q->packets, q->bytes, q->errors,
+					 q->drops, q->refill_fail, q->irqs);
+		}
+		for (j = 0; j < stats.nb_tx_queues; ++j) {
+			q = &stats.txq[j];
+			uk_report_printf(o, "  txq%"PRIu16": packets %"PRIu64
+					 " bytes %"PRIu64" errors %"PRIu64
+					 " ring-full %"PRIu64"\n",
+					 j, q->packets, q->bytes, q->errors,
+					 q->ring_full);
+		}
+	}
+}
+
+size_t uk_netdev_stats_print(char *buf, size_t len)
+{
+	return uk_report_print(stats_report, buf, len);
+}
+
+void uk_netdev_stats_dump(void)
+{
+	uk_report_dump(stats_report);
+}
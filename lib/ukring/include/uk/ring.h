@@ -52,14 +52,14 @@ struct uk_ring {
 	int               br_prod_size;
 	int               br_prod_mask;
 	uint64_t          br_drops;
-	volatile uint32_t br_cons_head __aligned(CACHE_LINE_SIZE);
+	volatile uint32_t br_cons_head __align(CACHE_LINE_SIZE);
 	volatile uint32_t br_cons_tail;
 	int               br_cons_size;
 	int               br_cons_mask;
 #ifdef DEBUG_BUFRING
 	struct uk_mutex  *br_lock;
 #endif
-	void             *br_ring[0] __aligned(CACHE_LINE_SIZE);
+	void             *br_ring[0] __align(CACHE_LINE_SIZE);
 };
 
 /*
@@ -99,8 +99,8 @@ uk_ring_enqueue(struct uk_ring *br, void *buf)
 			}
 			continue;
 		}
-	} while (!ukarch_compare_exchange_sync((uint32_t *) &br->br_prod_head,
-			prod_head, prod_next));
+	} while (ukarch_compare_exchange_sync((uint32_t *) &br->br_prod_head,
+			prod_head, prod_next) != prod_next);
 
 #ifdef DEBUG_BUFRING
 	if (br->br_ring[prod_head] != NULL)
@@ -139,8 +139,8 @@ uk_ring_dequeue_mc(struct uk_ring *br)
 			critical_exit();
 			return NULL;
 		}
-	} while (!ukarch_compare_exchange_sync((uint32_t *) &br->br_cons_head,
-			cons_head, cons_next));
+	} while (ukarch_compare_exchange_sync((uint32_t *) &br->br_cons_head,
+			cons_head, cons_next) != cons_next);
 
 	buf = br->br_ring[cons_head];
 #ifdef DEBUG_BUFRING
@@ -332,8 +332,7 @@ uk_ring_peek_clear_sc(struct uk_ring *br)
 	 * conditional check will be true, so we will return previously fetched
 	 * (and invalid) buffer.
 	 */
-	#error "unsupported: atomic_thread_fence_acq()"
-	/* TODO atomic_thread_fence_acq(); */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
 #endif
 
 #ifdef DEBUG_BUFRING
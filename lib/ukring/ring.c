@@ -46,7 +46,8 @@ uk_ring_alloc(int count, struct uk_alloc *a
 	/* buf ring must be size power of 2 */
 	UK_ASSERT(POWER_OF_2(count));
 
-	br = uk_malloc(a, sizeof(struct uk_ring) + count * sizeof(caddr_t));
+	br = uk_memalign(a, CACHE_LINE_SIZE,
+			 sizeof(struct uk_ring) + count * sizeof(void *));
 	if (br == NULL)
 		return NULL;
 #ifdef DEBUG_BUFRING
@@ -56,6 +57,7 @@ uk_ring_alloc(int count, struct uk_alloc *a
 	br->br_prod_mask = br->br_cons_mask = count - 1;
 	br->br_prod_head = br->br_cons_head = 0;
 	br->br_prod_tail = br->br_cons_tail = 0;
+	br->br_drops = 0;
 
 	return br;
 }
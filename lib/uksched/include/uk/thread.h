@@ -39,6 +39,9 @@
 #if CONFIG_LIBUKSIGNAL
 #include <uk/uk_signal.h>
 #endif
+#if CONFIG_LIBUKALLOC_CACHE
+#include <uk/alloc_cache.h>
+#endif
 #include <uk/thread_attr.h>
 #include <uk/wait_types.h>
 #include <uk/list.h>
@@ -68,6 +71,9 @@ struct uk_thread {
 #if CONFIG_LIBUKSIGNAL
 	struct uk_thread_sig signals_container;
 #endif
+#if CONFIG_LIBUKALLOC_CACHE
+	struct uk_alloc_magazines *alloc_cache;
+#endif
 };
 
 UK_TAILQ_HEAD(uk_thread_list, struct uk_thread);
@@ -141,6 +141,10 @@ struct uk_sched *uk_sched_create(struct uk_alloc *a, size_t prv_size)
 void uk_sched_start(struct uk_sched *sched)
 {
 	UK_ASSERT(sched != NULL);
+#if CONFIG_LIBUKALLOC_CACHE
+	/* Threads use their own magazines, return the ones used for booting */
+	uk_alloc_cache_flush();
+#endif
 	ukplat_thread_ctx_start(&sched->plat_ctx_cbs, sched->idle.ctx);
 }
 
@@ -128,6 +128,9 @@ int uk_thread_init(struct uk_thread *thread,
 #if CONFIG_LIBUKSIGNAL
 	uk_thread_sig_init(&thread->signals_container);
 #endif
+#if CONFIG_LIBUKALLOC_CACHE
+	thread->alloc_cache = NULL;
+#endif
 
 	uk_pr_info("Thread \"%s\": pointer: %p, stack: %p, tls: %p\n",
 		   name, thread, thread->stack, thread->tls);
@@ -140,6 +143,9 @@ void uk_thread_fini(struct uk_thread *thread, struct uk_alloc *allocator)
 	UK_ASSERT(thread != NULL);
 #if CONFIG_LIBUKSIGNAL
 	uk_thread_sig_uninit(&thread->signals_container);
+#endif
+#if CONFIG_LIBUKALLOC_CACHE
+	uk_alloc_cache_release(&thread->alloc_cache);
 #endif
 	ukplat_thread_ctx_destroy(allocator, thread->ctx);
 }
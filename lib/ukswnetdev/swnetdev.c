@@ -0,0 +1,489 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Software loopback and veth network devices
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Each receive queue is a uk_ring of netbufs. Transmitting on a queue
+ * enqueues the netbufs to the receive queue with the same index (modulo the
+ * number of receive queues) of the peer device, which is the device itself
+ * for the loopback device. The receive buffer allocator of a queue is not
+ * used. If interrupts of the receiving queue are enabled, the transmitting
+ * context raises its queue event. Queue interrupts are only provided with
+ * dispatcher threads, which take the event handling out of the transmitting
+ * context. Otherwise the receive callback would run nested in the transmit
+ * call of the peer.
+ * Like with other drivers, a queue must not be used concurrently.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <uk/alloc.h>
+#include <uk/arch/atomic.h>
+#include <uk/arch/lcpu.h>
+#include <uk/assert.h>
+#include <uk/print.h>
+#include <uk/bus.h>
+#include <uk/ring.h>
+#include <uk/netdev.h>
+#include <uk/netdev_driver.h>
+
+#define SWNET_LO_NAME		"loopback"
+#define SWNET_VETH_NAME		"veth"
+
+#define SWNET_DEF_DESC		256
+#define SWNET_MAX_DESC		4096
+
+#define to_swnet_dev(ndev) \
+	__containerof(ndev, struct swnet_dev, netdev)
+
+struct swnet_dev;
+
+struct uk_netdev_rx_queue {
+	struct swnet_dev *sdev;
+	uint16_t lqueue_id;
+	/* Set while the user has enabled interrupts */
+	uint8_t intr_enabled;
+	/* Set while the interrupt is armed, cleared by whoever raises it */
+	int intr_armed;
+	/* Received netbufs, enqueued by the transmitting peer */
+	struct uk_ring *ring;
+};
+
+struct uk_netdev_tx_queue {
+	struct swnet_dev *sdev;
+	uint16_t lqueue_id;
+};
+
+struct swnet_dev {
+	struct uk_netdev netdev;
+	/* Receiver of the transmitted packets, can be the device itself */
+	struct swnet_dev *peer;
+	int running;
+	uint16_t mtu;
+	unsigned int promisc;
+	struct uk_hwaddr hwaddr;
+	uint16_t nb_rx_queues;
+	struct uk_netdev_rx_queue rxqs[CONFIG_LIBUKNETDEV_MAXNBQUEUES];
+	struct uk_netdev_tx_queue txqs[CONFIG_LIBUKNETDEV_MAXNBQUEUES];
+};
+
+static struct uk_alloc *a;
+static unsigned int sdevs_count;
+
+/*
+ * Arms the receive interrupt. Returns 1 if packets are pending, in that
+ * case the interrupt stays disarmed.
+ */
+static int swnet_rxq_arm(struct uk_netdev_rx_queue *rxq)
+{
+	ukarch_store_n(&rxq->intr_armed, 1);
+	/* Pairs with the fence in swnet_rxq_notify(): Either we see the
+	 * enqueued packets or the sender sees the armed interrupt.
+	 */
+	mb();
+	if (uk_ring_empty(rxq->ring))
+		return 0;
+
+	/* If the sender took the interrupt already, its event is raised */
+	return ukarch_exchange_n(&rxq->intr_armed, 0);
+}
+
+/* Raises the queue event if the receive interrupt is armed */
+static void swnet_rxq_notify(struct uk_netdev_rx_queue *rxq)
+{
+	/* Order the ring enqueue before checking the interrupt */
+	mb();
+	if (!ukarch_load_n(&rxq->intr_armed))
+		return;
+
+	/* Interrupts stay off until the queue was drained */
+	if (ukarch_exchange_n(&rxq->intr_armed, 0))
+		uk_netdev_drv_rx_event(&rxq->sdev->netdev, rxq->lqueue_id);
+}
+
+static inline unsigned long _pktlen(struct uk_netbuf *pkt)
+{
+	struct uk_netbuf *nb;
+	unsigned long len = 0;
+
+	UK_NETBUF_CHAIN_FOREACH(nb, pkt)
+		len += nb->len;
+	return len;
+}
+
+static int swnet_recv_burst(struct uk_netdev *dev,
+			    struct uk_netdev_rx_queue *rxq,
+			    struct uk_netbuf *pkt[],
+			    uint16_t *cnt)
+{
+	int status = 0x0;
+	uint16_t i;
+
+	UK_ASSERT(dev && rxq);
+	UK_ASSERT(pkt && cnt);
+
+	/* Queue interrupts have to be off when calling receive */
+	UK_ASSERT(!ukarch_load_n(&rxq->intr_armed));
+
+	for (i = 0; i < *cnt; ++i) {
+		pkt[i] = uk_ring_dequeue_sc(rxq->ring);
+		if (!pkt[i])
+			break;
+		uk_netdev_drv_rxq_stats_add(dev, rxq->lqueue_id, packets, 1);
+		uk_netdev_drv_rxq_stats_add(dev, rxq->lqueue_id, bytes,
+					    _pktlen(pkt[i]));
+	}
+
+	if (!uk_ring_empty(rxq->ring)) {
+		status |= UK_NETDEV_STATUS_MORE;
+	} else if (rxq->intr_enabled) {
+		/* Enable the interrupt only when user had previously enabled
+		 * it. Packets that arrived after draining the queue are
+		 * reported with UK_NETDEV_STATUS_MORE.
+		 */
+		if (swnet_rxq_arm(rxq))
+			status |= UK_NETDEV_STATUS_MORE;
+	}
+
+	*cnt = i;
+	return status | ((i > 0) ? UK_NETDEV_STATUS_SUCCESS : 0x0);
+}
+
+static int swnet_xmit_burst(struct uk_netdev *dev,
+			    struct uk_netdev_tx_queue *txq,
+			    struct uk_netbuf *pkt[],
+			    uint16_t *cnt)
+{
+	struct uk_netdev_rx_queue *rxq;
+	struct swnet_dev *peer;
+	unsigned long len;
+	uint16_t i;
+
+	UK_ASSERT(dev && txq);
+	UK_ASSERT(pkt && cnt);
+
+	peer = to_swnet_dev(dev)->peer;
+	if (unlikely(!peer || !peer->running || peer->nb_rx_queues == 0)) {
+		/* Like on a cable without receiver, the packets are lost */
+		for (i = 0; i < *cnt; ++i)
+			uk_netbuf_free(pkt[i]);
+		uk_netdev_drv_txq_stats_add(dev, txq->lqueue_id, packets, i);
+		return UK_NETDEV_STATUS_SUCCESS | UK_NETDEV_STATUS_MORE;
+	}
+
+	rxq = &peer->rxqs[txq->lqueue_id % peer->nb_rx_queues];
+	for (i = 0; i < *cnt; ++i) {
+		/* The receiver owns the netbuf as soon as it is enqueued */
+		len = _pktlen(pkt[i]);
+		if (uk_ring_enqueue(rxq->ring, pkt[i]) < 0)
+			break;
+		uk_netdev_drv_txq_stats_add(dev, txq->lqueue_id, bytes, len);
+	}
+	uk_netdev_drv_txq_stats_add(dev, txq->lqueue_id, packets, i);
+
+	if (i > 0)
+		swnet_rxq_notify(rxq);
+
+	if (i < *cnt) {
+		/* The receiving queue is full, the caller has to retry */
+		uk_netdev_drv_txq_stats_add(dev, txq->lqueue_id,
+					    ring_full, 1);
+		*cnt = i;
+		return (i > 0) ? UK_NETDEV_STATUS_SUCCESS : 0x0;
+	}
+	return UK_NETDEV_STATUS_SUCCESS
+		| (!uk_ring_full(rxq->ring) ? UK_NETDEV_STATUS_MORE : 0x0);
+}
+
+#if CONFIG_LIBUKNETDEV_DISPATCHERTHREADS
+static int swnet_rxq_intr_enable(struct uk_netdev *dev __unused,
+				 struct uk_netdev_rx_queue *rxq)
+{
+	UK_ASSERT(rxq);
+
+	if (ukarch_load_n(&rxq->intr_armed))
+		return 0;
+
+	rxq->intr_enabled = 1;
+	return swnet_rxq_arm(rxq);
+}
+
+static int swnet_rxq_intr_disable(struct uk_netdev *dev __unused,
+				  struct uk_netdev_rx_queue *rxq)
+{
+	UK_ASSERT(rxq);
+
+	rxq->intr_enabled = 0;
+	ukarch_store_n(&rxq->intr_armed, 0);
+	return 0;
+}
+#endif /* CONFIG_LIBUKNETDEV_DISPATCHERTHREADS */
+
+static void swnet_info_get(struct uk_netdev *dev __unused,
+			   struct uk_netdev_info *dev_info)
+{
+	UK_ASSERT(dev_info);
+
+	dev_info->max_rx_queues = CONFIG_LIBUKNETDEV_MAXNBQUEUES;
+	dev_info->max_tx_queues = CONFIG_LIBUKNETDEV_MAXNBQUEUES;
+	dev_info->in_queue_pairs = 0;
+	dev_info->max_mtu = UK_ETH_JPAYLOAD_MAXLEN;
+	dev_info->nb_encap_tx = 0;
+	dev_info->nb_encap_rx = 0;
+	dev_info->ioalign = sizeof(void *);
+#if CONFIG_LIBUKNETDEV_DISPATCHERTHREADS
+	dev_info->features = UK_FEATURE_RXQ_INTR_AVAILABLE;
+#else
+	dev_info->features = 0;
+#endif
+}
+
+static int swnet_configure(struct uk_netdev *dev,
+			   const struct uk_netdev_conf *conf)
+{
+	UK_ASSERT(dev && conf);
+
+	to_swnet_dev(dev)->nb_rx_queues = conf->nb_rx_queues;
+	return 0;
+}
+
+static int swnet_queue_info_get(struct uk_netdev *dev __unused,
+				uint16_t queue_id __unused,
+				struct uk_netdev_queue_info *qinfo)
+{
+	UK_ASSERT(qinfo);
+
+	qinfo->nb_min = 2;
+	qinfo->nb_max = SWNET_MAX_DESC;
+	qinfo->nb_is_power_of_two = 1;
+	return 0;
+}
+
+static struct uk_netdev_rx_queue *swnet_rxq_configure(struct uk_netdev *dev,
+		uint16_t queue_id, uint16_t nb_desc,
+		struct uk_netdev_rxqueue_conf *conf)
+{
+	struct swnet_dev *sdev;
+	struct uk_netdev_rx_queue *rxq;
+
+	UK_ASSERT(dev && conf);
+
+	sdev = to_swnet_dev(dev);
+	rxq = &sdev->rxqs[queue_id];
+	if (nb_desc == 0)
+		nb_desc = SWNET_DEF_DESC;
+	if (unlikely(!POWER_OF_2(nb_desc) || nb_desc < 2
+		     || nb_desc > SWNET_MAX_DESC))
+		return ERR2PTR(-EINVAL);
+
+	/* A ring keeps one slot free */
+	rxq->ring = uk_ring_alloc(nb_desc, conf->a);
+	if (!rxq->ring)
+		return ERR2PTR(-ENOMEM);
+	rxq->sdev = sdev;
+	rxq->lqueue_id = queue_id;
+	rxq->intr_enabled = 0;
+	rxq->intr_armed = 0;
+	return rxq;
+}
+
+static struct uk_netdev_tx_queue *swnet_txq_configure(struct uk_netdev *dev,
+		uint16_t queue_id, uint16_t nb_desc __unused,
+		struct uk_netdev_txqueue_conf *conf __unused)
+{
+	struct swnet_dev *sdev;
+
+	UK_ASSERT(dev);
+
+	sdev = to_swnet_dev(dev);
+	sdev->txqs[queue_id].sdev = sdev;
+	sdev->txqs[queue_id].lqueue_id = queue_id;
+	return &sdev->txqs[queue_id];
+}
+
+static int swnet_start(struct uk_netdev *dev)
+{
+	uint16_t i;
+
+	UK_ASSERT(dev);
+
+	/* Packets can only be delivered when all queues are set up */
+	for (i = 0; i < to_swnet_dev(dev)->nb_rx_queues; ++i)
+		if (!to_swnet_dev(dev)->rxqs[i].ring)
+			return -EINVAL;
+
+	to_swnet_dev(dev)->running = 1;
+	return 0;
+}
+
+static const struct uk_hwaddr *swnet_hwaddr_get(struct uk_netdev *dev)
+{
+	UK_ASSERT(dev);
+
+	return &to_swnet_dev(dev)->hwaddr;
+}
+
+static int swnet_hwaddr_set(struct uk_netdev *dev,
+			    const struct uk_hwaddr *hwaddr)
+{
+	UK_ASSERT(dev && hwaddr);
+
+	/* All packets are delivered, the address is used by the network
+	 * stack only
+	 */
+	to_swnet_dev(dev)->hwaddr = *hwaddr;
+	return 0;
+}
+
+static unsigned int swnet_promisc_get(struct uk_netdev *dev)
+{
+	UK_ASSERT(dev);
+
+	return to_swnet_dev(dev)->promisc;
+}
+
+static int swnet_promisc_set(struct uk_netdev *dev, unsigned int mode)
+{
+	UK_ASSERT(dev);
+
+	to_swnet_dev(dev)->promisc = mode;
+	return 0;
+}
+
+static uint16_t swnet_mtu_get(struct uk_netdev *dev)
+{
+	UK_ASSERT(dev);
+
+	return to_swnet_dev(dev)->mtu;
+}
+
+static int swnet_mtu_set(struct uk_netdev *dev, uint16_t mtu)
+{
+	UK_ASSERT(dev);
+
+	if (mtu > UK_ETH_JPAYLOAD_MAXLEN)
+		return -EINVAL;
+	to_swnet_dev(dev)->mtu = mtu;
+	return 0;
+}
+
+static const struct uk_netdev_ops swnet_ops = {
+	.configure = swnet_configure,
+	.rxq_configure = swnet_rxq_configure,
+	.txq_configure = swnet_txq_configure,
+	.start = swnet_start,
+#if CONFIG_LIBUKNETDEV_DISPATCHERTHREADS
+	.rxq_intr_enable = swnet_rxq_intr_enable,
+	.rxq_intr_disable = swnet_rxq_intr_disable,
+#endif
+	.info_get = swnet_info_get,
+	.promiscuous_get = swnet_promisc_get,
+	.promiscuous_set = swnet_promisc_set,
+	.hwaddr_get = swnet_hwaddr_get,
+	.hwaddr_set = swnet_hwaddr_set,
+	.mtu_get = swnet_mtu_get,
+	.mtu_set = swnet_mtu_set,
+	.txq_info_get = swnet_queue_info_get,
+	.rxq_info_get = swnet_queue_info_get,
+};
+
+static struct swnet_dev *swnet_add_dev(const char *drv_name)
+{
+	struct swnet_dev *sdev;
+	int rc;
+
+	sdev = uk_calloc(a, 1, sizeof(*sdev));
+	if (!sdev)
+		return NULL;
+
+	sdev->mtu = UK_ETH_PAYLOAD_MAXLEN;
+	/* Locally administered address */
+	sdev->hwaddr.addr_bytes[0] = 0x02;
+	sdev->hwaddr.addr_bytes[1] = 0x75;
+	sdev->hwaddr.addr_bytes[2] = 0x6b;
+	sdev->hwaddr.addr_bytes[3] = 0x73;
+	sdev->hwaddr.addr_bytes[4] = 0x77;
+	sdev->hwaddr.addr_bytes[5] = sdevs_count;
+
+	sdev->netdev.rx_burst = swnet_recv_burst;
+	sdev->netdev.tx_burst = swnet_xmit_burst;
+	sdev->netdev.ops = &swnet_ops;
+
+	rc = uk_netdev_drv_register(&sdev->netdev, a, drv_name);
+	if (rc < 0) {
+		uk_pr_err("Failed to register %s device: %d\n", drv_name, rc);
+		uk_free(a, sdev);
+		return NULL;
+	}
+
+	sdevs_count++;
+	uk_pr_info("Registered %s device %d\n", drv_name, rc);
+	return sdev;
+}
+
+static int swnet_probe(void)
+{
+	struct swnet_dev *sdev, *peer;
+	int i;
+
+#if CONFIG_LIBUKSWNETDEV_LOOPBACK
+	sdev = swnet_add_dev(SWNET_LO_NAME);
+	if (!sdev)
+		return -ENOMEM;
+	sdev->peer = sdev;
+#endif
+
+	for (i = 0; i < CONFIG_LIBUKSWNETDEV_VETH_PAIRS; ++i) {
+		sdev = swnet_add_dev(SWNET_VETH_NAME);
+		if (!sdev)
+			return -ENOMEM;
+		peer = swnet_add_dev(SWNET_VETH_NAME);
+		if (!peer)
+			return -ENOMEM;
+		sdev->peer = peer;
+		peer->peer = sdev;
+	}
+	return 0;
+}
+
+static int swnet_init(struct uk_alloc *drv_allocator)
+{
+	UK_ASSERT(drv_allocator);
+
+	a = drv_allocator;
+	return 0;
+}
+
+static struct uk_bus swnet_bus = {
+	.init = swnet_init,
+	.probe = swnet_probe,
+};
+UK_BUS_REGISTER(&swnet_bus);
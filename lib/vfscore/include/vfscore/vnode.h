@@ -171,6 +171,10 @@ typedef int (*vnop_cache_t) (struct vnode *, struct vfscore_file *, struct uio *
 typedef int (*vnop_fallocate_t) (struct vnode *, int, off_t, off_t);
 typedef int (*vnop_readlink_t)  (struct vnode *, struct uio *);
 typedef int (*vnop_symlink_t)   (struct vnode *, char *, char *);
+typedef int (*vnop_mmap_t)      (struct vnode *, struct vfscore_file *,
+				 off_t, size_t, void **);
+typedef int (*vnop_munmap_t)    (struct vnode *, struct vfscore_file *,
+				 off_t, size_t);
 
 /*
  * vnode operations
@@ -199,6 +203,15 @@ struct vnops {
 	vnop_fallocate_t	vop_fallocate;
 	vnop_readlink_t		vop_readlink;
 	vnop_symlink_t		vop_symlink;
+	/*
+	 * Optional, NULL if files cannot be memory-mapped. vop_mmap returns
+	 * the address of the file data at the given offset if it is kept in
+	 * memory and page-aligned; the data stays in place until vop_munmap
+	 * is called with the same range. Otherwise, *addr is set to NULL and
+	 * the mapping is populated with vop_read.
+	 */
+	vnop_mmap_t		vop_mmap;
+	vnop_munmap_t		vop_munmap;
 };
 
 /*
@@ -228,6 +241,10 @@ struct vnops {
 #define VOP_FALLOCATE(VP, M, OFF, LEN) ((VP)->v_op->vop_fallocate)(VP, M, OFF, LEN)
 #define VOP_READLINK(VP, U)        ((VP)->v_op->vop_readlink)(VP, U)
 #define VOP_SYMLINK(DVP, OP, NP)   ((DVP)->v_op->vop_symlink)(DVP, OP, NP)
+#define VOP_MMAP(VP, FP, OFF, LEN, A) \
+			   ((VP)->v_op->vop_mmap)(VP, FP, OFF, LEN, A)
+#define VOP_MUNMAP(VP, FP, OFF, LEN) \
+			   ((VP)->v_op->vop_munmap)(VP, FP, OFF, LEN)
 
 int	 vfscore_vop_nullop(void);
 int	 vfscore_vop_einval(void);
@@ -307,8 +307,8 @@ ssize_t pread(int fd, void *buf, size_t count, off_t offset)
 	return bytes;
 
 out_errno:
-	trace_vfs_pread_err(bytes);
-	errno = bytes;
+	/* errno is set by preadv() */
+	trace_vfs_pread_err(errno);
 	return -1;
 }
 
@@ -337,7 +337,7 @@ UK_SYSCALL_R_DEFINE(ssize_t, preadv, int, fd, const struct iovec*, iov,
 		goto out_error;
 
 	/* Check if the file is indeed seekable. */
-	if (!(fp->f_vfs_flags & UK_VFSCORE_NOPOS)) {
+	if (offset != -1 && (fp->f_vfs_flags & UK_VFSCORE_NOPOS)) {
 		error = ESPIPE;
 		goto out_error_fdrop;
 	}
@@ -356,7 +356,7 @@ UK_SYSCALL_R_DEFINE(ssize_t, preadv, int, fd, const struct iovec*, iov,
 out_error_fdrop:
 	fdrop(fp);
 
-	if (error < 0)
+	if (error)
 		goto out_error;
 
 	trace_vfs_preadv_ret(bytes);
@@ -397,8 +397,8 @@ ssize_t pwrite(int fd, const void *buf, size_t count, off_t offset)
 	return bytes;
 
 out_errno:
-	trace_vfs_pwrite_err(bytes);
-	errno = bytes;
+	/* errno is set by pwritev() */
+	trace_vfs_pwrite_err(errno);
 	return -1;
 }
 
@@ -427,7 +427,7 @@ UK_SYSCALL_R_DEFINE(ssize_t, pwritev, int, fd, const struct iovec*, iov,
 		goto out_error;
 
 	/* Check if the file is indeed seekable. */
-	if (!(fp->f_vfs_flags & UK_VFSCORE_NOPOS)) {
+	if (offset != -1 && (fp->f_vfs_flags & UK_VFSCORE_NOPOS)) {
 		error = ESPIPE;
 		goto out_error_fdrop;
 	}
@@ -446,7 +446,7 @@ UK_SYSCALL_R_DEFINE(ssize_t, pwritev, int, fd, const struct iovec*, iov,
 out_error_fdrop:
 	fdrop(fp);
 
-	if (error < 0)
+	if (error)
 		goto out_error;
 
 	trace_vfs_pwritev_ret(bytes);
@@ -421,6 +421,8 @@ static int pipe_ioctl(struct vnode *vnode,
 #define pipe_readlink    ((vnop_readlink_t) vfscore_vop_einval)
 #define pipe_symlink     ((vnop_symlink_t) vfscore_vop_eperm)
 #define pipe_fallocate   ((vnop_fallocate_t) vfscore_vop_nullop)
+#define pipe_mmap        ((vnop_mmap_t) NULL)
+#define pipe_munmap      ((vnop_munmap_t) NULL)
 
 static struct vnops pipe_vnops = {
 	.vop_open      = pipe_open,
@@ -445,7 +447,9 @@ static struct vnops pipe_vnops = {
 	.vop_cache     = pipe_cache,
 	.vop_fallocate = pipe_fallocate,
 	.vop_readlink  = pipe_readlink,
-	.vop_symlink   = pipe_symlink
+	.vop_symlink   = pipe_symlink,
+	.vop_mmap      = pipe_mmap,
+	.vop_munmap    = pipe_munmap
 };
 
 #define pipe_vget  ((vfsop_vget_t) vfscore_vop_nullop)
@@ -184,6 +184,8 @@ static struct vnops stdio_vnops = {
 	stdio_fallocate,	/* fallocate */
 	stdio_readlink,		/* read link */
 	stdio_symlink,		/* symbolic link */
+	(vnop_mmap_t) NULL, /* mmap */
+	(vnop_munmap_t) NULL, /* munmap */
 };
 
 static struct vnode stdio_vnode = {
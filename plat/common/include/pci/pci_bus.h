@@ -152,8 +152,37 @@ struct pci_device {
 
 	uint16_t base;
 	unsigned long irq;
+
+	/**< MSI-X table, mapped by pci_msix_enable() */
+	volatile uint32_t *msix_table;
 };
 
+/* Configuration space registers and bits */
+#define PCI_COMMAND                 (0x04)
+#define PCI_COMMAND_MEMORY          (0x0002)
+#define PCI_COMMAND_MASTER          (0x0004)
+#define PCI_COMMAND_INTX_DISABLE    (0x0400)
+#define PCI_STATUS                  (0x06)
+#define PCI_STATUS_CAP_LIST         (0x0010)
+#define PCI_BASE_ADDRESS_0          (0x10)
+#define PCI_CAPABILITY_LIST         (0x34)
+
+/* Capabilities */
+#define PCI_CAP_ID_VNDR             (0x09)
+#define PCI_CAP_ID_MSIX             (0x11)
+#define PCI_CAP_LIST_ID             (0x00)
+#define PCI_CAP_LIST_NEXT           (0x01)
+
+/* MSI-X capability */
+#define PCI_MSIX_FLAGS              (0x02)
+#define PCI_MSIX_FLAGS_QSIZE        (0x07FF)
+#define PCI_MSIX_FLAGS_MASKALL      (0x4000)
+#define PCI_MSIX_FLAGS_ENABLE       (0x8000)
+#define PCI_MSIX_TABLE              (0x04)
+#define PCI_MSIX_TABLE_BIR          (0x00000007)
+#define PCI_MSIX_TABLE_OFFSET       (0xFFFFFFF8)
+#define PCI_MSIX_ENTRY_SIZE         (16)
+
 
 #define PCI_REGISTER_DRIVER(b)                  \
 	_PCI_REGISTER_DRIVER(__LIBNAME__, b)
@@ -174,5 +203,73 @@ struct pci_device {
 /* Do not use this function directly: */
 void _pci_register_driver(struct pci_driver *drv);
 
+/**
+ * Access the configuration space of a device. Offsets are naturally aligned
+ * to the access size.
+ */
+uint8_t pci_config_read8(struct pci_device *dev, uint8_t offset);
+uint16_t pci_config_read16(struct pci_device *dev, uint8_t offset);
+uint32_t pci_config_read32(struct pci_device *dev, uint8_t offset);
+void pci_config_write16(struct pci_device *dev, uint8_t offset,
+			uint16_t val);
+void pci_config_write32(struct pci_device *dev, uint8_t offset,
+			uint32_t val);
+
+/**
+ * Find a capability of a device.
+ * @param dev
+ *	Reference to the PCI device.
+ * @param cap_id
+ *	Identifier of the capability (PCI_CAP_ID_*).
+ * @param pos
+ *	Offset of the capability after which the search continues, 0 to
+ *	start with the first one.
+ * @return
+ *	Offset of the capability in the configuration space, 0 if there is
+ *	none (left).
+ */
+uint8_t pci_cap_find(struct pci_device *dev, uint8_t cap_id, uint8_t pos);
+
+/**
+ * Map a range of a memory BAR and enable memory decoding of the device.
+ * @param dev
+ *	Reference to the PCI device.
+ * @param bar
+ *	Index of the BAR.
+ * @param offset
+ *	Offset of the range within the BAR.
+ * @param len
+ *	Length of the range.
+ * @return
+ *	Virtual address of the range, NULL if the BAR is not a memory BAR or
+ *	could not be mapped.
+ */
+void *pci_bar_map(struct pci_device *dev, int bar, uint32_t offset,
+		  uint32_t len);
+
+/**
+ * Enable MSI-X for a device. Each table entry gets an interrupt of its own,
+ * which replaces the interrupt line of the device.
+ * @param dev
+ *	Reference to the PCI device.
+ * @param irqs
+ *	Filled out with the IRQ of each table entry. The handlers are
+ *	registered with ukplat_irq_register().
+ * @param count
+ *	Number of table entries to use.
+ * @return
+ *	0 on success, -ENOTSUP if the device or the platform does not support
+ *	MSI-X, -ENOSPC if not enough vectors are available.
+ */
+int pci_msix_enable(struct pci_device *dev, unsigned long *irqs,
+		    uint16_t count);
+
+/**
+ * Disable MSI-X. The device raises interrupts on its interrupt line again.
+ * @param dev
+ *	Reference to the PCI device.
+ */
+void pci_msix_disable(struct pci_device *dev);
+
 
 #endif /* __UKPLAT_COMMON_PCI_BUS_H__ */
@@ -117,7 +117,14 @@ static inline struct sw_ctx *arch_alloc_sw_ctx(struct uk_alloc *allocator)
 
 	sz = ALIGN_UP(sizeof(struct sw_ctx), x86_cpu_features.extregs_align)
 		+ x86_cpu_features.extregs_size;
-	ctx = uk_malloc(allocator, sz);
+	/* The extregs area is placed relative to the context, so the
+	 * context itself has to be aligned. Otherwise the area can exceed
+	 * the allocation with allocators that return less aligned objects
+	 * than pages.
+	 */
+	ctx = uk_memalign(allocator,
+			  MAX(x86_cpu_features.extregs_align, sizeof(void *)),
+			  sz);
 	uk_pr_debug("Allocating %lu bytes for sw ctx at %p\n", sz, ctx);
 
 	return ctx;
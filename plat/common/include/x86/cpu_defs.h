@@ -116,6 +116,13 @@
 #define X86_MSR_CSTAR		0xc0000083
 /* EFLAGS mask for syscall */
 #define X86_MSR_SYSCALL_MASK	0xc0000084
+/* local APIC base address */
+#define X86_MSR_APIC_BASE	0x0000001b
+
+/* MSR APIC_BASE bits */
+#define X86_APIC_BASE_EXTD	(1 << 10)
+#define X86_APIC_BASE_EN	(1 << 11)
+#define X86_APIC_BASE_ADDR_MASK	0x000ffffffffff000UL
 
 /* MSR EFER bits */
 #define X86_EFER_SCE		(1 << 0)
@@ -84,6 +84,12 @@ static inline int irqs_disabled(void)
 #define local_irq_disable()      __cli()
 #define local_irq_enable()       __sti()
 
-#define __MAX_IRQ	16
+/*
+ * IRQs 0-15 are the lines of the PIC. Message signaled interrupts are
+ * delivered by the local APIC and use the IRQs above.
+ */
+#define __MSI_IRQ_BASE	16
+#define __MSI_IRQ_COUNT	32
+#define __MAX_IRQ	(__MSI_IRQ_BASE + __MSI_IRQ_COUNT)
 
 #endif /* __PLAT_CMN_X86_IRQ_H__ */
@@ -54,8 +54,11 @@
  */
 
 #include <string.h>
+#include <errno.h>
 #include <uk/print.h>
 #include <uk/plat/common/cpu.h>
+#include <uk/plat/paging.h>
+#include <uk/plat/irq.h>
 #include <pci/pci_bus.h>
 
 struct pci_bus_handler {
@@ -393,6 +396,194 @@ void _pci_register_driver(struct pci_driver *drv)
 	uk_list_add_tail(&drv->list, &ph.drv_list);
 }
 
+static inline uint32_t pci_config_addr(struct pci_device *dev, uint8_t offset)
+{
+	return (PCI_ENABLE_BIT)
+		| (dev->addr.bus << PCI_BUS_SHIFT)
+		| (dev->addr.devid << PCI_DEVICE_SHIFT)
+		| (dev->addr.function << PCI_FUNCTION_SHIFT)
+		| (offset & ~0x3);
+}
+
+uint32_t pci_config_read32(struct pci_device *dev, uint8_t offset)
+{
+	UK_ASSERT(dev != NULL);
+
+	outl(PCI_CONFIG_ADDR, pci_config_addr(dev, offset));
+	return inl(PCI_CONFIG_DATA);
+}
+
+uint16_t pci_config_read16(struct pci_device *dev, uint8_t offset)
+{
+	return pci_config_read32(dev, offset) >> ((offset & 0x2) * 8);
+}
+
+uint8_t pci_config_read8(struct pci_device *dev, uint8_t offset)
+{
+	return pci_config_read32(dev, offset) >> ((offset & 0x3) * 8);
+}
+
+void pci_config_write32(struct pci_device *dev, uint8_t offset, uint32_t val)
+{
+	UK_ASSERT(dev != NULL);
+
+	outl(PCI_CONFIG_ADDR, pci_config_addr(dev, offset));
+	outl(PCI_CONFIG_DATA, val);
+}
+
+void pci_config_write16(struct pci_device *dev, uint8_t offset, uint16_t val)
+{
+	UK_ASSERT(dev != NULL);
+
+	outl(PCI_CONFIG_ADDR, pci_config_addr(dev, offset));
+	outw(PCI_CONFIG_DATA + (offset & 0x2), val);
+}
+
+uint8_t pci_cap_find(struct pci_device *dev, uint8_t cap_id, uint8_t pos)
+{
+	/* Bound the walk in case of a malformed (circular) list */
+	int ttl = 48;
+
+	if (!(pci_config_read16(dev, PCI_STATUS) & PCI_STATUS_CAP_LIST))
+		return 0;
+
+	if (pos == 0)
+		pos = pci_config_read8(dev, PCI_CAPABILITY_LIST);
+	else
+		pos = pci_config_read8(dev, pos + PCI_CAP_LIST_NEXT);
+
+	while (pos && ttl--) {
+		/* The lower two bits are reserved */
+		pos &= ~0x3;
+		if (pci_config_read8(dev, pos + PCI_CAP_LIST_ID) == cap_id)
+			return pos;
+		pos = pci_config_read8(dev, pos + PCI_CAP_LIST_NEXT);
+	}
+	return 0;
+}
+
+void *pci_bar_map(struct pci_device *dev, int bar, uint32_t offset,
+		  uint32_t len)
+{
+	uint32_t lo, hi = 0;
+	uint64_t addr;
+	uint16_t cmd;
+
+	UK_ASSERT(dev != NULL);
+
+	if (bar < 0 || bar > 5)
+		return NULL;
+
+	lo = pci_config_read32(dev, PCI_BASE_ADDRESS_0 + bar * 4);
+	/* I/O space BAR */
+	if (lo & 0x1)
+		return NULL;
+	/* 64-bit memory BAR, the next BAR holds the upper half */
+	if ((lo & 0x6) == 0x4 && bar < 5)
+		hi = pci_config_read32(dev, PCI_BASE_ADDRESS_0 + (bar + 1) * 4);
+	addr = ((uint64_t) hi << 32) | (lo & ~0xfUL);
+	if (!addr)
+		return NULL;
+
+	cmd = pci_config_read16(dev, PCI_COMMAND);
+	if (!(cmd & PCI_COMMAND_MEMORY))
+		pci_config_write16(dev, PCI_COMMAND, cmd | PCI_COMMAND_MEMORY);
+
+	return ukplat_io_map(addr + offset, len);
+}
+
+int pci_msix_enable(struct pci_device *dev, unsigned long *irqs,
+		    uint16_t count)
+{
+	volatile uint32_t *entry;
+	uint32_t table, data;
+	uint16_t flags, cmd;
+	uint64_t addr;
+	uint8_t cap;
+	int i, rc;
+
+	UK_ASSERT(dev != NULL);
+	UK_ASSERT(irqs != NULL);
+
+	cap = pci_cap_find(dev, PCI_CAP_ID_MSIX, 0);
+	if (!cap)
+		return -ENOTSUP;
+
+	flags = pci_config_read16(dev, cap + PCI_MSIX_FLAGS);
+	if (count == 0 || count > (flags & PCI_MSIX_FLAGS_QSIZE) + 1)
+		return -ENOSPC;
+
+	if (!dev->msix_table) {
+		table = pci_config_read32(dev, cap + PCI_MSIX_TABLE);
+		dev->msix_table = pci_bar_map(dev,
+				table & PCI_MSIX_TABLE_BIR,
+				table & PCI_MSIX_TABLE_OFFSET,
+				((flags & PCI_MSIX_FLAGS_QSIZE) + 1)
+				* PCI_MSIX_ENTRY_SIZE);
+		if (!dev->msix_table)
+			return -ENOTSUP;
+	}
+
+	/* Mask all vectors while the table is programmed */
+	pci_config_write16(dev, cap + PCI_MSIX_FLAGS,
+			   flags | PCI_MSIX_FLAGS_ENABLE
+			   | PCI_MSIX_FLAGS_MASKALL);
+
+	for (i = 0; i < count; i++) {
+		rc = ukplat_irq_msi_alloc(&irqs[i], &addr, &data);
+		if (rc < 0) {
+			uk_pr_err("PCI %02x:%02x.%02x: Failed to allocate MSI-X vector %d: %d\n",
+				  (int) dev->addr.bus,
+				  (int) dev->addr.devid,
+				  (int) dev->addr.function, i, rc);
+			goto err_free;
+		}
+
+		entry = &dev->msix_table[i * PCI_MSIX_ENTRY_SIZE / 4];
+		entry[0] = (uint32_t) addr;
+		entry[1] = (uint32_t) (addr >> 32);
+		entry[2] = data;
+		/* Unmask the vector */
+		entry[3] = 0;
+	}
+
+	/* The device must not raise its interrupt line anymore */
+	cmd = pci_config_read16(dev, PCI_COMMAND);
+	pci_config_write16(dev, PCI_COMMAND, cmd | PCI_COMMAND_INTX_DISABLE);
+
+	pci_config_write16(dev, cap + PCI_MSIX_FLAGS,
+			   (flags | PCI_MSIX_FLAGS_ENABLE)
+			   & ~PCI_MSIX_FLAGS_MASKALL);
+	return 0;
+
+err_free:
+	/* No handler is registered yet for the vectors we got */
+	while (i-- > 0)
+		ukplat_irq_msi_free(irqs[i]);
+	pci_config_write16(dev, cap + PCI_MSIX_FLAGS,
+			   flags & ~PCI_MSIX_FLAGS_ENABLE);
+	return rc;
+}
+
+void pci_msix_disable(struct pci_device *dev)
+{
+	uint16_t flags, cmd;
+	uint8_t cap;
+
+	UK_ASSERT(dev != NULL);
+
+	cap = pci_cap_find(dev, PCI_CAP_ID_MSIX, 0);
+	if (!cap)
+		return;
+
+	flags = pci_config_read16(dev, cap + PCI_MSIX_FLAGS);
+	pci_config_write16(dev, cap + PCI_MSIX_FLAGS,
+			   flags & ~PCI_MSIX_FLAGS_ENABLE);
+
+	cmd = pci_config_read16(dev, PCI_COMMAND);
+	pci_config_write16(dev, PCI_COMMAND, cmd & ~PCI_COMMAND_INTX_DISABLE);
+}
+
 
 /* Register this bus driver to libukbus:
  */
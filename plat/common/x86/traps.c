@@ -40,6 +40,11 @@
 #include <uk/print.h>
 #include <uk/assert.h>
 #include <uk/asmdump.h>
+#if CONFIG_HAVE_PAGING
+#include <uk/plat/paging.h>
+#include <uk/plat/memory.h>
+#include <errno.h>
+#endif
 
 /* A general word of caution when writing trap handlers. The platform trap
  * entry code is set up to properly save general-purpose registers (e.g., rsi,
@@ -113,10 +118,74 @@ void do_gp_fault(struct __regs *regs, long error_code)
 	UK_CRASH("Crashing\n");
 }
 
+#if CONFIG_HAVE_PAGING
+#define X86_PF_EC_PRESENT	(1UL << 0)
+#define X86_PF_EC_WRITE		(1UL << 1)
+#define X86_PF_EC_FETCH		(1UL << 4)
+
+static ukplat_pagefault_handler_t pagefault_handler;
+/* Only the extregs area is used: The handler is regular code that may use
+ * extended registers, which are not saved by the trap entry code.
+ */
+static struct sw_ctx pagefault_ctx;
+
+int ukplat_pagefault_handler_register(ukplat_pagefault_handler_t handler)
+{
+	struct uk_alloc *a;
+	void *extregs;
+
+	if (handler && !pagefault_ctx.extregs) {
+		a = ukplat_memallocator_get();
+		if (!a)
+			return -ENOMEM;
+		extregs = uk_memalign(a, MAX(x86_cpu_features.extregs_align,
+					     sizeof(void *)),
+				      x86_cpu_features.extregs_size);
+		if (!extregs)
+			return -ENOMEM;
+		pagefault_ctx.extregs = (uintptr_t) extregs;
+	}
+
+	pagefault_handler = handler;
+	return 0;
+}
+
+static int pagefault_resolve(unsigned long addr, unsigned long error_code)
+{
+	unsigned long flags = 0;
+	int rc;
+
+	if (!pagefault_handler || handling_fault)
+		return -EFAULT;
+
+	if (error_code & X86_PF_EC_PRESENT)
+		flags |= UKPLAT_PAGEFAULT_PRESENT;
+	if (error_code & X86_PF_EC_WRITE)
+		flags |= UKPLAT_PAGEFAULT_WRITE;
+	if (error_code & X86_PF_EC_FETCH)
+		flags |= UKPLAT_PAGEFAULT_EXEC;
+
+	/* A fault within the handler is fatal (see fault_prologue()) */
+	handling_fault++;
+	barrier();
+	save_extregs(&pagefault_ctx);
+	rc = pagefault_handler(addr, flags);
+	restore_extregs(&pagefault_ctx);
+	barrier();
+	handling_fault--;
+	return rc;
+}
+#endif /* CONFIG_HAVE_PAGING */
+
 void do_page_fault(struct __regs *regs, unsigned long error_code)
 {
 	unsigned long addr = read_cr2();
 
+#if CONFIG_HAVE_PAGING
+	if (pagefault_resolve(addr, error_code) == 0)
+		return;
+#endif
+
 	fault_prologue();
 	uk_pr_crit("Page fault at linear address %lx, rip %lx, "
 		   "regs %p, sp %lx, our_sp %p, code %lx\n",
@@ -30,12 +30,13 @@
 #ifndef __PLAT_DRV_VIRTIO_PCI_H__
 #define __PLAT_DRV_VIRTIO_PCI_H__
 
+#include <virtio/virtio_types.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus __ */
 
-/* virtio config space layout */
-/* TODO we currently support only the legacy interface */
+/* virtio config space layout of the legacy interface */
 #define VIRTIO_PCI_HOST_FEATURES        0    /* 32-bit r/o */
 #define VIRTIO_PCI_GUEST_FEATURES       4    /* 32-bit r/w */
 #define VIRTIO_PCI_QUEUE_PFN            8    /* 32-bit r/w */
@@ -63,10 +64,56 @@ extern "C" {
 #define VIRTIO_PCI_ISR_HAS_INTR         0x1  /* interrupt is for this device */
 #define VIRTIO_PCI_ISR_CONFIG           0x2  /* config change bit */
 
-/* TODO Revisit when adding MSI support. */
+/* The legacy interface is only used without MSI-X */
 #define VIRTIO_PCI_CONFIG_OFF           20
 #define VIRTIO_PCI_VRING_ALIGN          4096
 
+/*
+ * The modern interface is described by vendor specific PCI capabilities
+ * that locate its configuration structures within the BARs.
+ */
+#define VIRTIO_PCI_CAP_COMMON_CFG       1  /* Common configuration */
+#define VIRTIO_PCI_CAP_NOTIFY_CFG       2  /* Notifications */
+#define VIRTIO_PCI_CAP_ISR_CFG          3  /* ISR status */
+#define VIRTIO_PCI_CAP_DEVICE_CFG       4  /* Device specific configuration */
+#define VIRTIO_PCI_CAP_PCI_CFG          5  /* PCI configuration access */
+
+/* Fields of the capability (offsets into the PCI configuration space) */
+#define VIRTIO_PCI_CAP_CFG_TYPE         3   /* 8-bit */
+#define VIRTIO_PCI_CAP_BAR              4   /* 8-bit */
+#define VIRTIO_PCI_CAP_OFFSET           8   /* 32-bit */
+#define VIRTIO_PCI_CAP_LENGTH           12  /* 32-bit */
+#define VIRTIO_PCI_NOTIFY_CAP_MULT      16  /* 32-bit, notify cap only */
+
+/* Vector for disabling MSI-X interrupts of a queue or config changes */
+#define VIRTIO_MSI_NO_VECTOR            0xffff
+
+/* Common configuration structure of the modern interface */
+struct virtio_pci_common_cfg {
+	/* About the whole device. */
+	__virtio_le32 device_feature_select;	/* read-write */
+	__virtio_le32 device_feature;		/* read-only */
+	__virtio_le32 driver_feature_select;	/* read-write */
+	__virtio_le32 driver_feature;		/* read-write */
+	__virtio_le16 msix_config;		/* read-write */
+	__virtio_le16 num_queues;		/* read-only */
+	__u8 device_status;			/* read-write */
+	__u8 config_generation;			/* read-only */
+
+	/* About a specific virtqueue. */
+	__virtio_le16 queue_select;		/* read-write */
+	__virtio_le16 queue_size;		/* read-write */
+	__virtio_le16 queue_msix_vector;	/* read-write */
+	__virtio_le16 queue_enable;		/* read-write */
+	__virtio_le16 queue_notify_off;		/* read-only */
+	__virtio_le32 queue_desc_lo;		/* read-write */
+	__virtio_le32 queue_desc_hi;		/* read-write */
+	__virtio_le32 queue_avail_lo;		/* read-write */
+	__virtio_le32 queue_avail_hi;		/* read-write */
+	__virtio_le32 queue_used_lo;		/* read-write */
+	__virtio_le32 queue_used_hi;		/* read-write */
+};
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus __ */
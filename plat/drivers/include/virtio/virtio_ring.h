@@ -81,6 +81,25 @@ extern "C" {
 /* Arbitrary descriptor layouts. */
 #define VIRTIO_F_ANY_LAYOUT       27
 
+/* Support for the packed virtqueue layout */
+#define VIRTIO_F_RING_PACKED      34
+
+/*
+ * Bit positions of the avail and used flags of a packed descriptor. They are
+ * set to the wrap counter by the driver and the device respectively.
+ */
+#define VRING_PACKED_DESC_F_AVAIL       7
+#define VRING_PACKED_DESC_F_USED        15
+
+/* Event suppression modes of a packed virtqueue. */
+#define VRING_PACKED_EVENT_FLAG_ENABLE  0x0
+#define VRING_PACKED_EVENT_FLAG_DISABLE 0x1
+/* Only if VIRTIO_F_EVENT_IDX: notify at the descriptor in off_wrap. */
+#define VRING_PACKED_EVENT_FLAG_DESC    0x2
+
+/* Bit position of the wrap counter within off_wrap. */
+#define VRING_PACKED_EVENT_F_WRAP_CTR   15
+
 /**
  * Virtqueue descriptors: 16 bytes.
  * These can chain together via "next".
@@ -126,6 +145,38 @@ struct vring {
 	struct vring_used *used;
 };
 
+/**
+ * Packed virtqueue descriptors: 16 bytes.
+ * Available and used descriptors share a single ring.
+ */
+struct vring_packed_desc {
+	/* Address (guest-physical). */
+	__virtio_le64 addr;
+	/* Length. */
+	__virtio_le32 len;
+	/* Buffer ID. */
+	__virtio_le16 id;
+	/* The flags as indicated above. */
+	__virtio_le16 flags;
+};
+
+struct vring_packed_desc_event {
+	/* Descriptor ring change event offset and wrap counter. */
+	__virtio_le16 off_wrap;
+	/* Descriptor ring change event flags. */
+	__virtio_le16 flags;
+};
+
+struct vring_packed {
+	unsigned int num;
+
+	struct vring_packed_desc *desc;
+	/* Event suppression written by the driver */
+	struct vring_packed_desc_event *driver;
+	/* Event suppression written by the device */
+	struct vring_packed_desc_event *device;
+};
+
 /* The standard layout for the ring is a continuous chunk of memory which
  * looks like this.  We assume num is a power of 2.
  *
@@ -157,7 +208,9 @@ struct vring {
  * versa. They are at the end for backwards compatibility.
  */
 #define vring_used_event(vr) ((vr)->avail->ring[(vr)->num])
-#define vring_avail_event(vr) (*(__virtio16 *)&(vr)->used->ring[(vr)->num])
+#define vring_avail_event(vr) \
+	(*(__virtio_le16 *)((__u8 *)(vr)->used->ring \
+			    + (vr)->num * sizeof(struct vring_used_elem)))
 
 static inline void vring_init(struct vring *vr, unsigned int num, uint8_t *p,
 			      unsigned long align)
@@ -183,10 +236,27 @@ static inline unsigned int vring_size(unsigned int num, unsigned long align)
 	return size;
 }
 
+/* The packed layout is a descriptor ring followed by the event structures. */
+static inline void vring_packed_init(struct vring_packed *vr,
+				     unsigned int num, uint8_t *p)
+{
+	vr->num = num;
+	vr->desc = (struct vring_packed_desc *) p;
+	vr->driver = (struct vring_packed_desc_event *) (p +
+			num * sizeof(struct vring_packed_desc));
+	vr->device = vr->driver + 1;
+}
+
+static inline unsigned int vring_packed_size(unsigned int num)
+{
+	return num * sizeof(struct vring_packed_desc) +
+		2 * sizeof(struct vring_packed_desc_event);
+}
+
 static inline int vring_need_event(__u16 event_idx, __u16 new_idx,
 				   __u16 old_idx)
 {
-	return (new_idx - event_idx - 1) < (new_idx - old_idx);
+	return (__u16) (new_idx - event_idx - 1) < (__u16) (new_idx - old_idx);
 }
 
 #ifdef __cplusplus
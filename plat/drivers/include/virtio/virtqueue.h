@@ -82,6 +82,28 @@ struct virtqueue {
  */
 __phys_addr virtqueue_physaddr(struct virtqueue *vq);
 
+/**
+ * Fetch the physical address of the driver area. This is the available ring
+ * or, with a packed ring, the driver event suppression structure.
+ * @param vq
+ *	Reference to the virtqueue.
+ *
+ * @return
+ *	Return the guest physical address of the driver area.
+ */
+__phys_addr virtqueue_driver_area_physaddr(struct virtqueue *vq);
+
+/**
+ * Fetch the physical address of the device area. This is the used ring
+ * or, with a packed ring, the device event suppression structure.
+ * @param vq
+ *	Reference to the virtqueue.
+ *
+ * @return
+ *	Return the guest physical address of the device area.
+ */
+__phys_addr virtqueue_device_area_physaddr(struct virtqueue *vq);
+
 /**
  * Ring interrupt handler. This function is invoked from the interrupt handler
  * in the virtio device for interrupt specific to the ring.
@@ -106,7 +128,8 @@ int virtqueue_ring_interrupt(void *obj);
 __u64 virtqueue_feature_negotiate(__u64 feature_set);
 
 /**
- * Check if host notification is enabled.
+ * Check if host notification is enabled. This only considers the
+ * VRING_USED_F_NO_NOTIFY flag, see virtqueue_kick_prepare().
  *
  * @param vq
  *	Reference to the virtqueue.
@@ -116,6 +139,19 @@ __u64 virtqueue_feature_negotiate(__u64 feature_set);
  */
 int virtqueue_notify_enabled(struct virtqueue *vq);
 
+/**
+ * Check if the host needs to be notified about the descriptors that were
+ * made available since the last call. With VIRTIO_F_EVENT_IDX, the host is
+ * only notified when it waits for one of these descriptors.
+ *
+ * @param vq
+ *	Reference to the virtqueue.
+ * @return
+ *	Returns 1, host needs notification on new descriptors.
+ *		0, otherwise.
+ */
+int virtqueue_kick_prepare(struct virtqueue *vq);
+
 /**
  * Remove the user buffer from the virtqueue.
  *
@@ -188,6 +224,25 @@ struct virtqueue *virtqueue_create(__u16 queue_id, __u16 nr_descs, __u16 align,
 				   virtqueue_notify_host_t notify,
 				   struct virtio_dev *vdev, struct uk_alloc *a);
 
+/**
+ * Allocate indirect descriptor tables for a virtqueue. Afterwards, buffers
+ * with up to max_segs segments occupy a single descriptor of the ring. The
+ * tables are released together with the virtqueue.
+ *
+ * @param vq
+ *	A reference to the virtqueue.
+ * @param max_segs
+ *	The maximum number of segments of a buffer, limited to the queue size.
+ * @param a
+ *	A reference to the allocator.
+ * @return int
+ *	0 on success,
+ *	-ENOTSUP if VIRTIO_F_INDIRECT_DESC was not negotiated,
+ *	-ENOMEM if the tables could not be allocated.
+ */
+int virtqueue_indirect_setup(struct virtqueue *vq, __u16 max_segs,
+			     struct uk_alloc *a);
+
 /**
  * Check the virtqueue if full.
  * @param vq
@@ -235,7 +290,8 @@ void virtqueue_intr_disable(struct virtqueue *vq);
 int virtqueue_intr_enable(struct virtqueue *vq);
 
 /**
- * Notify the host of an event.
+ * Notify the host of an event, unless the host suppressed the notification.
+ * Drivers should call this once after enqueuing a batch of buffers.
  * @param vq
  *      Reference to the virtual queue.
  */
@@ -244,13 +300,10 @@ static inline void virtqueue_host_notify(struct virtqueue *vq)
 	UK_ASSERT(vq);
 
 	/*
-	 * Before notifying the virtio backend on the host we should make sure
-	 * that the virtqueue index update operation happened. Note that this
-	 * function is declared as inline.
+	 * virtqueue_kick_prepare() makes sure that the virtqueue index update
+	 * operation happened before it checks for notification suppression.
 	 */
-	mb();
-
-	if (vq->vq_notify_host && virtqueue_notify_enabled(vq)) {
+	if (vq->vq_notify_host && virtqueue_kick_prepare(vq)) {
 		uk_pr_debug("notify queue %d\n", vq->queue_id);
 		vq->vq_notify_host(vq->vdev, vq->queue_id);
 	}
@@ -371,7 +371,9 @@ static int virtio_9p_feature_negotiate(struct virtio_9p_device *d)
 	d->tag[tag_len] = '\0';
 
 	d->vdev->features &= host_features;
-	virtio_feature_set(d->vdev, d->vdev->features);
+	rc = virtio_feature_set(d->vdev, d->vdev->features);
+	if (rc < 0)
+		goto free_mem;
 	return 0;
 
 free_mem:
@@ -384,6 +386,8 @@ static inline void virtio_9p_feature_set(struct virtio_9p_device *d)
 {
 	d->vdev->features = 0;
 	VIRTIO_FEATURES_UPDATE(d->vdev->features, VIRTIO_9P_F_MOUNT_TAG);
+	VIRTIO_FEATURES_UPDATE(d->vdev->features, VIRTIO_F_EVENT_IDX);
+	VIRTIO_FEATURES_UPDATE(d->vdev->features, VIRTIO_F_RING_PACKED);
 }
 
 static int virtio_9p_configure(struct virtio_9p_device *d)
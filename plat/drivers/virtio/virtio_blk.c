@@ -52,10 +52,16 @@
  *	Flush
  **/
 #define VIRTIO_BLK_DRV_FEATURES(features) \
-	(VIRTIO_FEATURES_UPDATE(features, VIRTIO_BLK_F_RO | \
-	VIRTIO_BLK_F_BLK_SIZE | VIRTIO_BLK_F_MQ | \
-	VIRTIO_BLK_F_SEG_MAX | VIRTIO_BLK_F_SIZE_MAX | \
-	VIRTIO_BLK_F_CONFIG_WCE | VIRTIO_BLK_F_FLUSH))
+	(VIRTIO_FEATURES_UPDATE(features, VIRTIO_BLK_F_RO), \
+	VIRTIO_FEATURES_UPDATE(features, VIRTIO_BLK_F_BLK_SIZE), \
+	VIRTIO_FEATURES_UPDATE(features, VIRTIO_BLK_F_MQ), \
+	VIRTIO_FEATURES_UPDATE(features, VIRTIO_BLK_F_SEG_MAX), \
+	VIRTIO_FEATURES_UPDATE(features, VIRTIO_BLK_F_SIZE_MAX), \
+	VIRTIO_FEATURES_UPDATE(features, VIRTIO_BLK_F_CONFIG_WCE), \
+	VIRTIO_FEATURES_UPDATE(features, VIRTIO_BLK_F_FLUSH), \
+	VIRTIO_FEATURES_UPDATE(features, VIRTIO_F_EVENT_IDX), \
+	VIRTIO_FEATURES_UPDATE(features, VIRTIO_F_RING_PACKED), \
+	VIRTIO_FEATURES_UPDATE(features, VIRTIO_F_INDIRECT_DESC))
 
 static struct uk_alloc *a;
 static const char *drv_name = DRIVER_NAME;
@@ -470,6 +476,7 @@ static int virtio_blkdev_vqueue_setup(struct uk_blkdev_queue *queue,
 {
 	uint16_t max_desc;
 	struct virtqueue *vq;
+	int rc;
 
 	UK_ASSERT(queue);
 	max_desc = queue->max_nb_desc;
@@ -496,6 +503,11 @@ static int virtio_blkdev_vqueue_setup(struct uk_blkdev_queue *queue,
 		return PTR2ERR(vq);
 	}
 
+	/* Requests with multiple segments occupy a single ring descriptor */
+	rc = virtqueue_indirect_setup(vq, queue->vbd->max_segments, a);
+	if (unlikely(rc < 0 && rc != -ENOTSUP))
+		uk_pr_warn("Failed to set up indirect descriptors: %d\n", rc);
+
 	queue->vq = vq;
 	vq->priv = queue;
 
@@ -843,7 +855,7 @@ static int virtio_blkdev_feature_negotiate(struct virtio_blk_device *vbdev)
 	 * Mask out features supported by both driver and device.
 	 */
 	vbdev->vdev->features &= host_features;
-	virtio_feature_set(vbdev->vdev, vbdev->vdev->features);
+	rc = virtio_feature_set(vbdev->vdev, vbdev->vdev->features);
 
 exit:
 	return rc;
@@ -33,6 +33,9 @@
 #include <uk/sglist.h>
 #include <uk/arch/types.h>
 #include <uk/arch/limits.h>
+#include <uk/arch/lcpu.h>
+#include <uk/arch/time.h>
+#include <uk/plat/time.h>
 #include <uk/netbuf.h>
 #include <uk/netdev.h>
 #include <uk/netdev_core.h>
@@ -50,9 +53,26 @@
 #define VIRTIO_PKT_BUFFER_LEN ((UK_ETH_PAYLOAD_MAXLEN) \
 			       + (UK_ETH_HDR_UNTAGGED_LEN) \
 			       + (VIRTIO_HDR_LEN))
+/**
+ * Packets with segmentation offload carry up to 64 KiB of IP packet.
+ */
+#define VIRTIO_PKT_GSO_BUFFER_LEN ((__U16_MAX) \
+				   + (UK_ETH_HDR_8021Q_LEN) \
+				   + (VIRTIO_HDR_LEN))
 
 #define DRIVER_NAME           "virtio-net"
 
+/**
+ * Time to wait for the device to complete a control command.
+ */
+#define VTNET_CTRL_TIMEOUT    ukarch_time_sec_to_nsec(1)
+
+/**
+ * Largest number of queue pairs for which the control virtqueue, which
+ * follows the last pair, has a 16-bit index.
+ */
+#define VTNET_VQ_PAIRS_MAX    ((__U16_MAX - 1) / 2)
+
 
 #define  VTNET_RX_HEADER_PAD (4)
 #define  VTNET_INTR_EN   (1 << 0)
@@ -69,7 +89,21 @@
 	__containerof(ndev, struct virtio_net_device, netdev)
 
 #define VIRTIO_NET_DRV_FEATURES(features)           \
-	(VIRTIO_FEATURES_UPDATE(features, VIRTIO_NET_F_MAC))
+	(VIRTIO_FEATURES_UPDATE(features, VIRTIO_NET_F_MAC), \
+	 VIRTIO_FEATURES_UPDATE(features, VIRTIO_NET_F_MRG_RXBUF), \
+	 VIRTIO_FEATURES_UPDATE(features, VIRTIO_F_ANY_LAYOUT), \
+	 VIRTIO_FEATURES_UPDATE(features, VIRTIO_F_VERSION_1), \
+	 VIRTIO_FEATURES_UPDATE(features, VIRTIO_NET_F_CTRL_VQ), \
+	 VIRTIO_FEATURES_UPDATE(features, VIRTIO_NET_F_MQ), \
+	 VIRTIO_FEATURES_UPDATE(features, VIRTIO_F_EVENT_IDX), \
+	 VIRTIO_FEATURES_UPDATE(features, VIRTIO_F_RING_PACKED), \
+	 VIRTIO_FEATURES_UPDATE(features, VIRTIO_F_INDIRECT_DESC))
+
+/**
+ * Scatter list segments of a control command: header, data and ack, each of
+ * which may cross a page boundary.
+ */
+#define VIRTIO_NET_CTRL_MAX_SEGS	6
 
 typedef enum {
 	VNET_RX,
@@ -77,10 +111,12 @@ typedef enum {
 } virtq_type_t;
 
 /**
- * When mergeable buffers are not negotiated, the virtio_net_hdr_padded struct
+ * When VIRTIO_F_ANY_LAYOUT is not negotiated, the virtio_net_hdr_padded struct
  * below is placed at the beginning of the netbuf data. Use 4 bytes of pad to
  * both keep the VirtIO header and the data non-contiguous and to keep the
  * frame's payload 4 byte aligned.
+ * With VIRTIO_F_ANY_LAYOUT, the header directly precedes the frame and both
+ * share a single descriptor.
  */
 struct virtio_net_hdr_padded {
 	struct virtio_net_hdr vhdr;
@@ -136,6 +172,18 @@ struct uk_netdev_rx_queue {
 	struct uk_sglist_seg sgsegs[NET_MAX_FRAGMENTS];
 };
 
+/**
+ * @internal structure of a command on the control virtqueue. The device
+ * reads the header and the data and writes the acknowledgment.
+ */
+struct virtio_net_ctrl_cmd {
+	struct virtio_net_ctrl_hdr hdr;
+	union {
+		struct virtio_net_ctrl_mq mq;
+	} data;
+	virtio_net_ctrl_ack ack;
+};
+
 struct virtio_net_device {
 	/* Virtio Device */
 	struct virtio_dev *vdev;
@@ -144,6 +192,13 @@ struct virtio_net_device {
 	struct uk_netdev netdev;
 	/* Count of the number of the virtqueues */
 	__u16 max_vqueue_pairs;
+	/* Number of virtqueue pairs provided by the device */
+	__u16 dev_vqueue_pairs;
+	/* Control virtqueue and the buffer for its commands */
+	struct virtqueue *ctrl_vq;
+	struct virtio_net_ctrl_cmd ctrl_cmd;
+	struct uk_sglist ctrl_sg;
+	struct uk_sglist_seg ctrl_sgsegs[VIRTIO_NET_CTRL_MAX_SEGS];
 	/* List of the Rx/Tx queue */
 	__u16    rx_vqueue_cnt;
 	struct   uk_netdev_rx_queue *rxqs;
@@ -161,6 +216,14 @@ struct virtio_net_device {
 	__u8 state;
 	/* RX promiscuous mode. */
 	__u8 promisc : 1;
+	/* Header and data share descriptors (VIRTIO_F_ANY_LAYOUT) */
+	__u8 any_layout : 1;
+	/* Packets may span multiple receive buffers (VIRTIO_NET_F_MRG_RXBUF) */
+	__u8 mrg_rxbuf : 1;
+	/* Length of the virtio-net header */
+	__u8 hdr_len;
+	/* Negotiated offloads (UK_NETDEV_OFFLOAD_*) */
+	__u32 offloads;
 };
 
 /**
@@ -175,7 +238,8 @@ static int virtio_netdev_configure(struct uk_netdev *n,
 				   const struct uk_netdev_conf *conf);
 static int virtio_netdev_rxtx_alloc(struct virtio_net_device *vndev,
 				    const struct uk_netdev_conf *conf);
-static int virtio_netdev_feature_negotiate(struct virtio_net_device *vndev);
+static int virtio_netdev_feature_negotiate(struct virtio_net_device *vndev,
+					   const struct uk_netdev_conf *conf);
 static struct uk_netdev_tx_queue *virtio_netdev_tx_queue_setup(
 					struct uk_netdev *n, uint16_t queue_id,
 					uint16_t nb_desc,
@@ -196,9 +260,17 @@ static void virtio_netdev_xmit_free(struct uk_netdev_tx_queue *txq);
 static int virtio_netdev_xmit(struct uk_netdev *dev,
 			      struct uk_netdev_tx_queue *queue,
 			      struct uk_netbuf *pkt);
+static int virtio_netdev_xmit_burst(struct uk_netdev *dev,
+				    struct uk_netdev_tx_queue *queue,
+				    struct uk_netbuf *pkt[],
+				    uint16_t *cnt);
 static int virtio_netdev_recv(struct uk_netdev *dev,
 			      struct uk_netdev_rx_queue *queue,
 			      struct uk_netbuf **pkt);
+static int virtio_netdev_recv_burst(struct uk_netdev *dev,
+				    struct uk_netdev_rx_queue *queue,
+				    struct uk_netbuf *pkt[],
+				    uint16_t *cnt);
 static const struct uk_hwaddr *virtio_net_mac_get(struct uk_netdev *n);
 static __u16 virtio_net_mtu_get(struct uk_netdev *n);
 static unsigned virtio_net_promisc_get(struct uk_netdev *n);
@@ -220,6 +292,58 @@ static int virtio_netdev_rx_fillup(struct uk_netdev_rx_queue *rxq,
 static const char *drv_name = DRIVER_NAME;
 static struct uk_alloc *a;
 
+/**
+ * Offloads and the corresponding device features. TSO requires the
+ * checksum offload of the same direction.
+ */
+static const struct {
+	__u32 offload;
+	__u8 feature;
+	__u32 requires;
+} virtio_net_offloads[] = {
+	{ UK_NETDEV_OFFLOAD_TX_CSUM, VIRTIO_NET_F_CSUM, 0 },
+	{ UK_NETDEV_OFFLOAD_RX_CSUM, VIRTIO_NET_F_GUEST_CSUM, 0 },
+	{ UK_NETDEV_OFFLOAD_TSO4, VIRTIO_NET_F_HOST_TSO4,
+	  UK_NETDEV_OFFLOAD_TX_CSUM },
+	{ UK_NETDEV_OFFLOAD_TSO6, VIRTIO_NET_F_HOST_TSO6,
+	  UK_NETDEV_OFFLOAD_TX_CSUM },
+	{ UK_NETDEV_OFFLOAD_LRO4, VIRTIO_NET_F_GUEST_TSO4,
+	  UK_NETDEV_OFFLOAD_RX_CSUM },
+	{ UK_NETDEV_OFFLOAD_LRO6, VIRTIO_NET_F_GUEST_TSO6,
+	  UK_NETDEV_OFFLOAD_RX_CSUM },
+};
+
+/**
+ * Devices of the modern interface (VIRTIO_F_VERSION_1) always accept any
+ * descriptor layout.
+ */
+static inline int virtio_netdev_any_layout(__u64 features)
+{
+	return virtio_has_features(features, VIRTIO_F_ANY_LAYOUT)
+		|| virtio_has_features(features, VIRTIO_F_VERSION_1);
+}
+
+/**
+ * Returns the offloads that are available with a set of device features.
+ */
+static __u32 virtio_netdev_offloads(__u64 features)
+{
+	__u32 offloads = 0;
+	__u32 i;
+
+	for (i = 0; i < ARRAY_SIZE(virtio_net_offloads); i++) {
+		if (virtio_has_features(features,
+					virtio_net_offloads[i].feature))
+			offloads |= virtio_net_offloads[i].offload;
+	}
+	for (i = 0; i < ARRAY_SIZE(virtio_net_offloads); i++) {
+		if ((offloads & virtio_net_offloads[i].requires)
+		    != virtio_net_offloads[i].requires)
+			offloads &= ~virtio_net_offloads[i].offload;
+	}
+	return offloads;
+}
+
 /**
  * The Driver method implementation.
  */
@@ -271,24 +395,28 @@ static int virtio_netdev_rx_fillup(struct uk_netdev_rx_queue *rxq,
 				   int notify)
 {
 	struct uk_netbuf *netbuf[RX_FILLUP_BATCHLEN];
+	struct virtio_net_device *vndev = to_virtionetdev(rxq->ndev);
 	int rc = 0;
 	int status = 0x0;
 	__u16 i, j;
 	__u16 req;
 	__u16 cnt = 0;
 	__u16 filled = 0;
+	__u16 desc_per_buf;
 
 	/**
-	 * Fixed amount of memory is allocated to each received buffer. In
-	 * our case since we don't support jumbo frame or LRO yet we require
-	 * that the buffer feed to the ring descriptor is atleast
-	 * ethernet MTU + virtio net header.
-	 * Because we using 2 descriptor for a single netbuf, our effective
-	 * queue size is just the half.
+	 * Without mergeable buffers, the buffer fed to the ring descriptor has
+	 * to hold a complete packet: At least the ethernet MTU + virtio net
+	 * header, or lro_rxbuf_len with large receive offload. With mergeable
+	 * buffers, the device spreads larger packets over multiple buffers.
+	 * Without VIRTIO_F_ANY_LAYOUT we are using 2 descriptors for a single
+	 * netbuf, so our effective queue size is just the half.
 	 */
-	nb_desc = ALIGN_DOWN(nb_desc, 2);
+	desc_per_buf = vndev->any_layout ? 1 : 2;
+	nb_desc = ALIGN_DOWN(nb_desc, desc_per_buf);
 	while (filled < nb_desc) {
-		req = MIN(nb_desc / 2, RX_FILLUP_BATCHLEN);
+		req = MIN((nb_desc - filled) / desc_per_buf,
+			  RX_FILLUP_BATCHLEN);
 		cnt = rxq->alloc_rxpkts(rxq->alloc_rxpkts_argp, netbuf, req);
 		for (i = 0; i < cnt; i++) {
 			uk_pr_debug("Enqueue netbuf %"PRIu16"/%"PRIu16" (%p) to virtqueue %p...\n",
@@ -307,7 +435,7 @@ static int virtio_netdev_rx_fillup(struct uk_netdev_rx_queue *rxq,
 				status |= UK_NETDEV_STATUS_UNDERRUN;
 				goto out;
 			}
-			filled += 2;
+			filled += desc_per_buf;
 		}
 
 		if (unlikely(cnt < req)) {
@@ -320,7 +448,10 @@ static int virtio_netdev_rx_fillup(struct uk_netdev_rx_queue *rxq,
 
 out:
 	uk_pr_debug("Programmed %"PRIu16" receive netbufs to receive virtqueue %p (status %x)\n",
-		    filled / 2, rxq, status);
+		    filled / desc_per_buf, rxq, status);
+	if (unlikely(status & UK_NETDEV_STATUS_UNDERRUN))
+		uk_netdev_drv_rxq_stats_add(rxq->ndev, rxq->lqueue_id,
+					    refill_fail, 1);
 
 	/**
 	 * Notify the host, when we submit new descriptor(s).
@@ -331,41 +462,82 @@ out:
 	return status;
 }
 
-static int virtio_netdev_xmit(struct uk_netdev *dev,
-			      struct uk_netdev_tx_queue *queue,
-			      struct uk_netbuf *pkt)
+/**
+ * Translates the offload fields of a netbuf to the virtio-net header.
+ */
+static int virtio_netdev_xmit_offload(struct virtio_net_device *vndev,
+				      struct virtio_net_hdr *vhdr,
+				      const struct uk_netbuf *pkt)
 {
-	struct virtio_net_device *vndev __unused;
+	__u32 required;
+
+	if (pkt->flags & UK_NETBUF_F_PARTIAL_CSUM) {
+		if (unlikely(!(vndev->offloads & UK_NETDEV_OFFLOAD_TX_CSUM)))
+			return -ENOTSUP;
+		vhdr->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+		vhdr->csum_start = pkt->csum_start;
+		vhdr->csum_offset = pkt->csum_offset;
+	}
+
+	switch (pkt->gso_type) {
+	case UK_NETBUF_GSO_NONE:
+		vhdr->gso_type = VIRTIO_NET_HDR_GSO_NONE;
+		return 0;
+	case UK_NETBUF_GSO_TCPV4:
+		vhdr->gso_type = VIRTIO_NET_HDR_GSO_TCPV4;
+		required = UK_NETDEV_OFFLOAD_TSO4;
+		break;
+	case UK_NETBUF_GSO_TCPV6:
+		vhdr->gso_type = VIRTIO_NET_HDR_GSO_TCPV6;
+		required = UK_NETDEV_OFFLOAD_TSO6;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	/* The device computes the checksums of the segments */
+	if (unlikely(!(pkt->flags & UK_NETBUF_F_PARTIAL_CSUM)
+		     || !pkt->gso_size))
+		return -EINVAL;
+	if (unlikely(!(vndev->offloads & required)))
+		return -ENOTSUP;
+	vhdr->gso_size = pkt->gso_size;
+	vhdr->hdr_len = pkt->header_len;
+	return 0;
+}
+
+/**
+ * Prepends the virtio-net header to a packet and adds it to the transmit
+ * virtqueue. The host is not notified.
+ * @return
+ *	>= 0 The packet was enqueued, the count indicates the number of
+ *	available descriptors.
+ *	-ENOSPC There are not enough descriptors available.
+ *	< 0 Failed to enqueue the packet.
+ */
+static int virtio_netdev_xmit_enqueue(struct uk_netdev_tx_queue *queue,
+				      struct uk_netbuf *pkt)
+{
+	struct virtio_net_device *vndev = to_virtionetdev(queue->ndev);
 	struct virtio_net_hdr *vhdr;
-	struct virtio_net_hdr_padded *padded_hdr;
-	int16_t header_sz = sizeof(*padded_hdr);
+	int16_t header_sz;
 	int rc = 0;
-	int status = 0x0;
-	size_t total_len = 0;
+	size_t total_len = 0, max_len;
 	__u8  *buf_start;
 	size_t buf_len;
 
-	UK_ASSERT(dev);
-	UK_ASSERT(pkt && queue);
-
-	vndev = to_virtionetdev(dev);
-	/**
-	 * We are reclaiming the free descriptors from buffers. The function is
-	 * not protected by means of locks. We need to be careful if there are
-	 * multiple context through which we free the tx descriptors.
-	 */
-	virtio_netdev_xmit_free(queue);
-
 	buf_start = pkt->data;
 	buf_len = pkt->len;
 	/**
-	 * Use the preallocated header space for the virtio header.
+	 * Use the preallocated header space for the virtio header. The padded
+	 * header is only required when the header needs its own descriptor.
 	 */
+	header_sz = vndev->any_layout ? vndev->hdr_len
+		    : sizeof(struct virtio_net_hdr_padded);
 	rc = uk_netbuf_header(pkt, header_sz);
 	if (unlikely(rc != 1)) {
 		uk_pr_err("Failed to prepend virtio header\n");
-		rc = -ENOSPC;
-		goto err_exit;
+		return -EINVAL;
 	}
 	vhdr = pkt->data;
 
@@ -373,28 +545,35 @@ static int virtio_netdev_xmit(struct uk_netdev *dev,
 	 * Fill the virtio-net-header with the necessary information.
 	 * Zero explicitly set.
 	 */
-	memset(vhdr, 0, sizeof(*vhdr));
-	vhdr->gso_type = VIRTIO_NET_HDR_GSO_NONE;
+	memset(vhdr, 0, vndev->hdr_len);
+	rc = virtio_netdev_xmit_offload(vndev, vhdr, pkt);
+	if (unlikely(rc < 0)) {
+		uk_pr_err("Unsupported offload request: %d\n", rc);
+		goto err_remove_vhdr;
+	}
 
 	/**
 	 * Prepare the sglist and enqueue the buffer to the virtio-ring.
 	 */
 	uk_sglist_reset(&queue->sg);
 
-	/**
-	 * According the specification 5.1.6.6, we need to explicitly use
-	 * 2 descriptor for each transmit and receive network packet since we
-	 * do not negotiate for the VIRTIO_F_ANY_LAYOUT.
-	 *
-	 * 1 for the virtio header and the other for the actual network packet.
-	 */
-	/* Appending the data to the list. */
-	rc = uk_sglist_append(&queue->sg, vhdr, sizeof(*vhdr));
-	if (unlikely(rc != 0)) {
-		uk_pr_err("Failed to append to the sg list\n");
-		goto err_remove_vhdr;
+	if (vndev->any_layout) {
+		/* The header shares the first descriptor with the packet */
+		rc = uk_sglist_append(&queue->sg, vhdr,
+				      vndev->hdr_len + buf_len);
+	} else {
+		/**
+		 * According the specification 5.1.6.6, we need to explicitly
+		 * use 2 descriptor for each transmit and receive network
+		 * packet if the device does not offer VIRTIO_F_ANY_LAYOUT.
+		 *
+		 * 1 for the virtio header and the other for the actual
+		 * network packet.
+		 */
+		rc = uk_sglist_append(&queue->sg, vhdr, vndev->hdr_len);
+		if (likely(rc == 0))
+			rc = uk_sglist_append(&queue->sg, buf_start, buf_len);
 	}
-	rc = uk_sglist_append(&queue->sg, buf_start, buf_len);
 	if (unlikely(rc != 0)) {
 		uk_pr_err("Failed to append to the sg list\n");
 		goto err_remove_vhdr;
@@ -408,9 +587,11 @@ static int virtio_netdev_xmit(struct uk_netdev *dev,
 	}
 
 	total_len = uk_sglist_length(&queue->sg);
-	if (unlikely(total_len > VIRTIO_PKT_BUFFER_LEN)) {
-		uk_pr_err("Packet size too big: %lu, max:%u\n",
-			  total_len, VIRTIO_PKT_BUFFER_LEN);
+	max_len = (vhdr->gso_type == VIRTIO_NET_HDR_GSO_NONE)
+		  ? VIRTIO_PKT_BUFFER_LEN : VIRTIO_PKT_GSO_BUFFER_LEN;
+	if (unlikely(total_len > max_len)) {
+		uk_pr_err("Packet size too big: %lu, max:%lu\n",
+			  total_len, max_len);
 		rc = -ENOTSUP;
 		goto err_remove_vhdr;
 	}
@@ -420,6 +601,53 @@ static int virtio_netdev_xmit(struct uk_netdev *dev,
 	 */
 	rc = virtqueue_buffer_enqueue(queue->vq, pkt, &queue->sg,
 				      queue->sg.sg_nseg, 0);
+	if (likely(rc >= 0)) {
+		uk_netdev_drv_txq_stats_add(queue->ndev, queue->lqueue_id,
+					    packets, 1);
+		uk_netdev_drv_txq_stats_add(queue->ndev, queue->lqueue_id,
+					    bytes, total_len - vndev->hdr_len);
+		return rc;
+	}
+
+	if (rc == -ENOSPC)
+		uk_pr_debug("No more descriptor available\n");
+	else
+		uk_pr_err("Failed to enqueue descriptors into the ring: %d\n",
+			  rc);
+
+err_remove_vhdr:
+	if (rc == -ENOSPC)
+		uk_netdev_drv_txq_stats_add(queue->ndev, queue->lqueue_id,
+					    ring_full, 1);
+	else
+		uk_netdev_drv_txq_stats_add(queue->ndev, queue->lqueue_id,
+					    errors, 1);
+	/**
+	 * Remove header before exiting because we could not send
+	 */
+	uk_netbuf_header(pkt, -header_sz);
+	UK_ASSERT(rc < 0);
+	return rc;
+}
+
+static int virtio_netdev_xmit(struct uk_netdev *dev,
+			      struct uk_netdev_tx_queue *queue,
+			      struct uk_netbuf *pkt)
+{
+	int status = 0x0;
+	int rc;
+
+	UK_ASSERT(dev);
+	UK_ASSERT(pkt && queue);
+
+	/**
+	 * We are reclaiming the free descriptors from buffers. The function is
+	 * not protected by means of locks. We need to be careful if there are
+	 * multiple context through which we free the tx descriptors.
+	 */
+	virtio_netdev_xmit_free(queue);
+
+	rc = virtio_netdev_xmit_enqueue(queue, pkt);
 	if (likely(rc >= 0)) {
 		status |= UK_NETDEV_STATUS_SUCCESS;
 		/**
@@ -431,32 +659,56 @@ static int virtio_netdev_xmit(struct uk_netdev *dev,
 		 * return UK_NETDEV_STATUS_MORE.
 		 */
 		status |= likely(rc > 0) ? UK_NETDEV_STATUS_MORE : 0x0;
-	} else if (rc == -ENOSPC) {
-		uk_pr_debug("No more descriptor available\n");
+	} else if (rc != -ENOSPC) {
+		return rc;
+	}
+	return status;
+}
+
+static int virtio_netdev_xmit_burst(struct uk_netdev *dev,
+				    struct uk_netdev_tx_queue *queue,
+				    struct uk_netbuf *pkt[],
+				    uint16_t *cnt)
+{
+	int status = 0x0;
+	int rc = 0;
+	uint16_t i = 0;
+
+	UK_ASSERT(dev);
+	UK_ASSERT(pkt && cnt && queue);
+
+	virtio_netdev_xmit_free(queue);
+
+	while (i < *cnt) {
+		rc = virtio_netdev_xmit_enqueue(queue, pkt[i]);
+		if (unlikely(rc < 0))
+			break;
+		i++;
+		if (unlikely(rc == 0))
+			break;
+	}
+
+	if (likely(i > 0)) {
+		status |= UK_NETDEV_STATUS_SUCCESS;
 		/**
-		 * Remove header before exiting because we could not send
+		 * A single notification for the whole burst.
 		 */
-		uk_netbuf_header(pkt, -header_sz);
-	} else {
-		uk_pr_err("Failed to enqueue descriptors into the ring: %d\n",
-			  rc);
-		goto err_remove_vhdr;
+		virtqueue_host_notify(queue->vq);
+		status |= (rc > 0) ? UK_NETDEV_STATUS_MORE : 0x0;
+	} else if (rc < 0 && rc != -ENOSPC) {
+		return rc;
 	}
+	*cnt = i;
 	return status;
-
-err_remove_vhdr:
-	uk_netbuf_header(pkt, -header_sz);
-err_exit:
-	UK_ASSERT(rc < 0);
-	return rc;
 }
 
 static int virtio_netdev_rxq_enqueue(struct uk_netdev_rx_queue *rxq,
 				     struct uk_netbuf *netbuf)
 {
+	struct virtio_net_device *vndev = to_virtionetdev(rxq->ndev);
 	int rc = 0;
-	struct virtio_net_hdr_padded *rxhdr;
-	int16_t header_sz = sizeof(*rxhdr);
+	struct virtio_net_hdr *rxhdr;
+	int16_t header_sz;
 	__u8 *buf_start;
 	size_t buf_len = 0;
 	struct uk_sglist *sg;
@@ -473,8 +725,12 @@ static int virtio_netdev_rxq_enqueue(struct uk_netdev_rx_queue *rxq,
 	buf_len = netbuf->len;
 
 	/**
-	 * Retrieve the buffer header length.
+	 * Retrieve the buffer header length. With mergeable buffers, every
+	 * buffer reserves header space because the device decides which
+	 * buffer starts a packet.
 	 */
+	header_sz = vndev->any_layout ? vndev->hdr_len
+		    : sizeof(struct virtio_net_hdr_padded);
 	rc = uk_netbuf_header(netbuf, header_sz);
 	if (unlikely(rc != 1)) {
 		uk_pr_err("Failed to allocate space to prepend virtio header\n");
@@ -485,23 +741,67 @@ static int virtio_netdev_rxq_enqueue(struct uk_netdev_rx_queue *rxq,
 	sg = &rxq->sg;
 	uk_sglist_reset(sg);
 
-	/* Appending the header buffer to the sglist */
-	uk_sglist_append(sg, rxhdr, sizeof(struct virtio_net_hdr));
+	if (vndev->any_layout) {
+		/* A single descriptor for the header and the data buffer */
+		uk_sglist_append(sg, rxhdr, vndev->hdr_len + buf_len);
+	} else {
+		/* Appending the header buffer to the sglist */
+		uk_sglist_append(sg, rxhdr, vndev->hdr_len);
 
-	/* Appending the data buffer to the sglist */
-	uk_sglist_append(sg, buf_start, buf_len);
+		/* Appending the data buffer to the sglist */
+		uk_sglist_append(sg, buf_start, buf_len);
+	}
 
 	rc = virtqueue_buffer_enqueue(rxq->vq, netbuf, sg, 0, sg->sg_nseg);
 	return rc;
 }
 
+/**
+ * Translates the virtio-net header of a received packet to the offload
+ * fields of the netbuf.
+ */
+static void virtio_netdev_recv_offload(struct uk_netbuf *pkt,
+				       const struct virtio_net_hdr *vhdr)
+{
+	pkt->flags = 0;
+	pkt->csum_start = 0;
+	pkt->csum_offset = 0;
+	pkt->gso_type = UK_NETBUF_GSO_NONE;
+	pkt->gso_size = 0;
+	pkt->header_len = 0;
+
+	if (vhdr->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) {
+		pkt->flags = UK_NETBUF_F_PARTIAL_CSUM | UK_NETBUF_F_DATA_VALID;
+		pkt->csum_start = vhdr->csum_start;
+		pkt->csum_offset = vhdr->csum_offset;
+	} else if (vhdr->flags & VIRTIO_NET_HDR_F_DATA_VALID) {
+		pkt->flags = UK_NETBUF_F_DATA_VALID;
+	}
+
+	switch (vhdr->gso_type & ~VIRTIO_NET_HDR_GSO_ECN) {
+	case VIRTIO_NET_HDR_GSO_TCPV4:
+		pkt->gso_type = UK_NETBUF_GSO_TCPV4;
+		break;
+	case VIRTIO_NET_HDR_GSO_TCPV6:
+		pkt->gso_type = UK_NETBUF_GSO_TCPV6;
+		break;
+	default:
+		return;
+	}
+	pkt->gso_size = vhdr->gso_size;
+	pkt->header_len = vhdr->hdr_len;
+}
+
 static int virtio_netdev_rxq_dequeue(struct uk_netdev_rx_queue *rxq,
 				     struct uk_netbuf **netbuf)
 {
+	struct virtio_net_device *vndev = to_virtionetdev(rxq->ndev);
+	struct virtio_net_hdr_mrg_rxbuf *mrg_hdr;
 	int ret;
 	int rc = 0;
-	struct uk_netbuf *buf = NULL;
-	__u32 len;
+	struct uk_netbuf *buf = NULL, *last, *seg;
+	__u16 nb_bufs = 1;
+	__u32 len, pkt_len;
 
 	UK_ASSERT(netbuf);
 
@@ -511,25 +811,83 @@ static int virtio_netdev_rxq_dequeue(struct uk_netdev_rx_queue *rxq,
 		*netbuf = NULL;
 		return rxq->nb_desc;
 	}
-	if (unlikely((len < VIRTIO_HDR_LEN + UK_ETH_HDR_UNTAGGED_LEN)
-		     || (len > VIRTIO_PKT_BUFFER_LEN))) {
-		uk_pr_err("Received invalid packet size: %"__PRIu32"\n", len);
-		return -EINVAL;
+
+	if (!vndev->any_layout) {
+		/**
+		 * The received data cannot exceed the posted buffer: The
+		 * virtio header and the netbuf data following the padded
+		 * header.
+		 */
+		if (unlikely((len < VIRTIO_HDR_LEN + UK_ETH_HDR_UNTAGGED_LEN)
+			     || (len > (__u32) buf->len - VTNET_RX_HEADER_PAD)))
+			goto err_len;
+		virtio_netdev_recv_offload(buf, buf->data);
+
+		/**
+		 * Removing the virtio header from the buffer and adjusting
+		 * length. We pad "VTNET_RX_HEADER_PAD" to the rx buffer while
+		 * enqueuing for alignment of the packet data. We compensate
+		 * for this, by adding the padding to the length on dequeue.
+		 */
+		buf->len = len + VTNET_RX_HEADER_PAD;
+		rc = uk_netbuf_header(buf,
+			-((int16_t)sizeof(struct virtio_net_hdr_padded)));
+		UK_ASSERT(rc == 1);
+		uk_netdev_drv_rxq_stats_add(rxq->ndev, rxq->lqueue_id,
+					    packets, 1);
+		uk_netdev_drv_rxq_stats_add(rxq->ndev, rxq->lqueue_id,
+					    bytes, buf->len);
+		*netbuf = buf;
+		return ret;
 	}
 
+	/* The header directly precedes the frame within the buffer */
+	if (unlikely((len < (__u32) vndev->hdr_len + UK_ETH_HDR_UNTAGGED_LEN)
+		     || (len > buf->len)))
+		goto err_len;
+	virtio_netdev_recv_offload(buf, buf->data);
+	if (vndev->mrg_rxbuf) {
+		mrg_hdr = buf->data;
+		nb_bufs = mrg_hdr->num_buffers;
+	}
+	buf->len = len;
+	rc = uk_netbuf_header(buf, -((int16_t) vndev->hdr_len));
+	UK_ASSERT(rc == 1);
+	pkt_len = buf->len;
+
 	/**
-	 * Removing the virtio header from the buffer and adjusting length.
-	 * We pad "VTNET_RX_HEADER_PAD" to the rx buffer while enqueuing for
-	 * alignment of the packet data. We compensate for this, by adding the
-	 *  padding to the length on dequeue.
+	 * The remaining buffers of a merged packet carry packet data only,
+	 * starting at the header space that was reserved on enqueue. They
+	 * are chained to the first buffer.
 	 */
-	buf->len = len + VTNET_RX_HEADER_PAD;
-	rc = uk_netbuf_header(buf,
-			      -((int16_t)sizeof(struct virtio_net_hdr_padded)));
-	UK_ASSERT(rc == 1);
+	last = buf;
+	while (nb_bufs > 1) {
+		ret = virtqueue_buffer_dequeue(rxq->vq, (void **) &seg, &len);
+		if (unlikely(ret < 0)) {
+			uk_pr_err("Merged packet misses %"__PRIu16" buffers\n",
+				  nb_bufs - 1);
+			goto err_free;
+		}
+		uk_netbuf_connect(last, seg);
+		last = seg;
+		if (unlikely(len > seg->len))
+			goto err_len;
+		seg->len = len;
+		pkt_len += len;
+		nb_bufs--;
+	}
+	uk_netdev_drv_rxq_stats_add(rxq->ndev, rxq->lqueue_id, packets, 1);
+	uk_netdev_drv_rxq_stats_add(rxq->ndev, rxq->lqueue_id, bytes, pkt_len);
 	*netbuf = buf;
-
 	return ret;
+
+err_len:
+	uk_pr_err("Received invalid packet size: %"__PRIu32"\n", len);
+err_free:
+	uk_netdev_drv_rxq_stats_add(rxq->ndev, rxq->lqueue_id, drops, 1);
+	uk_netbuf_free(buf);
+	*netbuf = NULL;
+	return -EINVAL;
 }
 
 static int virtio_netdev_recv(struct uk_netdev *dev,
@@ -599,6 +957,64 @@ err_exit:
 	return rc;
 }
 
+static int virtio_netdev_recv_burst(struct uk_netdev *dev,
+				    struct uk_netdev_rx_queue *queue,
+				    struct uk_netbuf *pkt[],
+				    uint16_t *cnt)
+{
+	int status = 0x0;
+	int used = -1;
+	uint16_t i = 0;
+	int rc;
+
+	UK_ASSERT(dev && queue);
+	UK_ASSERT(pkt && cnt);
+
+	/* Queue interrupts have to be off when calling receive */
+	UK_ASSERT(!(queue->intr_enabled & VTNET_INTR_EN));
+
+retry:
+	while (i < *cnt) {
+		rc = virtio_netdev_rxq_dequeue(queue, &pkt[i]);
+		if (unlikely(rc < 0)) {
+			uk_pr_err("Failed to dequeue the packet: %d\n", rc);
+			if (i == 0)
+				return rc;
+			break;
+		}
+		if (!pkt[i])
+			break;
+		used = rc;
+		i++;
+	}
+
+	/* Refill the ring and notify the host once for the whole burst */
+	if (used >= 0) {
+		status |= virtio_netdev_rx_fillup(queue,
+						  (queue->nb_desc - used), 1);
+		used = -1;
+	}
+
+	/* Enable interrupt only when user had previously enabled it */
+	if (queue->intr_enabled & VTNET_INTR_USR_EN_MASK) {
+		rc = virtqueue_intr_enable(queue->vq);
+		if (rc == 1) {
+			/**
+			 * Packets arrived after reading the queue and before
+			 * enabling the interrupt
+			 */
+			if (i == 0)
+				goto retry;
+			status |= UK_NETDEV_STATUS_MORE;
+		}
+	} else if (i > 0 && virtqueue_hasdata(queue->vq)) {
+		status |= UK_NETDEV_STATUS_MORE;
+	}
+
+	*cnt = i;
+	return status | ((i > 0) ? UK_NETDEV_STATUS_SUCCESS : 0x0);
+}
+
 static struct uk_netdev_rx_queue *virtio_netdev_rx_queue_setup(
 				struct uk_netdev *n, uint16_t queue_id,
 				uint16_t nb_desc,
@@ -613,7 +1029,7 @@ static struct uk_netdev_rx_queue *virtio_netdev_rx_queue_setup(
 	UK_ASSERT(conf->alloc_rxpkts);
 
 	vndev = to_virtionetdev(n);
-	if (queue_id >= vndev->max_vqueue_pairs) {
+	if (queue_id >= vndev->rx_vqueue_cnt) {
 		uk_pr_err("Invalid virtqueue identifier: %"__PRIu16"\n",
 			  queue_id);
 		rc = -EINVAL;
@@ -665,13 +1081,13 @@ static int virtio_netdev_vqueue_setup(struct virtio_net_device *vndev,
 	uint16_t max_desc, hwvq_id;
 	struct virtqueue *vq;
 
+	/* The queues are indexed by the user queue identifier */
+	id = queue_id;
 	if (queue_type == VNET_RX) {
-		id = vndev->rx_vqueue_cnt;
 		callback = virtio_netdev_recv_done;
 		max_desc = vndev->rxqs[id].max_nb_desc;
 		hwvq_id = vndev->rxqs[id].hwvq_id;
 	} else {
-		id = vndev->tx_vqueue_cnt;
 		/* We don't support the callback from the txqueue yet */
 		callback = NULL;
 		max_desc = vndev->txqs[id].max_nb_desc;
@@ -700,19 +1116,25 @@ static int virtio_netdev_vqueue_setup(struct virtio_net_device *vndev,
 		return rc;
 	}
 
+	if (queue_type == VNET_TX) {
+		/* Chained packets occupy a single descriptor of the ring */
+		rc = virtqueue_indirect_setup(vq, NET_MAX_FRAGMENTS, a);
+		if (unlikely(rc < 0 && rc != -ENOTSUP))
+			uk_pr_warn("Failed to set up indirect descriptors: %d\n",
+				   rc);
+	}
+
 	if (queue_type == VNET_RX) {
 		vq->priv = &vndev->rxqs[id];
 		vndev->rxqs[id].ndev = &vndev->netdev;
 		vndev->rxqs[id].vq = vq;
 		vndev->rxqs[id].nb_desc = nr_desc;
 		vndev->rxqs[id].lqueue_id = queue_id;
-		vndev->rx_vqueue_cnt++;
 	} else {
 		vndev->txqs[id].vq = vq;
 		vndev->txqs[id].ndev = &vndev->netdev;
 		vndev->txqs[id].nb_desc = nr_desc;
 		vndev->txqs[id].lqueue_id = queue_id;
-		vndev->tx_vqueue_cnt++;
 	}
 	return id;
 }
@@ -728,7 +1150,7 @@ static struct uk_netdev_tx_queue *virtio_netdev_tx_queue_setup(
 
 	UK_ASSERT(n);
 	vndev = to_virtionetdev(n);
-	if (queue_id >= vndev->max_vqueue_pairs) {
+	if (queue_id >= vndev->tx_vqueue_cnt) {
 		uk_pr_err("Invalid virtqueue identifier: %"__PRIu16"\n",
 			  queue_id);
 		rc = -EINVAL;
@@ -762,7 +1184,7 @@ static int virtio_netdev_rxq_info_get(struct uk_netdev *dev,
 	UK_ASSERT(dev);
 	UK_ASSERT(qinfo);
 	vndev = to_virtionetdev(dev);
-	if (unlikely(queue_id >= vndev->max_vqueue_pairs)) {
+	if (unlikely(queue_id >= vndev->rx_vqueue_cnt)) {
 		uk_pr_err("Invalid virtqueue id: %"__PRIu16"\n", queue_id);
 		rc = -EINVAL;
 		goto exit;
@@ -789,7 +1211,7 @@ static int virtio_netdev_txq_info_get(struct uk_netdev *dev,
 	UK_ASSERT(qinfo);
 
 	vndev = to_virtionetdev(dev);
-	if (unlikely(queue_id >= vndev->max_vqueue_pairs)) {
+	if (unlikely(queue_id >= vndev->tx_vqueue_cnt)) {
 		uk_pr_err("Invalid queue_id %"__PRIu16"\n", queue_id);
 		rc = -EINVAL;
 		goto exit;
@@ -830,8 +1252,81 @@ static __u16 virtio_net_mtu_get(struct uk_netdev *n)
 	return d->mtu;
 }
 
-static int virtio_netdev_feature_negotiate(struct virtio_net_device *vndev)
+/**
+ * Sends a command on the control virtqueue and waits for its completion.
+ * Commands are only sent from configuration context, so the single command
+ * buffer of the device is not protected.
+ * @return
+ *	0 The device acknowledged the command.
+ *	-ENOTSUP There is no control virtqueue.
+ *	-EIO The device rejected the command.
+ *	-ETIMEDOUT The device did not complete the command in time. The
+ *		control virtqueue is not used anymore afterwards.
+ *	< 0 Failed to enqueue the command.
+ */
+static int virtio_netdev_ctrl_send(struct virtio_net_device *vndev,
+				   __u8 class, __u8 cmd,
+				   const void *data, __u32 len)
+{
+	struct virtio_net_ctrl_cmd *ctrl = &vndev->ctrl_cmd;
+	struct uk_sglist *sg = &vndev->ctrl_sg;
+	__u16 read_bufs;
+	__nsec deadline;
+	void *cookie;
+	int rc;
+
+	UK_ASSERT(len <= sizeof(ctrl->data));
+
+	if (unlikely(!vndev->ctrl_vq))
+		return -ENOTSUP;
+
+	ctrl->hdr.class = class;
+	ctrl->hdr.cmd = cmd;
+	memcpy(&ctrl->data, data, len);
+	ctrl->ack = VIRTIO_NET_ERR;
+
+	uk_sglist_reset(sg);
+	rc = uk_sglist_append(sg, &ctrl->hdr, sizeof(ctrl->hdr));
+	if (likely(rc == 0 && len))
+		rc = uk_sglist_append(sg, &ctrl->data, len);
+	read_bufs = sg->sg_nseg;
+	if (likely(rc == 0))
+		rc = uk_sglist_append(sg, &ctrl->ack, sizeof(ctrl->ack));
+	if (unlikely(rc != 0)) {
+		uk_pr_err("Failed to append to the sg list\n");
+		return rc;
+	}
+
+	rc = virtqueue_buffer_enqueue(vndev->ctrl_vq, ctrl, sg, read_bufs,
+				      sg->sg_nseg - read_bufs);
+	if (unlikely(rc < 0)) {
+		uk_pr_err("Failed to enqueue the control command: %d\n", rc);
+		return rc;
+	}
+	virtqueue_host_notify(vndev->ctrl_vq);
+
+	/* The device processes control commands right away */
+	deadline = ukplat_monotonic_clock() + VTNET_CTRL_TIMEOUT;
+	while (virtqueue_buffer_dequeue(vndev->ctrl_vq, &cookie, NULL) < 0) {
+		if (unlikely(ukplat_monotonic_clock() > deadline)) {
+			/* The device still owns the command buffer */
+			uk_pr_err("Control command %"__PRIu8" timed out\n",
+				  cmd);
+			vndev->ctrl_vq = NULL;
+			return -ETIMEDOUT;
+		}
+		ukarch_spinwait();
+	}
+	UK_ASSERT(cookie == ctrl);
+
+	return (ctrl->ack == VIRTIO_NET_OK) ? 0 : -EIO;
+}
+
+static int virtio_netdev_feature_negotiate(struct virtio_net_device *vndev,
+					   const struct uk_netdev_conf *conf)
 {
+	__u32 offloads;
+	__u32 i;
 	__u64 host_features = 0;
 	__u16 hw_len;
 	int rc = 0;
@@ -874,11 +1369,49 @@ static int virtio_netdev_feature_negotiate(struct virtio_net_device *vndev)
 	}
 	rc = 0;
 
+	/**
+	 * Offloads are only negotiated on request because the network stack
+	 * has to handle the offload fields of the netbufs. Offloads that
+	 * others depend on are enabled implicitly.
+	 */
+	offloads = conf->offloads;
+	for (i = 0; i < ARRAY_SIZE(virtio_net_offloads); i++) {
+		if (offloads & virtio_net_offloads[i].offload)
+			offloads |= virtio_net_offloads[i].requires;
+	}
+	for (i = 0; i < ARRAY_SIZE(virtio_net_offloads); i++) {
+		if (offloads & virtio_net_offloads[i].offload)
+			VIRTIO_FEATURES_UPDATE(vndev->vdev->features,
+					       virtio_net_offloads[i].feature);
+	}
+
 	/**
 	 * Mask out features supported by both driver and device.
 	 */
 	vndev->vdev->features &= host_features;
-	virtio_feature_set(vndev->vdev, vndev->vdev->features);
+
+	/**
+	 * Mergeable buffers are only used with VIRTIO_F_ANY_LAYOUT: Each
+	 * receive buffer is a single descriptor that starts with header space.
+	 */
+	if (!virtio_netdev_any_layout(vndev->vdev->features))
+		vndev->vdev->features &= ~(1ULL << VIRTIO_NET_F_MRG_RXBUF);
+	/* The number of queue pairs is set with control commands */
+	if (!virtio_has_features(vndev->vdev->features, VIRTIO_NET_F_CTRL_VQ))
+		vndev->vdev->features &= ~(1ULL << VIRTIO_NET_F_MQ);
+	rc = virtio_feature_set(vndev->vdev, vndev->vdev->features);
+	if (unlikely(rc < 0))
+		goto exit;
+	vndev->offloads = virtio_netdev_offloads(vndev->vdev->features);
+	vndev->any_layout = virtio_netdev_any_layout(vndev->vdev->features);
+	vndev->mrg_rxbuf = virtio_has_features(vndev->vdev->features,
+					       VIRTIO_NET_F_MRG_RXBUF);
+	/* With VIRTIO_F_VERSION_1, the header always has num_buffers */
+	vndev->hdr_len = (vndev->mrg_rxbuf
+			  || virtio_has_features(vndev->vdev->features,
+						 VIRTIO_F_VERSION_1))
+			 ? sizeof(struct virtio_net_hdr_mrg_rxbuf)
+			 : sizeof(struct virtio_net_hdr);
 exit:
 	return rc;
 }
@@ -889,16 +1422,48 @@ static int virtio_netdev_rxtx_alloc(struct virtio_net_device *vndev,
 	int rc = 0;
 	int i = 0;
 	int vq_avail = 0;
-	int total_vqs = conf->nb_rx_queues + conf->nb_tx_queues;
-	__u16 qdesc_size[total_vqs];
+	int total_vqs;
+	int ctrl_vq_id = 0;
+	__u16 *qdesc_size = NULL;
+	struct virtqueue *vq;
 
-	if (conf->nb_rx_queues != 1 || conf->nb_tx_queues != 1) {
+	/**
+	 * The device steers received flows to all queue pairs that are
+	 * enabled, so receive and transmit queues are used in pairs.
+	 */
+	if (conf->nb_rx_queues == 0
+	    || conf->nb_rx_queues != conf->nb_tx_queues
+	    || conf->nb_rx_queues > vndev->max_vqueue_pairs) {
 		uk_pr_err("Queue combination not supported: %"__PRIu16"/%"__PRIu16" rx/tx\n",
 			  conf->nb_rx_queues, conf->nb_tx_queues);
 
 		return -ENOTSUP;
 	}
 
+	/**
+	 * The virtqueue are organized as:
+	 * Virtqueue-rx0
+	 * Virtqueue-tx0
+	 * Virtqueue-rx1
+	 * Virtqueue-tx1
+	 * ...
+	 * Virtqueue-ctrlq
+	 * The control virtqueue follows the last pair that the device
+	 * provides, independent of the number of pairs that we use.
+	 */
+	if (virtio_has_features(vndev->vdev->features, VIRTIO_NET_F_CTRL_VQ)) {
+		if (virtio_has_features(vndev->vdev->features,
+					VIRTIO_NET_F_MQ))
+			ctrl_vq_id = 2 * vndev->dev_vqueue_pairs;
+		else
+			ctrl_vq_id = 2;
+		total_vqs = ctrl_vq_id + 1;
+	} else {
+		total_vqs = 2 * conf->nb_rx_queues;
+	}
+	/* Ensured by virtio_netdev_feature_set() */
+	UK_ASSERT(total_vqs <= (int) __U16_MAX);
+
 	/**
 	 * TODO:
 	 * The virtio device management data structure are allocated using the
@@ -906,9 +1471,10 @@ static int virtio_netdev_rxtx_alloc(struct virtio_net_device *vndev,
 	 * wiser to move it to the allocator of each individual queue. This
 	 * would better considering NUMA support.
 	 */
-	vndev->rxqs = uk_malloc(a, sizeof(*vndev->rxqs) * conf->nb_rx_queues);
-	vndev->txqs = uk_malloc(a, sizeof(*vndev->txqs) * conf->nb_tx_queues);
-	if (unlikely(!vndev->rxqs || !vndev->txqs)) {
+	qdesc_size = uk_malloc(a, sizeof(*qdesc_size) * total_vqs);
+	vndev->rxqs = uk_calloc(a, conf->nb_rx_queues, sizeof(*vndev->rxqs));
+	vndev->txqs = uk_calloc(a, conf->nb_tx_queues, sizeof(*vndev->txqs));
+	if (unlikely(!qdesc_size || !vndev->rxqs || !vndev->txqs)) {
 		uk_pr_err("Failed to allocate memory for queue management\n");
 		rc = -ENOMEM;
 		goto err_free_txrx;
@@ -922,16 +1488,7 @@ static int virtio_netdev_rxtx_alloc(struct virtio_net_device *vndev,
 		goto err_free_txrx;
 	}
 
-	/**
-	 * The virtqueue are organized as:
-	 * Virtqueue-rx0
-	 * Virtqueue-tx0
-	 * Virtqueue-rx1
-	 * Virtqueue-tx1
-	 * ...
-	 * Virtqueue-ctrlq
-	 */
-	for (i = 0; i < vndev->max_vqueue_pairs; i++) {
+	for (i = 0; i < conf->nb_rx_queues; i++) {
 		/**
 		 * Initialize the received queue with the information received
 		 * from the device.
@@ -942,7 +1499,8 @@ static int virtio_netdev_rxtx_alloc(struct virtio_net_device *vndev,
 			       (sizeof(vndev->rxqs[i].sgsegs) /
 				sizeof(vndev->rxqs[i].sgsegs[0])),
 			       &vndev->rxqs[i].sgsegs[0]);
-
+	}
+	for (i = 0; i < conf->nb_tx_queues; i++) {
 		/**
 		 * Initialize the transmit queue with the information received
 		 * from the device.
@@ -954,14 +1512,36 @@ static int virtio_netdev_rxtx_alloc(struct virtio_net_device *vndev,
 				sizeof(vndev->txqs[i].sgsegs[0])),
 			       &vndev->txqs[i].sgsegs[0]);
 	}
+	vndev->rx_vqueue_cnt = conf->nb_rx_queues;
+	vndev->tx_vqueue_cnt = conf->nb_tx_queues;
+
+	if (ctrl_vq_id) {
+		/* Control commands are polled for completion */
+		vq = virtio_vqueue_setup(vndev->vdev, ctrl_vq_id,
+					 qdesc_size[ctrl_vq_id], NULL, a);
+		if (unlikely(PTRISERR(vq))) {
+			uk_pr_err("Failed to set up the control virtqueue\n");
+			rc = PTR2ERR(vq);
+			goto err_free_txrx;
+		}
+		virtqueue_intr_disable(vq);
+		vndev->ctrl_vq = vq;
+		uk_sglist_init(&vndev->ctrl_sg, ARRAY_SIZE(vndev->ctrl_sgsegs),
+			       &vndev->ctrl_sgsegs[0]);
+	}
+	uk_free(a, qdesc_size);
 exit:
 	return rc;
 
 err_free_txrx:
-	if (!vndev->rxqs)
+	if (qdesc_size)
+		uk_free(a, qdesc_size);
+	if (vndev->rxqs)
 		uk_free(a, vndev->rxqs);
-	if (!vndev->txqs)
+	if (vndev->txqs)
 		uk_free(a, vndev->txqs);
+	vndev->rxqs = NULL;
+	vndev->txqs = NULL;
 	goto exit;
 }
 
@@ -975,7 +1555,7 @@ static int virtio_netdev_configure(struct uk_netdev *n,
 	UK_ASSERT(conf);
 	vndev = to_virtionetdev(n);
 
-	rc = virtio_netdev_feature_negotiate(vndev);
+	rc = virtio_netdev_feature_negotiate(vndev, conf);
 	if (rc != 0) {
 		uk_pr_err("Failed to negotiate the device feature %d\n", rc);
 		goto err_negotiate_feature;
@@ -987,10 +1567,6 @@ static int virtio_netdev_configure(struct uk_netdev *n,
 		goto err_negotiate_feature;
 	}
 
-	/* Initialize the count of the virtio-net device */
-	vndev->rx_vqueue_cnt = 0;
-	vndev->tx_vqueue_cnt = 0;
-
 	uk_pr_info("Configured: features=0x%lx max_virtqueue_pairs=%"__PRIu16"\n",
 		   vndev->vdev->features, vndev->max_vqueue_pairs);
 exit:
@@ -1042,9 +1618,11 @@ static void virtio_net_info_get(struct uk_netdev *dev,
 				struct uk_netdev_info *dev_info)
 {
 	struct virtio_net_device *vndev;
+	__u64 host_features;
 
 	UK_ASSERT(dev && dev_info);
 	vndev = to_virtionetdev(dev);
+	host_features = virtio_feature_get(vndev->vdev);
 
 	dev_info->max_rx_queues = vndev->max_vqueue_pairs;
 	dev_info->max_tx_queues = vndev->max_vqueue_pairs;
@@ -1053,16 +1631,40 @@ static void virtio_net_info_get(struct uk_netdev *dev,
 	dev_info->nb_encap_rx = sizeof(struct virtio_net_hdr_padded);
 	dev_info->ioalign = sizeof(void *); /* word size alignment */
 	dev_info->features = UK_FEATURE_RXQ_INTR_AVAILABLE;
+	dev_info->offloads = virtio_netdev_offloads(host_features);
+	/* Large packets are spread over multiple (e.g., page-sized) buffers */
+	if (virtio_has_features(host_features, VIRTIO_NET_F_MRG_RXBUF)
+	    && virtio_netdev_any_layout(host_features))
+		dev_info->lro_rxbuf_len = 0;
+	else
+		dev_info->lro_rxbuf_len = VIRTIO_PKT_GSO_BUFFER_LEN
+					  - VIRTIO_HDR_LEN;
 }
 
 static int virtio_net_start(struct uk_netdev *n)
 {
 	struct virtio_net_device *d;
+	struct virtio_net_ctrl_mq mq;
 	int i = 0;
+	int rc;
 
 	UK_ASSERT(n != NULL);
 	d = to_virtionetdev(n);
 
+	/* The device may use every queue of the enabled pairs */
+	for (i = 0; i < d->rx_vqueue_cnt; i++) {
+		if (unlikely(!d->rxqs[i].vq)) {
+			uk_pr_err("Receive queue %d is not configured\n", i);
+			return -EINVAL;
+		}
+	}
+	for (i = 0; i < d->tx_vqueue_cnt; i++) {
+		if (unlikely(!d->txqs[i].vq)) {
+			uk_pr_err("Transmit queue %d is not configured\n", i);
+			return -EINVAL;
+		}
+	}
+
 	/*
 	 * By default, interrupts are disabled and it is up to the user or
 	 * network stack to manually enable them with a call to
@@ -1082,6 +1684,22 @@ static int virtio_net_start(struct uk_netdev *n)
 	 * Set the DRIVER_OK status bit. At this point the device is "live".
 	 */
 	virtio_dev_drv_up(d->vdev);
+
+	/**
+	 * The device starts with a single queue pair. Control commands can
+	 * only be sent to a live device.
+	 */
+	mq.virtqueue_pairs = d->rx_vqueue_cnt;
+	if (mq.virtqueue_pairs > 1) {
+		rc = virtio_netdev_ctrl_send(d, VIRTIO_NET_CTRL_MQ,
+					     VIRTIO_NET_CTRL_MQ_VQ_PAIRS_SET,
+					     &mq, sizeof(mq));
+		if (unlikely(rc < 0)) {
+			uk_pr_err("Failed to enable %"__PRIu16" queue pairs: %d\n",
+				  mq.virtqueue_pairs, rc);
+			return rc;
+		}
+	}
 	uk_pr_info(DRIVER_NAME": %"__PRIu16" started\n", d->uid);
 
 	return 0;
@@ -1089,14 +1707,44 @@ static int virtio_net_start(struct uk_netdev *n)
 
 static inline void virtio_netdev_feature_set(struct virtio_net_device *vndev)
 {
+	__u64 host_features;
+	__u16 pairs = 1;
+	int rc;
+
 	vndev->vdev->features = 0;
 	/* Setting the feature the driver support */
 	VIRTIO_NET_DRV_FEATURES(vndev->vdev->features);
+
 	/**
-	 * TODO:
-	 * Adding multiqueue support for the virtio net driver.
+	 * The number of queue pairs is reported before the device is
+	 * configured, so we read it from the configuration space already now.
 	 */
-	vndev->max_vqueue_pairs = 1;
+	host_features = virtio_feature_get(vndev->vdev);
+	if (virtio_has_features(host_features, VIRTIO_NET_F_MQ)
+	    && virtio_has_features(host_features, VIRTIO_NET_F_CTRL_VQ)) {
+		rc = virtio_config_get(vndev->vdev,
+				       __offsetof(struct virtio_net_config,
+						  max_virtqueue_pairs),
+				       &pairs, sizeof(pairs), 1);
+		if (unlikely(rc != sizeof(pairs)
+			     || pairs < VIRTIO_NET_CTRL_MQ_VQ_PAIRS_MIN
+			     || pairs > VIRTIO_NET_CTRL_MQ_VQ_PAIRS_MAX)) {
+			uk_pr_warn("Invalid number of virtqueue pairs, using a single pair\n");
+			vndev->vdev->features &= ~(1ULL << VIRTIO_NET_F_MQ);
+			pairs = 1;
+		} else if (unlikely(pairs > VTNET_VQ_PAIRS_MAX)) {
+			/**
+			 * The control virtqueue follows the last pair and
+			 * cannot be addressed. Without multiqueue, it is the
+			 * third virtqueue.
+			 */
+			uk_pr_warn("Too many virtqueue pairs, using a single pair\n");
+			vndev->vdev->features &= ~(1ULL << VIRTIO_NET_F_MQ);
+			pairs = 1;
+		}
+	}
+	vndev->dev_vqueue_pairs = pairs;
+	vndev->max_vqueue_pairs = MIN(pairs, CONFIG_LIBUKNETDEV_MAXNBQUEUES);
 }
 
 static const struct uk_netdev_ops virtio_netdev_ops = {
@@ -1130,6 +1778,8 @@ static int virtio_net_add_dev(struct virtio_dev *vdev)
 	/* register netdev */
 	vndev->netdev.rx_one = virtio_netdev_recv;
 	vndev->netdev.tx_one = virtio_netdev_xmit;
+	vndev->netdev.rx_burst = virtio_netdev_recv_burst;
+	vndev->netdev.tx_burst = virtio_netdev_xmit_burst;
 	vndev->netdev.ops = &virtio_netdev_ops;
 
 	rc = uk_netdev_drv_register(&vndev->netdev, a, drv_name);
@@ -47,9 +47,22 @@
 
 #define VENDOR_QUMRANET_VIRTIO           (0x1AF4)
 #define VIRTIO_PCI_MODERN_DEVICEID_START (0x1040)
+#define VIRTIO_PCI_MODERN_DEVICEID_END   (0x107F)
 
 static struct uk_alloc *a;
 
+struct virtio_pci_dev;
+
+/**
+ * The structure declares a queue of the modern interface.
+ */
+struct virtio_pci_queue {
+	/* Virtqueue, NULL while the queue is not set up */
+	struct virtqueue *vq;
+	/* Notification address of the queue */
+	volatile __u16 *notify;
+};
+
 /**
  * The structure declares a pci device.
  */
@@ -62,6 +75,21 @@ struct virtio_pci_dev {
 	__u16 pci_isr_addr;
 	/* Pci device information */
 	struct pci_device *pdev;
+
+	/* Modern interface: Configuration structures mapped from the BARs */
+	volatile struct virtio_pci_common_cfg *common;
+	volatile __u8 *isr;
+	volatile __u8 *device_cfg;
+	volatile __u8 *notify_base;
+	__u32 notify_off_mult;
+	/* Modern interface: Queues of the device */
+	struct virtio_pci_queue *queues;
+	__u16 queue_cnt;
+	/**
+	 * MSI-X IRQs: one for configuration changes followed by one for
+	 * each queue. NULL if the interrupt line of the device is used.
+	 */
+	unsigned long *msix_irqs;
 };
 
 /**
@@ -81,8 +109,8 @@ static int vpci_legacy_pci_config_set(struct virtio_dev *vdev, __u16 offset,
 static int vpci_legacy_pci_config_get(struct virtio_dev *vdev, __u16 offset,
 				      void *buf, __u32 len, __u8 type_len);
 static __u64 vpci_legacy_pci_features_get(struct virtio_dev *vdev);
-static void vpci_legacy_pci_features_set(struct virtio_dev *vdev,
-					 __u64 features);
+static int vpci_legacy_pci_features_set(struct virtio_dev *vdev,
+					__u64 features);
 static int vpci_legacy_pci_vq_find(struct virtio_dev *vdev, __u16 num_vq,
 				   __u16 *qdesc_size);
 static void vpci_legacy_pci_status_set(struct virtio_dev *vdev, __u8 status);
@@ -98,6 +126,28 @@ static int virtio_pci_handle(void *arg);
 static int vpci_legacy_notify(struct virtio_dev *vdev, __u16 queue_id);
 static int virtio_pci_legacy_add_dev(struct pci_device *pci_dev,
 				     struct virtio_pci_dev *vpci_dev);
+static void vpci_modern_pci_dev_reset(struct virtio_dev *vdev);
+static int vpci_modern_pci_config_set(struct virtio_dev *vdev, __u16 offset,
+				      const void *buf, __u32 len);
+static int vpci_modern_pci_config_get(struct virtio_dev *vdev, __u16 offset,
+				      void *buf, __u32 len, __u8 type_len);
+static __u64 vpci_modern_pci_features_get(struct virtio_dev *vdev);
+static int vpci_modern_pci_features_set(struct virtio_dev *vdev,
+					__u64 features);
+static int vpci_modern_pci_vq_find(struct virtio_dev *vdev, __u16 num_vq,
+				   __u16 *qdesc_size);
+static void vpci_modern_pci_status_set(struct virtio_dev *vdev, __u8 status);
+static __u8 vpci_modern_pci_status_get(struct virtio_dev *vdev);
+static struct virtqueue *vpci_modern_vq_setup(struct virtio_dev *vdev,
+					      __u16 queue_id,
+					      __u16 num_desc,
+					      virtqueue_callback_t callback,
+					      struct uk_alloc *a);
+static void vpci_modern_vq_release(struct virtio_dev *vdev,
+		struct virtqueue *vq, struct uk_alloc *a);
+static int vpci_modern_notify(struct virtio_dev *vdev, __u16 queue_id);
+static int virtio_pci_modern_add_dev(struct pci_device *pci_dev,
+				     struct virtio_pci_dev *vpci_dev);
 
 /**
  * Configuration operations legacy PCI device.
@@ -115,6 +165,22 @@ static struct virtio_config_ops vpci_legacy_ops = {
 	.vq_release   = vpci_legacy_vq_release,
 };
 
+/**
+ * Configuration operations modern PCI device.
+ */
+static struct virtio_config_ops vpci_modern_ops = {
+	.device_reset = vpci_modern_pci_dev_reset,
+	.config_get   = vpci_modern_pci_config_get,
+	.config_set   = vpci_modern_pci_config_set,
+	.features_get = vpci_modern_pci_features_get,
+	.features_set = vpci_modern_pci_features_set,
+	.status_get   = vpci_modern_pci_status_get,
+	.status_set   = vpci_modern_pci_status_set,
+	.vqs_find     = vpci_modern_pci_vq_find,
+	.vq_setup     = vpci_modern_vq_setup,
+	.vq_release   = vpci_modern_vq_release,
+};
+
 static int vpci_legacy_notify(struct virtio_dev *vdev, __u16 queue_id)
 {
 	struct virtio_pci_dev *vpdev;
@@ -137,7 +203,11 @@ static int virtio_pci_handle(void *arg)
 	UK_ASSERT(arg);
 
 	/* Reading the isr status is used to acknowledge the interrupt */
-	isr_status = virtio_cread8((void *)(unsigned long)d->pci_isr_addr, 0);
+	if (d->isr)
+		isr_status = *d->isr;
+	else
+		isr_status = virtio_cread8(
+				(void *)(unsigned long)d->pci_isr_addr, 0);
 	/* We don't support configuration interrupt on the device */
 	if (isr_status & VIRTIO_PCI_ISR_CONFIG) {
 		uk_pr_warn("Unsupported config change interrupt received on virtio-pci device %p\n",
@@ -152,6 +222,26 @@ static int virtio_pci_handle(void *arg)
 	return rc;
 }
 
+static int virtio_pci_queue_handle(void *arg)
+{
+	struct virtqueue *vq = *(struct virtqueue **) arg;
+
+	/**
+	 * The vector belongs to a single queue. Neither the ISR status has to
+	 * be read nor the other queues checked.
+	 */
+	if (likely(vq))
+		virtqueue_ring_interrupt(vq);
+	return 1;
+}
+
+static int virtio_pci_config_handle(void *arg)
+{
+	uk_pr_warn("Unsupported config change interrupt received on virtio-pci device %p\n",
+		   arg);
+	return 1;
+}
+
 static struct virtqueue *vpci_legacy_vq_setup(struct virtio_dev *vdev,
 					      __u16 queue_id,
 					      __u16 num_desc,
@@ -347,8 +437,8 @@ static __u64 vpci_legacy_pci_features_get(struct virtio_dev *vdev)
 	return features;
 }
 
-static void vpci_legacy_pci_features_set(struct virtio_dev *vdev,
-					 __u64 features)
+static int vpci_legacy_pci_features_set(struct virtio_dev *vdev,
+					__u64 features)
 {
 	struct virtio_pci_dev *vpdev = NULL;
 
@@ -358,6 +448,7 @@ static void vpci_legacy_pci_features_set(struct virtio_dev *vdev,
 	features = virtqueue_feature_negotiate(features);
 	virtio_cwrite32((void *) (unsigned long)vpdev->pci_base_addr,
 			VIRTIO_PCI_GUEST_FEATURES, (__u32)features);
+	return 0;
 }
 
 static int virtio_pci_legacy_add_dev(struct pci_device *pci_dev,
@@ -384,6 +475,409 @@ static int virtio_pci_legacy_add_dev(struct pci_device *pci_dev,
 }
 
 
+static int vpci_modern_notify(struct virtio_dev *vdev, __u16 queue_id)
+{
+	struct virtio_pci_dev *vpdev;
+
+	UK_ASSERT(vdev);
+	vpdev = to_virtiopcidev(vdev);
+	UK_ASSERT(queue_id < vpdev->queue_cnt);
+	*vpdev->queues[queue_id].notify = queue_id;
+
+	return 0;
+}
+
+static struct virtqueue *vpci_modern_vq_setup(struct virtio_dev *vdev,
+					      __u16 queue_id,
+					      __u16 num_desc,
+					      virtqueue_callback_t callback,
+					      struct uk_alloc *a)
+{
+	struct virtio_pci_dev *vpdev = NULL;
+	volatile struct virtio_pci_common_cfg *common;
+	struct virtio_pci_queue *queue;
+	struct virtqueue *vq;
+	__phys_addr addr;
+	long flags;
+
+	UK_ASSERT(vdev != NULL);
+
+	vpdev = to_virtiopcidev(vdev);
+	common = vpdev->common;
+	if (unlikely(queue_id >= vpdev->queue_cnt)) {
+		uk_pr_err("Virtqueue %"__PRIu16" was not found\n", queue_id);
+		return ERR2PTR(-EINVAL);
+	}
+	queue = &vpdev->queues[queue_id];
+
+	vq = virtqueue_create(queue_id, num_desc, VIRTIO_PCI_VRING_ALIGN,
+			      callback, vpci_modern_notify, vdev, a);
+	if (PTRISERR(vq)) {
+		uk_pr_err("Failed to create the virtqueue: %d\n",
+			  PTR2ERR(vq));
+		goto err_exit;
+	}
+
+	/* Select the queue of interest */
+	common->queue_select = queue_id;
+	common->queue_size = num_desc;
+
+	/* Physical addresses of the queue areas */
+	addr = virtqueue_physaddr(vq);
+	common->queue_desc_lo = (__u32) addr;
+	common->queue_desc_hi = (__u32) (addr >> 32);
+	addr = virtqueue_driver_area_physaddr(vq);
+	common->queue_avail_lo = (__u32) addr;
+	common->queue_avail_hi = (__u32) (addr >> 32);
+	addr = virtqueue_device_area_physaddr(vq);
+	common->queue_used_lo = (__u32) addr;
+	common->queue_used_hi = (__u32) (addr >> 32);
+
+	if (vpdev->msix_irqs) {
+		/* Vector 0 is used for configuration changes */
+		common->queue_msix_vector = queue_id + 1;
+		if (common->queue_msix_vector != queue_id + 1) {
+			uk_pr_err("Failed to assign an MSI-X vector to virtqueue %"__PRIu16"\n",
+				  queue_id);
+			virtqueue_destroy(vq, a);
+			vq = ERR2PTR(-EIO);
+			goto err_exit;
+		}
+	}
+
+	queue->notify = (volatile __u16 *) (vpdev->notify_base +
+			common->queue_notify_off * vpdev->notify_off_mult);
+
+	flags = ukplat_lcpu_save_irqf();
+	queue->vq = vq;
+	UK_TAILQ_INSERT_TAIL(&vpdev->vdev.vqs, vq, next);
+	ukplat_lcpu_restore_irqf(flags);
+
+	common->queue_enable = 1;
+
+err_exit:
+	return vq;
+}
+
+static void vpci_modern_vq_release(struct virtio_dev *vdev,
+		struct virtqueue *vq, struct uk_alloc *a)
+{
+	struct virtio_pci_dev *vpdev = NULL;
+	long flags;
+
+	UK_ASSERT(vq != NULL);
+	UK_ASSERT(a != NULL);
+	vpdev = to_virtiopcidev(vdev);
+
+	/**
+	 * The modern interface does not allow to disable a single queue. It is
+	 * disabled with the next device reset.
+	 */
+	flags = ukplat_lcpu_save_irqf();
+	vpdev->queues[vq->queue_id].vq = NULL;
+	UK_TAILQ_REMOVE(&vpdev->vdev.vqs, vq, next);
+	ukplat_lcpu_restore_irqf(flags);
+
+	virtqueue_destroy(vq, a);
+}
+
+/**
+ * Use a MSI-X vector for configuration changes and one for each queue.
+ */
+static int vpci_modern_msix_setup(struct virtio_pci_dev *vpdev,
+				  __u16 num_vqs)
+{
+	unsigned long *irqs;
+	int i, rc;
+
+	irqs = uk_calloc(a, num_vqs + 1, sizeof(*irqs));
+	if (!irqs)
+		return -ENOMEM;
+
+	rc = pci_msix_enable(vpdev->pdev, irqs, num_vqs + 1);
+	if (rc < 0)
+		goto err_free;
+
+	rc = ukplat_irq_register(irqs[0], virtio_pci_config_handle, vpdev);
+	if (rc < 0)
+		goto err_disable;
+	for (i = 0; i < num_vqs; i++) {
+		rc = ukplat_irq_register(irqs[i + 1], virtio_pci_queue_handle,
+					 &vpdev->queues[i].vq);
+		if (rc < 0)
+			goto err_disable;
+	}
+
+	vpdev->common->msix_config = 0;
+	vpdev->msix_irqs = irqs;
+	return 0;
+
+err_disable:
+	/* Registered handlers stay inactive without MSI-X */
+	pci_msix_disable(vpdev->pdev);
+err_free:
+	uk_free(a, irqs);
+	return rc;
+}
+
+static int vpci_modern_pci_vq_find(struct virtio_dev *vdev, __u16 num_vqs,
+				   __u16 *qdesc_size)
+{
+	struct virtio_pci_dev *vpdev = NULL;
+	volatile struct virtio_pci_common_cfg *common;
+	int vq_cnt = 0, i = 0, rc = 0;
+
+	UK_ASSERT(vdev);
+	vpdev = to_virtiopcidev(vdev);
+	common = vpdev->common;
+
+	/* The queues are only set up once for the lifetime of the device */
+	if (vpdev->queues) {
+		uk_pr_err("Virtqueues were already found\n");
+		return -EEXIST;
+	}
+	vpdev->queues = uk_calloc(a, num_vqs, sizeof(*vpdev->queues));
+	if (!vpdev->queues)
+		return -ENOMEM;
+	vpdev->queue_cnt = num_vqs;
+
+	/**
+	 * Each queue interrupts with a vector of its own. We fall back to the
+	 * shared interrupt line if MSI-X is not available.
+	 */
+	rc = vpci_modern_msix_setup(vpdev, num_vqs);
+	if (rc < 0) {
+		uk_pr_info("Using the interrupt line of the device: MSI-X not available (%d)\n",
+			   rc);
+		rc = ukplat_irq_register(vpdev->pdev->irq, virtio_pci_handle,
+					 vpdev);
+		if (rc != 0) {
+			uk_pr_err("Failed to register the interrupt\n");
+			uk_free(a, vpdev->queues);
+			vpdev->queues = NULL;
+			vpdev->queue_cnt = 0;
+			return rc;
+		}
+	}
+
+	for (i = 0; i < num_vqs; i++) {
+		qdesc_size[i] = 0;
+		if (i < common->num_queues) {
+			common->queue_select = i;
+			qdesc_size[i] = common->queue_size;
+		}
+		if (unlikely(!qdesc_size[i])) {
+			uk_pr_err("Virtqueue %d not available\n", i);
+			continue;
+		}
+		vq_cnt++;
+	}
+	return vq_cnt;
+}
+
+static int vpci_modern_pci_config_set(struct virtio_dev *vdev, __u16 offset,
+				      const void *buf, __u32 len)
+{
+	struct virtio_pci_dev *vpdev = NULL;
+	__u32 i;
+
+	UK_ASSERT(vdev);
+	vpdev = to_virtiopcidev(vdev);
+	if (unlikely(!vpdev->device_cfg))
+		return -ENOTSUP;
+
+	for (i = 0; i < len; i++)
+		vpdev->device_cfg[offset + i] = ((const __u8 *) buf)[i];
+
+	return 0;
+}
+
+static int vpci_modern_pci_config_get(struct virtio_dev *vdev, __u16 offset,
+				      void *buf, __u32 len, __u8 type_len)
+{
+	struct virtio_pci_dev *vpdev = NULL;
+	volatile __u8 *cfg;
+	__u8 generation;
+	__u32 i;
+
+	UK_ASSERT(vdev);
+	vpdev = to_virtiopcidev(vdev);
+	if (unlikely(!vpdev->device_cfg))
+		return -ENOTSUP;
+	cfg = vpdev->device_cfg + offset;
+
+	/**
+	 * The configuration generation changes if the device modified the
+	 * configuration while we were reading it.
+	 */
+	do {
+		generation = vpdev->common->config_generation;
+		if (type_len == len && type_len == 2) {
+			*(__u16 *) buf = *(volatile __u16 *) cfg;
+		} else if (type_len == len && type_len == 4) {
+			*(__u32 *) buf = *(volatile __u32 *) cfg;
+		} else {
+			for (i = 0; i < len; i++)
+				((__u8 *) buf)[i] = cfg[i];
+		}
+	} while (generation != vpdev->common->config_generation);
+
+	return len;
+}
+
+static __u8 vpci_modern_pci_status_get(struct virtio_dev *vdev)
+{
+	struct virtio_pci_dev *vpdev = NULL;
+
+	UK_ASSERT(vdev);
+	vpdev = to_virtiopcidev(vdev);
+	return vpdev->common->device_status;
+}
+
+static void vpci_modern_pci_status_set(struct virtio_dev *vdev, __u8 status)
+{
+	struct virtio_pci_dev *vpdev = NULL;
+
+	/* Reset should be performed using the reset interface */
+	UK_ASSERT(vdev || status != VIRTIO_CONFIG_STATUS_RESET);
+
+	vpdev = to_virtiopcidev(vdev);
+	vpdev->common->device_status |= status;
+}
+
+static void vpci_modern_pci_dev_reset(struct virtio_dev *vdev)
+{
+	struct virtio_pci_dev *vpdev = NULL;
+
+	UK_ASSERT(vdev);
+
+	vpdev = to_virtiopcidev(vdev);
+	vpdev->common->device_status = VIRTIO_CONFIG_STATUS_RESET;
+	/* The reset is complete once the device reads back 0 */
+	while (vpdev->common->device_status != VIRTIO_CONFIG_STATUS_RESET)
+		;
+}
+
+static __u64 vpci_modern_pci_features_get(struct virtio_dev *vdev)
+{
+	struct virtio_pci_dev *vpdev = NULL;
+	__u64 features;
+
+	UK_ASSERT(vdev);
+
+	vpdev = to_virtiopcidev(vdev);
+	vpdev->common->device_feature_select = 0;
+	features = vpdev->common->device_feature;
+	vpdev->common->device_feature_select = 1;
+	features |= (__u64) vpdev->common->device_feature << 32;
+	return features;
+}
+
+static int vpci_modern_pci_features_set(struct virtio_dev *vdev,
+					__u64 features)
+{
+	struct virtio_pci_dev *vpdev = NULL;
+
+	UK_ASSERT(vdev);
+	vpdev = to_virtiopcidev(vdev);
+	/* Mask out features not supported by the virtqueue driver */
+	features = virtqueue_feature_negotiate(features);
+	/**
+	 * The modern interface requires VIRTIO_F_VERSION_1. We record it so
+	 * that drivers use the virtio 1.0 layouts.
+	 */
+	VIRTIO_FEATURES_UPDATE(features, VIRTIO_F_VERSION_1);
+	VIRTIO_FEATURES_UPDATE(vdev->features, VIRTIO_F_VERSION_1);
+
+	vpdev->common->driver_feature_select = 0;
+	vpdev->common->driver_feature = (__u32) features;
+	vpdev->common->driver_feature_select = 1;
+	vpdev->common->driver_feature = (__u32) (features >> 32);
+
+	/* The device clears FEATURES_OK if it cannot operate with them */
+	vpci_modern_pci_status_set(vdev, VIRTIO_CONFIG_STATUS_FEATURES_OK);
+	if (!(vpci_modern_pci_status_get(vdev)
+	      & VIRTIO_CONFIG_STATUS_FEATURES_OK)) {
+		uk_pr_err("Device did not accept the features 0x%"__PRIx64"\n",
+			  features);
+		return -EIO;
+	}
+	return 0;
+}
+
+static int virtio_pci_modern_add_dev(struct pci_device *pci_dev,
+				     struct virtio_pci_dev *vpci_dev)
+{
+	__u8 pos = 0, type, bar;
+	__u32 offset, length;
+	__u16 cmd;
+
+	/* Locate the configuration structures, the first of each type wins */
+	while ((pos = pci_cap_find(pci_dev, PCI_CAP_ID_VNDR, pos)) != 0) {
+		type = pci_config_read8(pci_dev, pos + VIRTIO_PCI_CAP_CFG_TYPE);
+		bar = pci_config_read8(pci_dev, pos + VIRTIO_PCI_CAP_BAR);
+		offset = pci_config_read32(pci_dev,
+					   pos + VIRTIO_PCI_CAP_OFFSET);
+		length = pci_config_read32(pci_dev,
+					   pos + VIRTIO_PCI_CAP_LENGTH);
+
+		switch (type) {
+		case VIRTIO_PCI_CAP_COMMON_CFG:
+			if (!vpci_dev->common && length >=
+			    sizeof(struct virtio_pci_common_cfg))
+				vpci_dev->common = pci_bar_map(pci_dev, bar,
+							       offset, length);
+			break;
+		case VIRTIO_PCI_CAP_NOTIFY_CFG:
+			if (vpci_dev->notify_base)
+				break;
+			vpci_dev->notify_off_mult = pci_config_read32(pci_dev,
+					pos + VIRTIO_PCI_NOTIFY_CAP_MULT);
+			vpci_dev->notify_base = pci_bar_map(pci_dev, bar,
+							    offset, length);
+			break;
+		case VIRTIO_PCI_CAP_ISR_CFG:
+			if (!vpci_dev->isr)
+				vpci_dev->isr = pci_bar_map(pci_dev, bar,
+							    offset, length);
+			break;
+		case VIRTIO_PCI_CAP_DEVICE_CFG:
+			if (!vpci_dev->device_cfg)
+				vpci_dev->device_cfg = pci_bar_map(pci_dev,
+						bar, offset, length);
+			break;
+		default:
+			break;
+		}
+	}
+	if (!vpci_dev->common || !vpci_dev->notify_base || !vpci_dev->isr) {
+		vpci_dev->common = NULL;
+		vpci_dev->notify_base = NULL;
+		vpci_dev->isr = NULL;
+		vpci_dev->device_cfg = NULL;
+		return -ENODEV;
+	}
+
+	/* The device accesses the virtqueues with DMA */
+	cmd = pci_config_read16(pci_dev, PCI_COMMAND);
+	pci_config_write16(pci_dev, PCI_COMMAND, cmd | PCI_COMMAND_MASTER);
+
+	/* Setting the configuration operation */
+	vpci_dev->vdev.cops = &vpci_modern_ops;
+
+	uk_pr_info("Added virtio-pci device %04x (modern)\n",
+		   pci_dev->id.device_id);
+
+	/* Mapping the virtio device identifier */
+	if (pci_dev->id.device_id >= VIRTIO_PCI_MODERN_DEVICEID_START)
+		vpci_dev->vdev.id.virtio_device_id = pci_dev->id.device_id
+			- VIRTIO_PCI_MODERN_DEVICEID_START;
+	else
+		vpci_dev->vdev.id.virtio_device_id =
+			pci_dev->id.subsystem_device_id;
+	return 0;
+}
+
 static int virtio_pci_add_dev(struct pci_device *pci_dev)
 {
 	struct virtio_pci_dev *vpci_dev = NULL;
@@ -391,7 +885,7 @@ static int virtio_pci_add_dev(struct pci_device *pci_dev)
 
 	UK_ASSERT(pci_dev != NULL);
 
-	vpci_dev = uk_malloc(a, sizeof(*vpci_dev));
+	vpci_dev = uk_calloc(a, 1, sizeof(*vpci_dev));
 	if (!vpci_dev) {
 		uk_pr_err("Failed to allocate virtio-pci device\n");
 		return -ENOMEM;
@@ -402,11 +896,19 @@ static int virtio_pci_add_dev(struct pci_device *pci_dev)
 	vpci_dev->pci_base_addr = pci_dev->base;
 
 	/**
-	 * Probing for the legacy virtio device. We separate the legacy probing
-	 * with the possibility of supporting the modern PCI device in the
-	 * future.
+	 * Probing for the modern virtio device first. Transitional devices
+	 * offer both interfaces; the legacy one is used if the modern
+	 * configuration structures are missing.
 	 */
-	rc = virtio_pci_legacy_add_dev(pci_dev, vpci_dev);
+	if (pci_dev->id.device_id > VIRTIO_PCI_MODERN_DEVICEID_END) {
+		uk_pr_err("Invalid Virtio Devices %04x\n",
+			  pci_dev->id.device_id);
+		rc = -EINVAL;
+		goto free_pci_dev;
+	}
+	rc = virtio_pci_modern_add_dev(pci_dev, vpci_dev);
+	if (rc != 0)
+		rc = virtio_pci_legacy_add_dev(pci_dev, vpci_dev);
 	if (rc != 0) {
 		uk_pr_err("Failed to probe (legacy) pci device: %d\n", rc);
 		goto free_pci_dev;
@@ -45,6 +45,7 @@
 #include <uk/plat/io.h>
 #include <virtio/virtio_ring.h>
 #include <virtio/virtqueue.h>
+#include <virtio/virtio_bus.h>
 
 #define VIRTQUEUE_MAX_SIZE  32768
 #define to_virtqueue_vring(vq)			\
@@ -53,20 +54,43 @@
 struct virtqueue_desc_info {
 	void *cookie;
 	__u16 desc_count;
+	/* Next free buffer id of the packed ring */
+	__u16 next_id;
 };
 
 struct virtqueue_vring {
 	struct virtqueue vq;
 	/* Descriptor Ring */
 	struct vring vring;
+	/* Packed descriptor ring, used instead with VIRTIO_F_RING_PACKED */
+	struct vring_packed vring_packed;
 	/* Reference to the vring */
 	void   *vring_mem;
 	/* Keep track of available descriptors */
 	__u16 desc_avail;
-	/* Index of the next available slot */
+	/* Index of the next available slot (buffer id of the packed ring) */
 	__u16 head_free_desc;
 	/* Index of the last used descriptor by the host */
 	__u16 last_used_desc_idx;
+	/* Available index at the last host notification */
+	__u16 last_kick_avail_idx;
+	/* Notifications are suppressed with event indexes */
+	__u8 event_idx;
+	/* The ring uses the packed layout */
+	__u8 packed;
+	/* Packed ring: wrap counters of the next available and used slot */
+	__u8 avail_wrap;
+	__u8 used_wrap;
+	/* Packed ring: index of the next available slot */
+	__u16 next_avail_idx;
+	/* Packed ring: descriptors made available since the last kick */
+	__u16 kick_added;
+	/* Indirect descriptor tables, one for each buffer */
+	void *indirect;
+	/* Number of descriptors in each indirect table */
+	__u16 indirect_max;
+	/* Allocator of the indirect descriptor tables */
+	struct uk_alloc *indirect_a;
 	/* Cookie to identify driver buffer */
 	struct virtqueue_desc_info vq_info[];
 };
@@ -84,8 +108,66 @@ static inline int virtqueue_buffer_enqueue_segments(
 						    struct uk_sglist *sg,
 						    __u16 read_bufs,
 						    __u16 write_bufs);
+static inline int virtqueue_buffer_enqueue_indirect(
+						struct virtqueue_vring *vrq,
+						__u16 head,
+						struct uk_sglist *sg,
+						__u16 read_bufs,
+						__u16 write_bufs);
 static void virtqueue_vring_init(struct virtqueue_vring *vrq, __u16 nr_desc,
 				 __u16 align);
+static inline int virtqueue_packed_hasdata(struct virtqueue_vring *vrq);
+static void virtqueue_packed_buffer_enqueue(struct virtqueue_vring *vrq,
+					    void *cookie,
+					    struct uk_sglist *sg,
+					    __u16 read_bufs,
+					    __u16 write_bufs,
+					    int indirect);
+static void virtqueue_packed_buffer_dequeue(struct virtqueue_vring *vrq,
+					    void **cookie, __u32 *len);
+
+static inline __u16 virtqueue_vring_num(struct virtqueue_vring *vrq)
+{
+	return vrq->packed ? vrq->vring_packed.num : vrq->vring.num;
+}
+
+/**
+ * Check whether interrupts are requested for used descriptors.
+ */
+static inline int virtqueue_intr_armed(struct virtqueue_vring *vrq)
+{
+	if (vrq->packed)
+		return (vrq->vring_packed.driver->flags
+			!= VRING_PACKED_EVENT_FLAG_DISABLE);
+	return ((vrq->vring.avail->flags & VRING_AVAIL_F_NO_INTERRUPT) == 0);
+}
+
+/**
+ * Request an interrupt for the next used descriptor.
+ */
+static inline void virtqueue_intr_arm(struct virtqueue_vring *vrq)
+{
+	struct vring_packed_desc_event *event;
+
+	if (!vrq->packed) {
+		vrq->vring.avail->flags &= (~VRING_AVAIL_F_NO_INTERRUPT);
+		if (vrq->event_idx)
+			vring_used_event(&vrq->vring) =
+				vrq->last_used_desc_idx;
+		return;
+	}
+
+	event = vrq->vring_packed.driver;
+	if (vrq->event_idx) {
+		event->off_wrap = vrq->last_used_desc_idx |
+			(vrq->used_wrap << VRING_PACKED_EVENT_F_WRAP_CTR);
+		/* The offset has to be valid before the device uses it */
+		wmb();
+		event->flags = VRING_PACKED_EVENT_FLAG_DESC;
+	} else {
+		event->flags = VRING_PACKED_EVENT_FLAG_ENABLE;
+	}
+}
 
 /**
  * Driver implementation
@@ -97,7 +179,19 @@ void virtqueue_intr_disable(struct virtqueue *vq)
 	UK_ASSERT(vq);
 
 	vrq = to_virtqueue_vring(vq);
+	if (vrq->packed) {
+		vrq->vring_packed.driver->flags =
+			VRING_PACKED_EVENT_FLAG_DISABLE;
+		return;
+	}
 	vrq->vring.avail->flags |= (VRING_AVAIL_F_NO_INTERRUPT);
+	/**
+	 * With event indexes, the device ignores the flag. An event index
+	 * that was just passed defers the next interrupt until the used index
+	 * wraps around.
+	 */
+	if (vrq->event_idx)
+		vring_used_event(&vrq->vring) = vrq->last_used_desc_idx - 1;
 }
 
 int virtqueue_intr_enable(struct virtqueue *vq)
@@ -110,9 +204,8 @@ int virtqueue_intr_enable(struct virtqueue *vq)
 	vrq = to_virtqueue_vring(vq);
 	/* Check if there are no more packets enabled */
 	if (!virtqueue_hasdata(vq)) {
-		if (vrq->vring.avail->flags | VRING_AVAIL_F_NO_INTERRUPT) {
-			vrq->vring.avail->flags &=
-				(~VRING_AVAIL_F_NO_INTERRUPT);
+		if (!virtqueue_intr_armed(vrq)) {
+			virtqueue_intr_arm(vrq);
 			/**
 			 * We enabled the interrupts. We ensure it using the
 			 * memory barrier and check if there are any further
@@ -186,6 +279,59 @@ int virtqueue_notify_enabled(struct virtqueue *vq)
 	UK_ASSERT(vq);
 	vrq = to_virtqueue_vring(vq);
 
+	if (vrq->packed)
+		return (vrq->vring_packed.device->flags
+			!= VRING_PACKED_EVENT_FLAG_DISABLE);
+	return ((vrq->vring.used->flags & VRING_USED_F_NO_NOTIFY) == 0);
+}
+
+static int virtqueue_packed_kick_prepare(struct virtqueue_vring *vrq)
+{
+	struct vring_packed_desc_event *event = vrq->vring_packed.device;
+	__u16 new_idx, old_idx, off_wrap, event_idx, flags;
+
+	new_idx = vrq->next_avail_idx;
+	old_idx = new_idx - vrq->kick_added;
+	vrq->kick_added = 0;
+
+	flags = event->flags;
+	if (flags != VRING_PACKED_EVENT_FLAG_DESC)
+		return (flags != VRING_PACKED_EVENT_FLAG_DISABLE);
+
+	off_wrap = event->off_wrap;
+	event_idx = off_wrap & ~(1 << VRING_PACKED_EVENT_F_WRAP_CTR);
+	/**
+	 * An event offset of the previous lap around the ring lies before
+	 * the start of the current one.
+	 */
+	if ((off_wrap >> VRING_PACKED_EVENT_F_WRAP_CTR) != vrq->avail_wrap)
+		event_idx -= vrq->vring_packed.num;
+	return vring_need_event(event_idx, new_idx, old_idx);
+}
+
+int virtqueue_kick_prepare(struct virtqueue *vq)
+{
+	struct virtqueue_vring *vrq;
+	__u16 new_idx, old_idx;
+
+	UK_ASSERT(vq);
+	vrq = to_virtqueue_vring(vq);
+
+	/**
+	 * The available index has to be visible to the device before we read
+	 * its notification suppression state.
+	 */
+	mb();
+	if (vrq->packed)
+		return virtqueue_packed_kick_prepare(vrq);
+
+	new_idx = vrq->vring.avail->idx;
+	old_idx = vrq->last_kick_avail_idx;
+	vrq->last_kick_avail_idx = new_idx;
+
+	if (vrq->event_idx)
+		return vring_need_event(vring_avail_event(&vrq->vring),
+					new_idx, old_idx);
 	return ((vrq->vring.used->flags & VRING_USED_F_NO_NOTIFY) == 0);
 }
 
@@ -215,6 +361,42 @@ static inline int virtqueue_buffer_enqueue_segments(
 	return idx;
 }
 
+static inline int virtqueue_buffer_enqueue_indirect(
+		struct virtqueue_vring *vrq,
+		__u16 head, struct uk_sglist *sg, __u16 read_bufs,
+		__u16 write_bufs)
+{
+	int i = 0, total_desc = 0;
+	struct uk_sglist_seg *segs;
+	struct vring_desc *table;
+
+	total_desc = read_bufs + write_bufs;
+	table = (struct vring_desc *) vrq->indirect + head * vrq->indirect_max;
+
+	for (i = 0; i < total_desc; i++) {
+		segs = &sg->sg_segs[i];
+		table[i].addr = segs->ss_paddr;
+		table[i].len = segs->ss_len;
+		table[i].flags = 0;
+		if (i >= read_bufs)
+			table[i].flags |= VRING_DESC_F_WRITE;
+
+		if (i < total_desc - 1) {
+			table[i].flags |= VRING_DESC_F_NEXT;
+			table[i].next = i + 1;
+		}
+	}
+
+	/**
+	 * The ring descriptor refers to the table. Its next field keeps
+	 * linking the free descriptors.
+	 */
+	vrq->vring.desc[head].addr = ukplat_virt_to_phys(table);
+	vrq->vring.desc[head].len = total_desc * sizeof(*table);
+	vrq->vring.desc[head].flags = VRING_DESC_F_INDIRECT;
+	return vrq->vring.desc[head].next;
+}
+
 int virtqueue_hasdata(struct virtqueue *vq)
 {
 	struct virtqueue_vring *vring;
@@ -222,6 +404,8 @@ int virtqueue_hasdata(struct virtqueue *vq)
 	UK_ASSERT(vq);
 
 	vring = to_virtqueue_vring(vq);
+	if (vring->packed)
+		return virtqueue_packed_hasdata(vring);
 	return (vring->last_used_desc_idx != vring->vring.used->idx);
 }
 
@@ -230,9 +414,11 @@ __u64 virtqueue_feature_negotiate(__u64 feature_set)
 	__u64 feature = (1ULL << VIRTIO_TRANSPORT_F_START) - 1;
 
 	/**
-	 * Currently out vring driver does not support any ring feature. We will
-	 * add support to transport feature in the future.
+	 * Ring features that our vring driver supports.
 	 */
+	feature |= (1ULL << VIRTIO_F_INDIRECT_DESC);
+	feature |= (1ULL << VIRTIO_F_EVENT_IDX);
+	feature |= (1ULL << VIRTIO_F_RING_PACKED);
 	feature &= feature_set;
 	return feature;
 }
@@ -262,6 +448,30 @@ __phys_addr virtqueue_physaddr(struct virtqueue *vq)
 	return ukplat_virt_to_phys(vrq->vring_mem);
 }
 
+__phys_addr virtqueue_driver_area_physaddr(struct virtqueue *vq)
+{
+	struct virtqueue_vring *vrq = NULL;
+
+	UK_ASSERT(vq);
+
+	vrq = to_virtqueue_vring(vq);
+	if (vrq->packed)
+		return ukplat_virt_to_phys(vrq->vring_packed.driver);
+	return ukplat_virt_to_phys(vrq->vring.avail);
+}
+
+__phys_addr virtqueue_device_area_physaddr(struct virtqueue *vq)
+{
+	struct virtqueue_vring *vrq = NULL;
+
+	UK_ASSERT(vq);
+
+	vrq = to_virtqueue_vring(vq);
+	if (vrq->packed)
+		return ukplat_virt_to_phys(vrq->vring_packed.device);
+	return ukplat_virt_to_phys(vrq->vring.used);
+}
+
 int virtqueue_buffer_dequeue(struct virtqueue *vq, void **cookie, __u32 *len)
 {
 	struct virtqueue_vring *vrq = NULL;
@@ -275,6 +485,10 @@ int virtqueue_buffer_dequeue(struct virtqueue *vq, void **cookie, __u32 *len)
 	/* No new descriptor since last dequeue operation */
 	if (!virtqueue_hasdata(vq))
 		return -ENOMSG;
+	if (vrq->packed) {
+		virtqueue_packed_buffer_dequeue(vrq, cookie, len);
+		goto out;
+	}
 	used_idx = vrq->last_used_desc_idx++ & (vrq->vring.num - 1);
 	elem = &vrq->vring.used->ring[used_idx];
 	/**
@@ -288,7 +502,18 @@ int virtqueue_buffer_dequeue(struct virtqueue *vq, void **cookie, __u32 *len)
 	*cookie = vrq->vq_info[head_idx].cookie;
 	virtqueue_detach_desc(vrq, head_idx);
 	vrq->vq_info[head_idx].cookie = NULL;
-	return (vrq->vring.num - vrq->desc_avail);
+
+out:
+	/**
+	 * While interrupts are enabled, move the event index along so that
+	 * the device interrupts again for the next used descriptor.
+	 */
+	if (vrq->event_idx && virtqueue_intr_armed(vrq)) {
+		virtqueue_intr_arm(vrq);
+		/* Publish the event index before checking for new data */
+		mb();
+	}
+	return (virtqueue_vring_num(vrq) - vrq->desc_avail);
 }
 
 int virtqueue_buffer_enqueue(struct virtqueue *vq, void *cookie,
@@ -296,37 +521,55 @@ int virtqueue_buffer_enqueue(struct virtqueue *vq, void *cookie,
 			     __u16 write_bufs)
 {
 	__u32 total_desc = 0;
+	__u32 ring_desc = 0;
 	__u16 head_idx = 0, idx = 0;
 	struct virtqueue_vring *vrq = NULL;
+	int indirect;
 
 	UK_ASSERT(vq);
 
 	vrq = to_virtqueue_vring(vq);
 	total_desc = read_bufs + write_bufs;
-	if (unlikely(total_desc < 1 || total_desc > vrq->vring.num)) {
+	/**
+	 * Multiple segments occupy a single ring descriptor when they fit
+	 * into an indirect table.
+	 */
+	indirect = vrq->indirect && total_desc > 1
+		   && total_desc <= vrq->indirect_max;
+	ring_desc = indirect ? 1 : total_desc;
+	if (unlikely(total_desc < 1 || total_desc > virtqueue_vring_num(vrq))) {
 		uk_pr_err("%"__PRIu32" invalid number of descriptor\n",
 			  total_desc);
 		return -EINVAL;
-	} else if (vrq->desc_avail < total_desc) {
+	} else if (vrq->desc_avail < ring_desc) {
 		uk_pr_err("Available descriptor:%"__PRIu16", Requested descriptor:%"__PRIu32"\n",
-			  vrq->desc_avail, total_desc);
+			  vrq->desc_avail, ring_desc);
 		return -ENOSPC;
 	}
+	UK_ASSERT(cookie);
+	if (vrq->packed) {
+		virtqueue_packed_buffer_enqueue(vrq, cookie, sg, read_bufs,
+						write_bufs, indirect);
+		return vrq->desc_avail;
+	}
 	/* Get the head of free descriptor */
 	head_idx = vrq->head_free_desc;
-	UK_ASSERT(cookie);
 	/* Additional information to reconstruct the data buffer */
 	vrq->vq_info[head_idx].cookie = cookie;
-	vrq->vq_info[head_idx].desc_count = total_desc;
+	vrq->vq_info[head_idx].desc_count = ring_desc;
 
 	/**
 	 * We separate the descriptor management to enqueue segment(s).
 	 */
-	idx = virtqueue_buffer_enqueue_segments(vrq, head_idx, sg,
-			read_bufs, write_bufs);
+	if (indirect)
+		idx = virtqueue_buffer_enqueue_indirect(vrq, head_idx, sg,
+				read_bufs, write_bufs);
+	else
+		idx = virtqueue_buffer_enqueue_segments(vrq, head_idx, sg,
+				read_bufs, write_bufs);
 	/* Metadata maintenance for the virtqueue */
 	vrq->head_free_desc = idx;
-	vrq->desc_avail -= total_desc;
+	vrq->desc_avail -= ring_desc;
 
 	uk_pr_debug("Old head:%d, new head:%d, total_desc:%d\n",
 		    head_idx, idx, total_desc);
@@ -335,16 +578,186 @@ int virtqueue_buffer_enqueue(struct virtqueue *vq, void *cookie,
 	return vrq->desc_avail;
 }
 
+static inline int virtqueue_packed_hasdata(struct virtqueue_vring *vrq)
+{
+	__u16 flags;
+	__u8 avail, used;
+
+	/**
+	 * The device marks a descriptor as used by setting both flags to its
+	 * wrap counter.
+	 */
+	flags = vrq->vring_packed.desc[vrq->last_used_desc_idx].flags;
+	avail = !!(flags & (1 << VRING_PACKED_DESC_F_AVAIL));
+	used = !!(flags & (1 << VRING_PACKED_DESC_F_USED));
+	return (avail == used && used == vrq->used_wrap);
+}
+
+/**
+ * Flags of a descriptor that is available to the device in the lap of the
+ * given wrap counter.
+ */
+static inline __u16 virtqueue_packed_avail_flags(__u8 wrap)
+{
+	return wrap ? (1 << VRING_PACKED_DESC_F_AVAIL)
+		    : (1 << VRING_PACKED_DESC_F_USED);
+}
+
+static inline __u16 virtqueue_packed_next(struct virtqueue_vring *vrq,
+					  __u16 idx, __u8 *wrap)
+{
+	if (++idx == vrq->vring_packed.num) {
+		idx = 0;
+		*wrap ^= 1;
+	}
+	return idx;
+}
+
+static void virtqueue_packed_buffer_enqueue(struct virtqueue_vring *vrq,
+					    void *cookie,
+					    struct uk_sglist *sg,
+					    __u16 read_bufs,
+					    __u16 write_bufs,
+					    int indirect)
+{
+	struct vring_packed_desc *desc = vrq->vring_packed.desc;
+	struct vring_packed_desc *table;
+	struct uk_sglist_seg *segs;
+	__u16 total_desc, ring_desc;
+	__u16 id, idx, head, flags, head_flags = 0;
+	__u8 wrap;
+	int i;
+
+	total_desc = read_bufs + write_bufs;
+	ring_desc = indirect ? 1 : total_desc;
+
+	/* Get a free buffer id */
+	id = vrq->head_free_desc;
+	UK_ASSERT(id < vrq->vring_packed.num);
+	vrq->head_free_desc = vrq->vq_info[id].next_id;
+	/* Additional information to reconstruct the data buffer */
+	vrq->vq_info[id].cookie = cookie;
+	vrq->vq_info[id].desc_count = ring_desc;
+
+	head = idx = vrq->next_avail_idx;
+	wrap = vrq->avail_wrap;
+	if (indirect) {
+		table = (struct vring_packed_desc *) vrq->indirect
+			+ id * vrq->indirect_max;
+		for (i = 0; i < total_desc; i++) {
+			segs = &sg->sg_segs[i];
+			table[i].addr = segs->ss_paddr;
+			table[i].len = segs->ss_len;
+			table[i].id = 0;
+			table[i].flags = (i >= read_bufs) ?
+				VRING_DESC_F_WRITE : 0;
+		}
+		desc[idx].addr = ukplat_virt_to_phys(table);
+		desc[idx].len = total_desc * sizeof(*table);
+		desc[idx].id = id;
+		head_flags = VRING_DESC_F_INDIRECT
+			| virtqueue_packed_avail_flags(wrap);
+		idx = virtqueue_packed_next(vrq, idx, &wrap);
+	} else {
+		for (i = 0; i < total_desc; i++) {
+			segs = &sg->sg_segs[i];
+			desc[idx].addr = segs->ss_paddr;
+			desc[idx].len = segs->ss_len;
+			desc[idx].id = id;
+			flags = virtqueue_packed_avail_flags(wrap);
+			if (i >= read_bufs)
+				flags |= VRING_DESC_F_WRITE;
+			if (i < total_desc - 1)
+				flags |= VRING_DESC_F_NEXT;
+
+			if (i == 0)
+				head_flags = flags;
+			else
+				desc[idx].flags = flags;
+			idx = virtqueue_packed_next(vrq, idx, &wrap);
+		}
+	}
+
+	/* Metadata maintenance for the virtqueue */
+	vrq->next_avail_idx = idx;
+	vrq->avail_wrap = wrap;
+	vrq->desc_avail -= ring_desc;
+	vrq->kick_added += ring_desc;
+
+	/**
+	 * The device may process the chain as soon as its head is available.
+	 * Write barrier to make sure the remaining descriptors are visible
+	 * first.
+	 */
+	wmb();
+	desc[head].flags = head_flags;
+}
+
+static void virtqueue_packed_buffer_dequeue(struct virtqueue_vring *vrq,
+					    void **cookie, __u32 *len)
+{
+	struct vring_packed_desc *desc;
+	struct virtqueue_desc_info *vq_info;
+	__u16 id;
+
+	desc = &vrq->vring_packed.desc[vrq->last_used_desc_idx];
+	/**
+	 * We are reading from the used descriptor information updated by the
+	 * host.
+	 */
+	rmb();
+	id = desc->id;
+	UK_ASSERT(id < vrq->vring_packed.num);
+	if (len)
+		*len = desc->len;
+	vq_info = &vrq->vq_info[id];
+	*cookie = vq_info->cookie;
+	vq_info->cookie = NULL;
+
+	/**
+	 * The device writes a single used descriptor for a buffer and skips
+	 * the remaining descriptors of its chain.
+	 */
+	vrq->desc_avail += vq_info->desc_count;
+	vrq->last_used_desc_idx += vq_info->desc_count;
+	if (vrq->last_used_desc_idx >= vrq->vring_packed.num) {
+		vrq->last_used_desc_idx -= vrq->vring_packed.num;
+		vrq->used_wrap ^= 1;
+	}
+
+	/* Appending the buffer id to the head of list */
+	vq_info->desc_count = 0;
+	vq_info->next_id = vrq->head_free_desc;
+	vrq->head_free_desc = id;
+}
+
 static void virtqueue_vring_init(struct virtqueue_vring *vrq, __u16 nr_desc,
 				 __u16 align)
 {
 	int i = 0;
 
+	if (vrq->packed) {
+		vring_packed_init(&vrq->vring_packed, nr_desc,
+				  vrq->vring_mem);
+		vrq->desc_avail = nr_desc;
+		vrq->head_free_desc = 0;
+		vrq->last_used_desc_idx = 0;
+		vrq->next_avail_idx = 0;
+		vrq->kick_added = 0;
+		/* Both wrap counters start at 1 */
+		vrq->avail_wrap = 1;
+		vrq->used_wrap = 1;
+		for (i = 0; i < nr_desc; i++)
+			vrq->vq_info[i].next_id = i + 1;
+		return;
+	}
+
 	vring_init(&vrq->vring, nr_desc, vrq->vring_mem, align);
 
 	vrq->desc_avail = vrq->vring.num;
 	vrq->head_free_desc = 0;
 	vrq->last_used_desc_idx = 0;
+	vrq->last_kick_avail_idx = 0;
 	for (i = 0; i < nr_desc - 1; i++)
 		vrq->vring.desc[i].next = i + 1;
 	/**
@@ -379,8 +792,20 @@ struct virtqueue *virtqueue_create(__u16 queue_id, __u16 nr_descs, __u16 align,
 	 * allocation.
 	 */
 	vrq->vring_mem = NULL;
-
-	ring_size = vring_size(nr_descs, align);
+	vrq->indirect = NULL;
+	vrq->indirect_max = 0;
+	vrq->indirect_a = NULL;
+
+	/* The features are negotiated before the virtqueues are set up */
+	vrq->event_idx = vdev && virtio_has_features(vdev->features,
+						    VIRTIO_F_EVENT_IDX);
+	vrq->packed = vdev && virtio_has_features(vdev->features,
+						  VIRTIO_F_RING_PACKED);
+
+	if (vrq->packed)
+		ring_size = vring_packed_size(nr_descs);
+	else
+		ring_size = vring_size(nr_descs, align);
 	if (uk_posix_memalign(a, &vrq->vring_mem,
 			      __PAGE_SIZE, ring_size) != 0) {
 		uk_pr_err("Allocation of vring failed\n");
@@ -411,6 +836,10 @@ void virtqueue_destroy(struct virtqueue *vq, struct uk_alloc *a)
 
 	vrq = to_virtqueue_vring(vq);
 
+	/* Free the indirect descriptor tables */
+	if (vrq->indirect)
+		uk_free(vrq->indirect_a, vrq->indirect);
+
 	/* Free the ring */
 	uk_free(a, vrq->vring_mem);
 
@@ -418,6 +847,43 @@ void virtqueue_destroy(struct virtqueue *vq, struct uk_alloc *a)
 	uk_free(a, vrq);
 }
 
+int virtqueue_indirect_setup(struct virtqueue *vq, __u16 max_segs,
+			     struct uk_alloc *a)
+{
+	struct virtqueue_vring *vrq;
+	void *tables = NULL;
+	size_t size;
+
+	UK_ASSERT(vq);
+	UK_ASSERT(a);
+
+	vrq = to_virtqueue_vring(vq);
+	UK_ASSERT(!vrq->indirect);
+	if (!vq->vdev || !virtio_has_features(vq->vdev->features,
+					      VIRTIO_F_INDIRECT_DESC))
+		return -ENOTSUP;
+
+	/* A chain must not be longer than the queue */
+	max_segs = MIN(max_segs, virtqueue_vring_num(vrq));
+	if (unlikely(max_segs < 2))
+		return -EINVAL;
+
+	size = (size_t) virtqueue_vring_num(vrq) * max_segs;
+	if (vrq->packed)
+		size *= sizeof(struct vring_packed_desc);
+	else
+		size *= sizeof(struct vring_desc);
+	if (uk_posix_memalign(a, &tables, __PAGE_SIZE, size) != 0) {
+		uk_pr_err("Allocation of indirect descriptor tables failed\n");
+		return -ENOMEM;
+	}
+
+	vrq->indirect = tables;
+	vrq->indirect_max = max_segs;
+	vrq->indirect_a = a;
+	return 0;
+}
+
 int virtqueue_is_full(struct virtqueue *vq)
 {
 	struct virtqueue_vring *vrq;
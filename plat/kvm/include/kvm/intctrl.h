@@ -32,7 +32,22 @@
  * THIS HEADER MAY NOT BE EXTRACTED OR MODIFIED IN ANY WAY.
  */
 
+#include <uk/arch/types.h>
+
 void intctrl_init(void);
 void intctrl_clear_irq(unsigned int irq);
 void intctrl_mask_irq(unsigned int irq);
 void intctrl_ack_irq(unsigned int irq);
+
+/*
+ * Allocates an IRQ for a message signaled interrupt. The device raises it by
+ * writing `data` to `addr`. Returns 0 on success, < 0 if no IRQ is left or
+ * the interrupt controller cannot receive messages.
+ */
+int intctrl_msi_alloc(unsigned long *irq, __u64 *addr, __u32 *data);
+
+/*
+ * Releases an IRQ returned by intctrl_msi_alloc(). No handler may be
+ * registered for it.
+ */
+void intctrl_msi_free(unsigned long irq);
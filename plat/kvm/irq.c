@@ -118,3 +118,21 @@ int ukplat_irq_init(struct uk_alloc *a)
 	allocator = a;
 	return 0;
 }
+
+int ukplat_irq_msi_alloc(unsigned long *irq, __u64 *addr, __u32 *data)
+{
+#if CONFIG_ARCH_X86_64
+	return intctrl_msi_alloc(irq, addr, data);
+#else
+	return -ENOTSUP;
+#endif
+}
+
+void ukplat_irq_msi_free(unsigned long irq)
+{
+#if CONFIG_ARCH_X86_64
+	intctrl_msi_free(irq);
+#else
+	UK_CRASH("No message signaled interrupt was allocated: %lu\n", irq);
+#endif
+}
@@ -23,8 +23,14 @@
 /* Taken from solo5 platform_intr.c */
 
 #include <stdint.h>
+#include <errno.h>
 #include <x86/cpu.h>
+#include <x86/irq.h>
+#include <uk/plat/paging.h>
+#include <uk/print.h>
+#include <uk/assert.h>
 #include <kvm/intctrl.h>
+#include <kvm-x86/traps.h>
 
 #define PIC1             0x20    /* IO base address for master PIC */
 #define PIC2             0xA0    /* IO base address for slave PIC */
@@ -48,6 +54,28 @@
 #define ICW4_BUF_MASTER  0x0C /* Buffered mode/master */
 #define ICW4_SFN         0x10 /* Special fully nested (not) */
 
+/* Local APIC registers (offsets in 32-bit words) */
+#define LAPIC_ID         (0x020 >> 2)
+#define LAPIC_EOI        (0x0B0 >> 2)
+#define LAPIC_SVR        (0x0F0 >> 2)
+#define LAPIC_LVT_LINT0  (0x350 >> 2)
+#define LAPIC_SVR_ENABLE 0x100 /* APIC software enable */
+#define LAPIC_LVT_EXTINT 0x700 /* Delivery mode ExtINT */
+
+/* Message address and data of interrupts for the local APIC */
+#define MSI_ADDR_BASE    0xFEE00000UL
+#define MSI_ADDR_DEST(d) ((__u64) (d) << 12)
+#define MSI_DATA_VECTOR(v) ((__u32) (v))
+
+/* Message signaled interrupts use the vectors after the PIC ones */
+#define MSI_VECTOR(irq)  (32 + (irq))
+
+static volatile __u32 *lapic;
+/* Bit i is set while IRQ __MSI_IRQ_BASE + i is allocated */
+static __u32 msi_used;
+
+UK_CTASSERT(__MSI_IRQ_COUNT <= sizeof(msi_used) * 8);
+
 /*
  * arguments:
  * offset1 - vector offset for master PIC vectors on the master become
@@ -88,6 +116,11 @@ void intctrl_init(void)
 
 void intctrl_ack_irq(unsigned int irq)
 {
+	if (irq >= __MSI_IRQ_BASE) {
+		lapic[LAPIC_EOI] = 0;
+		return;
+	}
+
 	if (!IRQ_ON_MASTER(irq))
 		outb(PIC2_COMMAND, PIC_EOI);
 
@@ -98,6 +131,10 @@ void intctrl_mask_irq(unsigned int irq)
 {
 	__u16 port;
 
+	/* Message signaled interrupts are masked at the device */
+	if (irq >= __MSI_IRQ_BASE)
+		return;
+
 	port = IRQ_PORT(irq);
 	outb(port, inb(port) | (1 << IRQ_OFFSET(irq)));
 }
@@ -106,6 +143,77 @@ void intctrl_clear_irq(unsigned int irq)
 {
 	__u16 port;
 
+	if (irq >= __MSI_IRQ_BASE)
+		return;
+
 	port = IRQ_PORT(irq);
 	outb(port, inb(port) & ~(1 << IRQ_OFFSET(irq)));
 }
+
+/*
+ * The local APIC is only needed for message signaled interrupts. It is
+ * enabled when the first one is allocated. The PIC keeps delivering the
+ * legacy IRQs through LINT0 (virtual wire mode).
+ */
+static int lapic_init(void)
+{
+	__u64 base;
+
+	base = rdmsrl(X86_MSR_APIC_BASE);
+	if (!(base & X86_APIC_BASE_EN) || (base & X86_APIC_BASE_EXTD)) {
+		uk_pr_warn("Local APIC not available in xAPIC mode\n");
+		return -ENOTSUP;
+	}
+
+	lapic = ukplat_io_map(base & X86_APIC_BASE_ADDR_MASK, __PAGE_SIZE);
+	if (!lapic)
+		return -ENOMEM;
+
+	lapic[LAPIC_LVT_LINT0] = LAPIC_LVT_EXTINT;
+	lapic[LAPIC_SVR] = LAPIC_SVR_ENABLE | IDT_SPURIOUS_VECTOR;
+	return 0;
+}
+
+int intctrl_msi_alloc(unsigned long *irq, __u64 *addr, __u32 *data)
+{
+	unsigned long flags;
+	unsigned int i;
+	int rc;
+
+	UK_ASSERT(irq && addr && data);
+
+	if (!lapic) {
+		rc = lapic_init();
+		if (rc < 0)
+			return rc;
+	}
+
+	local_irq_save(flags);
+	for (i = 0; i < __MSI_IRQ_COUNT; i++)
+		if (!(msi_used & (1U << i)))
+			break;
+	if (i == __MSI_IRQ_COUNT) {
+		local_irq_restore(flags);
+		return -ENOSPC;
+	}
+	msi_used |= 1U << i;
+	local_irq_restore(flags);
+	*irq = __MSI_IRQ_BASE + i;
+
+	/* All interrupts are delivered to the boot CPU */
+	*addr = MSI_ADDR_BASE | MSI_ADDR_DEST(lapic[LAPIC_ID] >> 24);
+	*data = MSI_DATA_VECTOR(MSI_VECTOR(*irq));
+	return 0;
+}
+
+void intctrl_msi_free(unsigned long irq)
+{
+	unsigned long flags;
+
+	UK_ASSERT(irq >= __MSI_IRQ_BASE && irq < __MAX_IRQ);
+
+	local_irq_save(flags);
+	UK_ASSERT(msi_used & (1U << (irq - __MSI_IRQ_BASE)));
+	msi_used &= ~(1U << (irq - __MSI_IRQ_BASE));
+	local_irq_restore(flags);
+}
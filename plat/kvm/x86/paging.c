@@ -0,0 +1,282 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Dynamic page mappings for x86_64 KVM guests
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <uk/plat/paging.h>
+#include <uk/plat/memory.h>
+#include <uk/alloc.h>
+#include <uk/assert.h>
+#include <uk/print.h>
+#include <uk/essentials.h>
+#include <uk/page.h>
+#include <x86/cpu.h>
+
+/*
+ * The boot page tables (pagetable.S) identity-map the first GiB of the
+ * physical address space with the first entry of the PML4. The remaining
+ * entries are unused. We reserve a window of entries above it for dynamic
+ * mappings with 4 KiB pages. Page tables of the window are allocated from
+ * the platform memory allocator; they are within the identity-mapped range,
+ * so their physical and virtual addresses are the same.
+ */
+#define PT_LEVELS		4
+#define PT_ENTRIES		512
+#define PT_SHIFT(lvl)		(__PAGE_SHIFT + 9 * (lvl))
+#define PT_SIZE(lvl)		(1UL << PT_SHIFT(lvl))
+#define PT_INDEX(va, lvl)	(((va) >> PT_SHIFT(lvl)) & (PT_ENTRIES - 1))
+
+#define PTE_PRESENT		(1UL << 0)
+#define PTE_RW			(1UL << 1)
+#define PTE_PWT			(1UL << 3)
+#define PTE_PCD			(1UL << 4)
+#define PTE_PS			(1UL << 7)
+#define PTE_SW_MAPPED		(1UL << 9)  /* Ignored by hardware: frame set */
+#define PTE_NX			(1UL << 63)
+#define PTE_ADDR_MASK		0x000ffffffffff000UL
+
+#define WINDOW_PML4_FIRST	1
+#define WINDOW_PML4_COUNT	128
+#define WINDOW_BASE		((__uptr) WINDOW_PML4_FIRST << PT_SHIFT(3))
+#define WINDOW_LEN		((__sz) WINDOW_PML4_COUNT << PT_SHIFT(3))
+
+/*
+ * Device memory is mapped into the PML4 entry after the window. Mappings are
+ * only added during device initialization and never removed.
+ */
+#define IO_WINDOW_BASE		(WINDOW_BASE + WINDOW_LEN)
+#define IO_WINDOW_LEN		((__sz) 1 << PT_SHIFT(3))
+
+static __uptr io_next = IO_WINDOW_BASE;
+
+static inline unsigned long read_cr3(void)
+{
+	unsigned long cr3;
+
+	__asm__ __volatile__("mov %%cr3, %0" : "=r"(cr3));
+	return cr3;
+}
+
+static inline int in_window(__uptr vaddr, __sz len)
+{
+	return vaddr >= WINDOW_BASE
+		&& len <= WINDOW_LEN
+		&& vaddr - WINDOW_BASE <= WINDOW_LEN - len;
+}
+
+static inline __u64 prot2pte(unsigned long prot)
+{
+	__u64 pte = 0;
+
+	if (prot == UKPLAT_PAGE_PROT_NONE)
+		return 0;
+
+	pte |= PTE_PRESENT;
+	if (prot & UKPLAT_PAGE_PROT_WRITE)
+		pte |= PTE_RW;
+	if (!(prot & UKPLAT_PAGE_PROT_EXEC))
+		pte |= PTE_NX;
+	return pte;
+}
+
+/*
+ * Returns the page table entry of `vaddr`. Missing page tables are
+ * allocated if `alloc` is set. Otherwise, NULL is returned and `*skip` is
+ * set to the next address that may be covered by a page table.
+ */
+static __u64 *pte_get(__uptr vaddr, int alloc, __uptr *skip)
+{
+	struct uk_alloc *a;
+	__u64 *pt, *e;
+	void *tbl;
+	int lvl;
+
+	pt = (__u64 *) (read_cr3() & PTE_ADDR_MASK);
+	for (lvl = PT_LEVELS - 1; lvl > 0; --lvl) {
+		e = &pt[PT_INDEX(vaddr, lvl)];
+		if (!(*e & PTE_PRESENT)) {
+			if (!alloc) {
+				if (skip)
+					*skip = ALIGN_DOWN(vaddr, PT_SIZE(lvl))
+						+ PT_SIZE(lvl);
+				return NULL;
+			}
+
+			a = ukplat_memallocator_get();
+			tbl = a ? uk_palloc(a, 1) : NULL;
+			if (unlikely(!tbl))
+				return NULL;
+			memset(tbl, 0, __PAGE_SIZE);
+			*e = (__u64) tbl | PTE_PRESENT | PTE_RW;
+		}
+		UK_ASSERT(!(*e & PTE_PS));
+		pt = (__u64 *) (*e & PTE_ADDR_MASK);
+	}
+	return &pt[PT_INDEX(vaddr, 0)];
+}
+
+void ukplat_paging_window(__uptr *base, __sz *len)
+{
+	UK_ASSERT(base && len);
+
+	*base = WINDOW_BASE;
+	*len  = WINDOW_LEN;
+}
+
+int ukplat_page_map(__uptr vaddr, __uptr paddr, unsigned long prot)
+{
+	__u64 *pte;
+
+	UK_ASSERT(round_pgdown(vaddr) == vaddr && round_pgdown(paddr) == paddr);
+
+	if (unlikely(!in_window(vaddr, __PAGE_SIZE)))
+		return -EINVAL;
+
+	pte = pte_get(vaddr, 1, NULL);
+	if (unlikely(!pte))
+		return -ENOMEM;
+	if (unlikely(*pte & PTE_SW_MAPPED))
+		return -EEXIST;
+
+	*pte = (paddr & PTE_ADDR_MASK) | PTE_SW_MAPPED | prot2pte(prot);
+	invlpg(vaddr);
+	return 0;
+}
+
+long ukplat_page_unmap(__uptr vaddr, __sz len,
+		       ukplat_page_unmap_cb_t cb, void *cookie)
+{
+	__uptr end = vaddr + len;
+	__uptr skip;
+	__u64 *pte;
+	__u64 old;
+	long count = 0;
+
+	UK_ASSERT(round_pgdown(vaddr) == vaddr && round_pgdown(len) == len);
+
+	if (unlikely(!in_window(vaddr, len)))
+		return -EINVAL;
+
+	while (vaddr < end) {
+		pte = pte_get(vaddr, 0, &skip);
+		if (!pte) {
+			vaddr = skip;
+			continue;
+		}
+
+		old = *pte;
+		if (old & PTE_SW_MAPPED) {
+			*pte = 0;
+			invlpg(vaddr);
+			if (cb)
+				cb(vaddr, (__uptr) (old & PTE_ADDR_MASK),
+				   cookie);
+			count++;
+		}
+		vaddr += __PAGE_SIZE;
+	}
+	return count;
+}
+
+int ukplat_page_set_prot(__uptr vaddr, __sz len, unsigned long prot)
+{
+	__uptr end = vaddr + len;
+	__uptr skip;
+	__u64 *pte;
+
+	UK_ASSERT(round_pgdown(vaddr) == vaddr && round_pgdown(len) == len);
+
+	if (unlikely(!in_window(vaddr, len)))
+		return -EINVAL;
+
+	while (vaddr < end) {
+		pte = pte_get(vaddr, 0, &skip);
+		if (!pte) {
+			vaddr = skip;
+			continue;
+		}
+
+		if (*pte & PTE_SW_MAPPED) {
+			*pte = (*pte & PTE_ADDR_MASK) | PTE_SW_MAPPED
+				| prot2pte(prot);
+			invlpg(vaddr);
+		}
+		vaddr += __PAGE_SIZE;
+	}
+	return 0;
+}
+
+int ukplat_page_lookup(__uptr vaddr, __uptr *paddr)
+{
+	__u64 *pte;
+
+	UK_ASSERT(paddr);
+
+	if (unlikely(!in_window(vaddr, __PAGE_SIZE)))
+		return -ENOENT;
+
+	pte = pte_get(vaddr, 0, NULL);
+	if (!pte || !(*pte & PTE_SW_MAPPED))
+		return -ENOENT;
+
+	*paddr = (__uptr) (*pte & PTE_ADDR_MASK) | (vaddr & (__PAGE_SIZE - 1));
+	return 0;
+}
+
+void *ukplat_io_map(__uptr paddr, __sz len)
+{
+	__uptr off, vaddr;
+	__sz i, pages;
+	__u64 *pte;
+
+	off = paddr & (__PAGE_SIZE - 1);
+	paddr -= off;
+	pages = round_pgup(off + len) >> __PAGE_SHIFT;
+	if (unlikely(!len || pages > (IO_WINDOW_BASE + IO_WINDOW_LEN
+				      - io_next) >> __PAGE_SHIFT))
+		return NULL;
+
+	for (i = 0; i < pages; i++) {
+		vaddr = io_next + (i << __PAGE_SHIFT);
+		pte = pte_get(vaddr, 1, NULL);
+		if (unlikely(!pte))
+			return NULL;
+
+		*pte = ((paddr + (i << __PAGE_SHIFT)) & PTE_ADDR_MASK)
+			| PTE_PRESENT | PTE_RW | PTE_PWT | PTE_PCD | PTE_NX;
+		invlpg(vaddr);
+	}
+
+	vaddr = io_next;
+	io_next += pages << __PAGE_SHIFT;
+	return (void *) (vaddr + off);
+}
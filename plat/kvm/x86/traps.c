@@ -154,6 +154,7 @@ static void idt_init(void)
 	/*
 	 * Load irq vectors. All irqs run on IST1 (cpu_intr_stack).
 	 */
+	extern void cpu_irq_spurious(void);
 #define FILL_IRQ_GATE(num, ist) extern void cpu_irq_##num(void); \
 	idt_fillgate(32 + num, cpu_irq_##num, ist)
 	FILL_IRQ_GATE(0, 1);
@@ -172,6 +173,40 @@ static void idt_init(void)
 	FILL_IRQ_GATE(13, 1);
 	FILL_IRQ_GATE(14, 1);
 	FILL_IRQ_GATE(15, 1);
+	/* Message signaled interrupts */
+	FILL_IRQ_GATE(16, 1);
+	FILL_IRQ_GATE(17, 1);
+	FILL_IRQ_GATE(18, 1);
+	FILL_IRQ_GATE(19, 1);
+	FILL_IRQ_GATE(20, 1);
+	FILL_IRQ_GATE(21, 1);
+	FILL_IRQ_GATE(22, 1);
+	FILL_IRQ_GATE(23, 1);
+	FILL_IRQ_GATE(24, 1);
+	FILL_IRQ_GATE(25, 1);
+	FILL_IRQ_GATE(26, 1);
+	FILL_IRQ_GATE(27, 1);
+	FILL_IRQ_GATE(28, 1);
+	FILL_IRQ_GATE(29, 1);
+	FILL_IRQ_GATE(30, 1);
+	FILL_IRQ_GATE(31, 1);
+	FILL_IRQ_GATE(32, 1);
+	FILL_IRQ_GATE(33, 1);
+	FILL_IRQ_GATE(34, 1);
+	FILL_IRQ_GATE(35, 1);
+	FILL_IRQ_GATE(36, 1);
+	FILL_IRQ_GATE(37, 1);
+	FILL_IRQ_GATE(38, 1);
+	FILL_IRQ_GATE(39, 1);
+	FILL_IRQ_GATE(40, 1);
+	FILL_IRQ_GATE(41, 1);
+	FILL_IRQ_GATE(42, 1);
+	FILL_IRQ_GATE(43, 1);
+	FILL_IRQ_GATE(44, 1);
+	FILL_IRQ_GATE(45, 1);
+	FILL_IRQ_GATE(46, 1);
+	FILL_IRQ_GATE(47, 1);
+	idt_fillgate(IDT_SPURIOUS_VECTOR, cpu_irq_spurious, 1);
 
 	idtptr.limit = sizeof(cpu_idt) - 1;
 	idtptr.base = (__u64) &cpu_idt;
@@ -0,0 +1,188 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Linux kernel network interfaces for the linuxu platform
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ * THIS HEADER MAY NOT BE EXTRACTED OR MODIFIED IN ANY WAY.
+ */
+
+/* Like signal.h, this file provides ABI-compatible definitions for
+ * interfacing with the Linux kernel instead of libc-provided ones.
+ */
+
+#ifndef __LINUXU_NET_H__
+#define __LINUXU_NET_H__
+
+#include <uk/arch/types.h>
+#include <linuxu/syscall.h>
+#include <linuxu/ioctl.h>
+
+/* Linux error numbers returned by the system calls */
+#define K_EINTR       4
+#define K_EAGAIN     11
+
+/* ioctl requests */
+#define K_SIOCGIFFLAGS  0x8913
+#define K_SIOCSIFFLAGS  0x8914
+#define K_SIOCGIFMTU    0x8921
+#define K_SIOCGIFINDEX  0x8933
+#define K_TUNSETIFF     0x400454ca
+
+/* Interface flags */
+#define K_IFF_UP        0x0001
+#define K_IFF_TAP       0x0002
+#define K_IFF_NO_PI     0x1000
+
+#define K_IFNAMSIZ      16
+
+struct k_ifreq {
+	char ifr_name[K_IFNAMSIZ];
+	union {
+		short ifr_flags;
+		int ifr_ifindex;
+		int ifr_mtu;
+		/* size of struct ifmap */
+		unsigned long ifr_pad[3];
+		char ifr_sockaddr[16];
+	};
+};
+
+/* Sockets */
+#define K_AF_INET       2
+#define K_AF_PACKET    17
+#define K_SOCK_DGRAM    2
+#define K_SOCK_RAW      3
+#define K_ETH_P_ALL     0x0003
+
+#define K_SOL_SOCKET                1
+#define K_SO_RCVBUF                 8
+#define K_SO_RCVBUFFORCE           33
+
+#define K_SOL_PACKET              263
+#define K_PACKET_ADD_MEMBERSHIP     1
+#define K_PACKET_MR_PROMISC         1
+#define K_PACKET_IGNORE_OUTGOING   23
+
+#define K_MSG_TRUNC     0x20
+#define K_MSG_DONTWAIT  0x40
+
+struct k_sockaddr_ll {
+	__u16 sll_family;
+	__u16 sll_protocol;   /* network byte order */
+	int   sll_ifindex;
+	__u16 sll_hatype;
+	__u8  sll_pkttype;
+	__u8  sll_halen;
+	__u8  sll_addr[8];
+};
+
+struct k_packet_mreq {
+	int   mr_ifindex;
+	__u16 mr_type;
+	__u16 mr_alen;
+	__u8  mr_address[8];
+};
+
+struct k_iovec {
+	void *iov_base;
+	unsigned long iov_len;
+};
+
+struct k_msghdr {
+	void *msg_name;
+	int msg_namelen;
+	struct k_iovec *msg_iov;
+	unsigned long msg_iovlen;
+	void *msg_control;
+	unsigned long msg_controllen;
+	unsigned int msg_flags;
+};
+
+struct k_mmsghdr {
+	struct k_msghdr msg_hdr;
+	unsigned int msg_len;
+};
+
+static inline int sys_socket(int domain, int type, int protocol)
+{
+	return (int) syscall3(__SC_SOCKET,
+			      (long) domain,
+			      (long) type,
+			      (long) protocol);
+}
+
+static inline int sys_bind(int fd, const void *addr, int addrlen)
+{
+	return (int) syscall3(__SC_BIND,
+			      (long) fd,
+			      (long) addr,
+			      (long) addrlen);
+}
+
+static inline int sys_setsockopt(int fd, int level, int optname,
+		const void *optval, int optlen)
+{
+	return (int) syscall5(__SC_SETSOCKOPT,
+			      (long) fd,
+			      (long) level,
+			      (long) optname,
+			      (long) optval,
+			      (long) optlen);
+}
+
+static inline ssize_t sys_writev(int fd, const struct k_iovec *iov, int iovcnt)
+{
+	return (ssize_t) syscall3(__SC_WRITEV,
+				  (long) fd,
+				  (long) iov,
+				  (long) iovcnt);
+}
+
+static inline int sys_recvmmsg(int fd, struct k_mmsghdr *msgvec,
+		unsigned int vlen, unsigned int flags, void *timeout)
+{
+	return (int) syscall5(__SC_RECVMMSG,
+			      (long) fd,
+			      (long) msgvec,
+			      (long) vlen,
+			      (long) flags,
+			      (long) timeout);
+}
+
+static inline int sys_sendmmsg(int fd, struct k_mmsghdr *msgvec,
+		unsigned int vlen, unsigned int flags)
+{
+	return (int) syscall4(__SC_SENDMMSG,
+			      (long) fd,
+			      (long) msgvec,
+			      (long) vlen,
+			      (long) flags);
+}
+
+#endif /* __LINUXU_NET_H__ */
@@ -44,6 +44,7 @@
 
 /* Signal numbers */
 #define SIGALRM       14
+#define SIGIO         29
 
 /* type definitions */
 typedef unsigned long k_sigset_t;
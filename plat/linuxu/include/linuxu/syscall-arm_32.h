@@ -45,7 +45,13 @@
 #define __SC_MMAP     192 /* use mmap2() since mmap() is obsolete */
 #define __SC_MUNMAP    91
 #define __SC_EXIT       1
+#define __SC_GETPID    20
 #define __SC_IOCTL     54
+#define __SC_FCNTL     55
+#define __SC_WRITEV   146
+#define __SC_SOCKET   281
+#define __SC_BIND     282
+#define __SC_SETSOCKOPT 294
 #define __SC_RT_SIGPROCMASK   126
 #define __SC_ARCH_PRCTL       172
 #define __SC_RT_SIGACTION     174
@@ -56,6 +62,8 @@
 #define __SC_TIMER_DELETE     261
 #define __SC_CLOCK_GETTIME    263
 #define __SC_PSELECT6 335
+#define __SC_RECVMMSG 365
+#define __SC_SENDMMSG 374
 
 /* NOTE: from `man syscall`:
  *
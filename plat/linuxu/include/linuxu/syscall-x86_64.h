@@ -47,7 +47,13 @@
 #define __SC_RT_SIGACTION   13
 #define __SC_RT_SIGPROCMASK 14
 #define __SC_IOCTL  16
+#define __SC_WRITEV 20
+#define __SC_GETPID 39
+#define __SC_SOCKET 41
+#define __SC_BIND   49
+#define __SC_SETSOCKOPT 54
 #define __SC_EXIT   60
+#define __SC_FCNTL  72
 #define __SC_ARCH_PRCTL       158
 #define __SC_TIMER_CREATE     222
 #define __SC_TIMER_SETTIME    223
@@ -56,6 +62,8 @@
 #define __SC_TIMER_DELETE     226
 #define __SC_CLOCK_GETTIME    228
 #define __SC_PSELECT6 270
+#define __SC_RECVMMSG 299
+#define __SC_SENDMMSG 307
 
 /* NOTE: from linux-4.6.3 (arch/x86/entry/entry_64.S):
  *
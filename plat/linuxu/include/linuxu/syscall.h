@@ -64,6 +64,43 @@ static inline ssize_t sys_write(int fd, const char *buf, size_t len)
 				  (long) (len));
 }
 
+/*
+ * Please note that on failure the following functions are returning -errno
+ * with Linux error numbers
+ */
+#define K_O_RDWR      (0x0002)
+#define K_O_NONBLOCK  (0x0800)
+#define K_O_ASYNC     (0x2000)
+static inline int sys_open(const char *pathname, int flags, int mode)
+{
+	return (int) syscall3(__SC_OPEN,
+			      (long) (pathname),
+			      (long) (flags),
+			      (long) (mode));
+}
+
+static inline int sys_close(int fd)
+{
+	return (int) syscall1(__SC_CLOSE,
+			      (long) (fd));
+}
+
+#define K_F_GETFL     (3)
+#define K_F_SETFL     (4)
+#define K_F_SETOWN    (8)
+static inline int sys_fcntl(int fd, int cmd, long arg)
+{
+	return (int) syscall3(__SC_FCNTL,
+			      (long) (fd),
+			      (long) (cmd),
+			      (long) (arg));
+}
+
+static inline int sys_getpid(void)
+{
+	return (int) syscall0(__SC_GETPID);
+}
+
 static inline int sys_exit(int status)
 {
 	return (int) syscall1(__SC_EXIT,
@@ -40,7 +40,7 @@
 #include <linuxu/syscall.h>
 #include <linuxu/signal.h>
 
-#define IRQS_NUM    16
+#define IRQS_NUM    32
 
 /* IRQ handlers declarations */
 struct irq_handler {
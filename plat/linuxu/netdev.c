@@ -0,0 +1,894 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/*
+ * Host-backed network devices for the linuxu platform
+ *
+ * Copyright (c) 2026, The Unikraft Authors. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Each device is backed by a file descriptor of the host: Either a TAP
+ * device or an AF_PACKET socket bound to an existing interface. Received
+ * frames are read into netbufs that are allocated ahead with the
+ * receive buffer allocator of the queue. Both backends are non-blocking.
+ * The kernel signals readable descriptors with SIGIO, which is registered
+ * as interrupt to emulate receive queue interrupts.
+ *
+ * AF_PACKET sockets receive and transmit a burst of frames with a single
+ * recvmmsg()/sendmmsg() system call. TAP devices can only be read frame by
+ * frame.
+ *
+ * Devices are specified with the library parameter
+ *   linuxu.netdev=<tap|packet>:<ifname>[,<tap|packet>:<ifname>...]
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <uk/alloc.h>
+#include <uk/assert.h>
+#include <uk/print.h>
+#include <uk/bus.h>
+#include <uk/libparam.h>
+#include <uk/netdev.h>
+#include <uk/netdev_driver.h>
+#include <uk/plat/irq.h>
+#include <linuxu/syscall.h>
+#include <linuxu/signal.h>
+#include <linuxu/net.h>
+
+#define DRIVER_NAME		"linuxu-net"
+
+#define LINUXU_NET_MAX_DEVS	8
+/* Maximum number of prepared receive buffers of a queue */
+#define LINUXU_NET_MAX_DESC	1024
+#define LINUXU_NET_DEF_DESC	256
+/* Frames per recvmmsg()/sendmmsg() system call */
+#define LINUXU_NET_BATCH	32
+/* Maximum number of netbufs of a transmitted packet */
+#define LINUXU_NET_MAX_SEGS	16
+/* Socket receive buffer, absorbs bursts until the queue is serviced */
+#define LINUXU_NET_SOCKBUF	(4 << 20)
+
+#define LINUXU_NET_INTR_EN	(1 << 0)
+#define LINUXU_NET_INTR_USR_EN	(1 << 1)
+
+#define to_linuxu_netdev(ndev) \
+	__containerof(ndev, struct linuxu_net_device, netdev)
+
+enum linuxu_net_backend {
+	LINUXU_NET_TAP = 0,
+	LINUXU_NET_PACKET,
+};
+
+struct linuxu_net_device;
+
+struct uk_netdev_rx_queue {
+	struct linuxu_net_device *ldev;
+	uint16_t lqueue_id;
+	/* Number of receive buffers that are kept ready */
+	uint16_t nb_desc;
+	/* Interrupt flags (LINUXU_NET_INTR_*) */
+	uint8_t intr_enabled;
+	uk_netdev_alloc_rxpkts alloc_rxpkts;
+	void *alloc_rxpkts_argp;
+	/* Prepared receive buffers, used from the top */
+	struct uk_netbuf **bufs;
+	uint16_t nb_bufs;
+	/* System call arguments for a receive burst */
+	struct k_mmsghdr msgs[LINUXU_NET_BATCH];
+	struct k_iovec iovs[LINUXU_NET_BATCH];
+};
+
+struct uk_netdev_tx_queue {
+	struct linuxu_net_device *ldev;
+	uint16_t lqueue_id;
+	/* System call arguments for a transmit burst */
+	struct k_mmsghdr msgs[LINUXU_NET_BATCH];
+	struct k_iovec iovs[LINUXU_NET_BATCH][LINUXU_NET_MAX_SEGS];
+};
+
+struct linuxu_net_device {
+	struct uk_netdev netdev;
+	enum linuxu_net_backend backend;
+	char ifname[K_IFNAMSIZ];
+	/* Host file descriptor of the TAP device or packet socket */
+	int fd;
+	uint16_t mtu;
+	struct uk_hwaddr hwaddr;
+	struct uk_netdev_rx_queue rxq;
+	struct uk_netdev_tx_queue txq;
+};
+
+static struct uk_alloc *a;
+static struct linuxu_net_device *ldevs[LINUXU_NET_MAX_DEVS];
+static unsigned int ldevs_count;
+
+static char *netdev;
+UK_LIB_PARAM_STR(netdev);
+
+static inline __u16 _htons(__u16 x)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	return __builtin_bswap16(x);
+#else
+	return x;
+#endif
+}
+
+/*
+ * Not every file type supports FIONREAD (e.g., TAP devices), so we poll the
+ * descriptor instead
+ */
+static int _pending(int fd)
+{
+	struct k_timespec timeout = { 0, 0 };
+	k_fd_set readfds;
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(readfds.fds_bits); ++i)
+		readfds.fds_bits[i] = 0;
+	readfds.fds_bits[fd / (8 * sizeof(long))] |=
+		1UL << (fd % (8 * sizeof(long)));
+
+	return (sys_pselect6(fd + 1, &readfds, NULL, NULL,
+			     &timeout, NULL) > 0);
+}
+
+/*
+ * SIGIO is shared by all devices, we check every armed receive queue for
+ * available frames
+ */
+static int linuxu_net_irq_handle(void *arg __unused)
+{
+	struct uk_netdev_rx_queue *rxq;
+	unsigned int i;
+
+	for (i = 0; i < ldevs_count; ++i) {
+		rxq = &ldevs[i]->rxq;
+		if (!(rxq->intr_enabled & LINUXU_NET_INTR_EN)
+		    || !_pending(ldevs[i]->fd))
+			continue;
+
+		/* Interrupts stay off until the queue was drained */
+		rxq->intr_enabled &= ~LINUXU_NET_INTR_EN;
+		uk_netdev_drv_rx_event(&ldevs[i]->netdev, rxq->lqueue_id);
+	}
+	return 1;
+}
+
+/*
+ * Arms the receive interrupt. Returns 1 if frames are pending, in that
+ * case the interrupt stays disarmed.
+ */
+static int linuxu_net_rxq_arm(struct uk_netdev_rx_queue *rxq)
+{
+	rxq->intr_enabled |= LINUXU_NET_INTR_EN;
+	if (!_pending(rxq->ldev->fd))
+		return 0;
+
+	rxq->intr_enabled &= ~LINUXU_NET_INTR_EN;
+	return 1;
+}
+
+static int linuxu_net_rxq_fillup(struct uk_netdev_rx_queue *rxq)
+{
+	uint16_t req, cnt;
+
+	while (rxq->nb_bufs < rxq->nb_desc) {
+		req = rxq->nb_desc - rxq->nb_bufs;
+		cnt = rxq->alloc_rxpkts(rxq->alloc_rxpkts_argp,
+					&rxq->bufs[rxq->nb_bufs], req);
+		rxq->nb_bufs += cnt;
+		if (unlikely(cnt < req)) {
+			uk_netdev_drv_rxq_stats_add(&rxq->ldev->netdev,
+						    rxq->lqueue_id,
+						    refill_fail, 1);
+			return UK_NETDEV_STATUS_UNDERRUN;
+		}
+	}
+	return 0;
+}
+
+static inline struct uk_netbuf *linuxu_net_rxq_top(
+					struct uk_netdev_rx_queue *rxq,
+					uint16_t i)
+{
+	return rxq->bufs[rxq->nb_bufs - 1 - i];
+}
+
+static inline size_t _tailroom(struct uk_netbuf *nb)
+{
+	return (size_t) ((__u8 *) nb->buf + nb->buflen - (__u8 *) nb->data);
+}
+
+/*
+ * Backend receive functions: They read up to *cnt frames into the prepared
+ * buffers from the top of the stack and return the frames in pkt[]. The
+ * number of returned frames is stored in *cnt. The return value is the
+ * number of consumed buffers or a negative error code.
+ */
+
+/* Reads frames from a TAP device, one by one */
+static int linuxu_net_recv_tap(struct uk_netdev_rx_queue *rxq,
+			       struct uk_netbuf *pkt[], uint16_t *cnt)
+{
+	struct uk_netbuf *nb;
+	ssize_t len;
+	uint16_t i;
+
+	for (i = 0; i < *cnt; ++i) {
+		nb = linuxu_net_rxq_top(rxq, i);
+		len = sys_read(rxq->ldev->fd, nb->data, _tailroom(nb));
+		if (len < 0) {
+			if (len == -K_EAGAIN || len == -K_EINTR)
+				break;
+			uk_pr_err("%s: Failed to read frame: %ld\n",
+				  rxq->ldev->ifname, (long) len);
+			if (i == 0)
+				return -EIO;
+			break;
+		}
+		nb->len = (uint16_t) len;
+		pkt[i] = nb;
+	}
+	*cnt = i;
+	return i;
+}
+
+/* Receives a burst of frames from a packet socket */
+static int linuxu_net_recv_packet(struct uk_netdev_rx_queue *rxq,
+				  struct uk_netbuf *pkt[], uint16_t *cnt)
+{
+	struct uk_netbuf *nb;
+	uint16_t i, j, req;
+	int rc;
+
+	req = MIN(*cnt, LINUXU_NET_BATCH);
+	for (i = 0; i < req; ++i) {
+		nb = linuxu_net_rxq_top(rxq, i);
+		rxq->iovs[i].iov_base = nb->data;
+		rxq->iovs[i].iov_len = _tailroom(nb);
+		memset(&rxq->msgs[i], 0, sizeof(rxq->msgs[i]));
+		rxq->msgs[i].msg_hdr.msg_iov = &rxq->iovs[i];
+		rxq->msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	rc = sys_recvmmsg(rxq->ldev->fd, rxq->msgs, req, K_MSG_DONTWAIT, NULL);
+	if (rc < 0) {
+		*cnt = 0;
+		if (rc == -K_EAGAIN || rc == -K_EINTR)
+			return 0;
+		uk_pr_err("%s: Failed to receive frames: %d\n",
+			  rxq->ldev->ifname, rc);
+		return -EIO;
+	}
+
+	for (i = 0, j = 0; i < (uint16_t) rc; ++i) {
+		nb = linuxu_net_rxq_top(rxq, i);
+		/* Frames that did not fit into the buffer are dropped */
+		if (unlikely(rxq->msgs[i].msg_hdr.msg_flags & K_MSG_TRUNC)) {
+			uk_netdev_drv_rxq_stats_add(&rxq->ldev->netdev,
+						    rxq->lqueue_id, drops, 1);
+			uk_netbuf_free(nb);
+			continue;
+		}
+		nb->len = (uint16_t) rxq->msgs[i].msg_len;
+		pkt[j++] = nb;
+	}
+	*cnt = j;
+	return rc;
+}
+
+static int linuxu_net_recv_burst(struct uk_netdev *dev,
+				 struct uk_netdev_rx_queue *rxq,
+				 struct uk_netbuf *pkt[],
+				 uint16_t *cnt)
+{
+	struct linuxu_net_device *ldev;
+	uint16_t req, i;
+	int status = 0x0;
+	int rc;
+
+	UK_ASSERT(dev && rxq);
+	UK_ASSERT(pkt && cnt);
+
+	ldev = to_linuxu_netdev(dev);
+	/* Queue interrupts have to be off when calling receive */
+	UK_ASSERT(!(rxq->intr_enabled & LINUXU_NET_INTR_EN));
+
+	req = MIN(*cnt, rxq->nb_bufs);
+	if (ldev->backend == LINUXU_NET_PACKET)
+		rc = linuxu_net_recv_packet(rxq, pkt, &req);
+	else
+		rc = linuxu_net_recv_tap(rxq, pkt, &req);
+	if (unlikely(rc < 0))
+		return rc;
+	rxq->nb_bufs -= rc;
+
+	for (i = 0; i < req; ++i) {
+		uk_netdev_drv_rxq_stats_add(dev, rxq->lqueue_id, packets, 1);
+		uk_netdev_drv_rxq_stats_add(dev, rxq->lqueue_id, bytes,
+					    pkt[i]->len);
+	}
+
+	/* Replace the consumed buffers */
+	status |= linuxu_net_rxq_fillup(rxq);
+
+	if ((uint16_t) rc == *cnt) {
+		/* The queue was not drained, further frames are likely */
+		status |= UK_NETDEV_STATUS_MORE;
+	} else if (rxq->intr_enabled & LINUXU_NET_INTR_USR_EN) {
+		/* Enable the interrupt only when user had previously enabled
+		 * it. Frames that arrived after reading the queue are
+		 * reported with UK_NETDEV_STATUS_MORE.
+		 */
+		if (linuxu_net_rxq_arm(rxq))
+			status |= UK_NETDEV_STATUS_MORE;
+	}
+
+	*cnt = req;
+	return status | ((req > 0) ? UK_NETDEV_STATUS_SUCCESS : 0x0);
+}
+
+/* Collects the netbufs of a packet as I/O vector */
+static int linuxu_net_iov(struct uk_netbuf *pkt, struct k_iovec *iov)
+{
+	struct uk_netbuf *nb;
+	int i = 0;
+
+	UK_NETBUF_CHAIN_FOREACH(nb, pkt) {
+		if (unlikely(i == LINUXU_NET_MAX_SEGS))
+			return -ENOTSUP;
+		iov[i].iov_base = nb->data;
+		iov[i].iov_len = nb->len;
+		i++;
+	}
+	return i;
+}
+
+/*
+ * Backend transmit functions: They send up to cnt packets and return the
+ * number of sent packets or a negative error code. Sent packets are
+ * free'd by the caller.
+ */
+
+/* Writes packets to a TAP device, one by one */
+static int linuxu_net_xmit_tap(struct uk_netdev_tx_queue *txq,
+			       struct uk_netbuf *pkt[], uint16_t cnt)
+{
+	struct k_iovec *iov = txq->iovs[0];
+	ssize_t len;
+	uint16_t i;
+	int iovcnt;
+
+	for (i = 0; i < cnt; ++i) {
+		iovcnt = linuxu_net_iov(pkt[i], iov);
+		if (unlikely(iovcnt < 0))
+			return (i > 0) ? i : iovcnt;
+		len = sys_writev(txq->ldev->fd, iov, iovcnt);
+		if (len < 0) {
+			if (len == -K_EAGAIN || len == -K_EINTR)
+				return i;
+			uk_pr_err("%s: Failed to write frame: %ld\n",
+				  txq->ldev->ifname, (long) len);
+			return (i > 0) ? i : -EIO;
+		}
+		uk_netdev_drv_txq_stats_add(&txq->ldev->netdev,
+					    txq->lqueue_id, bytes, len);
+	}
+	return i;
+}
+
+/* Sends a burst of packets to a packet socket */
+static int linuxu_net_xmit_packet(struct uk_netdev_tx_queue *txq,
+				  struct uk_netbuf *pkt[], uint16_t cnt)
+{
+	uint16_t i;
+	int iovcnt;
+	int rc;
+
+	cnt = MIN(cnt, LINUXU_NET_BATCH);
+	for (i = 0; i < cnt; ++i) {
+		iovcnt = linuxu_net_iov(pkt[i], txq->iovs[i]);
+		if (unlikely(iovcnt < 0)) {
+			if (i == 0)
+				return iovcnt;
+			break;
+		}
+		memset(&txq->msgs[i], 0, sizeof(txq->msgs[i]));
+		txq->msgs[i].msg_hdr.msg_iov = txq->iovs[i];
+		txq->msgs[i].msg_hdr.msg_iovlen = iovcnt;
+	}
+
+	rc = sys_sendmmsg(txq->ldev->fd, txq->msgs, i, K_MSG_DONTWAIT);
+	if (rc < 0) {
+		if (rc == -K_EAGAIN || rc == -K_EINTR)
+			return 0;
+		uk_pr_err("%s: Failed to send frames: %d\n",
+			  txq->ldev->ifname, rc);
+		return -EIO;
+	}
+
+	/* The kernel reports the number of sent bytes of each message */
+	for (i = 0; i < (uint16_t) rc; ++i)
+		uk_netdev_drv_txq_stats_add(&txq->ldev->netdev, txq->lqueue_id,
+					    bytes, txq->msgs[i].msg_len);
+	return rc;
+}
+
+static int linuxu_net_xmit_burst(struct uk_netdev *dev,
+				 struct uk_netdev_tx_queue *txq,
+				 struct uk_netbuf *pkt[],
+				 uint16_t *cnt)
+{
+	struct linuxu_net_device *ldev;
+	uint16_t sent = 0;
+	int rc = 0;
+	uint16_t i;
+
+	UK_ASSERT(dev && txq);
+	UK_ASSERT(pkt && cnt);
+
+	ldev = to_linuxu_netdev(dev);
+	while (sent < *cnt) {
+		if (ldev->backend == LINUXU_NET_PACKET)
+			rc = linuxu_net_xmit_packet(txq, &pkt[sent],
+						    *cnt - sent);
+		else
+			rc = linuxu_net_xmit_tap(txq, &pkt[sent],
+						 *cnt - sent);
+		if (rc <= 0)
+			break;
+
+		/* The host copied the frames already */
+		for (i = sent; i < sent + rc; ++i)
+			uk_netbuf_free(pkt[i]);
+		sent += rc;
+	}
+
+	uk_netdev_drv_txq_stats_add(dev, txq->lqueue_id, packets, sent);
+	if (sent < *cnt) {
+		if (rc < 0)
+			uk_netdev_drv_txq_stats_add(dev, txq->lqueue_id,
+						    errors, 1);
+		else
+			uk_netdev_drv_txq_stats_add(dev, txq->lqueue_id,
+						    ring_full, 1);
+	}
+	if (unlikely(rc < 0 && sent == 0))
+		return rc;
+
+	*cnt = sent;
+	if (sent == 0)
+		return 0x0;
+	/* The send buffer of the host had space for all packets */
+	return UK_NETDEV_STATUS_SUCCESS
+		| ((rc > 0) ? UK_NETDEV_STATUS_MORE : 0x0);
+}
+
+static int linuxu_net_rxq_intr_enable(struct uk_netdev *dev __unused,
+				      struct uk_netdev_rx_queue *rxq)
+{
+	UK_ASSERT(rxq);
+
+	if (rxq->intr_enabled & LINUXU_NET_INTR_EN)
+		return 0;
+
+	rxq->intr_enabled |= LINUXU_NET_INTR_USR_EN;
+	return linuxu_net_rxq_arm(rxq);
+}
+
+static int linuxu_net_rxq_intr_disable(struct uk_netdev *dev __unused,
+				       struct uk_netdev_rx_queue *rxq)
+{
+	UK_ASSERT(rxq);
+
+	rxq->intr_enabled &= ~(LINUXU_NET_INTR_USR_EN | LINUXU_NET_INTR_EN);
+	return 0;
+}
+
+static void linuxu_net_info_get(struct uk_netdev *dev __unused,
+				struct uk_netdev_info *dev_info)
+{
+	UK_ASSERT(dev_info);
+
+	dev_info->max_rx_queues = 1;
+	dev_info->max_tx_queues = 1;
+	dev_info->in_queue_pairs = 1;
+	dev_info->max_mtu = UK_ETH_PAYLOAD_MAXLEN;
+	dev_info->nb_encap_tx = 0;
+	dev_info->nb_encap_rx = 0;
+	dev_info->ioalign = sizeof(void *);
+	dev_info->features = UK_FEATURE_RXQ_INTR_AVAILABLE;
+}
+
+static int linuxu_net_configure(struct uk_netdev *dev __unused,
+				const struct uk_netdev_conf *conf)
+{
+	UK_ASSERT(conf);
+
+	if (conf->nb_rx_queues > 1 || conf->nb_tx_queues > 1)
+		return -ENOTSUP;
+	return 0;
+}
+
+static int linuxu_net_rxq_info_get(struct uk_netdev *dev __unused,
+				   uint16_t queue_id __unused,
+				   struct uk_netdev_queue_info *qinfo)
+{
+	UK_ASSERT(qinfo);
+
+	qinfo->nb_min = 1;
+	qinfo->nb_max = LINUXU_NET_MAX_DESC;
+	qinfo->nb_is_power_of_two = 0;
+	return 0;
+}
+
+static int linuxu_net_txq_info_get(struct uk_netdev *dev __unused,
+				   uint16_t queue_id __unused,
+				   struct uk_netdev_queue_info *qinfo)
+{
+	UK_ASSERT(qinfo);
+
+	/* Transmitted frames are copied by the host immediately */
+	qinfo->nb_min = 1;
+	qinfo->nb_max = LINUXU_NET_MAX_DESC;
+	qinfo->nb_is_power_of_two = 0;
+	return 0;
+}
+
+static struct uk_netdev_rx_queue *linuxu_net_rxq_configure(
+				struct uk_netdev *dev, uint16_t queue_id,
+				uint16_t nb_desc,
+				struct uk_netdev_rxqueue_conf *conf)
+{
+	struct linuxu_net_device *ldev;
+	struct uk_netdev_rx_queue *rxq;
+
+	UK_ASSERT(dev && conf);
+	UK_ASSERT(queue_id == 0);
+
+	ldev = to_linuxu_netdev(dev);
+	rxq = &ldev->rxq;
+	rxq->ldev = ldev;
+	rxq->lqueue_id = queue_id;
+	rxq->nb_desc = nb_desc ? MIN(nb_desc, LINUXU_NET_MAX_DESC)
+			       : LINUXU_NET_DEF_DESC;
+	rxq->alloc_rxpkts = conf->alloc_rxpkts;
+	rxq->alloc_rxpkts_argp = conf->alloc_rxpkts_argp;
+	rxq->intr_enabled = 0;
+	rxq->nb_bufs = 0;
+	rxq->bufs = uk_calloc(conf->a, rxq->nb_desc, sizeof(*rxq->bufs));
+	if (!rxq->bufs)
+		return ERR2PTR(-ENOMEM);
+
+	return rxq;
+}
+
+static struct uk_netdev_tx_queue *linuxu_net_txq_configure(
+				struct uk_netdev *dev, uint16_t queue_id,
+				uint16_t nb_desc __unused,
+				struct uk_netdev_txqueue_conf *conf __unused)
+{
+	struct linuxu_net_device *ldev;
+
+	UK_ASSERT(dev);
+	UK_ASSERT(queue_id == 0);
+
+	ldev = to_linuxu_netdev(dev);
+	ldev->txq.ldev = ldev;
+	ldev->txq.lqueue_id = queue_id;
+	return &ldev->txq;
+}
+
+static int linuxu_net_start(struct uk_netdev *dev)
+{
+	struct linuxu_net_device *ldev;
+	int rc;
+
+	UK_ASSERT(dev);
+
+	ldev = to_linuxu_netdev(dev);
+	if (ldev->rxq.bufs)
+		(void) linuxu_net_rxq_fillup(&ldev->rxq);
+
+	/* From now on, the host signals received frames with SIGIO */
+	rc = sys_fcntl(ldev->fd, K_F_SETOWN, sys_getpid());
+	if (rc >= 0)
+		rc = sys_fcntl(ldev->fd, K_F_SETFL, K_O_NONBLOCK | K_O_ASYNC);
+	if (rc < 0) {
+		uk_pr_err("%s: Failed to enable SIGIO: %d\n",
+			  ldev->ifname, rc);
+		return -EIO;
+	}
+
+	uk_pr_info(DRIVER_NAME ": %s started\n", ldev->ifname);
+	return 0;
+}
+
+static const struct uk_hwaddr *linuxu_net_hwaddr_get(struct uk_netdev *dev)
+{
+	UK_ASSERT(dev);
+
+	return &to_linuxu_netdev(dev)->hwaddr;
+}
+
+static int linuxu_net_hwaddr_set(struct uk_netdev *dev,
+				 const struct uk_hwaddr *hwaddr)
+{
+	UK_ASSERT(dev && hwaddr);
+
+	/* Both backends receive all frames, the address is used by the
+	 * network stack only
+	 */
+	to_linuxu_netdev(dev)->hwaddr = *hwaddr;
+	return 0;
+}
+
+static unsigned int linuxu_net_promisc_get(struct uk_netdev *dev __unused)
+{
+	return 1;
+}
+
+static uint16_t linuxu_net_mtu_get(struct uk_netdev *dev)
+{
+	UK_ASSERT(dev);
+
+	return to_linuxu_netdev(dev)->mtu;
+}
+
+static const struct uk_netdev_ops linuxu_net_ops = {
+	.configure = linuxu_net_configure,
+	.rxq_configure = linuxu_net_rxq_configure,
+	.txq_configure = linuxu_net_txq_configure,
+	.start = linuxu_net_start,
+	.rxq_intr_enable = linuxu_net_rxq_intr_enable,
+	.rxq_intr_disable = linuxu_net_rxq_intr_disable,
+	.info_get = linuxu_net_info_get,
+	.promiscuous_get = linuxu_net_promisc_get,
+	.hwaddr_get = linuxu_net_hwaddr_get,
+	.hwaddr_set = linuxu_net_hwaddr_set,
+	.mtu_get = linuxu_net_mtu_get,
+	.txq_info_get = linuxu_net_txq_info_get,
+	.rxq_info_get = linuxu_net_rxq_info_get,
+};
+
+/* Interface requests are issued on an ordinary socket */
+static int linuxu_net_ifreq(const char *ifname, unsigned long req,
+			    struct k_ifreq *ifr)
+{
+	int fd, rc;
+
+	fd = sys_socket(K_AF_INET, K_SOCK_DGRAM, 0);
+	if (fd < 0)
+		return fd;
+
+	strncpy(ifr->ifr_name, ifname, K_IFNAMSIZ - 1);
+	rc = sys_ioctl(fd, req, ifr);
+	sys_close(fd);
+	return rc;
+}
+
+static int linuxu_net_open_tap(struct linuxu_net_device *ldev)
+{
+	struct k_ifreq ifr;
+	int fd, rc;
+
+	fd = sys_open("/dev/net/tun", K_O_RDWR | K_O_NONBLOCK, 0);
+	if (fd < 0)
+		return fd;
+
+	/* Attaches to the TAP device, it is created if it does not exist */
+	memset(&ifr, 0, sizeof(ifr));
+	strncpy(ifr.ifr_name, ldev->ifname, K_IFNAMSIZ - 1);
+	ifr.ifr_flags = K_IFF_TAP | K_IFF_NO_PI;
+	rc = sys_ioctl(fd, K_TUNSETIFF, &ifr);
+	if (rc < 0) {
+		sys_close(fd);
+		return rc;
+	}
+
+	/* Best effort: Bring the host side of the device up */
+	memset(&ifr, 0, sizeof(ifr));
+	if (linuxu_net_ifreq(ldev->ifname, K_SIOCGIFFLAGS, &ifr) == 0
+	    && !(ifr.ifr_flags & K_IFF_UP)) {
+		ifr.ifr_flags |= K_IFF_UP;
+		linuxu_net_ifreq(ldev->ifname, K_SIOCSIFFLAGS, &ifr);
+	}
+	return fd;
+}
+
+static int linuxu_net_open_packet(struct linuxu_net_device *ldev)
+{
+	struct k_sockaddr_ll sll;
+	struct k_packet_mreq mreq;
+	struct k_ifreq ifr;
+	int fd, rc, one = 1, bufsz = LINUXU_NET_SOCKBUF;
+
+	fd = sys_socket(K_AF_PACKET, K_SOCK_RAW, _htons(K_ETH_P_ALL));
+	if (fd < 0)
+		return fd;
+
+	memset(&ifr, 0, sizeof(ifr));
+	strncpy(ifr.ifr_name, ldev->ifname, K_IFNAMSIZ - 1);
+	rc = sys_ioctl(fd, K_SIOCGIFINDEX, &ifr);
+	if (rc < 0)
+		goto err_close;
+
+	memset(&sll, 0, sizeof(sll));
+	sll.sll_family = K_AF_PACKET;
+	sll.sll_protocol = _htons(K_ETH_P_ALL);
+	sll.sll_ifindex = ifr.ifr_ifindex;
+	rc = sys_bind(fd, &sll, sizeof(sll));
+	if (rc < 0)
+		goto err_close;
+
+	/* We use our own hardware address */
+	memset(&mreq, 0, sizeof(mreq));
+	mreq.mr_ifindex = ifr.ifr_ifindex;
+	mreq.mr_type = K_PACKET_MR_PROMISC;
+	rc = sys_setsockopt(fd, K_SOL_PACKET, K_PACKET_ADD_MEMBERSHIP,
+			    &mreq, sizeof(mreq));
+	if (rc < 0)
+		goto err_close;
+
+	/* Best effort: Frames sent by the host are not for us */
+	sys_setsockopt(fd, K_SOL_PACKET, K_PACKET_IGNORE_OUTGOING,
+		       &one, sizeof(one));
+
+	/* Best effort: The default buffer holds only a few hundred frames */
+	if (sys_setsockopt(fd, K_SOL_SOCKET, K_SO_RCVBUFFORCE,
+			   &bufsz, sizeof(bufsz)) < 0)
+		sys_setsockopt(fd, K_SOL_SOCKET, K_SO_RCVBUF,
+			       &bufsz, sizeof(bufsz));
+	return fd;
+
+err_close:
+	sys_close(fd);
+	return rc;
+}
+
+static int linuxu_net_add_dev(enum linuxu_net_backend backend,
+			      const char *ifname, size_t len)
+{
+	struct linuxu_net_device *ldev;
+	struct k_ifreq ifr;
+	int pid, rc;
+
+	if (ldevs_count == LINUXU_NET_MAX_DEVS)
+		return -ENOSPC;
+	if (len == 0 || len >= K_IFNAMSIZ)
+		return -EINVAL;
+
+	ldev = uk_calloc(a, 1, sizeof(*ldev));
+	if (!ldev)
+		return -ENOMEM;
+	memcpy(ldev->ifname, ifname, len);
+	ldev->backend = backend;
+
+	if (backend == LINUXU_NET_PACKET)
+		ldev->fd = linuxu_net_open_packet(ldev);
+	else
+		ldev->fd = linuxu_net_open_tap(ldev);
+	if (ldev->fd < 0) {
+		uk_pr_err(DRIVER_NAME ": Failed to open %s: %d\n",
+			  ldev->ifname, ldev->fd);
+		rc = -EIO;
+		goto err_free;
+	}
+
+	memset(&ifr, 0, sizeof(ifr));
+	if (linuxu_net_ifreq(ldev->ifname, K_SIOCGIFMTU, &ifr) == 0
+	    && ifr.ifr_mtu > 0)
+		ldev->mtu = MIN(ifr.ifr_mtu, UK_ETH_PAYLOAD_MAXLEN);
+	else
+		ldev->mtu = UK_ETH_PAYLOAD_MAXLEN;
+
+	/* Locally administered address, unique per process and device */
+	pid = sys_getpid();
+	ldev->hwaddr.addr_bytes[0] = 0x02;
+	ldev->hwaddr.addr_bytes[1] = 0x75;
+	ldev->hwaddr.addr_bytes[2] = 0x6b;
+	ldev->hwaddr.addr_bytes[3] = (pid >> 8) & 0xff;
+	ldev->hwaddr.addr_bytes[4] = pid & 0xff;
+	ldev->hwaddr.addr_bytes[5] = ldevs_count;
+
+	ldev->netdev.rx_burst = linuxu_net_recv_burst;
+	ldev->netdev.tx_burst = linuxu_net_xmit_burst;
+	ldev->netdev.ops = &linuxu_net_ops;
+
+	rc = uk_netdev_drv_register(&ldev->netdev, a, DRIVER_NAME);
+	if (rc < 0) {
+		uk_pr_err(DRIVER_NAME ": Failed to register %s: %d\n",
+			  ldev->ifname, rc);
+		goto err_close;
+	}
+
+	ldevs[ldevs_count++] = ldev;
+	uk_pr_info(DRIVER_NAME ": Registered %s (%s)\n", ldev->ifname,
+		   (backend == LINUXU_NET_PACKET) ? "packet" : "tap");
+	return 0;
+
+err_close:
+	sys_close(ldev->fd);
+err_free:
+	uk_free(a, ldev);
+	return rc;
+}
+
+static int linuxu_net_probe(void)
+{
+	enum linuxu_net_backend backend;
+	const char *p, *sep, *end;
+	int rc;
+
+	if (!netdev)
+		return 0;
+
+	/* Invalid entries are skipped like devices that fail to open */
+	for (p = netdev; *p; p = (*end) ? end + 1 : end) {
+		end = strchrnul(p, ',');
+		sep = strchr(p, ':');
+		if (sep && sep < end && sep - p == 3
+		    && strncmp(p, "tap", 3) == 0) {
+			backend = LINUXU_NET_TAP;
+		} else if (sep && sep < end && sep - p == 6
+			   && strncmp(p, "packet", 6) == 0) {
+			backend = LINUXU_NET_PACKET;
+		} else {
+			uk_pr_err(DRIVER_NAME ": Invalid device \"%.*s\"\n",
+				  (int) (end - p), p);
+			continue;
+		}
+
+		rc = linuxu_net_add_dev(backend, sep + 1, end - sep - 1);
+		if (rc < 0)
+			uk_pr_err(DRIVER_NAME ": Failed to add device: %d\n",
+				  rc);
+	}
+
+	if (ldevs_count == 0)
+		return 0;
+	rc = ukplat_irq_register(SIGIO, linuxu_net_irq_handle, NULL);
+	if (rc < 0)
+		uk_pr_err(DRIVER_NAME ": Failed to register SIGIO: %d\n", rc);
+	return rc;
+}
+
+static int linuxu_net_init(struct uk_alloc *drv_allocator)
+{
+	UK_ASSERT(drv_allocator);
+
+	a = drv_allocator;
+	return 0;
+}
+
+static struct uk_bus linuxu_net_bus = {
+	.init = linuxu_net_init,
+	.probe = linuxu_net_probe,
+};
+UK_BUS_REGISTER(&linuxu_net_bus);